@@ -32,17 +32,809 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/device.hpp>
 #include <vpnes/core/bus.hpp>
 #include <vpnes/core/mboard.hpp>
+#include <vpnes/core/blip.hpp>
+#include <vpnes/core/cpu.hpp>
 
 namespace vpnes {
 
 namespace core {
 
+namespace apu {
+
+/**
+ * Channel timer
+ *
+ * Counts CPU cycles till the next clock of channel sequencer. Any amount of
+ * cycles is advanced at once, so channels don't need per-cycle stepping.
+ */
+class CTimer {
+public:
+	/**
+	 * Returned by channels when output cannot change on timer clocks
+	 */
+	static constexpr ticks_t Idle = std::numeric_limits<ticks_t>::max();
+
+protected:
+	/**
+	 * Cycles till next clock (1 .. period)
+	 */
+	ticks_t m_Counter;
+	/**
+	 * Period in CPU cycles
+	 */
+	ticks_t m_Period;
+
+	/**
+	 * Advances the timer
+	 *
+	 * @param cycles Amount of CPU cycles
+	 * @return Number of clocks
+	 */
+	ticks_t clockTimer(ticks_t cycles) {
+		if (cycles < m_Counter) {
+			m_Counter -= cycles;
+			return 0;
+		}
+		cycles -= m_Counter;
+		m_Counter = m_Period - cycles % m_Period;
+		return 1 + cycles / m_Period;
+	}
+
+public:
+	/**
+	 * Constructs the object
+	 *
+	 * @param period Period in CPU cycles
+	 */
+	explicit CTimer(ticks_t period) : m_Counter(period), m_Period(period) {
+	}
+	/**
+	 * Gets cycles till next clock
+	 *
+	 * @return Cycles till next clock
+	 */
+	ticks_t getCounter() const {
+		return m_Counter;
+	}
+};
+
+/**
+ * Envelope generator
+ */
+class CEnvelope {
+private:
+	/**
+	 * Loop, constant volume and volume / divider period bits
+	 */
+	std::uint8_t m_Control;
+	/**
+	 * Divider
+	 */
+	std::uint8_t m_Divider;
+	/**
+	 * Decay level
+	 */
+	std::uint8_t m_Decay;
+	/**
+	 * Start flag
+	 */
+	bool m_Start;
+
+public:
+	/**
+	 * Constructs the object
+	 */
+	CEnvelope() : m_Control(), m_Divider(), m_Decay(), m_Start() {
+	}
+
+	/**
+	 * Writes control bits
+	 *
+	 * @param val Register value
+	 */
+	void write(std::uint8_t val) {
+		m_Control = val & 0x3f;
+	}
+	/**
+	 * Restarts the envelope on next quarter frame
+	 */
+	void restart() {
+		m_Start = true;
+	}
+	/**
+	 * Clocks the envelope (quarter frame)
+	 */
+	void clock() {
+		if (m_Start) {
+			m_Start = false;
+			m_Decay = 15;
+			m_Divider = m_Control & 0x0f;
+		} else if (m_Divider == 0) {
+			m_Divider = m_Control & 0x0f;
+			if (m_Decay > 0) {
+				m_Decay--;
+			} else if (m_Control & 0x20) {
+				m_Decay = 15;
+			}
+		} else {
+			m_Divider--;
+		}
+	}
+	/**
+	 * Gets volume
+	 *
+	 * @return Volume
+	 */
+	int getVolume() const {
+		return (m_Control & 0x10) ? (m_Control & 0x0f) : m_Decay;
+	}
+};
+
+/**
+ * Length counter
+ */
+class CLengthCounter {
+private:
+	/**
+	 * Load values
+	 */
+	static const std::uint8_t LengthTable[32];
+
+	/**
+	 * Counter
+	 */
+	std::uint8_t m_Counter;
+	/**
+	 * Halt flag
+	 */
+	bool m_Halt;
+	/**
+	 * Channel is enabled by status register
+	 */
+	bool m_Enabled;
+
+public:
+	/**
+	 * Constructs the object
+	 */
+	CLengthCounter() : m_Counter(), m_Halt(), m_Enabled() {
+	}
+
+	/**
+	 * Enables or disables the channel
+	 *
+	 * @param enabled True to enable
+	 */
+	void setEnabled(bool enabled) {
+		m_Enabled = enabled;
+		if (!enabled) {
+			m_Counter = 0;
+		}
+	}
+	/**
+	 * Sets halt flag
+	 *
+	 * @param halt Halt flag
+	 */
+	void setHalt(bool halt) {
+		m_Halt = halt;
+	}
+	/**
+	 * Loads the counter
+	 *
+	 * @param val Register value, index is in the upper 5 bits
+	 */
+	void load(std::uint8_t val) {
+		if (m_Enabled) {
+			m_Counter = LengthTable[val >> 3];
+		}
+	}
+	/**
+	 * Clocks the counter (half frame)
+	 */
+	void clock() {
+		if (!m_Halt && m_Counter > 0) {
+			m_Counter--;
+		}
+	}
+	/**
+	 * Checks if counter is not zero
+	 *
+	 * @return True if channel is not silenced by counter
+	 */
+	bool isActive() const {
+		return m_Counter != 0;
+	}
+};
+
+/**
+ * Pulse channel
+ */
+class CPulse : public CTimer {
+private:
+	/**
+	 * Duty cycle sequences
+	 */
+	static const std::uint8_t DutyTable[4][8];
+
+	/**
+	 * Envelope
+	 */
+	CEnvelope m_Envelope;
+	/**
+	 * Length counter
+	 */
+	CLengthCounter m_Length;
+	/**
+	 * Duty cycle
+	 */
+	std::uint8_t m_Duty;
+	/**
+	 * Sequencer step
+	 */
+	std::uint8_t m_Step;
+	/**
+	 * Timer reload value
+	 */
+	std::uint16_t m_Reload;
+	/**
+	 * Sweep register
+	 */
+	std::uint8_t m_Sweep;
+	/**
+	 * Sweep divider
+	 */
+	std::uint8_t m_SweepDivider;
+	/**
+	 * Sweep reload flag
+	 */
+	bool m_SweepReload;
+	/**
+	 * Negation adds one's complement (first channel)
+	 */
+	bool m_OnesComplement;
+
+	/**
+	 * Gets target period of sweep unit
+	 *
+	 * @return Target period
+	 */
+	int getSweepTarget() const {
+		int change = m_Reload >> (m_Sweep & 0x07);
+		if (m_Sweep & 0x08) {
+			return m_Reload - change - (m_OnesComplement ? 1 : 0);
+		}
+		return m_Reload + change;
+	}
+	/**
+	 * Checks if the channel is muted by timer or sweep
+	 *
+	 * @return True if muted
+	 */
+	bool isMuted() const {
+		return m_Reload < 8 || getSweepTarget() > 0x07ff;
+	}
+	/**
+	 * Updates timer period from reload value
+	 */
+	void updatePeriod() {
+		m_Period = (m_Reload + 1) * 2;
+	}
+
+public:
+	/**
+	 * Constructs the object
+	 *
+	 * @param onesComplement Negation adds one's complement
+	 */
+	explicit CPulse(bool onesComplement)
+	    : CTimer(2)
+	    , m_Envelope()
+	    , m_Length()
+	    , m_Duty()
+	    , m_Step()
+	    , m_Reload()
+	    , m_Sweep()
+	    , m_SweepDivider()
+	    , m_SweepReload()
+	    , m_OnesComplement(onesComplement) {
+	}
+
+	/**
+	 * Writes register
+	 *
+	 * @param val Value
+	 * @param reg Register number (0 .. 3)
+	 */
+	void writeReg(std::uint8_t val, int reg);
+	/**
+	 * Enables or disables the channel
+	 *
+	 * @param enabled True to enable
+	 */
+	void setEnabled(bool enabled) {
+		m_Length.setEnabled(enabled);
+	}
+	/**
+	 * Checks length counter
+	 *
+	 * @return True if length counter is not zero
+	 */
+	bool isPlaying() const {
+		return m_Length.isActive();
+	}
+	/**
+	 * Clocks envelope (quarter frame)
+	 */
+	void clockQuarter() {
+		m_Envelope.clock();
+	}
+	/**
+	 * Clocks length counter and sweep (half frame)
+	 */
+	void clockHalf();
+	/**
+	 * Checks if output can change on timer clocks
+	 *
+	 * @return True if active
+	 */
+	bool isActive() const {
+		return m_Length.isActive() && !isMuted() && m_Envelope.getVolume() > 0;
+	}
+	/**
+	 * Gets cycles till next output change
+	 *
+	 * @return Cycles till next change or Idle
+	 */
+	ticks_t getNext() const;
+	/**
+	 * Advances the channel
+	 *
+	 * @param cycles Amount of CPU cycles
+	 */
+	void advance(ticks_t cycles) {
+		m_Step = (m_Step + clockTimer(cycles)) & 0x07;
+	}
+	/**
+	 * Gets output level
+	 *
+	 * @return Output level (0 .. 15)
+	 */
+	int getLevel() const {
+		if (!m_Length.isActive() || isMuted() || !DutyTable[m_Duty][m_Step]) {
+			return 0;
+		}
+		return m_Envelope.getVolume();
+	}
+};
+
+/**
+ * Triangle channel
+ */
+class CTriangle : public CTimer {
+private:
+	/**
+	 * Length counter
+	 */
+	CLengthCounter m_Length;
+	/**
+	 * Control flag and linear counter reload value
+	 */
+	std::uint8_t m_Control;
+	/**
+	 * Linear counter
+	 */
+	std::uint8_t m_Linear;
+	/**
+	 * Linear counter reload flag
+	 */
+	bool m_LinearReload;
+	/**
+	 * Timer reload value
+	 */
+	std::uint16_t m_Reload;
+	/**
+	 * Sequencer step
+	 */
+	std::uint8_t m_Step;
+
+public:
+	/**
+	 * Constructs the object
+	 */
+	CTriangle()
+	    : CTimer(1)
+	    , m_Length()
+	    , m_Control()
+	    , m_Linear()
+	    , m_LinearReload()
+	    , m_Reload()
+	    , m_Step() {
+	}
+
+	/**
+	 * Writes register
+	 *
+	 * @param val Value
+	 * @param reg Register number (0 .. 3)
+	 */
+	void writeReg(std::uint8_t val, int reg);
+	/**
+	 * Enables or disables the channel
+	 *
+	 * @param enabled True to enable
+	 */
+	void setEnabled(bool enabled) {
+		m_Length.setEnabled(enabled);
+	}
+	/**
+	 * Checks length counter
+	 *
+	 * @return True if length counter is not zero
+	 */
+	bool isPlaying() const {
+		return m_Length.isActive();
+	}
+	/**
+	 * Clocks linear counter (quarter frame)
+	 */
+	void clockQuarter();
+	/**
+	 * Clocks length counter (half frame)
+	 */
+	void clockHalf() {
+		m_Length.clock();
+	}
+	/**
+	 * Checks if sequencer is running
+	 *
+	 * Ultrasonic periods are not run, the output holds instead of popping.
+	 *
+	 * @return True if active
+	 */
+	bool isActive() const {
+		return m_Length.isActive() && m_Linear > 0 && m_Reload >= 2;
+	}
+	/**
+	 * Gets cycles till next output change
+	 *
+	 * @return Cycles till next change or Idle
+	 */
+	ticks_t getNext() const {
+		return isActive() ? m_Counter : Idle;
+	}
+	/**
+	 * Advances the channel
+	 *
+	 * @param cycles Amount of CPU cycles
+	 */
+	void advance(ticks_t cycles) {
+		ticks_t clocks = clockTimer(cycles);
+		if (isActive()) {
+			m_Step = (m_Step + clocks) & 0x1f;
+		}
+	}
+	/**
+	 * Gets output level
+	 *
+	 * @return Output level (0 .. 15)
+	 */
+	int getLevel() const {
+		return (m_Step & 0x10) ? (m_Step & 0x0f) : (~m_Step & 0x0f);
+	}
+};
+
+/**
+ * Noise channel
+ */
+class CNoise : public CTimer {
+private:
+	/**
+	 * Timer periods
+	 */
+	static const std::uint16_t PeriodTable[16];
+
+	/**
+	 * Envelope
+	 */
+	CEnvelope m_Envelope;
+	/**
+	 * Length counter
+	 */
+	CLengthCounter m_Length;
+	/**
+	 * Shift register
+	 */
+	std::uint16_t m_Shift;
+	/**
+	 * Feedback bit for short mode
+	 */
+	int m_FeedbackBit;
+
+public:
+	/**
+	 * Constructs the object
+	 */
+	CNoise()
+	    : CTimer(PeriodTable[0])
+	    , m_Envelope()
+	    , m_Length()
+	    , m_Shift(1)
+	    , m_FeedbackBit(1) {
+	}
+
+	/**
+	 * Writes register
+	 *
+	 * @param val Value
+	 * @param reg Register number (0 .. 3)
+	 */
+	void writeReg(std::uint8_t val, int reg);
+	/**
+	 * Enables or disables the channel
+	 *
+	 * @param enabled True to enable
+	 */
+	void setEnabled(bool enabled) {
+		m_Length.setEnabled(enabled);
+	}
+	/**
+	 * Checks length counter
+	 *
+	 * @return True if length counter is not zero
+	 */
+	bool isPlaying() const {
+		return m_Length.isActive();
+	}
+	/**
+	 * Clocks envelope (quarter frame)
+	 */
+	void clockQuarter() {
+		m_Envelope.clock();
+	}
+	/**
+	 * Clocks length counter (half frame)
+	 */
+	void clockHalf() {
+		m_Length.clock();
+	}
+	/**
+	 * Checks if output can change on timer clocks
+	 *
+	 * @return True if active
+	 */
+	bool isActive() const {
+		return m_Length.isActive() && m_Envelope.getVolume() > 0;
+	}
+	/**
+	 * Gets cycles till next output change
+	 *
+	 * @return Cycles till next change or Idle
+	 */
+	ticks_t getNext() const {
+		return isActive() ? m_Counter : Idle;
+	}
+	/**
+	 * Advances the channel
+	 *
+	 * Shift register is not stepped while the channel is silent, its phase
+	 * is not observable.
+	 *
+	 * @param cycles Amount of CPU cycles
+	 */
+	void advance(ticks_t cycles) {
+		ticks_t clocks = clockTimer(cycles);
+		if (isActive()) {
+			for (; clocks > 0; clocks--) {
+				int feedback = (m_Shift ^ (m_Shift >> m_FeedbackBit)) & 0x01;
+				m_Shift = (m_Shift >> 1) | (feedback << 14);
+			}
+		}
+	}
+	/**
+	 * Gets output level
+	 *
+	 * @return Output level (0 .. 15)
+	 */
+	int getLevel() const {
+		if (!m_Length.isActive() || (m_Shift & 0x01)) {
+			return 0;
+		}
+		return m_Envelope.getVolume();
+	}
+};
+
+/**
+ * Delta modulation channel
+ *
+ * Memory reader is driven by the APU, the channel only requests a new byte
+ * once its buffer is emptied.
+ */
+class CDMC : public CTimer {
+private:
+	/**
+	 * Timer periods
+	 */
+	static const std::uint16_t PeriodTable[16];
+
+	/**
+	 * Flags and rate index
+	 */
+	std::uint8_t m_Control;
+	/**
+	 * Output level
+	 */
+	std::uint8_t m_Level;
+	/**
+	 * Sample address register
+	 */
+	std::uint8_t m_SampleAddress;
+	/**
+	 * Sample length register
+	 */
+	std::uint8_t m_SampleLength;
+	/**
+	 * Current address
+	 */
+	std::uint16_t m_Address;
+	/**
+	 * Bytes remaining
+	 */
+	std::uint16_t m_BytesRemaining;
+	/**
+	 * Sample buffer
+	 */
+	std::uint8_t m_Buffer;
+	/**
+	 * Sample buffer is full
+	 */
+	bool m_BufferFull;
+	/**
+	 * Output shift register
+	 */
+	std::uint8_t m_Shift;
+	/**
+	 * Bits remaining in output cycle (1 .. 8)
+	 */
+	int m_Bits;
+	/**
+	 * Silence flag
+	 */
+	bool m_Silence;
+
+	/**
+	 * Restarts the sample
+	 */
+	void restart() {
+		m_Address = 0xc000 | (m_SampleAddress << 6);
+		m_BytesRemaining = (m_SampleLength << 4) + 1;
+	}
+
+public:
+	/**
+	 * Constructs the object
+	 */
+	CDMC()
+	    : CTimer(PeriodTable[0])
+	    , m_Control()
+	    , m_Level()
+	    , m_SampleAddress()
+	    , m_SampleLength()
+	    , m_Address(0xc000)
+	    , m_BytesRemaining()
+	    , m_Buffer()
+	    , m_BufferFull()
+	    , m_Shift()
+	    , m_Bits(8)
+	    , m_Silence(true) {
+	}
+
+	/**
+	 * Writes register
+	 *
+	 * @param val Value
+	 * @param reg Register number (0 .. 3)
+	 */
+	void writeReg(std::uint8_t val, int reg);
+	/**
+	 * Enables or disables the channel
+	 *
+	 * @param enabled True to enable
+	 */
+	void setEnabled(bool enabled) {
+		if (!enabled) {
+			m_BytesRemaining = 0;
+		} else if (m_BytesRemaining == 0) {
+			restart();
+		}
+	}
+	/**
+	 * Checks if sample is playing
+	 *
+	 * @return True if bytes remain
+	 */
+	bool isPlaying() const {
+		return m_BytesRemaining != 0;
+	}
+	/**
+	 * Checks if IRQ is enabled
+	 *
+	 * @return True if enabled
+	 */
+	bool isIRQEnabled() const {
+		return m_Control & 0x80;
+	}
+	/**
+	 * Checks if memory reader needs a byte
+	 *
+	 * @return True if a byte must be fetched
+	 */
+	bool isFetchNeeded() const {
+		return !m_BufferFull && m_BytesRemaining != 0;
+	}
+	/**
+	 * Gets address of next byte
+	 *
+	 * @return Address
+	 */
+	std::uint16_t getAddress() const {
+		return m_Address;
+	}
+	/**
+	 * Fills sample buffer with fetched byte
+	 *
+	 * @param val Fetched byte
+	 * @return True if sample has ended and IRQ should be raised
+	 */
+	bool fill(std::uint8_t val);
+	/**
+	 * Gets cycles till sample buffer is emptied
+	 *
+	 * @return Cycles till buffer is emptied or Idle
+	 */
+	ticks_t getBufferEnd() const {
+		return m_BufferFull ? m_Counter + (m_Bits - 1) * m_Period : Idle;
+	}
+	/**
+	 * Gets cycles till next output change
+	 *
+	 * @return Cycles till next change or Idle
+	 */
+	ticks_t getNext() const {
+		return m_Silence ? getBufferEnd() : m_Counter;
+	}
+	/**
+	 * Advances the channel
+	 *
+	 * @param cycles Amount of CPU cycles
+	 */
+	void advance(ticks_t cycles);
+	/**
+	 * Gets output level
+	 *
+	 * @return Output level (0 .. 127)
+	 */
+	int getLevel() const {
+		return m_Level;
+	}
+};
+
+}  // namespace apu
+
 /**
  * Basic APU
+ *
+ * Channels are rendered in bulk up to the current time on every register
+ * access and at frame counter and DMC events. Only channels whose output can
+ * change limit the rendering step, so silent channels cost nothing. Mixed
+ * level changes go to band-limited step buffer when front-end needs audio.
  */
 class CAPU : public CEventDevice {
 public:
@@ -96,32 +888,180 @@ public:
 	};
 
 private:
+	/**
+	 * Master clock ticks in CPU cycle
+	 */
+	enum { CPUCycle = 12 };
+	/**
+	 * Frame counter step times in CPU cycles (4-step and 5-step modes)
+	 *
+	 * Sequence restarts one cycle after the last step.
+	 */
+	static const ticks_t FrameSteps[2][5];
+
+	/**
+	 * Motherboard
+	 */
+	CMotherBoard *m_MotherBoard;
+	/**
+	 * CPU
+	 */
+	CCPU *m_CPU;
 	/**
 	 * IO Buffer
 	 */
 	std::uint8_t m_IOBuf;
+	/**
+	 * Time channels are rendered to
+	 */
+	ticks_t m_Time;
+	/**
+	 * Pulse channels
+	 */
+	apu::CPulse m_Pulse[2];
+	/**
+	 * Triangle channel
+	 */
+	apu::CTriangle m_Triangle;
+	/**
+	 * Noise channel
+	 */
+	apu::CNoise m_Noise;
+	/**
+	 * DMC channel
+	 */
+	apu::CDMC m_DMC;
+	/**
+	 * Frame counter is in 5-step mode
+	 */
+	bool m_FrameMode;
+	/**
+	 * Frame IRQ is inhibited
+	 */
+	bool m_FrameIRQInhibit;
+	/**
+	 * Frame IRQ flag
+	 */
+	bool m_FrameIRQ;
+	/**
+	 * DMC IRQ flag
+	 */
+	bool m_DMCIRQ;
+	/**
+	 * Next frame counter step
+	 */
+	int m_FrameStep;
+	/**
+	 * Time when frame counter sequence started
+	 */
+	ticks_t m_FrameStart;
+	/**
+	 * Frame counter write is pending
+	 */
+	bool m_FrameReset;
+	/**
+	 * Frame counter event
+	 */
+	CMotherBoard::CEvent *m_FrameEvent;
+	/**
+	 * DMC buffer event
+	 */
+	CMotherBoard::CEvent *m_DMCEvent;
+	/**
+	 * Pulse mixer output for sum of pulse levels
+	 */
+	float m_PulseTable[31];
+	/**
+	 * Triangle, noise and DMC mixer output for 3 * triangle + 2 * noise + DMC
+	 */
+	float m_TNDTable[203];
+	/**
+	 * Mixed output level
+	 */
+	float m_Output;
+	/**
+	 * Audio output (null if not needed)
+	 */
+	std::unique_ptr<CBlipBuffer> m_Blip;
+	/**
+	 * Buffer for samples of a frame
+	 */
+	std::vector<std::int16_t> m_Samples;
 
+	/**
+	 * Passes mixed level change at current time to audio output
+	 */
+	void updateOutput() {
+		if (m_Blip) {
+			float output =
+			    m_PulseTable[m_Pulse[0].getLevel() + m_Pulse[1].getLevel()] +
+			    m_TNDTable[3 * m_Triangle.getLevel() + 2 * m_Noise.getLevel() +
+			               m_DMC.getLevel()];
+			if (output != m_Output) {
+				m_Blip->addDelta(m_Time, output - m_Output);
+				m_Output = output;
+			}
+		}
+	}
+
+	/**
+	 * Renders channels up to the time
+	 *
+	 * @param time Time
+	 */
+	void render(ticks_t time);
+	/**
+	 * Schedules next frame counter step
+	 */
+	void scheduleFrame();
+	/**
+	 * Fetches DMC byte if needed and schedules buffer event
+	 *
+	 * Fetch halts the CPU for 4 cycles, or 3 if it is writing.
+	 *
+	 * @param write CPU is writing
+	 */
+	void updateDMC(bool write = false);
+	/**
+	 * Clocks envelopes and linear counter
+	 */
+	void clockQuarter();
+	/**
+	 * Clocks length counters and sweeps
+	 */
+	void clockHalf();
+	/**
+	 * Handles frame counter step
+	 *
+	 * @param event Event
+	 */
+	void handleFrame(CMotherBoard::CEvent *event);
+	/**
+	 * Handles DMC buffer being emptied
+	 *
+	 * @param event Event
+	 */
+	void handleDMC(CMotherBoard::CEvent *event);
 	/**
 	 * Reads register
 	 *
 	 * @param addr register address
 	 */
-	void readReg(std::uint16_t addr) {
-	}
+	void readReg(std::uint16_t addr);
 	/**
 	 * Writes to register
 	 *
 	 * @param val Value
 	 * @param addr Address
 	 */
-	void writeReg(std::uint8_t val, std::uint16_t addr) {
-	}
+	void writeReg(std::uint8_t val, std::uint16_t addr);
 
 protected:
 	/**
 	 * Simulation routine
 	 */
 	void execute() {
+		render(m_Clock);
 	}
 
 public:
@@ -133,9 +1073,12 @@ public:
 	 * Constructs the object
 	 *
 	 * @param motherBoard Motherboard
+	 * @param cpu CPU
+	 * @param frequency Frequency
+	 * @param frameTime Basic frame time
 	 */
-	explicit CAPU(CMotherBoard *motherBoard) : CEventDevice(), m_IOBuf() {
-	}
+	CAPU(CMotherBoard *motherBoard, CCPU *cpu, double frequency,
+	    ticks_t frameTime);
 	/**
 	 * Destroys the object
 	 */
@@ -153,6 +1096,14 @@ public:
 		}
 	}
 
+	/**
+	 * Resets the clock
+	 *
+	 * Happens on frame end, samples of the frame are passed to front-end.
+	 *
+	 * @param ticks Amount of ticks
+	 */
+	void resetClock(ticks_t ticks);
 	/**
 	 * Gets pending time
 	 *
@@ -0,0 +1,80 @@
+/**
+ * @file
+ *
+ * Defines compressed ROM containers
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_ARCHIVE_HPP_
+#define INCLUDE_VPNES_CORE_ARCHIVE_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace archive {
+
+/**
+ * Container type
+ */
+enum EContainer {
+	ContainerNone,  //!< Not compressed
+	ContainerGzip,  //!< gzip stream
+	ContainerZip    //!< zip archive
+};
+
+/**
+ * Detects container by its signature
+ *
+ * @param data File data
+ * @param size File size
+ * @return Container type
+ */
+EContainer detectContainer(const std::uint8_t *data, std::size_t size);
+
+/**
+ * Decompresses ROM from container
+ *
+ * For zip archives the first entry with .nes extension is taken. Data is
+ * inflated directly from the input into the returned buffer.
+ *
+ * @param data File data
+ * @param size File size
+ * @return ROM file data
+ */
+std::vector<std::uint8_t> extractROM(const std::uint8_t *data, std::size_t size);
+
+}  // namespace archive
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_ARCHIVE_HPP_
@@ -0,0 +1,196 @@
+/**
+ * @file
+ *
+ * Defines audio sample queue and rate-controlled resampler
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_AUDIORING_HPP_
+#define INCLUDE_VPNES_CORE_AUDIORING_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Single-producer single-consumer ring of audio samples
+ */
+class CAudioRing {
+private:
+	/**
+	 * Samples
+	 */
+	std::unique_ptr<std::int16_t[]> m_Samples;
+	/**
+	 * Capacity of the ring (power of 2)
+	 */
+	std::size_t m_Capacity;
+	/**
+	 * Write position (owned by producer)
+	 */
+	alignas(64) std::atomic<std::size_t> m_Head;
+	/**
+	 * Read position (owned by consumer)
+	 */
+	alignas(64) std::atomic<std::size_t> m_Tail;
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CAudioRing() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param capacity Minimal capacity
+	 */
+	explicit CAudioRing(std::size_t capacity);
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CAudioRing(const CAudioRing &s) = delete;
+
+	/**
+	 * Gets amount of queued samples
+	 *
+	 * @return Amount of queued samples
+	 */
+	std::size_t getSize() const {
+		return m_Head.load(std::memory_order_acquire) -
+		       m_Tail.load(std::memory_order_acquire);
+	}
+	/**
+	 * Gets capacity
+	 *
+	 * @return Capacity
+	 */
+	std::size_t getCapacity() const {
+		return m_Capacity;
+	}
+	/**
+	 * Pushes samples, never blocks (called by producer)
+	 *
+	 * @param samples Samples
+	 * @param count Amount of samples
+	 * @return Amount of pushed samples
+	 */
+	std::size_t push(const std::int16_t *samples, std::size_t count);
+	/**
+	 * Pops samples, never blocks (called by consumer)
+	 *
+	 * @param samples Output buffer
+	 * @param count Amount of requested samples
+	 * @return Amount of popped samples
+	 */
+	std::size_t pop(std::int16_t *samples, std::size_t count);
+};
+
+/**
+ * Resampler keeping a queue around its set point
+ *
+ * Samples are linearly interpolated with a ratio adjusted by up to
+ * MaxRateDelta according to the smoothed fill level of the queue, so the
+ * consumer neither starves nor accumulates latency.
+ */
+class CAudioResampler {
+public:
+	/**
+	 * Maximal resampling ratio deviation
+	 */
+	static constexpr double MaxRateDelta = 0.005;
+	/**
+	 * Amount of writes the fill level is averaged over
+	 */
+	static constexpr double LevelSmoothing = 16.0;
+
+private:
+	/**
+	 * Fill level the rate control aims for
+	 */
+	double m_SetPoint;
+	/**
+	 * Smoothed fill level
+	 */
+	double m_Level;
+	/**
+	 * Position of the next output sample between last and first input samples
+	 */
+	double m_Phase;
+	/**
+	 * Last input sample
+	 */
+	std::int16_t m_Last;
+
+public:
+	/**
+	 * Constructs the object
+	 *
+	 * @param setPoint Fill level the rate control aims for
+	 */
+	explicit CAudioResampler(double setPoint = 1.0)
+	    : m_SetPoint(setPoint), m_Level(setPoint), m_Phase(), m_Last() {
+	}
+
+	/**
+	 * Sets fill level the rate control aims for and resets the smoothed level
+	 *
+	 * @param setPoint Fill level
+	 */
+	void setSetPoint(double setPoint) {
+		m_SetPoint = setPoint;
+		m_Level = setPoint;
+	}
+	/**
+	 * Gets current resampling ratio
+	 *
+	 * @return Output samples per input sample
+	 */
+	double getRatio() const;
+	/**
+	 * Resamples input
+	 *
+	 * @param samples Input samples
+	 * @param count Amount of input samples
+	 * @param level Current fill level of the queue
+	 * @param output Resampled samples (replaced)
+	 */
+	void resample(const std::int16_t *samples, std::size_t count,
+	    std::size_t level, std::vector<std::int16_t> *output);
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_AUDIORING_HPP_
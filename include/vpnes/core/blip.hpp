@@ -0,0 +1,179 @@
+/**
+ * @file
+ *
+ * Defines band-limited step buffer
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_BLIP_HPP_
+#define INCLUDE_VPNES_CORE_BLIP_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/device.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Band-limited step buffer
+ *
+ * Amplitude changes are recorded as deltas at exact clock timestamps. Each
+ * delta adds a windowed-sinc impulse, chosen by the fractional sample
+ * position, to the buffer. Reading integrates impulses back into steps, so
+ * the output is resampled without aliasing and without filtering at the
+ * clock rate. Impulses are added with SSE or AVX, if available.
+ */
+class CBlipBuffer {
+public:
+	enum {
+		KernelSize = 16,                //!< Impulse length in samples
+		PhaseBits = 6,                  //!< Bits of fractional position
+		PhaseCount = 1 << PhaseBits,    //!< Amount of impulse phases
+		FracBits = 32                   //!< Bits of fixed point position
+	};
+
+private:
+	/**
+	 * Impulses for each fractional position
+	 */
+	float m_Kernel[PhaseCount][KernelSize];
+	/**
+	 * Samples per clock tick (fixed point)
+	 */
+	std::int64_t m_Factor;
+	/**
+	 * Position of frame start (fixed point)
+	 */
+	std::int64_t m_Offset;
+	/**
+	 * Accumulated impulses
+	 */
+	std::vector<float> m_Buffer;
+	/**
+	 * Integrated amplitude
+	 */
+	float m_Integrator;
+	/**
+	 * DC level removed from output
+	 */
+	float m_DCLevel;
+	/**
+	 * DC blocker coefficient
+	 */
+	float m_HighPass;
+	/**
+	 * Sample rate
+	 */
+	int m_SampleRate;
+	/**
+	 * Longest frame in ticks
+	 */
+	ticks_t m_MaxFrameTime;
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CBlipBuffer() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param frequency Clock frequency (milliseconds per tick)
+	 * @param sampleRate Sample rate
+	 * @param maxFrameTime Longest frame in ticks
+	 */
+	CBlipBuffer(double frequency, int sampleRate, ticks_t maxFrameTime);
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CBlipBuffer(const CBlipBuffer &s) = delete;
+	/**
+	 * Destroys the object
+	 */
+	~CBlipBuffer() = default;
+
+	/**
+	 * Adds amplitude change
+	 *
+	 * @param time Time relative to frame start (may be slightly negative)
+	 * @param delta Amplitude delta
+	 */
+	void addDelta(ticks_t time, float delta);
+	/**
+	 * Ends the frame, samples before its end become available
+	 *
+	 * @param time Frame length in ticks
+	 */
+	void endFrame(ticks_t time) {
+		assert(time <= m_MaxFrameTime);
+		m_Offset += time * m_Factor;
+	}
+	/**
+	 * Gets amount of available samples
+	 *
+	 * @return Amount of samples
+	 */
+	std::size_t getAvailable() const {
+		return static_cast<std::size_t>(m_Offset >> FracBits);
+	}
+	/**
+	 * Reads available samples
+	 *
+	 * @param samples Output buffer
+	 * @param count Buffer size
+	 * @return Amount of read samples
+	 */
+	std::size_t readSamples(std::int16_t *samples, std::size_t count);
+	/**
+	 * Gets sample rate
+	 *
+	 * @return Sample rate
+	 */
+	int getSampleRate() const {
+		return m_SampleRate;
+	}
+	/**
+	 * Gets maximum amount of samples in one frame
+	 *
+	 * @return Amount of samples
+	 */
+	std::size_t getMaxSamples() const {
+		return static_cast<std::size_t>(
+		           (m_MaxFrameTime * m_Factor) >> FracBits) + 1;
+	}
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_BLIP_HPP_
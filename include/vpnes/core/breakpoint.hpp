@@ -0,0 +1,306 @@
+/**
+ * @file
+ *
+ * Defines conditional breakpoints
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_BREAKPOINT_HPP_
+#define INCLUDE_VPNES_CORE_BREAKPOINT_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/watch.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+class CDebugger;
+
+/**
+ * Data available to breakpoint condition
+ */
+struct SBreakContext {
+	/**
+	 * Debugger (may be null if condition uses no CPU state or cycles)
+	 */
+	CDebugger *Debugger;
+	/**
+	 * Accessed address
+	 */
+	std::uint16_t Address;
+	/**
+	 * Value on the bus
+	 */
+	std::uint8_t Value;
+};
+
+/**
+ * Compiled breakpoint condition
+ *
+ * Conditions are C-like expressions over integer values. Operands are
+ * numbers (decimal, 0x or $ hexadecimal), value (bus value), addr
+ * (accessed address), cycles (CPU cycles since power up), registers
+ * a, x, y, s, p and pc, and memory reads [expr]. Operators from highest
+ * to lowest precedence are unary ! and -, binary + -, &, ^, |, comparisons,
+ * logical && (and) and || (or). Binary operators are left-associative,
+ * comparisons do not chain. Unlike C, bitwise operators bind tighter than
+ * comparisons, so value & 1 == 1 tests a bit. Source is compiled once into
+ * flat postfix bytecode.
+ */
+class CExpression {
+private:
+	/**
+	 * Bytecode operations
+	 */
+	enum EOperation {
+		OpConst,         //!< Push constant
+		OpValue,         //!< Push bus value
+		OpAddress,       //!< Push address
+		OpCycles,        //!< Push CPU cycles
+		OpRegA,          //!< Push A
+		OpRegX,          //!< Push X
+		OpRegY,          //!< Push Y
+		OpRegS,          //!< Push S
+		OpRegP,          //!< Push P
+		OpRegPC,         //!< Push PC
+		OpMemory,        //!< Replace address with memory value
+		OpNot,           //!< Logical not
+		OpNegate,        //!< Negate
+		OpAdd,           //!< Add
+		OpSubtract,      //!< Subtract
+		OpBitAnd,        //!< Bitwise and
+		OpBitOr,         //!< Bitwise or
+		OpBitXor,        //!< Bitwise xor
+		OpEqual,         //!< Equal
+		OpNotEqual,      //!< Not equal
+		OpLess,          //!< Less
+		OpLessEqual,     //!< Less or equal
+		OpGreater,       //!< Greater
+		OpGreaterEqual,  //!< Greater or equal
+		OpAnd,           //!< Logical and
+		OpOr             //!< Logical or
+	};
+	/**
+	 * Bytecode instruction
+	 */
+	struct SInstruction {
+		/**
+		 * Operation
+		 */
+		EOperation Operation;
+		/**
+		 * Constant operand
+		 */
+		std::int64_t Operand;
+	};
+	/**
+	 * Maximum evaluation stack depth
+	 */
+	enum { MaxStack = 32 };
+
+	/**
+	 * Compiled code
+	 */
+	std::vector<SInstruction> m_Code;
+	/**
+	 * Condition uses CPU registers
+	 */
+	bool m_UsesRegisters;
+	/**
+	 * Condition uses debugger
+	 */
+	bool m_UsesDebugger;
+
+	/**
+	 * Recursive-descent compiler
+	 */
+	class CParser;
+
+public:
+	/**
+	 * Compiles the condition
+	 *
+	 * Empty source is always true.
+	 *
+	 * @param source Condition source
+	 */
+	explicit CExpression(const std::string &source);
+
+	/**
+	 * Evaluates the condition
+	 *
+	 * Throws if condition uses CPU state or cycles without debugger.
+	 *
+	 * @param context Access data
+	 * @return Result
+	 */
+	std::int64_t evaluate(const SBreakContext &context) const;
+};
+
+/**
+ * Conditional breakpoints on CPU bus
+ *
+ * Uses breakpoint layer of CPU bus watch as per-address pre-filter, so
+ * conditions are evaluated only for addresses that have breakpoints.
+ * Watchpoints of the front end are left intact. Watched accesses find their
+ * breakpoints by binary search over address segments.
+ */
+class CBreakpoints {
+public:
+	/**
+	 * Breakpoint handler
+	 */
+	typedef std::function<void(std::size_t id, std::uint16_t addr,
+	    std::uint8_t val)>
+	    handler_t;
+
+private:
+	/**
+	 * Breakpoint
+	 */
+	struct SBreakpoint {
+		/**
+		 * Identifier
+		 */
+		std::size_t Id;
+		/**
+		 * Access type
+		 */
+		EWatchType Type;
+		/**
+		 * First address
+		 */
+		std::uint16_t First;
+		/**
+		 * Last address (inclusive)
+		 */
+		std::uint16_t Last;
+		/**
+		 * Condition
+		 */
+		CExpression Condition;
+		/**
+		 * Handler
+		 */
+		handler_t Handler;
+	};
+	/**
+	 * Address segment with the same set of breakpoints
+	 */
+	struct SSegment {
+		/**
+		 * First address (segment lasts until the next one)
+		 */
+		std::uint32_t First;
+		/**
+		 * Indices of breakpoints covering the segment
+		 */
+		std::vector<std::size_t> Breakpoints;
+	};
+
+	/**
+	 * Debugger
+	 */
+	CDebugger *m_Debugger;
+	/**
+	 * Breakpoints
+	 */
+	std::vector<SBreakpoint> m_Breakpoints;
+	/**
+	 * Sorted address segments per access type
+	 */
+	std::array<std::vector<SSegment>, WatchTypes> m_Segments;
+	/**
+	 * Next identifier
+	 */
+	std::size_t m_NextId;
+
+	/**
+	 * Checks breakpoints for watched access
+	 *
+	 * @param type Access type
+	 * @param addr Address
+	 * @param val Value
+	 */
+	void check(EWatchType type, std::uint16_t addr, std::uint8_t val);
+	/**
+	 * Rebuilds watchpoint bitmaps and address segments
+	 */
+	void updateWatches();
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CBreakpoints() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param debugger Debugger
+	 */
+	explicit CBreakpoints(CDebugger *debugger)
+	    : m_Debugger(debugger), m_Breakpoints(), m_Segments(), m_NextId(1) {
+	}
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CBreakpoints(const CBreakpoints &s) = delete;
+
+	/**
+	 * Adds a breakpoint
+	 *
+	 * Handlers must not add or remove breakpoints.
+	 *
+	 * @param type Access type
+	 * @param first First address
+	 * @param last Last address (inclusive)
+	 * @param condition Condition source
+	 * @param handler Handler called when condition holds
+	 * @return Breakpoint identifier
+	 */
+	std::size_t add(EWatchType type, std::uint16_t first, std::uint16_t last,
+	    const std::string &condition, handler_t handler);
+	/**
+	 * Removes a breakpoint
+	 *
+	 * @param id Breakpoint identifier
+	 */
+	void remove(std::size_t id);
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_BREAKPOINT_HPP_
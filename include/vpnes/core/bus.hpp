@@ -33,6 +33,8 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <array>
+#include <stdexcept>
 #include <utility>
 #include <memory>
 #include <type_traits>
@@ -40,6 +42,7 @@
 #include <vector>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/device.hpp>
+#include <vpnes/core/watch.hpp>
 
 namespace vpnes {
 
@@ -246,6 +249,23 @@ protected:
 	typedef std::unordered_multimap<std::uint16_t,
 	    std::unique_ptr<CAddrValHook>>
 	    WriteHooks;
+	/**
+	 * Write hook for an address range
+	 */
+	struct SRangeHook {
+		/**
+		 * First address
+		 */
+		std::uint16_t First;
+		/**
+		 * Last address
+		 */
+		std::uint16_t Last;
+		/**
+		 * Hook
+		 */
+		std::unique_ptr<CAddrValHook> Hook;
+	};
 	/**
 	 * Pre read hooks mapped to address
 	 */
@@ -258,6 +278,10 @@ protected:
 	 * Write hooks mapped to address
 	 */
 	WriteHooks m_WriteHooks;
+	/**
+	 * Write hooks for address ranges
+	 */
+	std::vector<SRangeHook> m_WriteRangeHooks;
 	/**
 	 * Open bus value
 	 */
@@ -270,6 +294,98 @@ protected:
 	 * Dummy write buffer
 	 */
 	std::uint8_t m_DummyWrite;
+	/**
+	 * Watchpoints and access counters
+	 */
+	CBusWatch m_Watch;
+	enum {
+		MaxPatches = 64  //!< Maximum amount of read patches
+	};
+	/**
+	 * Read patch
+	 */
+	struct SPatch {
+		/**
+		 * Patch is in use
+		 */
+		bool Used;
+		/**
+		 * Address
+		 */
+		std::uint16_t Address;
+		/**
+		 * Compare value or negative to patch unconditionally
+		 */
+		int Compare;
+		/**
+		 * Patched read map slot or null if not applied
+		 */
+		std::uint8_t **Slot;
+		/**
+		 * Original slot value
+		 */
+		std::uint8_t *Original;
+	};
+	/**
+	 * Patch page, read map slots of patched addresses point here
+	 */
+	std::array<std::uint8_t, MaxPatches> m_PatchPage;
+	/**
+	 * Read patches
+	 */
+	std::array<SPatch, MaxPatches> m_Patches;
+	/**
+	 * Amount of used patches
+	 */
+	std::size_t m_PatchCount;
+
+	/**
+	 * Gets read map slot for an address
+	 *
+	 * @param addr Address
+	 * @return Read map slot for current mapping
+	 */
+	virtual std::uint8_t **getReadSlot(std::uint16_t addr) = 0;
+	/**
+	 * Rewrites map slots of a device bank
+	 *
+	 * @param device Device
+	 * @param bank Bank number in device bank config
+	 * @param buf New bank buffer
+	 */
+	virtual void mapBank(CDevice *device, std::size_t bank, std::uint8_t *buf) = 0;
+	/**
+	 * Restores read map slots of applied patches
+	 */
+	void restorePatches() {
+		for (std::size_t id = MaxPatches; id-- > 0;) {
+			SPatch &patch = m_Patches[id];
+			if (patch.Slot) {
+				*patch.Slot = patch.Original;
+				patch.Slot = nullptr;
+			}
+		}
+	}
+	/**
+	 * Redirects read map slots of used patches
+	 */
+	void applyPatches() {
+		for (std::size_t id = 0; id < MaxPatches; id++) {
+			SPatch &patch = m_Patches[id];
+			if (!patch.Used) {
+				continue;
+			}
+			std::uint8_t **slot = getReadSlot(patch.Address);
+			// Open bus slot is shared by all unmapped addresses
+			if (*slot == &m_OpenBus ||
+			    (patch.Compare >= 0 && **slot != patch.Compare)) {
+				continue;
+			}
+			patch.Slot = slot;
+			patch.Original = *slot;
+			*slot = &m_PatchPage[id];
+		}
+	}
 
 	/**
 	 * Executes all pre read hooks for an address
@@ -305,6 +421,11 @@ protected:
 		for (auto hook = range.first; hook != range.second; ++hook) {
 			(*hook->second)(s, addr);
 		}
+		for (const SRangeHook &hook : m_WriteRangeHooks) {
+			if (addr >= hook.First && addr <= hook.Last) {
+				(*hook.Hook)(s, addr);
+			}
+		}
 	}
 
 	/**
@@ -320,9 +441,14 @@ protected:
 	    : m_ReadHooksPre()
 	    , m_ReadHooksPost()
 	    , m_WriteHooks()
+	    , m_WriteRangeHooks()
 	    , m_OpenBus(openBus)
 	    , m_WriteBuf()
-	    , m_DummyWrite() {
+	    , m_DummyWrite()
+	    , m_Watch()
+	    , m_PatchPage()
+	    , m_Patches()
+	    , m_PatchCount() {
 	}
 	/**
 	 * Deleted copy constructor
@@ -337,6 +463,121 @@ public:
 	 */
 	virtual ~CBus() = default;
 
+	/**
+	 * Gets watchpoints and access counters
+	 *
+	 * @return Bus watch
+	 */
+	CBusWatch *getWatch() {
+		return &m_Watch;
+	}
+
+	/**
+	 * Adds read patch
+	 *
+	 * The read map slot of the address is redirected to the patch page, so
+	 * patched reads cost the same as any other read. With compare value the
+	 * patch is applied only if the original value matches. Patches must be
+	 * updated after mapping changes.
+	 *
+	 * @param addr Address
+	 * @param val Patched value
+	 * @param compare Compare value or negative to patch unconditionally
+	 * @return Patch identifier
+	 */
+	std::size_t addPatch(
+	    std::uint16_t addr, std::uint8_t val, int compare = -1) {
+		for (std::size_t id = 0; id < MaxPatches; id++) {
+			if (!m_Patches[id].Used) {
+				m_PatchPage[id] = val;
+				m_Patches[id] = {true, addr, compare, nullptr, nullptr};
+				m_PatchCount++;
+				updatePatches();
+				return id;
+			}
+		}
+		throw std::invalid_argument("Too many patches");
+	}
+	/**
+	 * Removes read patch
+	 *
+	 * @param id Patch identifier
+	 */
+	void removePatch(std::size_t id) {
+		if (id >= MaxPatches || !m_Patches[id].Used) {
+			throw std::invalid_argument("Unknown patch");
+		}
+		m_Patches[id].Used = false;
+		m_PatchCount--;
+		updatePatches();
+	}
+	/**
+	 * Reapplies read patches to current mapping
+	 */
+	void updatePatches() {
+		restorePatches();
+		applyPatches();
+	}
+	/**
+	 * Switches a device bank to another buffer
+	 *
+	 * Only read, write and mod map slots of the bank are rewritten (one
+	 * pointer store per byte of the bank window), so accesses stay as
+	 * cheap as before. Read patches are reapplied to the new mapping.
+	 * Devices that change which bank is active (getBank) must call
+	 * updatePatches instead.
+	 *
+	 * @param device Device
+	 * @param bank Bank number in device bank config
+	 * @param buf New bank buffer
+	 * @throw std::out_of_range Bank number is not in device bank config
+	 */
+	void switchBank(CDevice *device, std::size_t bank, std::uint8_t *buf) {
+		if (m_PatchCount == 0) {
+			mapBank(device, bank, buf);
+			return;
+		}
+		restorePatches();
+		try {
+			mapBank(device, bank, buf);
+		} catch (...) {
+			applyPatches();
+			throw;
+		}
+		applyPatches();
+	}
+	/**
+	 * Switches consecutive device banks in one batch
+	 *
+	 * Read patches are restored and reapplied once for the whole batch.
+	 * Banks before an invalid one stay switched.
+	 *
+	 * @param device Device
+	 * @param firstBank First bank number in device bank config
+	 * @param bufs New bank buffers
+	 * @param count Number of banks
+	 * @throw std::out_of_range Bank number is not in device bank config
+	 */
+	void switchBanks(CDevice *device, std::size_t firstBank,
+	    std::uint8_t *const *bufs, std::size_t count) {
+		if (m_PatchCount != 0) {
+			restorePatches();
+		}
+		try {
+			for (std::size_t i = 0; i < count; i++) {
+				mapBank(device, firstBank + i, bufs[i]);
+			}
+		} catch (...) {
+			if (m_PatchCount != 0) {
+				applyPatches();
+			}
+			throw;
+		}
+		if (m_PatchCount != 0) {
+			applyPatches();
+		}
+	}
+
 	/**
 	 * Reads memory from the bus
 	 *
@@ -395,6 +636,23 @@ public:
 		m_WriteHooks.emplace(
 		    addr, std::make_unique<CAddrValHookMapped<T>>(device, hook));
 	}
+	/**
+	 * Adds new write hook for an address range
+	 *
+	 * Suits registers mirrored over a large range, such as mapper registers
+	 * at 0x8000 - 0xffff.
+	 *
+	 * @param first First address
+	 * @param last Last address
+	 * @param device Device
+	 * @param hook Hook in device
+	 */
+	template <class T>
+	void addWriteHook(std::uint16_t first, std::uint16_t last, T *device,
+	    typename CAddrValHookMapped<T>::addrHook_t hook) {
+		m_WriteRangeHooks.push_back(SRangeHook{first, last,
+		    std::make_unique<CAddrValHookMapped<T>>(device, hook)});
+	}
 };
 
 namespace banks {
@@ -1078,6 +1336,25 @@ struct BankConfig<> {
 	    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
 	    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf) {
 	}
+	/**
+	 * Maps single bank
+	 *
+	 * @param iterRead Read iterator
+	 * @param iterWrite Write iterator
+	 * @param iterMod Mod iterator
+	 * @param openBus Open bus
+	 * @param dummy Dummy write
+	 * @param writeBuf Write buffer
+	 * @param bank Bank number
+	 * @param buf Bank buffer
+	 * @throw std::out_of_range Config has no banks
+	 */
+	static void mapBank(MemoryMap::iterator iterRead,
+	    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+	    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+	    std::size_t bank, std::uint8_t *buf) {
+		throw std::out_of_range("Invalid bank number");
+	}
 	/**
 	 * Gives read iterator
 	 *
@@ -1159,6 +1436,42 @@ struct BankConfig<FirstClass, OtherClasses...> {
 		    iterWrite + FirstClass::WriteSize, iterMod + FirstClass::ModSize,
 		    openBus, dummy, writeBuf, std::forward<Args>(args)...);
 	}
+	/**
+	 * Maps single bank
+	 *
+	 * @param iterRead Read iterator
+	 * @param iterWrite Write iterator
+	 * @param iterMod Mod iterator
+	 * @param openBus Open bus
+	 * @param dummy Dummy write
+	 * @param writeBuf Write buffer
+	 * @param bank Bank number
+	 * @param buf Bank buffer
+	 * @throw std::out_of_range Bank number is not in the config
+	 */
+	static void mapBank(MemoryMap::iterator iterRead,
+	    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+	    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+	    std::size_t bank, std::uint8_t *buf) {
+		if (bank > sizeof...(OtherClasses)) {
+			throw std::out_of_range("Invalid bank number");
+		}
+		typedef void (*mapSingle)(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t * openBus, std::uint8_t * dummy,
+		    std::uint8_t * writeBuf, std::uint8_t * buf);
+
+		static const mapSingle maps[1 + sizeof...(OtherClasses)] = {
+		    &BankConfig<FirstClass>::template mapIO<>,
+		    &BankConfig<OtherClasses>::template mapIO<>...};
+
+		(*maps[bank])(
+		    iterRead + BankOffset<FirstClass, OtherClasses...>::getOffsetRead(bank),
+		    iterWrite +
+		        BankOffset<FirstClass, OtherClasses...>::getOffsetWrite(bank),
+		    iterMod + BankOffset<FirstClass, OtherClasses...>::getOffsetMod(bank),
+		    openBus, dummy, writeBuf, buf);
+	}
 	/**
 	 * Gives read iterator
 	 *
@@ -1175,6 +1488,7 @@ struct BankConfig<FirstClass, OtherClasses...> {
 		static const readAddr readAddrs[1 + sizeof...(OtherClasses)] = {
 		    &FirstClass::getAddrRead, &OtherClasses::getAddrRead...};
 
+		assert(bank <= sizeof...(OtherClasses));
 		return (*readAddrs[bank])(
 		    iter + BankOffset<FirstClass, OtherClasses...>::getOffsetRead(bank),
 		    addr);
@@ -1201,6 +1515,7 @@ struct BankConfig<FirstClass, OtherClasses...> {
 		static const modAddr modAddrs[1 + sizeof...(OtherClasses)] = {
 		    &FirstClass::getAddrMod, &OtherClasses::getAddrMod...};
 
+		assert(bank <= sizeof...(OtherClasses));
 		return std::make_pair(
 		    (*writeAddrs[bank])(
 		        iterWrite +
@@ -1286,6 +1601,26 @@ struct BusAggregate<> {
 	    MemoryMap::iterator iterMod, std::uint8_t *openBus, std::uint8_t *dummy,
 	    std::uint8_t *writeBuf) {
 	}
+	/**
+	 * Maps single bank of a device
+	 *
+	 * @param iter Device iterator
+	 * @param device Device
+	 * @param iterRead Read iterator
+	 * @param iterWrite Write iterator
+	 * @param iterMod Mod iterator
+	 * @param openBus Open bus
+	 * @param dummy Dummy write
+	 * @param writeBuf Write buffer
+	 * @param bank Bank number
+	 * @param buf Bank buffer
+	 */
+	static void mapBank(DevicePtrList::iterator iter, CDevice *device,
+	    MemoryMap::iterator iterRead, MemoryMap::iterator iterWrite,
+	    MemoryMap::iterator iterMod, std::uint8_t *openBus, std::uint8_t *dummy,
+	    std::uint8_t *writeBuf, std::size_t bank, std::uint8_t *buf) {
+		assert(false);
+	}
 
 private:
 	/**
@@ -1386,6 +1721,35 @@ struct BusAggregate<FirstDeviceConfig, OtherDevicesConfig...> {
 		    iterMod + FirstDeviceConfig::BankConfig::ModSize, openBus, dummy,
 		    writeBuf);
 	}
+	/**
+	 * Maps single bank of a device
+	 *
+	 * @param iter Device iterator
+	 * @param device Device
+	 * @param iterRead Read iterator
+	 * @param iterWrite Write iterator
+	 * @param iterMod Mod iterator
+	 * @param openBus Open bus
+	 * @param dummy Dummy write
+	 * @param writeBuf Write buffer
+	 * @param bank Bank number
+	 * @param buf Bank buffer
+	 */
+	static void mapBank(DevicePtrList::iterator iter, CDevice *device,
+	    MemoryMap::iterator iterRead, MemoryMap::iterator iterWrite,
+	    MemoryMap::iterator iterMod, std::uint8_t *openBus, std::uint8_t *dummy,
+	    std::uint8_t *writeBuf, std::size_t bank, std::uint8_t *buf) {
+		if (*iter == device) {
+			FirstDeviceConfig::BankConfig::mapBank(iterRead, iterWrite,
+			    iterMod, openBus, dummy, writeBuf, bank, buf);
+		} else {
+			BusAggregate<OtherDevicesConfig...>::mapBank(iter + 1, device,
+			    iterRead + FirstDeviceConfig::BankConfig::ReadSize,
+			    iterWrite + FirstDeviceConfig::BankConfig::WriteSize,
+			    iterMod + FirstDeviceConfig::BankConfig::ModSize, openBus,
+			    dummy, writeBuf, bank, buf);
+		}
+	}
 
 private:
 	/**
@@ -1613,6 +1977,33 @@ public:
 	 */
 	~CBusConfig() = default;
 
+protected:
+	/**
+	 * Gets read map slot for an address
+	 *
+	 * @param addr Address
+	 * @return Read map slot for current mapping
+	 */
+	std::uint8_t **getReadSlot(std::uint16_t addr) {
+		return &*BusAggregate<DeviceConfigs...,
+		    COpenBusDevice::BusConfig>::getAddrRead(m_DeviceArr.begin(),
+		    m_ReadArr.begin(), addr);
+	}
+	/**
+	 * Rewrites map slots of a device bank
+	 *
+	 * @param device Device
+	 * @param bank Bank number in device bank config
+	 * @param buf New bank buffer
+	 */
+	void mapBank(CDevice *device, std::size_t bank, std::uint8_t *buf) {
+		BusAggregate<DeviceConfigs..., COpenBusDevice::BusConfig>::mapBank(
+		    m_DeviceArr.begin(), device, m_ReadArr.begin(), m_WriteArr.begin(),
+		    m_ModArr.begin(), &m_OpenBus, &m_DummyWrite, &m_WriteBuf, bank,
+		    buf);
+	}
+
+public:
 	/**
 	 * Reads memory from the bus
 	 *
@@ -1630,6 +2021,9 @@ public:
 		std::uint8_t res = **iter;
 		if (!direct) {
 			processPostReadHooks(res, addr);
+			if (m_Watch.isActive()) {
+				m_Watch.access(WatchRead, addr, res);
+			}
 		}
 		return res;
 	}
@@ -1655,6 +2049,9 @@ public:
 			val &= **(iter.second);
 		} while (val != m_WriteBuf);
 		**(iter.first) = m_WriteBuf;
+		if (!direct && m_Watch.isActive()) {
+			m_Watch.access(WatchWrite, addr, m_WriteBuf);
+		}
 #else
 		m_WriteBuf = s;
 		m_WriteBuf &= **(iter.second);
@@ -1662,6 +2059,9 @@ public:
 			processWriteHooks(m_WriteBuf, addr);
 		}
 		**(iter.first) = m_WriteBuf;
+		if (!direct && m_Watch.isActive()) {
+			m_Watch.access(WatchWrite, addr, m_WriteBuf);
+		}
 #endif
 	}
 };
@@ -0,0 +1,74 @@
+/**
+ * @file
+ *
+ * Defines cheat codes
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_CHEATS_HPP_
+#define INCLUDE_VPNES_CORE_CHEATS_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdint>
+#include <string>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Decoded cheat code
+ */
+struct SCheatCode {
+	/**
+	 * CPU address
+	 */
+	std::uint16_t Address;
+	/**
+	 * Substituted value
+	 */
+	std::uint8_t Value;
+	/**
+	 * Compare value or negative if not used
+	 */
+	int Compare;
+};
+
+/**
+ * Decodes cheat code
+ *
+ * Accepts 6- and 8-letter Game Genie codes and raw codes in form
+ * AAAA:VV or AAAA?CC:VV (hexadecimal address, compare and value).
+ *
+ * @param code Cheat code
+ * @return Decoded cheat
+ */
+SCheatCode decodeCheat(const std::string &code);
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_CHEATS_HPP_
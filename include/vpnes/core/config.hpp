@@ -32,10 +32,12 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <vector>
-#include <fstream>
+#include <istream>
+#include <memory>
+#include <string>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/frontend.hpp>
+#include <vpnes/core/image.hpp>
 #include <vpnes/core/nes.hpp>
 #include <vpnes/gui/config.hpp>
 
@@ -60,35 +62,32 @@ enum EMirroring {
 enum ENESType {
 	NESTypeNTSC,       //!< NTSC NES
 	NESTypePAL,        //!< PAL NES
-	NESTypeFC,         //!< Famicom
-	NESTypeFamiclone,  //!< Famicom clone
-};
-
-/**
- * MMC Type
- */
-enum EMMCType {
-	MMCNROM128,  //!< NROM-128
-	MMCNROM256,  //!< NROM-256
-	MMCAmount    //!< Total amount
+	NESTypeFC,           //!< Famicom
+	NESTypeFamiclone,    //!< Famicom clone
+	NESTypeDendy,        //!< Dendy
+	NESTypeMultiRegion,  //!< Runs with any timing
 };
 
 /**
  * Defines NES instance
  */
 struct SNESConfig {
+	/**
+	 * ROM image (keeps banks alive)
+	 */
+	std::shared_ptr<CROMImage> Image;
 	/**
 	 * CHR ROM
 	 */
-	std::vector<std::uint8_t> CHR;
+	CROMSpan CHR;
 	/**
 	 * PRG ROM
 	 */
-	std::vector<std::uint8_t> PRG;
+	CROMSpan PRG;
 	/**
 	 * Trainer hack
 	 */
-	std::vector<std::uint8_t> Trainer;
+	CROMSpan Trainer;
 	/**
 	 * PRG size
 	 */
@@ -102,9 +101,41 @@ struct SNESConfig {
 	 */
 	std::size_t RAMSize;
 	/**
-	 * MMC type
+	 * Battery backed RAM size
+	 */
+	std::size_t BatterySize;
+	/**
+	 * CHR RAM size
+	 */
+	std::size_t CHRRAMSize;
+	/**
+	 * Battery backed CHR RAM size
+	 */
+	std::size_t CHRBatterySize;
+	/**
+	 * Mapper number
+	 */
+	std::uint16_t Mapper;
+	/**
+	 * Submapper number
+	 */
+	std::uint8_t Submapper;
+	/**
+	 * CRC32 of PRG and CHR ROM
 	 */
-	EMMCType MMCType;
+	std::uint32_t CRC32;
+	/**
+	 * Save file for battery backed RAM (empty to not save)
+	 */
+	std::string SaveFile;
+	/**
+	 * Save file flush interval in milliseconds (0 to save on exit only)
+	 */
+	std::uint32_t SaveInterval;
+	/**
+	 * Timeline trace file (used by builds with VPNES_TRACE)
+	 */
+	std::string TraceFile;
 	/**
 	 * Mirroring type
 	 */
@@ -114,6 +145,20 @@ struct SNESConfig {
 	 */
 	ENESType NESType;
 
+	/**
+	 * Configures the class
+	 *
+	 * @param appConfig Application configuration
+	 * @param image ROM image
+	 */
+	void configure(const gui::SApplicationConfig &appConfig,
+	    const std::shared_ptr<CROMImage> &image);
+	/**
+	 * Configures the class from memory mapped input file
+	 *
+	 * @param appConfig Application configuration
+	 */
+	void configure(const gui::SApplicationConfig &appConfig);
 	/**
 	 * Configures the class
 	 *
@@ -121,7 +166,7 @@ struct SNESConfig {
 	 * @param inputFile Input file stream
 	 */
 	void configure(
-	    const gui::SApplicationConfig &appConfig, std::ifstream *inputFile);
+	    const gui::SApplicationConfig &appConfig, std::istream *inputFile);
 	/**
 	 * Creates an instance of NES
 	 *
@@ -36,6 +36,9 @@
 #include <vpnes/core/device.hpp>
 #include <vpnes/core/bus.hpp>
 #include <vpnes/core/mboard.hpp>
+#include <vpnes/core/profiler.hpp>
+#include <vpnes/core/cputrace.hpp>
+#include <vpnes/core/disasm.hpp>
 
 namespace vpnes {
 
@@ -115,6 +118,10 @@ private:
 	 * Internal clock
 	 */
 	ticks_t m_InternalClock;
+	/**
+	 * Ticks per CPU cycle
+	 */
+	ticks_t m_Divider;
 	/**
 	 * Current index in compiled microcode
 	 */
@@ -207,6 +214,16 @@ private:
 	 * Carry flag
 	 */
 	int m_Carry;
+#if defined(VPNES_PROFILE)
+	/**
+	 * Code profile
+	 */
+	CCodeProfile m_CodeProfile;
+#endif
+	/**
+	 * Instruction trace
+	 */
+	CInstructionTrace *m_InstructionTrace;
 	/**
 	 * Default flag values
 	 */
@@ -310,11 +327,17 @@ private:
 		*d &= 0x00ff;
 		*d |= s << 8;
 	}
+	/**
+	 * Writes current instruction or taken interrupt to trace
+	 */
+	void traceInstruction();
 	/**
 	 * Processes interrupts
 	 */
 	void processInterrupts() {
-		// TODO(me) : Update interrupt flags
+		// TODO(me) : Update NMI flag
+		m_PendingIRQ = m_MotherBoard->isIRQ();
+		m_PendingINT = m_PendingNMI || (m_PendingIRQ && !m_Interrupt);
 	}
 
 protected:
@@ -322,13 +345,27 @@ protected:
 	 * Simulation routine
 	 */
 	void execute();
+	/**
+	 * Synchronizes the clock
+	 *
+	 * Execution stops at the new end point.
+	 *
+	 * @param ticks New clock value
+	 */
+	void sync(ticks_t ticks) {
+		m_Clock = ticks;
+	}
 	/**
 	 * Resets the clock by ticks amount
 	 *
 	 * @param ticks Amount of ticks
 	 */
 	void resetClock(ticks_t ticks) {
+		CClockedDevice::resetClock(ticks);
 		m_InternalClock -= ticks;
+#if defined(VPNES_PROFILE)
+		m_CodeProfile.resetClock(ticks);
+#endif
 	}
 
 public:
@@ -340,8 +377,9 @@ public:
 	 * Constructs the object
 	 *
 	 * @param motherBoard Motherboard
+	 * @param divider Ticks per CPU cycle
 	 */
-	explicit CCPU(CMotherBoard *motherBoard);
+	CCPU(CMotherBoard *motherBoard, ticks_t divider);
 	/**
 	 * Destroys the object
 	 */
@@ -363,6 +401,95 @@ public:
 	ticks_t getPending() const {
 		return m_InternalClock;
 	}
+	/**
+	 * Gets amount of ticks per CPU cycle
+	 *
+	 * @return Ticks per CPU cycle
+	 */
+	ticks_t getDivider() const {
+		return m_Divider;
+	}
+	/**
+	 * Halts the CPU for DMA
+	 *
+	 * @param cycles Amount of CPU cycles
+	 */
+	void stall(ticks_t cycles) {
+		m_InternalClock += cycles * m_Divider;
+	}
+	/**
+	 * Gets A
+	 *
+	 * @return A
+	 */
+	std::uint8_t getA() const {
+		return m_A;
+	}
+	/**
+	 * Gets X
+	 *
+	 * @return X
+	 */
+	std::uint8_t getX() const {
+		return m_X;
+	}
+	/**
+	 * Gets Y
+	 *
+	 * @return Y
+	 */
+	std::uint8_t getY() const {
+		return m_Y;
+	}
+	/**
+	 * Gets stack
+	 *
+	 * @return Stack
+	 */
+	std::uint8_t getS() const {
+		return m_S;
+	}
+	/**
+	 * Gets packed flags
+	 *
+	 * @return Packed flags
+	 */
+	std::uint8_t getP() {
+		return packState();
+	}
+	/**
+	 * Gets PC
+	 *
+	 * @return PC
+	 */
+	std::uint16_t getPC() const {
+		return m_PC;
+	}
+	/**
+	 * Sets instruction trace
+	 *
+	 * @param trace Instruction trace or null to stop tracing
+	 */
+	void setInstructionTrace(CInstructionTrace *trace) {
+		m_InstructionTrace = trace;
+	}
+	/**
+	 * Gets instruction info
+	 *
+	 * @param opcode Opcode
+	 * @return Mnemonic and addressing mode
+	 */
+	static const SInstructionInfo &getInstructionInfo(std::uint8_t opcode);
+#if defined(VPNES_PROFILE)
+	/**
+	 * Gets code profile
+	 *
+	 * @return Code profile
+	 */
+	const CCodeProfile &getCodeProfile() const {
+		return m_CodeProfile;
+	}
+#endif
 };
 
 }  // namespace core
@@ -70,8 +70,13 @@ struct Cycle {
 
 /**
  * Defines CPU command
+ *
+ * Each command has to define its mnemonic as static constexpr Name.
  */
 struct Command {
+	enum {
+		Accumulator = false  //!< Implied mode operates on accumulator
+	};
 	/**
 	 * Executes the command
 	 *
@@ -349,6 +354,73 @@ struct OpcodeParser<OpcodeFinder, std::index_sequence<Codes...>> {
 	}
 };
 
+/**
+ * Declares instruction info finder
+ */
+template <class OpcodePack>
+struct FindInstruction;
+
+/**
+ * Empty instruction info finder
+ */
+template <>
+struct FindInstruction<class_pack<>> {
+	/**
+	 * Looks up instruction info
+	 *
+	 * @param code Opcode
+	 * @return Info for jammed CPU
+	 */
+	static constexpr SInstructionInfo find(std::uint8_t code) {
+		return {"JAM", ModeImplied};
+	}
+};
+
+/**
+ * Implements instruction info finder
+ */
+template <class FirstOpcode, class... OtherOpcodes>
+struct FindInstruction<class_pack<FirstOpcode, OtherOpcodes...>> {
+	/**
+	 * Looks up instruction info
+	 *
+	 * @param code Opcode
+	 * @return Instruction info
+	 */
+	static constexpr SInstructionInfo find(std::uint8_t code) {
+		if (code == FirstOpcode::code) {
+			return {FirstOpcode::operation::Name,
+			    static_cast<EAddressingMode>(FirstOpcode::operation::Mode)};
+		} else {
+			return FindInstruction<class_pack<OtherOpcodes...>>::find(code);
+		}
+	}
+};
+
+/**
+ * Builds instruction info table
+ */
+template <class InstructionFinder, class IndexPack>
+struct InstructionTable;
+
+/**
+ * Implementation of instruction info table
+ */
+template <std::size_t... Codes, class InstructionFinder>
+struct InstructionTable<InstructionFinder, std::index_sequence<Codes...>> {
+	/**
+	 * Looks up instruction info
+	 *
+	 * @param code Opcode
+	 * @return Instruction info
+	 */
+	static const SInstructionInfo &getInfo(std::uint8_t code) {
+		static constexpr SInstructionInfo infos[sizeof...(Codes)] = {
+		    InstructionFinder::find(Codes)...};
+		return infos[code];
+	}
+};
+
 /**
  * Converts opcode pack to operation pack
  */
@@ -442,6 +514,16 @@ struct Control {
 		return OpcodeParser<opcode_finder,
 		    std::make_index_sequence<0x100>>::parseOpcode(code);
 	}
+	/**
+	 * Looks up instruction info generated from opcode pack
+	 *
+	 * @param code Opcode
+	 * @return Instruction info
+	 */
+	static const SInstructionInfo &getInstructionInfo(std::uint8_t code) {
+		return InstructionTable<FindInstruction<opcode_pack>,
+		    std::make_index_sequence<0x100>>::getInfo(code);
+	}
 };
 
 }  // namespace cpu
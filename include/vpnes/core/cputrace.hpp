@@ -0,0 +1,294 @@
+/**
+ * @file
+ *
+ * Defines CPU instruction trace
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_CPUTRACE_HPP_
+#define INCLUDE_VPNES_CORE_CPUTRACE_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Executed instruction or taken interrupt
+ */
+struct SInstructionRecord {
+	/**
+	 * Instruction address (return address for interrupt)
+	 */
+	std::uint16_t PC;
+	/**
+	 * Opcode and up to two operand bytes
+	 */
+	std::uint8_t Bytes[3];
+	/**
+	 * A
+	 */
+	std::uint8_t A;
+	/**
+	 * X
+	 */
+	std::uint8_t X;
+	/**
+	 * Y
+	 */
+	std::uint8_t Y;
+	/**
+	 * Stack
+	 */
+	std::uint8_t S;
+	/**
+	 * Packed flags
+	 */
+	std::uint8_t P;
+	/**
+	 * CPU cycle when instruction started
+	 */
+	std::uint64_t Cycle;
+	/**
+	 * Record is a taken interrupt, opcode bytes are zero
+	 */
+	bool Interrupt;
+};
+
+/**
+ * Binary instruction trace writer
+ *
+ * Records are packed into fixed 19-byte little-endian entries and collected
+ * into one of two block buffers. A full block is handed over to a writer
+ * thread that compresses it (with zlib, if available) and stores it, while
+ * emulation continues in the other buffer.
+ *
+ * File layout: "VPNESTRC", version (u16), record size (u16), compression
+ * (u8), then blocks of stored size (u32), raw size (u32) and data.
+ */
+class CInstructionTrace {
+public:
+	enum {
+		RecordSize = 19,       //!< Size of packed record
+		BlockRecords = 0x4000  //!< Records per block
+	};
+	/**
+	 * Block compression
+	 */
+	enum ECompression {
+		CompressionNone,  //!< Stored as is
+		CompressionZlib   //!< Deflated with zlib
+	};
+
+private:
+	/**
+	 * Output file
+	 */
+	std::ofstream m_Output;
+	/**
+	 * Block buffers
+	 */
+	std::vector<std::uint8_t> m_Buffers[2];
+	/**
+	 * Buffer being filled
+	 */
+	std::size_t m_Active;
+	/**
+	 * Used bytes in active buffer
+	 */
+	std::size_t m_Used;
+	/**
+	 * Size of block passed to writer
+	 */
+	std::size_t m_PendingSize;
+	/**
+	 * Block is passed to writer
+	 */
+	bool m_Pending;
+	/**
+	 * Stop flag
+	 */
+	bool m_Stop;
+	/**
+	 * Guards hand-over
+	 */
+	std::mutex m_Mutex;
+	/**
+	 * Signals hand-over
+	 */
+	std::condition_variable m_Signal;
+	/**
+	 * Writer thread
+	 */
+	std::thread m_Thread;
+
+	/**
+	 * Passes active block to writer
+	 */
+	void submit();
+	/**
+	 * Writes a block
+	 *
+	 * @param data Block data
+	 * @param size Block size
+	 */
+	void writeBlock(const std::uint8_t *data, std::size_t size);
+	/**
+	 * Writer thread routine
+	 */
+	void run();
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CInstructionTrace() = delete;
+	/**
+	 * Opens the trace
+	 *
+	 * @param fileName Output file
+	 */
+	explicit CInstructionTrace(const char *fileName);
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CInstructionTrace(const CInstructionTrace &s) = delete;
+	/**
+	 * Flushes and closes the trace
+	 */
+	~CInstructionTrace();
+
+	/**
+	 * Adds a record
+	 *
+	 * @param record Record
+	 */
+	void add(const SInstructionRecord &record) {
+		std::uint8_t *data = m_Buffers[m_Active].data() + m_Used;
+		data[0] = record.PC & 0xff;
+		data[1] = record.PC >> 8;
+		data[2] = record.Bytes[0];
+		data[3] = record.Bytes[1];
+		data[4] = record.Bytes[2];
+		data[5] = record.A;
+		data[6] = record.X;
+		data[7] = record.Y;
+		data[8] = record.S;
+		data[9] = record.P;
+		for (std::size_t i = 0; i < 8; i++) {
+			data[10 + i] = static_cast<std::uint8_t>(record.Cycle >> (i * 8));
+		}
+		data[18] = record.Interrupt;
+		m_Used += RecordSize;
+		if (m_Used == m_Buffers[m_Active].size()) {
+			submit();
+		}
+	}
+};
+
+/**
+ * Binary instruction trace reader
+ */
+class CInstructionTraceReader {
+private:
+	/**
+	 * Input stream
+	 */
+	std::istream &m_Input;
+	/**
+	 * Block compression
+	 */
+	CInstructionTrace::ECompression m_Compression;
+	/**
+	 * Current block
+	 */
+	std::vector<std::uint8_t> m_Block;
+	/**
+	 * Read position in block
+	 */
+	std::size_t m_Pos;
+
+	/**
+	 * Reads next block
+	 *
+	 * @return False at the end of trace
+	 */
+	bool readBlock();
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CInstructionTraceReader() = delete;
+	/**
+	 * Reads trace header
+	 *
+	 * @param input Input stream
+	 */
+	explicit CInstructionTraceReader(std::istream &input);
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CInstructionTraceReader(const CInstructionTraceReader &s) = delete;
+
+	/**
+	 * Reads next record
+	 *
+	 * @param record Record
+	 * @return False at the end of trace
+	 */
+	bool read(SInstructionRecord *record);
+};
+
+/**
+ * Prints binary instruction trace as text
+ *
+ * One line per record: address, instruction bytes, disassembly (INTERRUPT
+ * for taken interrupts), registers and cycle.
+ *
+ * @param in Trace stream
+ * @param out Output stream
+ */
+void dumpInstructionTrace(std::istream &in, std::ostream &out);
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_CPUTRACE_HPP_
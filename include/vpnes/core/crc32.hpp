@@ -0,0 +1,58 @@
+/**
+ * @file
+ *
+ * Defines CRC32 checksum
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_CRC32_HPP_
+#define INCLUDE_VPNES_CORE_CRC32_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Updates CRC32 (IEEE 802.3, as used by ROM databases)
+ *
+ * Processes eight bytes per step using slicing-by-8 tables.
+ *
+ * @param crc Previous CRC32 (0 for the first block)
+ * @param data Data
+ * @param size Data size
+ * @return Updated CRC32
+ */
+std::uint32_t updateCRC32(
+    std::uint32_t crc, const std::uint8_t *data, std::size_t size);
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_CRC32_HPP_
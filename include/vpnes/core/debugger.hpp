@@ -30,14 +30,54 @@
 #include "config.h"
 #endif
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <ostream>
+#include <string>
 #include <vpnes/vpnes.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/profiler.hpp>
+#include <vpnes/core/watch.hpp>
+#include <vpnes/core/breakpoint.hpp>
+#include <vpnes/core/cheats.hpp>
+#include <vpnes/core/disasm.hpp>
+#include <vpnes/core/search.hpp>
 
 namespace vpnes {
 
 namespace core {
 
+/**
+ * CPU registers
+ */
+struct SCPURegisters {
+	/**
+	 * A
+	 */
+	std::uint8_t A;
+	/**
+	 * X
+	 */
+	std::uint8_t X;
+	/**
+	 * Y
+	 */
+	std::uint8_t Y;
+	/**
+	 * Stack
+	 */
+	std::uint8_t S;
+	/**
+	 * Packed flags
+	 */
+	std::uint8_t P;
+	/**
+	 * PC
+	 */
+	std::uint16_t PC;
+};
+
 /**
  * NES Debugger
  */
@@ -76,6 +116,103 @@ public:
 	 * @param val Value
 	 */
 	virtual void directCPUWrite(std::uint16_t addr, std::uint8_t val) = 0;
+	/**
+	 * Gets bulk watchpoints and access counters for CPU bus
+	 *
+	 * @return CPU bus watch
+	 */
+	virtual CBusWatch *getWatchCPU() = 0;
+	/**
+	 * Gets conditional breakpoints on CPU bus
+	 *
+	 * @return Breakpoints
+	 */
+	virtual CBreakpoints *getBreakpoints() = 0;
+	/**
+	 * Gets CPU registers
+	 *
+	 * @return CPU registers
+	 */
+	virtual SCPURegisters getCPURegisters() = 0;
+	/**
+	 * Starts writing executed instructions to binary trace
+	 *
+	 * @param fileName Trace file
+	 */
+	virtual void startInstructionTrace(const char *fileName) = 0;
+	/**
+	 * Stops and flushes instruction trace
+	 */
+	virtual void stopInstructionTrace() = 0;
+	/**
+	 * Gets disassembler for CPU bus
+	 *
+	 * @return Disassembler
+	 */
+	virtual CDisassembler *getDisassembler() = 0;
+	/**
+	 * Disassembles instruction on CPU bus
+	 *
+	 * @param addr Address
+	 * @return Instruction text
+	 */
+	virtual const char *disassemble(std::uint16_t addr) = 0;
+	/**
+	 * Gets memory search
+	 *
+	 * @return Memory search
+	 */
+	virtual CMemorySearch *getMemorySearch() = 0;
+	/**
+	 * Adds cheat code
+	 *
+	 * @param code Game Genie or raw cheat code
+	 * @return Cheat identifier
+	 */
+	virtual std::size_t addCheat(const std::string &code) = 0;
+	/**
+	 * Removes cheat code
+	 *
+	 * @param id Cheat identifier
+	 */
+	virtual void removeCheat(std::size_t id) = 0;
+	/**
+	 * Gets amount of master clock ticks since power up
+	 *
+	 * @return Elapsed ticks
+	 */
+	virtual ticks_t getElapsedTicks() = 0;
+	/**
+	 * Gets amount of master clock ticks per CPU cycle
+	 *
+	 * @return Ticks per CPU cycle
+	 */
+	virtual ticks_t getCPUDivider() = 0;
+	/**
+	 * Gets profiling data for running devices
+	 *
+	 * Empty unless built with VPNES_PROFILE.
+	 *
+	 * @return Profiling data
+	 */
+	virtual ProfileData getDeviceProfile() = 0;
+	/**
+	 * Gets profiling data for events
+	 *
+	 * Empty unless built with VPNES_PROFILE.
+	 *
+	 * @return Profiling data
+	 */
+	virtual ProfileData getEventProfile() = 0;
+	/**
+	 * Prints hottest CPU addresses and loops
+	 *
+	 * Prints nothing unless built with VPNES_PROFILE.
+	 *
+	 * @param out Output stream
+	 * @param count Number of entries in each list
+	 */
+	virtual void dumpCodeProfile(std::ostream &out, std::size_t count) = 0;
 	/**
 	 * Constructor
 	 */
@@ -32,6 +32,9 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <tuple>
 #include <utility>
 #include <type_traits>
 #include <memory>
@@ -40,6 +43,8 @@
 #include <unordered_map>
 #include <vector>
 #include <vpnes/vpnes.hpp>
+#include <vpnes/core/profiler.hpp>
+#include <vpnes/core/trace.hpp>
 
 namespace vpnes {
 
@@ -176,6 +181,12 @@ protected:
 	 * Flag enabling the event
 	 */
 	bool m_Enabled;
+#if defined(VPNES_PROFILE)
+	/**
+	 * Profiling counters
+	 */
+	SProfileRecord m_Profile{};
+#endif
 	/**
 	 * Default constructor
 	 *
@@ -232,6 +243,38 @@ public:
 	bool isEnabled() const {
 		return m_Enabled;
 	}
+	/**
+	 * Gets event name
+	 *
+	 * @return Event name
+	 */
+	const char *getName() const {
+		return m_Name;
+	}
+#if defined(VPNES_PROFILE)
+	/**
+	 * Accounts a fire
+	 *
+	 * @param nanoseconds Host time spent
+	 */
+	void addProfile(std::uint64_t nanoseconds) {
+		m_Profile.add(0, nanoseconds);
+	}
+#endif
+	/**
+	 * Gets profiling counters
+	 *
+	 * @return Profiling record
+	 */
+	SProfileRecord getProfile() const {
+#if defined(VPNES_PROFILE)
+		SProfileRecord record = m_Profile;
+#else
+		SProfileRecord record{};
+#endif
+		record.Name = m_Name;
+		return record;
+	}
 };
 
 /**
@@ -353,13 +396,19 @@ private:
 		 * Saved enabling flag
 		 */
 		bool m_Enabled;
+		/**
+		 * Registration order, fires events sharing a time
+		 */
+		std::size_t m_Order;
 		/**
 		 * Constructs the object
 		 *
 		 * @param event Event to add
+		 * @param order Registration order
 		 */
-		explicit SEventData(CEvent *event) {
+		SEventData(CEvent *event, std::size_t order) {
 			m_Event = event;
+			m_Order = order;
 			update();
 		}
 		/**
@@ -395,7 +444,10 @@ private:
 		 */
 		static bool compare(SEventData *const left, SEventData *const right) {
 			assert(right->m_Enabled && left->m_Enabled);
-			return left->m_Time < right->m_Time;
+			if (left->m_Time != right->m_Time) {
+				return left->m_Time < right->m_Time;
+			}
+			return left->m_Order < right->m_Order;
 		}
 	};
 	/**
@@ -428,9 +480,9 @@ protected:
 	 */
 	void updateClock() {
 		ticks_t newClock = m_Clock;
-		EventQueue::const_reverse_iterator iter = m_EventQueue.crbegin();
+		EventQueue::const_iterator iter = m_EventQueue.cbegin();
 
-		if (iter == m_EventQueue.crend()) {
+		if (iter == m_EventQueue.cend()) {
 			newClock = m_LocalTime;
 		} else {
 			newClock = (*iter)->m_Time;
@@ -446,8 +498,8 @@ protected:
 	 * @return New clock value
 	 */
 	ticks_t generateTicks() {
-		EventQueue::const_reverse_iterator iter = m_EventQueue.crbegin();
-		assert(iter != m_EventQueue.crend());
+		EventQueue::const_iterator iter = m_EventQueue.cbegin();
+		assert(iter != m_EventQueue.cend());
 		return (*iter)->m_Time;
 	}
 	/**
@@ -455,11 +507,22 @@ protected:
 	 */
 	void fireEvents() {
 		for (;;) {
-			EventQueue::const_reverse_iterator iter = m_EventQueue.crbegin();
-			if (iter == m_EventQueue.crend() || (*iter)->m_Time > m_Clock) {
+			EventQueue::const_iterator iter = m_EventQueue.cbegin();
+			if (iter == m_EventQueue.cend() || (*iter)->m_Time > m_Clock) {
 				break;
 			}
-			(*iter)->m_Event->fire();
+			CEvent *event = (*iter)->m_Event;
+#if defined(VPNES_TRACE)
+			CTraceSlice slice(event->getName(), "event");
+			slice.setTicks(event->getFireTime());
+#endif
+#if defined(VPNES_PROFILE)
+			CProfileTimer timer;
+			event->fire();
+			event->addProfile(timer.getElapsed());
+#else
+			event->fire();
+#endif
 		}
 	}
 
@@ -513,6 +576,7 @@ public:
 	 */
 	void resetClock(ticks_t ticks) {
 		CClockedDevice::resetClock(ticks);
+		m_LocalTime -= ticks;
 		for (auto &event : m_EventData) {
 			SEventData &eventData = event.second;
 			eventData.m_Event->sync(ticks);
@@ -526,7 +590,9 @@ public:
 	 */
 	void registerDeviceEvent(CEvent *event) {
 		assert(m_EventData.find(event) == m_EventData.end());
-		auto newData = m_EventData.emplace(event, event);
+		auto newData = m_EventData.emplace(std::piecewise_construct,
+		    std::forward_as_tuple(event),
+		    std::forward_as_tuple(event, m_EventData.size()));
 		SEventData &eventData = newData.first->second;
 		if (eventData.m_Enabled) {
 			m_EventQueue.insert(&eventData);
@@ -563,7 +629,8 @@ public:
 	 */
 	void simulate() {
 		while (m_Enabled) {
-			setClock(generateTicks());
+			m_LocalTime = generateTicks();
+			setClock(m_LocalTime);
 			execute();
 			fireEvents();
 		}
@@ -669,6 +736,22 @@ public:
 		assert(iter != eventMap.end());
 		return *iter->second;
 	}
+	/**
+	 * Gets profiling data for all events
+	 *
+	 * @return Profiling data sorted by name
+	 */
+	ProfileData getEventProfile() const {
+		ProfileData data;
+		for (const auto &event : events) {
+			data.push_back(event.second->getProfile());
+		}
+		std::sort(data.begin(), data.end(),
+		    [](const SProfileRecord &left, const SProfileRecord &right) {
+			    return left.Name < right.Name;
+		    });
+		return data;
+	}
 	/**
 	 * Unregisters all device's events and destroys them
 	 *
@@ -0,0 +1,186 @@
+/**
+ * @file
+ *
+ * Defines 6502 disassembler
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_DISASM_HPP_
+#define INCLUDE_VPNES_CORE_DISASM_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * 6502 addressing modes
+ */
+enum EAddressingMode {
+	ModeImplied,      //!< No operand
+	ModeAccumulator,  //!< A
+	ModeImmediate,    //!< #$nn
+	ModeZeroPage,     //!< $nn
+	ModeZeroPageX,    //!< $nn,X
+	ModeZeroPageY,    //!< $nn,Y
+	ModeAbsolute,     //!< $nnnn
+	ModeAbsoluteX,    //!< $nnnn,X
+	ModeAbsoluteY,    //!< $nnnn,Y
+	ModeIndirect,     //!< ($nnnn)
+	ModeIndirectX,    //!< ($nn,X)
+	ModeIndirectY,    //!< ($nn),Y
+	ModeRelative      //!< Branch offset
+};
+
+/**
+ * Instruction info
+ */
+struct SInstructionInfo {
+	/**
+	 * Mnemonic
+	 */
+	const char *Name;
+	/**
+	 * Addressing mode
+	 */
+	EAddressingMode Mode;
+};
+
+/**
+ * Gets length of 6502 instruction
+ *
+ * @param opcode Opcode
+ * @return Length in bytes
+ */
+std::size_t getInstructionLength(std::uint8_t opcode);
+
+/**
+ * 6502 disassembler
+ *
+ * Instruction info comes from the CPU opcode table, so the disassembler
+ * always matches emulated instruction set. Decoded text is cached per
+ * address in lazily allocated banks; cache entries remember instruction
+ * bytes and are decoded again only if the bytes have changed (bank
+ * switching, code in RAM).
+ */
+class CDisassembler {
+public:
+	/**
+	 * Memory reader
+	 */
+	typedef std::function<std::uint8_t(std::uint16_t)> reader_t;
+	enum {
+		BankSize = 0x1000,  //!< Cache bank size
+		MaxText = 16        //!< Maximum text length with terminator
+	};
+
+private:
+	/**
+	 * Cached instruction
+	 */
+	struct SEntry {
+		/**
+		 * Instruction bytes
+		 */
+		std::uint8_t Bytes[3];
+		/**
+		 * Entry is decoded
+		 */
+		bool Valid;
+		/**
+		 * Decoded text
+		 */
+		char Text[MaxText];
+	};
+
+	/**
+	 * Cache banks
+	 */
+	std::unique_ptr<SEntry[]> m_Banks[0x10000 / BankSize];
+
+	/**
+	 * Gets cache entry
+	 *
+	 * @param addr Address
+	 * @return Cache entry
+	 */
+	SEntry &getEntry(std::uint16_t addr);
+
+public:
+	/**
+	 * Constructs the object
+	 */
+	CDisassembler() = default;
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CDisassembler(const CDisassembler &s) = delete;
+
+	/**
+	 * Decodes instruction without cache
+	 *
+	 * @param addr Instruction address
+	 * @param bytes Instruction bytes (up to 3)
+	 * @param text Output buffer of at least MaxText characters
+	 */
+	static void format(
+	    std::uint16_t addr, const std::uint8_t *bytes, char *text);
+	/**
+	 * Decodes instruction
+	 *
+	 * @param addr Instruction address
+	 * @param bytes Instruction bytes (up to 3)
+	 * @return Decoded text valid until next call for the same address
+	 */
+	const char *disassemble(std::uint16_t addr, const std::uint8_t *bytes);
+	/**
+	 * Decodes instruction from memory
+	 *
+	 * @param addr Instruction address
+	 * @param read Memory reader
+	 * @return Decoded text valid until next call for the same address
+	 */
+	const char *disassemble(std::uint16_t addr, const reader_t &read);
+	/**
+	 * Drops cached instructions
+	 *
+	 * @param first First address
+	 * @param last Last address (inclusive)
+	 */
+	void invalidate(std::uint16_t first, std::uint16_t last);
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_DISASM_HPP_
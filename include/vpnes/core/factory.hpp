@@ -30,6 +30,7 @@
 #include "config.h"
 #endif
 
+#include <cstdint>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/frontend.hpp>
 #include <vpnes/core/nes.hpp>
@@ -49,18 +50,94 @@ namespace core {
  */
 typedef CNES *(*NESFactory)(const SNESConfig &config, CFrontEnd *frontEnd);
 
-namespace factory {
-
 /**
- * NROM NES factory
+ * Mapper registry
  *
- * @param config NES config
- * @param frontEnd Front-end
- * @return NES
+ * Mapper translation units register their factories with a static
+ * CMapperRegistrar, so no central list has to know about them. Lookup is a
+ * flat table indexed by iNES mapper number with a short submapper chain in
+ * each slot.
  */
-CNES *factoryNROM(const SNESConfig &config, CFrontEnd *frontEnd);
+class CMapperRegistry {
+public:
+	enum {
+		MapperCount = 0x1000,  //!< iNES 2.0 mapper number range
+		AnySubmapper = -1      //!< Matches any submapper
+	};
+
+	/**
+	 * Registered factory
+	 */
+	struct SEntry {
+		/**
+		 * Submapper number or AnySubmapper
+		 */
+		int Submapper;
+		/**
+		 * Factory
+		 */
+		NESFactory Factory;
+		/**
+		 * Next entry for the same mapper
+		 */
+		const SEntry *Next;
+	};
+
+	/**
+	 * Registers factory
+	 *
+	 * Called during static initialization, entry must outlive the registry.
+	 * Throws std::invalid_argument if mapper is not below MapperCount.
+	 *
+	 * @param mapper Mapper number
+	 * @param entry Registered factory
+	 */
+	static void add(std::uint16_t mapper, SEntry *entry);
+	/**
+	 * Finds factory
+	 *
+	 * Exact submapper match takes precedence over AnySubmapper.
+	 *
+	 * @param mapper Mapper number
+	 * @param submapper Submapper number
+	 * @return Factory or nullptr if mapper is not supported
+	 */
+	static NESFactory find(std::uint16_t mapper, std::uint8_t submapper);
+};
 
-}  // namespace factory
+/**
+ * Registers mapper factory on construction
+ */
+class CMapperRegistrar {
+private:
+	/**
+	 * Registry entry
+	 */
+	CMapperRegistry::SEntry m_Entry;
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CMapperRegistrar() = delete;
+	/**
+	 * Registers factory
+	 *
+	 * @param mapper Mapper number
+	 * @param submapper Submapper number or CMapperRegistry::AnySubmapper
+	 * @param factory Factory
+	 */
+	CMapperRegistrar(std::uint16_t mapper, int submapper, NESFactory factory)
+	    : m_Entry{submapper, factory, nullptr} {
+		CMapperRegistry::add(mapper, &m_Entry);
+	}
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CMapperRegistrar(const CMapperRegistrar &s) = delete;
+};
 
 }  // namespace core
 
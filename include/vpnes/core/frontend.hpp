@@ -30,6 +30,8 @@
 #include "config.h"
 #endif
 
+#include <cstddef>
+#include <cstdint>
 #include <vpnes/vpnes.hpp>
 
 namespace vpnes {
@@ -62,6 +64,23 @@ public:
 	 * @param frameTime Frame time
 	 */
 	virtual void handleFrameRender(double frameTime) = 0;
+	/**
+	 * Gets audio sample rate
+	 *
+	 * @return Sample rate or 0 if audio is not needed
+	 */
+	virtual int getSampleRate() {
+		return 0;
+	}
+	/**
+	 * Audio-ready callback
+	 *
+	 * @param samples Mono samples
+	 * @param count Amount of samples
+	 */
+	virtual void handleAudioSamples(
+	    const std::int16_t *samples, std::size_t count) {
+	}
 };
 
 }  // namespace core
@@ -0,0 +1,244 @@
+/**
+ * @file
+ *
+ * Defines ROM image storage
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_IMAGE_HPP_
+#define INCLUDE_VPNES_CORE_IMAGE_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Read-only view into ROM image
+ */
+class CROMSpan {
+private:
+	/**
+	 * First byte
+	 */
+	const std::uint8_t *m_Data;
+	/**
+	 * Size in bytes
+	 */
+	std::size_t m_Size;
+
+public:
+	/**
+	 * Constructs empty span
+	 */
+	CROMSpan() : m_Data(nullptr), m_Size(0) {
+	}
+	/**
+	 * Constructs the span
+	 *
+	 * @param data First byte
+	 * @param size Size in bytes
+	 */
+	CROMSpan(const std::uint8_t *data, std::size_t size)
+	    : m_Data(data), m_Size(size) {
+	}
+
+	/**
+	 * Gets first byte
+	 *
+	 * @return First byte
+	 */
+	const std::uint8_t *data() const {
+		return m_Data;
+	}
+	/**
+	 * Gets size
+	 *
+	 * @return Size in bytes
+	 */
+	std::size_t size() const {
+		return m_Size;
+	}
+	/**
+	 * Checks if the span is empty
+	 *
+	 * @return True if empty
+	 */
+	bool empty() const {
+		return m_Size == 0;
+	}
+	/**
+	 * Gets begin iterator
+	 *
+	 * @return Begin iterator
+	 */
+	const std::uint8_t *begin() const {
+		return m_Data;
+	}
+	/**
+	 * Gets end iterator
+	 *
+	 * @return End iterator
+	 */
+	const std::uint8_t *end() const {
+		return m_Data + m_Size;
+	}
+	/**
+	 * Gets a byte
+	 *
+	 * @param index Index
+	 * @return Byte
+	 */
+	std::uint8_t operator[](std::size_t index) const {
+		return m_Data[index];
+	}
+};
+
+/**
+ * ROM image
+ *
+ * Holds the whole file either as read-only memory mapping or as owned
+ * buffer. Banks are views into the image, so ROM data is never copied and
+ * instances of the same file share pages of the mapping.
+ */
+class CROMImage {
+private:
+	/**
+	 * Image data
+	 */
+	const std::uint8_t *m_Data;
+	/**
+	 * Image size
+	 */
+	std::size_t m_Size;
+	/**
+	 * Owned buffer (if not mapped)
+	 */
+	std::vector<std::uint8_t> m_Buffer;
+	/**
+	 * Image is memory mapped
+	 */
+	bool m_Mapped;
+
+	/**
+	 * Takes over the mapping
+	 *
+	 * @param data Mapped data
+	 * @param size Mapped size
+	 */
+	CROMImage(const std::uint8_t *data, std::size_t size);
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CROMImage() = delete;
+	/**
+	 * Takes over the buffer
+	 *
+	 * @param buffer Image data
+	 */
+	explicit CROMImage(std::vector<std::uint8_t> &&buffer);
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CROMImage(const CROMImage &s) = delete;
+	/**
+	 * Unmaps the image
+	 */
+	~CROMImage();
+
+	/**
+	 * Maps the file
+	 *
+	 * Falls back to reading the file if mapping is not supported.
+	 *
+	 * @param fileName File name
+	 * @return ROM image
+	 */
+	static std::shared_ptr<CROMImage> map(const char *fileName);
+	/**
+	 * Reads the stream to the end
+	 *
+	 * @param input Input stream
+	 * @return ROM image
+	 */
+	static std::shared_ptr<CROMImage> read(std::istream *input);
+	/**
+	 * Decompresses the image if it is a zip or gzip container
+	 *
+	 * @param image ROM image
+	 * @return Decompressed image or the same image if not compressed
+	 */
+	static std::shared_ptr<CROMImage> unpack(
+	    const std::shared_ptr<CROMImage> &image);
+
+	/**
+	 * Gets image data
+	 *
+	 * @return Image data
+	 */
+	const std::uint8_t *data() const {
+		return m_Data;
+	}
+	/**
+	 * Gets image size
+	 *
+	 * @return Image size
+	 */
+	std::size_t size() const {
+		return m_Size;
+	}
+	/**
+	 * Checks if the image is memory mapped
+	 *
+	 * @return True if mapped
+	 */
+	bool isMapped() const {
+		return m_Mapped;
+	}
+	/**
+	 * Gets a view into the image
+	 *
+	 * @param offset Offset
+	 * @param size Size
+	 * @return View
+	 */
+	CROMSpan getSpan(std::size_t offset, std::size_t size) const;
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_IMAGE_HPP_
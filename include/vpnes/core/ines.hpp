@@ -32,10 +32,10 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <vector>
-#include <fstream>
+#include <memory>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/config.hpp>
+#include <vpnes/core/image.hpp>
 
 namespace vpnes {
 
@@ -89,6 +89,64 @@ typedef struct iNES_Header {
 	 */
 	std::uint32_t BadROM;
 } iNES_Header;
+
+/**
+ * NES 2.0 header structure
+ */
+typedef struct NES20_Header {
+	/**
+	 * iNES signature
+	 */
+	char Signature[4];
+	/**
+	 * PRG ROM size LSB
+	 */
+	std::uint8_t PRGSize;
+	/**
+	 * CHR ROM size LSB
+	 */
+	std::uint8_t CHRSize;
+	/**
+	 * Flags
+	 */
+	std::uint8_t Flags;
+	/**
+	 * More flags
+	 */
+	std::uint8_t Flags_ex;
+	/**
+	 * Mapper MSB (low nibble) and submapper (high nibble)
+	 */
+	std::uint8_t Mapper_ex;
+	/**
+	 * PRG ROM size MSB (low nibble) and CHR ROM size MSB (high nibble)
+	 */
+	std::uint8_t ROMSize_ex;
+	/**
+	 * PRG RAM (low nibble) and PRG NVRAM (high nibble) shift counts
+	 */
+	std::uint8_t RAMSize;
+	/**
+	 * CHR RAM (low nibble) and CHR NVRAM (high nibble) shift counts
+	 */
+	std::uint8_t CHRRAMSize;
+	/**
+	 * CPU/PPU timing
+	 */
+	std::uint8_t Timing;
+	/**
+	 * Vs. System type or extended console type
+	 */
+	std::uint8_t SystemType;
+	/**
+	 * Amount of miscellaneous ROMs
+	 */
+	std::uint8_t MiscROMs;
+	/**
+	 * Default expansion device
+	 */
+	std::uint8_t ExpansionDevice;
+} NES20_Header;
 #pragma pack(pop)
 
 /**
@@ -112,9 +170,25 @@ struct SNESData {
 	 */
 	std::size_t BatterySize;
 	/**
-	 * MMC type
+	 * CHR RAM size
+	 */
+	std::size_t CHRRAMSize;
+	/**
+	 * Battery backed CHR RAM size
+	 */
+	std::size_t CHRBatterySize;
+	/**
+	 * Mapper number
+	 */
+	std::uint16_t Mapper;
+	/**
+	 * Submapper number
 	 */
-	EMMCType MMCType;
+	std::uint8_t Submapper;
+	/**
+	 * CRC32 of PRG and CHR ROM
+	 */
+	std::uint32_t CRC32;
 	/**
 	 * Mirroring type
 	 */
@@ -123,23 +197,46 @@ struct SNESData {
 	 * NES Type
 	 */
 	ENESType NESType;
+	/**
+	 * ROM image
+	 */
+	std::shared_ptr<CROMImage> Image;
 	/**
 	 * PRG ROM
 	 */
-	std::vector<std::uint8_t> PRG;
+	CROMSpan PRG;
 	/**
 	 * CHR ROM
 	 */
-	std::vector<std::uint8_t> CHR;
+	CROMSpan CHR;
 	/**
 	 * Trainer hacks
 	 */
-	std::vector<std::uint8_t> Trainer;
+	CROMSpan Trainer;
+	/**
+	 * Constructs the structure from the image
+	 *
+	 * @param image ROM image
+	 */
+	explicit SNESData(const std::shared_ptr<CROMImage> &image);
 	/**
-	 * Constructs the structure from the data
-	 * @param ROM
+	 * Parses iNES header
+	 *
+	 * @param header Header
+	 */
+	void parseINES(const iNES_Header &header);
+	/**
+	 * Parses NES 2.0 header
+	 *
+	 * @param header Header
+	 */
+	void parseNES20(const NES20_Header &header);
+	/**
+	 * Corrects header data from ROM database
+	 *
+	 * @return True if ROM is known
 	 */
-	explicit SNESData(std::ifstream *ROM);
+	bool applyDatabase();
 	/**
 	 * Deleted default constructor
 	 */
@@ -0,0 +1,449 @@
+/**
+ * @file
+ *
+ * Defines discrete logic mappers (UxROM, CNROM, AxROM)
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_MAPPERS_DISCRETE_HPP_
+#define INCLUDE_VPNES_CORE_MAPPERS_DISCRETE_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/bus.hpp>
+#include <vpnes/core/mboard.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/image.hpp>
+#include <vpnes/core/saveram.hpp>
+#include <vpnes/core/mappers/nametable.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Discrete logic mapper with a single latch at 0x8000 - 0xffff
+ *
+ * All variant differences are template parameters, so the latch decoding
+ * is resolved at compile time.
+ *
+ * @param BusConflicts Latch write conflicts with PRG ROM
+ * @param PRGBankSize Switchable PRG ROM window (0x4000 with fixed last
+ * bank, 0x8000 or 0 for fixed PRG ROM)
+ * @param CHRBankSize Switchable CHR window (0x2000 or 0 for fixed CHR)
+ * @param MirroringControl Latch bit 4 selects single screen
+ */
+template <bool BusConflicts, std::size_t PRGBankSize, std::size_t CHRBankSize,
+    bool MirroringControl>
+class CDiscrete : public CEventDevice {
+	static_assert(
+	    PRGBankSize == 0 || PRGBankSize == 0x4000 || PRGBankSize == 0x8000,
+	    "Unsupported PRG bank size");
+	static_assert(
+	    CHRBankSize == 0 || CHRBankSize == 0x2000, "Unsupported CHR bank size");
+
+public:
+	/**
+	 * PRG ROM bank type
+	 */
+	template <std::uint16_t Base>
+	using PRGROM = typename std::conditional<BusConflicts,
+	    banks::ReadOnlyWithConflict<Base, 0x4000, 0x4000>,
+	    banks::ReadOnly<Base, 0x4000, 0x4000>>::type;
+
+	/**
+	 * CPU bus config
+	 */
+	struct CPUConfig : BusConfigBase<CDiscrete> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::BankConfig<banks::OpenBus,
+		    banks::ReadWrite<0x6000, 0x2000,
+		        0x2000>,         // PRG RAM 0x6000 - 0x7fff
+		    PRGROM<0x8000>,  // PRG ROM 0x8000 - 0xbfff
+		    PRGROM<0xc000>>  // PRG ROM 0xc000 - 0xffff
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CDiscrete *device) {
+			BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
+			    writeBuf, nullptr, device->m_RAM.data(), device->m_PRGMap[0],
+			    device->m_PRGMap[1]);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			return addr >= 0x6000;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(
+		    std::uint16_t addr, const CDiscrete &device) {
+			if (addr < 0x8000) {
+				return device.m_RAM.empty() ? 0 : 1;
+			}
+			return 2 + ((addr >> 14) & 1);
+		}
+	};
+	/**
+	 * PPU bus config
+	 */
+	struct PPUConfig : BusConfigBase<CDiscrete> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::NameTableConfig<
+		    banks::ReadOnly<0x0000, 0x2000, 0x2000>,   // CHR ROM 0x0000 - 0x1fff
+		    banks::ReadWrite<0x0000, 0x2000, 0x2000>>  // CHR RAM 0x0000 - 0x1fff
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CDiscrete *device) {
+			device->m_NameTable.template mapIO<BankConfig>(iterRead, iterWrite,
+			    iterMod, openBus, dummy, writeBuf, device->m_CHRMap,
+			    device->m_CHRMap);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			// This will override PPU palette access to the bus
+			// which is not needed since it has different access point
+			return true;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(
+		    std::uint16_t addr, const CDiscrete &device) {
+			if (addr < 0x2000) {
+				return device.m_CHRBank;
+			} else {
+				return 2 + CNameTable::getWindow(addr);
+			}
+		}
+	};
+
+private:
+	/**
+	 * Latch bits selecting PRG ROM bank
+	 */
+	enum { PRGMask = MirroringControl ? 0x0f : 0xff };
+
+	/**
+	 * Motherboard
+	 */
+	CMotherBoard *m_MotherBoard;
+	/**
+	 * ROM image
+	 */
+	std::shared_ptr<CROMImage> m_Image;
+	/**
+	 * PRG ROM
+	 */
+	CROMSpan m_PRG;
+	/**
+	 * CHR ROM / CHR RAM
+	 */
+	CROMSpan m_CHR;
+	/**
+	 * CHR RAM
+	 */
+	std::vector<std::uint8_t> m_CHRRAM;
+	/**
+	 * PRG RAM
+	 */
+	CSaveRAM m_RAM;
+	/**
+	 * Nametable
+	 */
+	CNameTable m_NameTable;
+	/**
+	 * CHR bank in PPU bank config (0 for ROM, 1 for RAM)
+	 */
+	std::size_t m_CHRBank;
+	/**
+	 * Latch
+	 */
+	std::uint8_t m_Latch;
+	/**
+	 * Mapped PRG ROM banks
+	 */
+	std::uint8_t *m_PRGMap[2];
+	/**
+	 * Mapped CHR bank
+	 */
+	std::uint8_t *m_CHRMap;
+
+	/**
+	 * Gets PRG ROM bank
+	 *
+	 * ROM is only mapped to read and conflict maps, so it is never written.
+	 *
+	 * @param bank 16 KB bank number
+	 * @return PRG ROM bank
+	 */
+	std::uint8_t *getPRG(std::size_t bank) {
+		return const_cast<std::uint8_t *>(m_PRG.data()) +
+		       ((bank * 0x4000) & (m_PRG.size() - 1));
+	}
+	/**
+	 * Gets CHR bank
+	 *
+	 * CHR ROM is only written through CHR RAM bank, which is never active
+	 * for it.
+	 *
+	 * @param bank 8 KB bank number
+	 * @return CHR ROM / CHR RAM bank
+	 */
+	std::uint8_t *getCHR(std::size_t bank) {
+		return const_cast<std::uint8_t *>(m_CHR.data()) +
+		       ((bank * 0x2000) & (m_CHR.size() - 1));
+	}
+	/**
+	 * Calculates mapping from the latch
+	 *
+	 * @param prgMap PRG ROM banks
+	 * @param chrMap CHR bank
+	 */
+	void getMapping(std::uint8_t **prgMap, std::uint8_t **chrMap) {
+		std::size_t bank = m_Latch & PRGMask;
+		std::size_t lastBank = m_PRG.size() / 0x4000 - 1;
+		switch (PRGBankSize) {
+		case 0x4000:
+			prgMap[0] = getPRG(bank);
+			prgMap[1] = getPRG(lastBank);
+			break;
+		case 0x8000:
+			prgMap[0] = getPRG(bank * 2);
+			prgMap[1] = getPRG(bank * 2 + 1);
+			break;
+		default:
+			prgMap[0] = getPRG(0);
+			prgMap[1] = getPRG(1);
+			break;
+		}
+		*chrMap = getCHR(CHRBankSize ? m_Latch : 0);
+	}
+	/**
+	 * Gets single screen mirroring from the latch
+	 *
+	 * @return Mirroring
+	 */
+	EMirroring getSingleScreen() const {
+		return static_cast<EMirroring>(
+		    MirroringSingleScreen1 + ((m_Latch >> 4) & 0x01));
+	}
+	/**
+	 * Writes the latch
+	 *
+	 * Bus conflicts are already applied to the value by the bus. Only
+	 * windows the variant can switch are checked and remapped.
+	 *
+	 * @param val Value
+	 * @param addr Address
+	 */
+	void writeLatch(std::uint8_t val, std::uint16_t addr) {
+		std::uint8_t *prgMap[2];
+		std::uint8_t *chrMap;
+		m_Latch = val;
+		getMapping(prgMap, &chrMap);
+		if (PRGBankSize != 0) {
+			CBus *busCPU = m_MotherBoard->getBusCPU();
+			if (prgMap[0] != m_PRGMap[0]) {
+				m_PRGMap[0] = prgMap[0];
+				busCPU->switchBank(this, 2, m_PRGMap[0]);
+			}
+			if (PRGBankSize == 0x8000 && prgMap[1] != m_PRGMap[1]) {
+				m_PRGMap[1] = prgMap[1];
+				busCPU->switchBank(this, 3, m_PRGMap[1]);
+			}
+		}
+		if (CHRBankSize != 0 && chrMap != m_CHRMap) {
+			m_CHRMap = chrMap;
+			m_MotherBoard->getBusPPU()->switchBank(this, m_CHRBank, m_CHRMap);
+		}
+		if (MirroringControl) {
+			m_NameTable.setMirroring(
+			    getSingleScreen(), m_MotherBoard->getBusPPU(), this, 2);
+		}
+	}
+
+protected:
+	/**
+	 * Simulation routine
+	 */
+	void execute() {
+	}
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CDiscrete() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param motherBoard Motherboard
+	 * @param config NES config
+	 */
+	CDiscrete(CMotherBoard *motherBoard, const SNESConfig &config)
+	    : m_MotherBoard(motherBoard)
+	    , m_Image(config.Image)
+	    , m_PRG(config.PRG)
+	    , m_CHR(config.CHR)
+	    , m_CHRRAM()
+	    , m_RAM(config, 0x2000)
+	    , m_NameTable(
+	          MirroringControl ? MirroringSingleScreen1 : config.Mirroring)
+	    , m_CHRBank()
+	    , m_Latch()
+	    , m_PRGMap()
+	    , m_CHRMap() {
+		if (m_CHR.empty()) {
+			m_CHRRAM.assign(config.CHRRAMSize + config.CHRBatterySize, 0);
+			m_CHR = CROMSpan(m_CHRRAM.data(), m_CHRRAM.size());
+			m_CHRBank = 1;
+		}
+		std::size_t maxPRG = PRGBankSize ? 0x400000 : 0x8000;
+		std::size_t maxCHR = CHRBankSize ? 0x200000 : 0x2000;
+		if (m_PRG.size() < 0x4000 || m_PRG.size() > maxPRG ||
+		    (m_PRG.size() & (m_PRG.size() - 1)) || m_CHR.size() < 0x2000 ||
+		    m_CHR.size() > maxCHR || (m_CHR.size() & (m_CHR.size() - 1)) ||
+		    m_RAM.size() > 0x2000) {
+			throw std::invalid_argument("Invalid ROM parameters");
+		}
+		getMapping(m_PRGMap, &m_CHRMap);
+	}
+	/**
+	 * Destroys the object
+	 */
+	~CDiscrete() = default;
+
+	/**
+	 * Adds CPU hooks
+	 *
+	 * @param bus CPU bus
+	 */
+	void addHooksCPU(CBus *bus) {
+		bus->addWriteHook(0x8000, 0xffff, this, &CDiscrete::writeLatch);
+	}
+	/**
+	 * Adds PPU hooks
+	 *
+	 * @param bus PPU bus
+	 */
+	void addHooksPPU(CBus *bus) {
+	}
+
+	/**
+	 * Resets the clock
+	 *
+	 * Happens on frame end, when PRG RAM can be copied for the save file.
+	 *
+	 * @param ticks Amount of ticks
+	 */
+	void resetClock(ticks_t ticks) {
+		CEventDevice::resetClock(ticks);
+		m_RAM.handleFrameEnd();
+	}
+	/**
+	 * Gets pending time
+	 *
+	 * @return Pending time
+	 */
+	ticks_t getPending() const {
+		return 0;
+	}
+};
+
+/**
+ * UxROM (mapper 2): switchable 16 KB PRG ROM at 0x8000, bus conflicts
+ */
+typedef CDiscrete<true, 0x4000, 0, false> CUxROM;
+/**
+ * CNROM (mapper 3): switchable 8 KB CHR ROM, bus conflicts
+ */
+typedef CDiscrete<true, 0, 0x2000, false> CCNROM;
+/**
+ * AxROM (mapper 7): switchable 32 KB PRG ROM and single screen, ANROM and
+ * AOROM boards have no bus conflicts
+ */
+typedef CDiscrete<false, 0x8000, 0, true> CAxROM;
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_MAPPERS_DISCRETE_HPP_
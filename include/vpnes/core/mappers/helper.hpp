@@ -31,18 +31,27 @@
 #endif
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
+#include <ostream>
+#include <iostream>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/debugger.hpp>
 #include <vpnes/core/nes.hpp>
 #include <vpnes/core/device.hpp>
 #include <vpnes/core/bus.hpp>
 #include <vpnes/core/mboard.hpp>
+#include <vpnes/core/trace.hpp>
 #include <vpnes/core/cpu.hpp>
 #include <vpnes/core/ppu.hpp>
 #include <vpnes/core/apu.hpp>
+#include <vpnes/core/cputrace.hpp>
+#include <vpnes/core/disasm.hpp>
 
 namespace vpnes {
 
@@ -143,10 +152,30 @@ private:
 	 * Motherboard
 	 */
 	CMotherBoard *m_MotherBoard;
+	/**
+	 * CPU
+	 */
+	CCPU *m_CPU;
 	/**
 	 * Debug device
 	 */
 	CDebugDevice m_DebugDevice;
+	/**
+	 * Conditional breakpoints
+	 */
+	CBreakpoints m_Breakpoints;
+	/**
+	 * Instruction trace
+	 */
+	std::unique_ptr<CInstructionTrace> m_InstructionTrace;
+	/**
+	 * Disassembler
+	 */
+	CDisassembler m_Disassembler;
+	/**
+	 * Memory search
+	 */
+	CMemorySearch m_MemorySearch;
 
 public:
 	/**
@@ -157,9 +186,22 @@ public:
 	 * Constructor
 	 *
 	 * @param motherBoard Motherboard
+	 * @param cpu CPU
 	 */
-	explicit CDebuggerHelper(CMotherBoard *motherBoard)
-	    : m_MotherBoard(motherBoard), m_DebugDevice(motherBoard) {
+	CDebuggerHelper(CMotherBoard *motherBoard, CCPU *cpu)
+	    : m_MotherBoard(motherBoard)
+	    , m_CPU(cpu)
+	    , m_DebugDevice(motherBoard)
+	    , m_Breakpoints(this)
+	    , m_InstructionTrace()
+	    , m_Disassembler()
+	    , m_MemorySearch(this) {
+	}
+	/**
+	 * Destructor
+	 */
+	~CDebuggerHelper() {
+		stopInstructionTrace();
 	}
 
 	/**
@@ -198,6 +240,139 @@ public:
 	void directCPUWrite(std::uint16_t addr, std::uint8_t val) {
 		m_MotherBoard->getBusCPU()->writeMemory(val, addr, true);
 	}
+	/**
+	 * Gets bulk watchpoints and access counters for CPU bus
+	 *
+	 * @return CPU bus watch
+	 */
+	CBusWatch *getWatchCPU() {
+		return m_MotherBoard->getBusCPU()->getWatch();
+	}
+	/**
+	 * Gets conditional breakpoints on CPU bus
+	 *
+	 * @return Breakpoints
+	 */
+	CBreakpoints *getBreakpoints() {
+		return &m_Breakpoints;
+	}
+	/**
+	 * Gets CPU registers
+	 *
+	 * @return CPU registers
+	 */
+	SCPURegisters getCPURegisters() {
+		return {m_CPU->getA(), m_CPU->getX(), m_CPU->getY(), m_CPU->getS(),
+		    m_CPU->getP(), m_CPU->getPC()};
+	}
+	/**
+	 * Starts writing executed instructions to binary trace
+	 *
+	 * @param fileName Trace file
+	 */
+	void startInstructionTrace(const char *fileName) {
+		stopInstructionTrace();
+		m_InstructionTrace.reset(new CInstructionTrace(fileName));
+		m_CPU->setInstructionTrace(m_InstructionTrace.get());
+	}
+	/**
+	 * Stops and flushes instruction trace
+	 */
+	void stopInstructionTrace() {
+		m_CPU->setInstructionTrace(nullptr);
+		m_InstructionTrace.reset();
+	}
+	/**
+	 * Gets disassembler for CPU bus
+	 *
+	 * @return Disassembler
+	 */
+	CDisassembler *getDisassembler() {
+		return &m_Disassembler;
+	}
+	/**
+	 * Disassembles instruction on CPU bus
+	 *
+	 * @param addr Address
+	 * @return Instruction text
+	 */
+	const char *disassemble(std::uint16_t addr) {
+		return m_Disassembler.disassemble(addr,
+		    [this](std::uint16_t readAddr) { return directCPURead(readAddr); });
+	}
+	/**
+	 * Gets memory search
+	 *
+	 * @return Memory search
+	 */
+	CMemorySearch *getMemorySearch() {
+		return &m_MemorySearch;
+	}
+	/**
+	 * Adds cheat code
+	 *
+	 * @param code Game Genie or raw cheat code
+	 * @return Cheat identifier
+	 */
+	std::size_t addCheat(const std::string &code) {
+		SCheatCode cheat = decodeCheat(code);
+		return m_MotherBoard->getBusCPU()->addPatch(
+		    cheat.Address, cheat.Value, cheat.Compare);
+	}
+	/**
+	 * Removes cheat code
+	 *
+	 * @param id Cheat identifier
+	 */
+	void removeCheat(std::size_t id) {
+		m_MotherBoard->getBusCPU()->removePatch(id);
+	}
+	/**
+	 * Gets amount of master clock ticks since power up
+	 *
+	 * @return Elapsed ticks
+	 */
+	ticks_t getElapsedTicks() {
+		return m_MotherBoard->getElapsedTicks();
+	}
+	/**
+	 * Gets amount of master clock ticks per CPU cycle
+	 *
+	 * @return Ticks per CPU cycle
+	 */
+	ticks_t getCPUDivider() {
+		return m_CPU->getDivider();
+	}
+	/**
+	 * Gets profiling data for running devices
+	 *
+	 * @return Profiling data
+	 */
+	ProfileData getDeviceProfile() {
+		return m_MotherBoard->getDeviceProfile();
+	}
+	/**
+	 * Gets profiling data for events
+	 *
+	 * @return Profiling data
+	 */
+	ProfileData getEventProfile() {
+		return m_MotherBoard->getEventProfile();
+	}
+	/**
+	 * Prints hottest CPU addresses and loops
+	 *
+	 * @param out Output stream
+	 * @param count Number of entries in each list
+	 */
+	void dumpCodeProfile(std::ostream &out, std::size_t count) {
+#if defined(VPNES_PROFILE)
+		m_CPU->getCodeProfile().dump(
+		    out, count, getCPUDivider(), [this](std::uint16_t addr) {
+			    return directCPURead(addr);
+		    });
+#endif
+	}
 };
 
 /**
@@ -247,15 +422,29 @@ public:
 	    const SNESConfig &config, CFrontEnd *frontEnd, Devices *... devices)
 	    : CNES()
 	    , m_MotherBoard(frontEnd)
-	    , m_CPU(&m_MotherBoard)
+	    , m_CPU(&m_MotherBoard, Config::CPUDivider)
 	    , m_PPU(&m_MotherBoard, Config::getFrequency(), Config::FrameTime)
-	    , m_APU(&m_MotherBoard)
+	    , m_APU(&m_MotherBoard, &m_CPU, Config::getFrequency(),
+	          Config::FrameTime)
 	    , m_MMC(&m_MotherBoard, config)
-	    , m_Debugger(&m_MotherBoard) {
+	    , m_Debugger(&m_MotherBoard, &m_CPU) {
+#if defined(VPNES_TRACE)
+		if (!config.TraceFile.empty()) {
+			CTraceWriter::setFileName(config.TraceFile);
+		}
+#endif
 		m_MotherBoard.addBusCPU(&m_CPU, &m_APU, &m_PPU, &m_MMC, devices...);
 		m_MotherBoard.addBusPPU(&m_MMC, devices...);
 		m_MotherBoard.registerSimDevices(&m_CPU, &m_APU, &m_PPU, &m_MMC);
 	}
+	/**
+	 * Destroys the object
+	 */
+	~CNESHelper() {
+#if defined(VPNES_PROFILE)
+		m_Debugger.dumpCodeProfile(std::clog, 20);
+#endif
+	}
 	/**
 	 * Starts the simulation
 	 */
@@ -283,7 +472,12 @@ public:
  * NTSC NES settings
  */
 struct SConfigNTSC {
-	enum { FrameTime = 4 * 341 * 262 };  //!< Frame Time
+	enum {
+		DotTime = 4,                     //!< Ticks per PPU dot
+		ScanlineTime = 341 * DotTime,    //!< Scanline Time
+		FrameTime = 262 * ScanlineTime,  //!< Frame Time
+		CPUDivider = 12                  //!< Ticks per CPU cycle
+	};
 
 	/**
 	 * Bus frequency
@@ -298,6 +492,9 @@ struct SConfigNTSC {
 /**
  * Basic NES factory
  *
+ * Famicom, its clones and multi-region images run with NTSC timings. PAL and
+ * Dendy timings are not implemented, so such images are rejected.
+ *
  * @param config NES config
  * @param frontEnd Front-end
  * @param devices Additional devices
@@ -306,8 +503,37 @@ struct SConfigNTSC {
 template <class T, class... Devices>
 CNES *factoryNES(
     const SNESConfig &config, CFrontEnd *frontEnd, Devices *... devices) {
-	return new CNESHelper<SConfigNTSC, T, Devices...>(
-	    config, frontEnd, devices...);
+	switch (config.NESType) {
+	case NESTypePAL:
+	case NESTypeDendy:
+		throw std::invalid_argument("PAL and Dendy timings are not supported");
+	default:
+		return new CNESHelper<SConfigNTSC, T, Devices...>(
+		    config, frontEnd, devices...);
+	}
+}
+
+/**
+ * NES factory for mappers depending on timings
+ *
+ * The mapper is instantiated with the same timings config as the NES.
+ *
+ * @param config NES config
+ * @param frontEnd Front-end
+ * @param devices Additional devices
+ * @return NES
+ */
+template <template <class> class T, class... Devices>
+CNES *factoryNES(
+    const SNESConfig &config, CFrontEnd *frontEnd, Devices *... devices) {
+	switch (config.NESType) {
+	case NESTypePAL:
+	case NESTypeDendy:
+		throw std::invalid_argument("PAL and Dendy timings are not supported");
+	default:
+		return new CNESHelper<SConfigNTSC, T<SConfigNTSC>, Devices...>(
+		    config, frontEnd, devices...);
+	}
 }
 
 }  // namespace factory
@@ -0,0 +1,382 @@
+/**
+ * @file
+ *
+ * Defines MMC1 (SxROM)
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_MAPPERS_MMC1_HPP_
+#define INCLUDE_VPNES_CORE_MAPPERS_MMC1_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/bus.hpp>
+#include <vpnes/core/mboard.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/image.hpp>
+#include <vpnes/core/saveram.hpp>
+#include <vpnes/core/mappers/nametable.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * MMC1 mapper (SxROM)
+ *
+ * Registers are loaded through a 5-bit serial shift register. Every register
+ * change remaps only the affected bank windows on the buses, so reads and
+ * writes stay plain pointer accesses.
+ */
+class CMMC1 : public CEventDevice {
+public:
+	/**
+	 * CPU bus config
+	 */
+	struct CPUConfig : BusConfigBase<CMMC1> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::BankConfig<banks::OpenBus,
+		    banks::ReadWrite<0x6000, 0x2000,
+		        0x2000>,  // PRG RAM 0x6000 - 0x7fff
+		    banks::ReadOnly<0x8000, 0x4000,
+		        0x4000>,  // PRG ROM 0x8000 - 0xbfff
+		    banks::ReadOnly<0xc000, 0x4000,
+		        0x4000>>  // PRG ROM 0xc000 - 0xffff
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CMMC1 *device) {
+			BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
+			    writeBuf, nullptr, device->m_RAMMap, device->m_PRGMap[0],
+			    device->m_PRGMap[1]);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			return addr >= 0x6000;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(std::uint16_t addr, const CMMC1 &device) {
+			if (addr < 0x8000) {
+				return device.m_RAMEnabled ? 1 : 0;
+			}
+			return 2 + ((addr >> 14) & 1);
+		}
+	};
+	/**
+	 * PPU bus config
+	 */
+	struct PPUConfig : BusConfigBase<CMMC1> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::NameTableConfig<
+		    banks::ReadOnly<0x0000, 0x1000, 0x1000>,   // CHR ROM 0x0000 - 0x0fff
+		    banks::ReadOnly<0x1000, 0x1000, 0x1000>,   // CHR ROM 0x1000 - 0x1fff
+		    banks::ReadWrite<0x0000, 0x1000, 0x1000>,  // CHR RAM 0x0000 - 0x0fff
+		    banks::ReadWrite<0x1000, 0x1000, 0x1000>>  // CHR RAM 0x1000 - 0x1fff
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CMMC1 *device) {
+			device->m_NameTable.mapIO<BankConfig>(iterRead, iterWrite, iterMod,
+			    openBus, dummy, writeBuf, device->m_CHRMap[0],
+			    device->m_CHRMap[1], device->m_CHRMap[0], device->m_CHRMap[1]);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			// This will override PPU palette access to the bus
+			// which is not needed since it has different access point
+			return true;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(std::uint16_t addr, const CMMC1 &device) {
+			if (addr < 0x2000) {
+				return device.m_CHRBank + (addr >> 12);
+			} else {
+				return 4 + CNameTable::getWindow(addr);
+			}
+		}
+	};
+
+private:
+	/**
+	 * Master clock ticks in CPU cycle
+	 */
+	enum { CPUCycle = 12 };
+	/**
+	 * Control register bits
+	 */
+	enum {
+		ControlMirroring = 0x03,  //!< Mirroring
+		ControlPRGMode = 0x0c,    //!< PRG ROM bank mode
+		ControlCHRMode = 0x10     //!< CHR 4 KB mode
+	};
+
+	/**
+	 * Motherboard
+	 */
+	CMotherBoard *m_MotherBoard;
+	/**
+	 * ROM image
+	 */
+	std::shared_ptr<CROMImage> m_Image;
+	/**
+	 * PRG ROM
+	 */
+	CROMSpan m_PRG;
+	/**
+	 * CHR ROM / CHR RAM
+	 */
+	CROMSpan m_CHR;
+	/**
+	 * CHR RAM
+	 */
+	std::vector<std::uint8_t> m_CHRRAM;
+	/**
+	 * PRG RAM
+	 */
+	CSaveRAM m_RAM;
+	/**
+	 * Nametable
+	 */
+	CNameTable m_NameTable;
+	/**
+	 * First CHR bank in PPU bank config (0 for ROM, 2 for RAM)
+	 */
+	std::size_t m_CHRBank;
+	/**
+	 * Shift register
+	 */
+	std::uint8_t m_Shift;
+	/**
+	 * Number of bits in shift register
+	 */
+	int m_ShiftCount;
+	/**
+	 * Time of last register write
+	 */
+	ticks_t m_LastWrite;
+	/**
+	 * Control register
+	 */
+	std::uint8_t m_Control;
+	/**
+	 * CHR bank 0 register
+	 */
+	std::uint8_t m_CHRReg0;
+	/**
+	 * CHR bank 1 register
+	 */
+	std::uint8_t m_CHRReg1;
+	/**
+	 * PRG bank register
+	 */
+	std::uint8_t m_PRGReg;
+	/**
+	 * PRG RAM is enabled
+	 */
+	bool m_RAMEnabled;
+	/**
+	 * Mapped PRG RAM bank
+	 */
+	std::uint8_t *m_RAMMap;
+	/**
+	 * Mapped PRG ROM banks
+	 */
+	std::uint8_t *m_PRGMap[2];
+	/**
+	 * Mapped CHR banks
+	 */
+	std::uint8_t *m_CHRMap[2];
+
+	/**
+	 * Gets PRG ROM bank
+	 *
+	 * ROM is only mapped to read maps, so it is never written.
+	 *
+	 * @param bank 16 KB bank number
+	 * @return PRG ROM bank
+	 */
+	std::uint8_t *getPRG(std::size_t bank) {
+		return const_cast<std::uint8_t *>(m_PRG.data()) +
+		       ((bank * 0x4000) & (m_PRG.size() - 1));
+	}
+	/**
+	 * Gets CHR bank
+	 *
+	 * CHR ROM is only written through CHR RAM banks, which are never active
+	 * for it.
+	 *
+	 * @param bank 4 KB bank number
+	 * @return CHR ROM / CHR RAM bank
+	 */
+	std::uint8_t *getCHR(std::size_t bank) {
+		return const_cast<std::uint8_t *>(m_CHR.data()) +
+		       ((bank * 0x1000) & (m_CHR.size() - 1));
+	}
+	/**
+	 * Calculates mapping from registers
+	 *
+	 * @param ramMap PRG RAM bank
+	 * @param prgMap PRG ROM banks
+	 * @param chrMap CHR banks
+	 * @param mirroring Mirroring
+	 */
+	void getMapping(std::uint8_t **ramMap, std::uint8_t **prgMap,
+	    std::uint8_t **chrMap, EMirroring *mirroring);
+	/**
+	 * Writes MMC1 register
+	 *
+	 * @param val Value
+	 * @param addr Address
+	 */
+	void writeReg(std::uint8_t val, std::uint16_t addr);
+	/**
+	 * Remaps bank windows changed by the registers
+	 */
+	void updateMapping();
+
+protected:
+	/**
+	 * Simulation routine
+	 */
+	void execute() {
+	}
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CMMC1() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param motherBoard Motherboard
+	 * @param config NES config
+	 */
+	CMMC1(CMotherBoard *motherBoard, const SNESConfig &config);
+	/**
+	 * Destroys the object
+	 */
+	~CMMC1() = default;
+
+	/**
+	 * Adds CPU hooks
+	 *
+	 * @param bus CPU bus
+	 */
+	void addHooksCPU(CBus *bus) {
+		for (std::uint32_t addr = 0x8000; addr < 0x10000; addr++) {
+			bus->addWriteHook(addr, this, &CMMC1::writeReg);
+		}
+	}
+	/**
+	 * Adds PPU hooks
+	 *
+	 * @param bus PPU bus
+	 */
+	void addHooksPPU(CBus *bus) {
+	}
+
+	/**
+	 * Resets the clock
+	 *
+	 * Happens on frame end, when PRG RAM can be copied for the save file.
+	 *
+	 * @param ticks Amount of ticks
+	 */
+	void resetClock(ticks_t ticks) {
+		CEventDevice::resetClock(ticks);
+		m_RAM.handleFrameEnd();
+	}
+	/**
+	 * Gets pending time
+	 *
+	 * @return Pending time
+	 */
+	ticks_t getPending() const {
+		return 0;
+	}
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_MAPPERS_MMC1_HPP_
@@ -0,0 +1,473 @@
+/**
+ * @file
+ *
+ * Defines MMC3 (TxROM)
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_MAPPERS_MMC3_HPP_
+#define INCLUDE_VPNES_CORE_MAPPERS_MMC3_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/bus.hpp>
+#include <vpnes/core/mboard.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/image.hpp>
+#include <vpnes/core/saveram.hpp>
+#include <vpnes/core/mappers/nametable.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * MMC3 mapper (TxROM)
+ *
+ * The scanline counter is clocked by PPU A12 rises. Instead of watching
+ * PPU bus accesses the rises are predicted from PPU pattern table and
+ * rendering settings, the counter is advanced lazily and the IRQ is
+ * scheduled as a motherboard event at the rise that reaches zero. Rise times
+ * follow PPU timings of the NES config.
+ */
+template <class Config>
+class CMMC3 : public CEventDevice {
+public:
+	/**
+	 * CPU bus config
+	 */
+	struct CPUConfig : BusConfigBase<CMMC3> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::BankConfig<banks::OpenBus,
+		    banks::ReadWrite<0x6000, 0x2000,
+		        0x2000>,  // PRG RAM 0x6000 - 0x7fff
+		    banks::ReadOnly<0x6000, 0x2000,
+		        0x2000>,  // Write protected PRG RAM 0x6000 - 0x7fff
+		    banks::ReadOnly<0x8000, 0x2000,
+		        0x2000>,  // PRG ROM 0x8000 - 0x9fff
+		    banks::ReadOnly<0xa000, 0x2000,
+		        0x2000>,  // PRG ROM 0xa000 - 0xbfff
+		    banks::ReadOnly<0xc000, 0x2000,
+		        0x2000>,  // PRG ROM 0xc000 - 0xdfff
+		    banks::ReadOnly<0xe000, 0x2000,
+		        0x2000>>  // PRG ROM 0xe000 - 0xffff
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CMMC3 *device) {
+			BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
+			    writeBuf, nullptr, device->m_RAM.data(), device->m_RAM.data(),
+			    device->m_PRGMap[0], device->m_PRGMap[1], device->m_PRGMap[2],
+			    device->m_PRGMap[3]);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			return addr >= 0x6000;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(std::uint16_t addr, const CMMC3 &device) {
+			if (addr < 0x8000) {
+				if (device.m_RAM.empty() || !(device.m_RAMProtect & 0x80)) {
+					return 0;
+				}
+				return (device.m_RAMProtect & 0x40) ? 2 : 1;
+			}
+			return 3 + ((addr >> 13) & 3);
+		}
+	};
+	/**
+	 * PPU bus config
+	 */
+	struct PPUConfig : BusConfigBase<CMMC3> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::NameTableConfig<
+		    banks::ReadOnly<0x0000, 0x0400, 0x0400>,   // CHR ROM 0x0000 - 0x03ff
+		    banks::ReadOnly<0x0400, 0x0400, 0x0400>,   // CHR ROM 0x0400 - 0x07ff
+		    banks::ReadOnly<0x0800, 0x0400, 0x0400>,   // CHR ROM 0x0800 - 0x0bff
+		    banks::ReadOnly<0x0c00, 0x0400, 0x0400>,   // CHR ROM 0x0c00 - 0x0fff
+		    banks::ReadOnly<0x1000, 0x0400, 0x0400>,   // CHR ROM 0x1000 - 0x13ff
+		    banks::ReadOnly<0x1400, 0x0400, 0x0400>,   // CHR ROM 0x1400 - 0x17ff
+		    banks::ReadOnly<0x1800, 0x0400, 0x0400>,   // CHR ROM 0x1800 - 0x1bff
+		    banks::ReadOnly<0x1c00, 0x0400, 0x0400>,   // CHR ROM 0x1c00 - 0x1fff
+		    banks::ReadWrite<0x0000, 0x0400, 0x0400>,  // CHR RAM 0x0000 - 0x03ff
+		    banks::ReadWrite<0x0400, 0x0400, 0x0400>,  // CHR RAM 0x0400 - 0x07ff
+		    banks::ReadWrite<0x0800, 0x0400, 0x0400>,  // CHR RAM 0x0800 - 0x0bff
+		    banks::ReadWrite<0x0c00, 0x0400, 0x0400>,  // CHR RAM 0x0c00 - 0x0fff
+		    banks::ReadWrite<0x1000, 0x0400, 0x0400>,  // CHR RAM 0x1000 - 0x13ff
+		    banks::ReadWrite<0x1400, 0x0400, 0x0400>,  // CHR RAM 0x1400 - 0x17ff
+		    banks::ReadWrite<0x1800, 0x0400, 0x0400>,  // CHR RAM 0x1800 - 0x1bff
+		    banks::ReadWrite<0x1c00, 0x0400, 0x0400>>  // CHR RAM 0x1c00 - 0x1fff
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CMMC3 *device) {
+			std::uint8_t **chr = device->m_CHRMap;
+			device->m_NameTable.mapIO<BankConfig>(iterRead, iterWrite, iterMod,
+			    openBus, dummy, writeBuf, chr[0], chr[1], chr[2], chr[3],
+			    chr[4], chr[5], chr[6], chr[7], chr[0], chr[1], chr[2], chr[3],
+			    chr[4], chr[5], chr[6], chr[7]);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			// This will override PPU palette access to the bus
+			// which is not needed since it has different access point
+			return true;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(std::uint16_t addr, const CMMC3 &device) {
+			if (addr < 0x2000) {
+				return device.m_CHRBank + (addr >> 10);
+			} else {
+				return 16 + CNameTable::getWindow(addr);
+			}
+		}
+	};
+
+private:
+	/**
+	 * PPU timings in master clock ticks
+	 */
+	enum {
+		DotTime = Config::DotTime,                 //!< PPU dot
+		ScanlineTime = Config::ScanlineTime,       //!< Scanline
+		FrameTime = Config::FrameTime,             //!< Frame
+		PreRenderTime = FrameTime - ScanlineTime,  //!< Start of pre-render line
+		VisibleLines = 240,                        //!< Visible scanlines
+		RisesPerFrame = VisibleLines + 1           //!< Counter clocks per frame
+	};
+
+	/**
+	 * Motherboard
+	 */
+	CMotherBoard *m_MotherBoard;
+	/**
+	 * ROM image
+	 */
+	std::shared_ptr<CROMImage> m_Image;
+	/**
+	 * PRG ROM
+	 */
+	CROMSpan m_PRG;
+	/**
+	 * CHR ROM / CHR RAM
+	 */
+	CROMSpan m_CHR;
+	/**
+	 * CHR RAM
+	 */
+	std::vector<std::uint8_t> m_CHRRAM;
+	/**
+	 * PRG RAM
+	 */
+	CSaveRAM m_RAM;
+	/**
+	 * Nametable
+	 */
+	CNameTable m_NameTable;
+	/**
+	 * First CHR bank in PPU bank config (0 for ROM, 8 for RAM)
+	 */
+	std::size_t m_CHRBank;
+	/**
+	 * Bank select register
+	 */
+	std::uint8_t m_BankSelect;
+	/**
+	 * Bank registers
+	 */
+	std::uint8_t m_Banks[8];
+	/**
+	 * Mirroring register
+	 */
+	std::uint8_t m_Mirroring;
+	/**
+	 * PRG RAM protect register
+	 */
+	std::uint8_t m_RAMProtect;
+	/**
+	 * Mapped PRG ROM banks
+	 */
+	std::uint8_t *m_PRGMap[4];
+	/**
+	 * Mapped CHR banks
+	 */
+	std::uint8_t *m_CHRMap[8];
+	/**
+	 * IRQ latch
+	 */
+	std::uint8_t m_IRQLatch;
+	/**
+	 * IRQ counter
+	 */
+	std::uint8_t m_IRQCounter;
+	/**
+	 * Counter is reloaded on next clock
+	 */
+	bool m_IRQReload;
+	/**
+	 * IRQ is enabled
+	 */
+	bool m_IRQEnabled;
+	/**
+	 * Time the counter is valid for
+	 */
+	ticks_t m_IRQTime;
+	/**
+	 * Shadow of PPU control register
+	 */
+	std::uint8_t m_PPUControl;
+	/**
+	 * Shadow of PPU mask register
+	 */
+	std::uint8_t m_PPUMask;
+	/**
+	 * IRQ event
+	 */
+	CMotherBoard::CEvent *m_IRQEvent;
+
+	/**
+	 * Gets PRG ROM bank
+	 *
+	 * ROM is only mapped to read maps, so it is never written.
+	 *
+	 * @param bank 8 KB bank number
+	 * @return PRG ROM bank
+	 */
+	std::uint8_t *getPRG(std::size_t bank) {
+		return const_cast<std::uint8_t *>(m_PRG.data()) +
+		       ((bank * 0x2000) & (m_PRG.size() - 1));
+	}
+	/**
+	 * Gets CHR bank
+	 *
+	 * CHR ROM is only written through CHR RAM banks, which are never active
+	 * for it.
+	 *
+	 * @param bank 1 KB bank number
+	 * @return CHR ROM / CHR RAM bank
+	 */
+	std::uint8_t *getCHR(std::size_t bank) {
+		return const_cast<std::uint8_t *>(m_CHR.data()) +
+		       ((bank * 0x0400) & (m_CHR.size() - 1));
+	}
+	/**
+	 * Calculates mapping from registers
+	 *
+	 * @param prgMap PRG ROM banks
+	 * @param chrMap CHR banks
+	 * @param mirroring Mirroring
+	 */
+	void getMapping(
+	    std::uint8_t **prgMap, std::uint8_t **chrMap, EMirroring *mirroring);
+	/**
+	 * Remaps bank windows changed by the registers
+	 */
+	void updateMapping();
+	/**
+	 * Writes MMC3 register
+	 *
+	 * @param val Value
+	 * @param addr Address
+	 */
+	void writeReg(std::uint8_t val, std::uint16_t addr);
+	/**
+	 * Tracks PPU control and mask registers
+	 *
+	 * @param val Value
+	 * @param addr Address
+	 */
+	void writePPUReg(std::uint8_t val, std::uint16_t addr);
+	/**
+	 * Gets time of A12 rise in scanline
+	 *
+	 * @return Offset in scanline or negative if counter is not clocked
+	 */
+	ticks_t getRiseOffset() const;
+	/**
+	 * Counts A12 rises since power up
+	 *
+	 * @param time Elapsed ticks
+	 * @param offset Offset of rise in scanline
+	 * @return Amount of rises at or before the time
+	 */
+	static ticks_t countRises(ticks_t time, ticks_t offset);
+	/**
+	 * Gets time of A12 rise
+	 *
+	 * @param rise Rise number since power up (from 1)
+	 * @param offset Offset of rise in scanline
+	 * @return Elapsed ticks
+	 */
+	static ticks_t getRiseTime(ticks_t rise, ticks_t offset);
+	/**
+	 * Clocks the counter
+	 *
+	 * @param clocks Amount of clocks
+	 * @return True if the counter became zero on any clock
+	 */
+	bool clockCounter(ticks_t clocks);
+	/**
+	 * Advances the counter to current time
+	 */
+	void syncCounter();
+	/**
+	 * Schedules IRQ event at the rise that reaches zero
+	 */
+	void scheduleIRQ();
+	/**
+	 * Handles IRQ event
+	 *
+	 * @param event Event
+	 */
+	void handleIRQ(CMotherBoard::CEvent *event);
+
+protected:
+	/**
+	 * Simulation routine
+	 */
+	void execute() {
+	}
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CMMC3() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param motherBoard Motherboard
+	 * @param config NES config
+	 */
+	CMMC3(CMotherBoard *motherBoard, const SNESConfig &config);
+	/**
+	 * Destroys the object
+	 */
+	~CMMC3() = default;
+
+	/**
+	 * Adds CPU hooks
+	 *
+	 * @param bus CPU bus
+	 */
+	void addHooksCPU(CBus *bus) {
+		for (std::uint32_t addr = 0x2000; addr < 0x4000; addr += 8) {
+			bus->addWriteHook(addr, this, &CMMC3::writePPUReg);
+			bus->addWriteHook(addr + 1, this, &CMMC3::writePPUReg);
+		}
+		for (std::uint32_t addr = 0x8000; addr < 0x10000; addr++) {
+			bus->addWriteHook(addr, this, &CMMC3::writeReg);
+		}
+	}
+	/**
+	 * Adds PPU hooks
+	 *
+	 * @param bus PPU bus
+	 */
+	void addHooksPPU(CBus *bus) {
+	}
+
+	/**
+	 * Resets the clock
+	 *
+	 * Happens on frame end, when PRG RAM can be copied for the save file.
+	 *
+	 * @param ticks Amount of ticks
+	 */
+	void resetClock(ticks_t ticks) {
+		CEventDevice::resetClock(ticks);
+		m_RAM.handleFrameEnd();
+	}
+	/**
+	 * Gets pending time
+	 *
+	 * @return Pending time
+	 */
+	ticks_t getPending() const {
+		return 0;
+	}
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_MAPPERS_MMC3_HPP_
@@ -0,0 +1,206 @@
+/**
+ * @file
+ *
+ * Defines nametable mirroring
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_MAPPERS_NAMETABLE_HPP_
+#define INCLUDE_VPNES_CORE_MAPPERS_NAMETABLE_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/bus.hpp>
+#include <vpnes/core/config.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace banks {
+
+/**
+ * Bank config followed by nametable windows 0x2000 - 0x3fff
+ */
+template <class... Banks>
+using NameTableConfig = BankConfig<Banks...,
+    ReadWrite<0x2000, 0x0400, 0x0400>,  // NameTable 1 0x2000 - 0x23ff
+    ReadWrite<0x2400, 0x0400, 0x0400>,  // NameTable 2 0x2400 - 0x27ff
+    ReadWrite<0x2800, 0x0400, 0x0400>,  // NameTable 3 0x2800 - 0x2bff
+    ReadWrite<0x2c00, 0x0400, 0x0400>,  // NameTable 4 0x2c00 - 0x2fff
+    ReadWrite<0x3000, 0x0400, 0x0400>,  // NameTable 1 0x3000 - 0x33ff
+    ReadWrite<0x3400, 0x0400, 0x0400>,  // NameTable 2 0x3400 - 0x37ff
+    ReadWrite<0x3800, 0x0400, 0x0400>,  // NameTable 3 0x3800 - 0x3bff
+    ReadWrite<0x3c00, 0x0400, 0x0400>>;  // NameTable 4 0x3c00 - 0x3fff
+
+}  // namespace banks
+
+/**
+ * Nametable memory and mirroring
+ *
+ * Mirroring only decides which buffer each of the 8 nametable windows of
+ * banks::NameTableConfig points to, so a mirroring change rewrites the
+ * windows once and accesses stay plain pointer reads.
+ */
+class CNameTable {
+public:
+	enum {
+		WindowCount = 8  //!< Nametable windows in 0x2000 - 0x3fff
+	};
+
+private:
+	/**
+	 * Nametable memory (4 KB only for four screens)
+	 */
+	std::vector<std::uint8_t> m_Memory;
+	/**
+	 * Current mirroring
+	 */
+	EMirroring m_Mirroring;
+	/**
+	 * Mapped windows
+	 */
+	std::uint8_t *m_Map[WindowCount];
+
+	/**
+	 * Calculates windows for mirroring
+	 *
+	 * @param mirroring Mirroring
+	 * @param map Windows
+	 */
+	void getMapping(EMirroring mirroring, std::uint8_t **map) {
+		// 1 KB page of each logical nametable
+		static const std::uint8_t pages[][4] = {
+		    {0, 0, 1, 1},  // MirroringHorizontal
+		    {0, 1, 0, 1},  // MirroringVertical
+		    {0, 0, 0, 0},  // MirroringSingleScreen1
+		    {1, 1, 1, 1},  // MirroringSingleScreen2
+		    {0, 1, 2, 3}   // MirroringFourScreens
+		};
+		assert(mirroring != MirroringFourScreens || m_Memory.size() == 0x1000);
+		for (std::size_t i = 0; i < WindowCount; i++) {
+			map[i] = m_Memory.data() + pages[mirroring][i & 3] * 0x0400;
+		}
+	}
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CNameTable() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param mirroring Initial mirroring
+	 */
+	explicit CNameTable(EMirroring mirroring)
+	    : m_Memory(mirroring == MirroringFourScreens ? 0x1000 : 0x0800)
+	    , m_Mirroring(mirroring)
+	    , m_Map() {
+		getMapping(m_Mirroring, m_Map);
+	}
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CNameTable(const CNameTable &s) = delete;
+	/**
+	 * Destroys the object
+	 */
+	~CNameTable() = default;
+
+	/**
+	 * Gets current mirroring
+	 *
+	 * @return Mirroring
+	 */
+	EMirroring getMirroring() const {
+		return m_Mirroring;
+	}
+	/**
+	 * Checks if four screen memory is present
+	 *
+	 * @return True if four screen memory is present
+	 */
+	bool hasFourScreens() const {
+		return m_Memory.size() == 0x1000;
+	}
+	/**
+	 * Maps IO for a bank config ending with nametable windows
+	 *
+	 * @param iterRead Read iterator
+	 * @param iterWrite Write iterator
+	 * @param iterMod Mod iterator
+	 * @param openBus Open bus
+	 * @param dummy Dummy write
+	 * @param writeBuf Write bus
+	 * @param bufs Buffers of banks before nametables
+	 */
+	template <class BankConfig, typename... Buffers>
+	void mapIO(MemoryMap::iterator iterRead, MemoryMap::iterator iterWrite,
+	    MemoryMap::iterator iterMod, std::uint8_t *openBus, std::uint8_t *dummy,
+	    std::uint8_t *writeBuf, Buffers... bufs) const {
+		BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
+		    writeBuf, bufs..., m_Map[0], m_Map[1], m_Map[2], m_Map[3],
+		    m_Map[4], m_Map[5], m_Map[6], m_Map[7]);
+	}
+	/**
+	 * Changes mirroring at runtime
+	 *
+	 * @param mirroring New mirroring
+	 * @param bus PPU bus
+	 * @param device Device owning nametable windows
+	 * @param firstBank Bank number of the first nametable window
+	 */
+	void setMirroring(EMirroring mirroring, CBus *bus, CDevice *device,
+	    std::size_t firstBank) {
+		if (mirroring == m_Mirroring) {
+			return;
+		}
+		m_Mirroring = mirroring;
+		getMapping(m_Mirroring, m_Map);
+		bus->switchBanks(device, firstBank, m_Map, WindowCount);
+	}
+	/**
+	 * Gets window for address
+	 *
+	 * @param addr Address
+	 * @return Window number
+	 */
+	static std::size_t getWindow(std::uint16_t addr) {
+		return (addr >> 10) & (WindowCount - 1);
+	}
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_MAPPERS_NAMETABLE_HPP_
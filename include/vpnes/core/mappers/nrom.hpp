@@ -30,15 +30,18 @@
 #include "config.h"
 #endif
 
-#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/device.hpp>
 #include <vpnes/core/bus.hpp>
 #include <vpnes/core/mboard.hpp>
 #include <vpnes/core/config.hpp>
+#include <vpnes/core/image.hpp>
+#include <vpnes/core/saveram.hpp>
+#include <vpnes/core/mappers/nametable.hpp>
 
 namespace vpnes {
 
@@ -59,11 +62,11 @@ public:
 		typedef banks::BankConfig<banks::OpenBus,
 		    banks::ReadWrite<0x6000, 0x0800,
 		        0x0800>,  // PRG RAM 0x6000 - 0x67ff
-		    banks::ReadWrite<0x6200, 0x0800,
+		    banks::ReadWrite<0x6800, 0x0800,
 		        0x0800>,  // PRG RAM 0x6800 - 0x6fff
-		    banks::ReadWrite<0x6000, 0x0800,
+		    banks::ReadWrite<0x7000, 0x0800,
 		        0x0800>,  // PRG RAM 0x7000 - 0x77ff
-		    banks::ReadWrite<0x6000, 0x0800,
+		    banks::ReadWrite<0x7800, 0x0800,
 		        0x0800>,  // PRG RAM 0x7800 - 0x7fff
 		    banks::ReadOnlyWithConflict<0x8000, 0x4000,
 		        0x4000>,  // PRG ROM 0x8000 - 0xbfff
@@ -91,8 +94,8 @@ public:
 			    device->m_RAM.data() + (0x0800 & (device->m_RAM.size() - 1)),
 			    device->m_RAM.data() + (0x1000 & (device->m_RAM.size() - 1)),
 			    device->m_RAM.data() + (0x1800 & (device->m_RAM.size() - 1)),
-			    device->m_PRG.data(),
-			    device->m_PRG.data() + (0x4000 & (device->m_PRG.size() - 1)));
+			    device->getPRG(),
+			    device->getPRG() + (0x4000 & (device->m_PRG.size() - 1)));
 		}
 		/**
 		 * Checks if device is enabled
@@ -101,7 +104,7 @@ public:
 		 * @return True if enabled
 		 */
 		static bool isDeviceEnabled(std::uint16_t addr) {
-			return (addr > 0x6000);
+			return addr >= 0x6000;
 		}
 		/**
 		 * Determines active bank
@@ -130,26 +133,11 @@ public:
 		/**
 		 * Banks config
 		 */
-		typedef banks::BankConfig<banks::ReadOnlyWithConflict<0x0000, 0x2000,
-		                              0x2000>,  // CHR ROM 0x0000 - 0x1fff
+		typedef banks::NameTableConfig<
+		    banks::ReadOnlyWithConflict<0x0000, 0x2000,
+		        0x2000>,  // CHR ROM 0x0000 - 0x1fff
 		    banks::ReadWrite<0x0000, 0x2000,
-		        0x2000>,  // CHR RAM 0x0000 - 0x1fff
-		    banks::ReadWrite<0x2000, 0x0400,
-		        0x0400>,  // NameTable 1 0x2000 - 0x23ff
-		    banks::ReadWrite<0x2000, 0x0400,
-		        0x0400>,  // NameTable 2 0x2400 - 0x27ff
-		    banks::ReadWrite<0x2000, 0x0400,
-		        0x0400>,  // NameTable 3 0x2800 - 0x2bff
-		    banks::ReadWrite<0x2000, 0x0400,
-		        0x0400>,  // NameTable 4 0x2c00 - 0x3000
-		    banks::ReadWrite<0x2000, 0x0400,
-		        0x0400>,  // NameTable 1 0x3000 - 0x33ff
-		    banks::ReadWrite<0x2000, 0x0400,
-		        0x0400>,  // NameTable 2 0x3400 - 0x37ff
-		    banks::ReadWrite<0x2000, 0x0400,
-		        0x0400>,  // NameTable 3 0x3800 - 0x3bff
-		    banks::ReadWrite<0x2000, 0x0400, 0x0400>>  // NameTable 4 0x3c00 -
-		                                               // 0x3000
+		        0x2000>>  // CHR RAM 0x0000 - 0x1fff
 		    BankConfig;
 
 		/**
@@ -167,26 +155,8 @@ public:
 		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
 		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
 		    CNROM *device) {
-			switch (device->m_Mirroring) {
-			case MirroringHorizontal:
-				BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
-				    writeBuf, device->m_CHR.data(), device->m_CHR.data(),
-				    device->m_NameTable, device->m_NameTable + 0x0400,
-				    device->m_NameTable, device->m_NameTable + 0x0400,
-				    device->m_NameTable, device->m_NameTable + 0x0400,
-				    device->m_NameTable, device->m_NameTable + 0x0400);
-				break;
-			case MirroringVertical:
-				BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
-				    writeBuf, device->m_CHR.data(), device->m_CHR.data(),
-				    device->m_NameTable, device->m_NameTable,
-				    device->m_NameTable + 0x0400, device->m_NameTable + 0x0400,
-				    device->m_NameTable, device->m_NameTable,
-				    device->m_NameTable + 0x0400, device->m_NameTable + 0x0400);
-				break;
-			default:
-				assert(false);
-			}
+			device->m_NameTable.mapIO<BankConfig>(iterRead, iterWrite, iterMod,
+			    openBus, dummy, writeBuf, device->getCHR(), device->getCHR());
 		}
 		/**
 		 * Checks if device is enabled
@@ -210,37 +180,63 @@ public:
 			if (addr < 0x2000) {
 				return device.m_CHRBank;
 			} else {
-				return 1 + ((addr >> 10) & 7);
+				return 2 + CNameTable::getWindow(addr);
 			}
 		}
 	};
 
 private:
+	/**
+	 * ROM image
+	 */
+	std::shared_ptr<CROMImage> m_Image;
 	/**
 	 * PRG ROM
 	 */
-	std::vector<std::uint8_t> m_PRG;
+	CROMSpan m_PRG;
 	/**
 	 * CHR ROM / CHR RAM
 	 */
-	std::vector<std::uint8_t> m_CHR;
+	CROMSpan m_CHR;
 	/**
-	 * PRG RAM
+	 * CHR RAM
 	 */
-	std::vector<std::uint8_t> m_RAM;
+	std::vector<std::uint8_t> m_CHRRAM;
 	/**
-	 * Mirroring
+	 * PRG RAM
 	 */
-	EMirroring m_Mirroring;
+	CSaveRAM m_RAM;
 	/**
 	 * Nametable
 	 */
-	std::uint8_t m_NameTable[0x0800];
+	CNameTable m_NameTable;
 	/**
 	 * CHR Bank
 	 */
 	std::size_t m_CHRBank;
 
+	/**
+	 * Gets PRG ROM for mapping
+	 *
+	 * ROM is only mapped to read and conflict maps, so it is never written.
+	 *
+	 * @return PRG ROM
+	 */
+	std::uint8_t *getPRG() {
+		return const_cast<std::uint8_t *>(m_PRG.data());
+	}
+	/**
+	 * Gets CHR ROM / CHR RAM for mapping
+	 *
+	 * CHR ROM is only written through CHR RAM bank, which is never active
+	 * for it.
+	 *
+	 * @return CHR ROM / CHR RAM
+	 */
+	std::uint8_t *getCHR() {
+		return const_cast<std::uint8_t *>(m_CHR.data());
+	}
+
 protected:
 	/**
 	 * Simulation routine
@@ -280,6 +276,17 @@ public:
 	void addHooksPPU(CBus *bus) {
 	}
 
+	/**
+	 * Resets the clock
+	 *
+	 * Happens on frame end, when PRG RAM can be copied for the save file.
+	 *
+	 * @param ticks Amount of ticks
+	 */
+	void resetClock(ticks_t ticks) {
+		CEventDevice::resetClock(ticks);
+		m_RAM.handleFrameEnd();
+	}
 	/**
 	 * Gets pending time
 	 *
@@ -34,10 +34,14 @@
 #include <cstdint>
 #include <utility>
 #include <type_traits>
+#include <typeinfo>
 #include <memory>
 #include <vector>
+#include <iostream>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/frontend.hpp>
+#include <vpnes/core/profiler.hpp>
+#include <vpnes/core/trace.hpp>
 #include <vpnes/core/device.hpp>
 #include <vpnes/core/bus.hpp>
 
@@ -49,6 +53,16 @@ namespace core {
  * Basic motherboard
  */
 class CMotherBoard : public CGeneratorDevice, public CEventManager {
+public:
+	/**
+	 * IRQ sources
+	 */
+	enum EIRQSource {
+		IRQMMC = 0x01,    //!< Cartridge mapper
+		IRQFrame = 0x02,  //!< APU frame counter
+		IRQDMC = 0x04     //!< APU DMC
+	};
+
 private:
 	/**
 	 * Devices that can be run
@@ -70,6 +84,26 @@ private:
 	 * Front-end
 	 */
 	CFrontEnd *m_FrontEnd;
+	/**
+	 * Ticks elapsed before the current clock base
+	 */
+	ticks_t m_ElapsedTicks;
+	/**
+	 * Active IRQ sources
+	 */
+	int m_IRQ;
+#if defined(VPNES_PROFILE)
+	/**
+	 * Profiling counters for devices
+	 */
+	ProfileData m_Profile;
+#endif
+#if defined(VPNES_TRACE)
+	/**
+	 * Device names for trace
+	 */
+	std::vector<const char *> m_TraceNames;
+#endif
 
 	/**
 	 * Adds hooks for PPU bus
@@ -107,20 +141,51 @@ private:
 protected:
 	/**
 	 * Executes the simulation
+	 *
+	 * Device ticks are counted from elapsed time, since the frame end resets
+	 * the clock base while a device is simulated.
 	 */
 	void execute() {
+#if defined(VPNES_PROFILE)
+		auto profile = m_Profile.begin();
+#endif
+#if defined(VPNES_TRACE)
+		auto traceName = m_TraceNames.cbegin();
+#endif
 		for (CClockedDevice *device : m_Devices) {
 			m_CurrentDevice = device;
+#if defined(VPNES_PROFILE) || defined(VPNES_TRACE)
+			ticks_t start = m_ElapsedTicks + device->getClock();
+#endif
+#if defined(VPNES_TRACE)
+			CTraceSlice slice(*traceName++, "simulate");
+#endif
+#if defined(VPNES_PROFILE)
+			CProfileTimer timer;
+			device->simulate(m_Clock);
+			(profile++)->add(m_ElapsedTicks + device->getClock() - start,
+			    timer.getElapsed());
+#else
 			device->simulate(m_Clock);
+#endif
+#if defined(VPNES_TRACE)
+			slice.setTicks(m_ElapsedTicks + device->getClock() - start);
+#endif
 		}
 		m_CurrentDevice = nullptr;
 	}
 	/**
 	 * Synchronizes clock of running device
 	 *
+	 * Happens when an event is scheduled before the current end point, so
+	 * all devices stop at the event time. The end point moves as well, so
+	 * events rescheduled while firing do not run ahead of the devices.
+	 *
 	 * @param ticks New time
 	 */
 	void sync(ticks_t ticks) {
+		m_Clock = ticks;
+		m_LocalTime = ticks;
 		if (m_CurrentDevice) {
 			m_CurrentDevice->setClock(ticks);
 		}
@@ -140,7 +205,9 @@ public:
 	    : CGeneratorDevice(true)
 	    , CEventManager()
 	    , m_CurrentDevice()
-	    , m_FrontEnd(frontEnd) {
+	    , m_FrontEnd(frontEnd)
+	    , m_ElapsedTicks()
+	    , m_IRQ() {
 	}
 	/**
 	 * Deleted copy constructor
@@ -151,7 +218,12 @@ public:
 	/**
 	 * Destroys the object
 	 */
-	~CMotherBoard() = default;
+	~CMotherBoard() {
+#if defined(VPNES_PROFILE)
+		dumpProfile(std::clog, "Devices", m_Profile);
+		dumpProfile(std::clog, "Events", getEventProfile());
+#endif
+	}
 
 	/**
 	 * Registers running devices
@@ -164,6 +236,19 @@ public:
 		    cond_and<std::is_base_of<CClockedDevice, Devices>...>::value,
 		    "Only for clocked devices");
 		m_Devices = {devices...};
+#if defined(VPNES_PROFILE)
+		m_Profile.clear();
+		for (const char *name : {typeid(Devices).name()...}) {
+			m_Profile.push_back(SProfileRecord{getReadableTypeName(name)});
+		}
+#endif
+#if defined(VPNES_TRACE)
+		m_TraceNames.clear();
+		for (const char *name : {typeid(Devices).name()...}) {
+			m_TraceNames.push_back(CTraceWriter::getInstance().getName(
+			    getReadableTypeName(name)));
+		}
+#endif
 	}
 
 	/**
@@ -214,6 +299,7 @@ public:
 	 * @param ticks Amount of ticks
 	 */
 	void resetClock(ticks_t ticks) {
+		m_ElapsedTicks += ticks;
 		CGeneratorDevice::resetClock(ticks);
 		for (CClockedDevice *device : m_Devices) {
 			device->resetClock(ticks);
@@ -231,6 +317,26 @@ public:
 			return m_Clock;
 		}
 	}
+	/**
+	 * Gets amount of ticks since power up
+	 *
+	 * @return Elapsed ticks
+	 */
+	ticks_t getElapsedTicks() const {
+		return m_ElapsedTicks + getPending();
+	}
+	/**
+	 * Gets profiling data for running devices
+	 *
+	 * @return Profiling data
+	 */
+	ProfileData getDeviceProfile() const {
+#if defined(VPNES_PROFILE)
+		return m_Profile;
+#else
+		return ProfileData();
+#endif
+	}
 	/**
 	 * Gets frontend
 	 *
@@ -239,6 +345,27 @@ public:
 	CFrontEnd *getFrontEnd() const {
 		return m_FrontEnd;
 	}
+	/**
+	 * Sets or clears IRQ line from a source
+	 *
+	 * @param source IRQ source
+	 * @param active True to assert, false to release
+	 */
+	void setIRQ(EIRQSource source, bool active) {
+		if (active) {
+			m_IRQ |= source;
+		} else {
+			m_IRQ &= ~source;
+		}
+	}
+	/**
+	 * Checks if IRQ line is asserted
+	 *
+	 * @return True if any source asserts IRQ
+	 */
+	bool isIRQ() const {
+		return m_IRQ != 0;
+	}
 };
 
 }  // namespace core
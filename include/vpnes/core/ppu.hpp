@@ -320,6 +320,10 @@ private:
 	 * @param event Frame ending event
 	 */
 	void handleFrameEnd(CMotherBoard::CEvent *event) {
+#if defined(VPNES_TRACE)
+		CTraceWriter::getInstance().addInstant(
+		    "frame", "frame", m_MotherBoard->getElapsedTicks());
+#endif
 		m_MotherBoard->getFrontEnd()->handleFrameRender(
 		    event->getFireTime() * m_Freq);
 		m_MotherBoard->resetClock(event->getFireTime());
@@ -0,0 +1,316 @@
+/**
+ * @file
+ *
+ * Defines simulation profiler
+ *
+ * Profiling is compiled in only when VPNES_PROFILE is defined.
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_PROFILER_HPP_
+#define INCLUDE_VPNES_CORE_PROFILER_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Profiling record
+ */
+struct SProfileRecord {
+	/**
+	 * Name of profiled device or event
+	 */
+	std::string Name;
+	/**
+	 * Number of calls
+	 */
+	std::uint64_t Calls;
+	/**
+	 * Advanced clock ticks
+	 */
+	std::intmax_t Ticks;
+	/**
+	 * Host time in nanoseconds
+	 */
+	std::uint64_t Nanoseconds;
+
+	/**
+	 * Accounts a call
+	 *
+	 * @param ticks Advanced ticks
+	 * @param nanoseconds Host time
+	 */
+	void add(std::intmax_t ticks, std::uint64_t nanoseconds) {
+		Calls++;
+		Ticks += ticks;
+		Nanoseconds += nanoseconds;
+	}
+};
+
+/**
+ * Profiling data
+ */
+typedef std::vector<SProfileRecord> ProfileData;
+
+/**
+ * Measures host time
+ */
+class CProfileTimer {
+private:
+	/**
+	 * Start time
+	 */
+	std::chrono::steady_clock::time_point m_Start;
+
+public:
+	/**
+	 * Starts the timer
+	 */
+	CProfileTimer() : m_Start(std::chrono::steady_clock::now()) {
+	}
+
+	/**
+	 * Gets elapsed time
+	 *
+	 * @return Elapsed nanoseconds
+	 */
+	std::uint64_t getElapsed() const {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		    std::chrono::steady_clock::now() - m_Start)
+		    .count();
+	}
+};
+
+/**
+ * Per-address code profile
+ *
+ * Accounts clock ticks spent on every instruction address in a flat table
+ * and counts backward transfers to detect loops.
+ */
+class CCodeProfile {
+public:
+	/**
+	 * Memory reader
+	 */
+	typedef std::function<std::uint8_t(std::uint16_t)> reader_t;
+
+private:
+	/**
+	 * Ticks spent per address
+	 */
+	std::vector<std::uint64_t> m_Ticks;
+	/**
+	 * Number of backward transfers per source address
+	 */
+	std::vector<std::uint32_t> m_Jumps;
+	/**
+	 * Last backward transfer target per source address
+	 */
+	std::vector<std::uint16_t> m_JumpTargets;
+	/**
+	 * Address of current instruction
+	 */
+	std::uint16_t m_Address;
+	/**
+	 * Time when current instruction started
+	 */
+	std::intmax_t m_Start;
+	/**
+	 * Started flag
+	 */
+	bool m_Started;
+	/**
+	 * Interrupt sequence is running
+	 */
+	bool m_Interrupted;
+	/**
+	 * Number of taken interrupts
+	 */
+	std::uint64_t m_Interrupts;
+	/**
+	 * Ticks spent in interrupt sequences
+	 */
+	std::uint64_t m_InterruptTicks;
+
+	/**
+	 * Charges ticks since start point to current instruction or interrupt
+	 *
+	 * @param clock Current clock
+	 */
+	void charge(std::intmax_t clock) {
+		if (m_Interrupted) {
+			m_InterruptTicks += clock - m_Start;
+		} else {
+			m_Ticks[m_Address] += clock - m_Start;
+		}
+	}
+
+public:
+	/**
+	 * Constructs the object
+	 */
+	CCodeProfile()
+	    : m_Ticks(0x10000)
+	    , m_Jumps(0x10000)
+	    , m_JumpTargets(0x10000)
+	    , m_Address()
+	    , m_Start()
+	    , m_Started()
+	    , m_Interrupted()
+	    , m_Interrupts()
+	    , m_InterruptTicks() {
+	}
+
+	/**
+	 * Starts new instruction
+	 *
+	 * The first instruction only seeds the start point.
+	 *
+	 * @param addr Instruction address
+	 * @param clock Current clock
+	 */
+	void enter(std::uint16_t addr, std::intmax_t clock) {
+		if (m_Started) {
+			charge(clock);
+			if (!m_Interrupted && addr <= m_Address) {
+				m_Jumps[m_Address]++;
+				m_JumpTargets[m_Address] = addr;
+			}
+		}
+		m_Started = true;
+		m_Interrupted = false;
+		m_Address = addr;
+		m_Start = clock;
+	}
+	/**
+	 * Starts interrupt sequence
+	 *
+	 * @param clock Current clock
+	 */
+	void enterInterrupt(std::intmax_t clock) {
+		if (m_Started) {
+			charge(clock);
+		}
+		m_Started = true;
+		m_Interrupted = true;
+		m_Interrupts++;
+		m_Start = clock;
+	}
+	/**
+	 * Resets the clock by ticks amount
+	 *
+	 * @param ticks Amount of ticks
+	 */
+	void resetClock(std::intmax_t ticks) {
+		m_Start -= ticks;
+	}
+	/**
+	 * Gets ticks spent on an address
+	 *
+	 * @param addr Instruction address
+	 * @return Ticks
+	 */
+	std::uint64_t getTicks(std::uint16_t addr) const {
+		return m_Ticks[addr];
+	}
+	/**
+	 * Gets number of backward transfers from an address
+	 *
+	 * @param addr Source address
+	 * @return Number of transfers
+	 */
+	std::uint32_t getJumps(std::uint16_t addr) const {
+		return m_Jumps[addr];
+	}
+	/**
+	 * Gets last backward transfer target
+	 *
+	 * @param addr Source address
+	 * @return Target address
+	 */
+	std::uint16_t getJumpTarget(std::uint16_t addr) const {
+		return m_JumpTargets[addr];
+	}
+	/**
+	 * Gets number of taken interrupts
+	 *
+	 * @return Number of interrupts
+	 */
+	std::uint64_t getInterrupts() const {
+		return m_Interrupts;
+	}
+	/**
+	 * Gets ticks spent in interrupt sequences
+	 *
+	 * @return Ticks
+	 */
+	std::uint64_t getInterruptTicks() const {
+		return m_InterruptTicks;
+	}
+	/**
+	 * Prints hottest addresses and loops
+	 *
+	 * @param out Output stream
+	 * @param count Number of entries in each list
+	 * @param divider Ticks per cycle
+	 * @param read Memory reader for opcode bytes
+	 */
+	void dump(std::ostream &out, std::size_t count, std::intmax_t divider,
+	    const reader_t &read) const;
+};
+
+/**
+ * Gets human-readable type name
+ *
+ * @param name Implementation-defined type name
+ * @return Readable name
+ */
+std::string getReadableTypeName(const char *name);
+
+/**
+ * Prints profiling data as table
+ *
+ * @param out Output stream
+ * @param title Table title
+ * @param data Profiling data
+ */
+void dumpProfile(
+    std::ostream &out, const char *title, const ProfileData &data);
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_PROFILER_HPP_
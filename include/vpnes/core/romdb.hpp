@@ -0,0 +1,95 @@
+/**
+ * @file
+ *
+ * Defines built-in ROM database
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_ROMDB_HPP_
+#define INCLUDE_VPNES_CORE_ROMDB_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace romdb {
+
+/**
+ * Known cartridge
+ */
+struct SROMInfo {
+	/**
+	 * CRC32 of PRG and CHR ROM
+	 */
+	std::uint32_t CRC32;
+	/**
+	 * Mapper number
+	 */
+	std::uint16_t Mapper;
+	/**
+	 * Submapper number
+	 */
+	std::uint8_t Submapper;
+	/**
+	 * Mirroring type (ignored if mapper controls mirroring)
+	 */
+	EMirroring Mirroring;
+	/**
+	 * PRG RAM size
+	 */
+	std::uint32_t RAMSize;
+	/**
+	 * Battery backed PRG RAM size
+	 */
+	std::uint32_t BatterySize;
+	/**
+	 * CHR RAM size
+	 */
+	std::uint32_t CHRRAMSize;
+};
+
+/**
+ * Looks up the cartridge
+ *
+ * The database is a flat array sorted by CRC32 and searched by binary
+ * search.
+ *
+ * @param crc CRC32 of PRG and CHR ROM
+ * @return Cartridge info or nullptr if unknown
+ */
+const SROMInfo *findROM(std::uint32_t crc);
+
+}  // namespace romdb
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_ROMDB_HPP_
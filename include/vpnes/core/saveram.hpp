@@ -0,0 +1,258 @@
+/**
+ * @file
+ *
+ * Defines battery backed RAM
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_SAVERAM_HPP_
+#define INCLUDE_VPNES_CORE_SAVERAM_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * PRG RAM with optional battery backed save file
+ *
+ * Only the battery backed part (after RAMSize bytes of work RAM) goes to the
+ * save file. For battery carts that part is a shared read-write mapping of
+ * the save file, so the bus writes straight into the page cache. Dirty pages
+ * are found by comparing a snapshot with the last flushed copy, which keeps
+ * the CPU write path untouched. The background thread only asks for a
+ * snapshot, the emulation thread copies RAM at frame end, and the thread
+ * syncs or writes the dirty pages. Without memory mapping the save file is
+ * loaded into a buffer and dirty pages are written back instead.
+ */
+class CSaveRAM {
+private:
+	/**
+	 * RAM data
+	 */
+	std::uint8_t *m_Data;
+	/**
+	 * RAM size
+	 */
+	std::size_t m_Size;
+	/**
+	 * Offset of battery backed part
+	 */
+	std::size_t m_SaveOffset;
+	/**
+	 * Size of battery backed part
+	 */
+	std::size_t m_SaveSize;
+	/**
+	 * Owned buffer (if not mapped)
+	 */
+	std::vector<std::uint8_t> m_Buffer;
+	/**
+	 * RAM is a mapping of the save file
+	 */
+	bool m_Mapped;
+	/**
+	 * Save file name (empty if RAM is not saved)
+	 */
+	std::string m_FileName;
+	/**
+	 * Page size for dirty tracking
+	 */
+	std::size_t m_PageSize;
+	/**
+	 * Battery backed contents at last flush
+	 */
+	std::vector<std::uint8_t> m_Flushed;
+	/**
+	 * Serializes flushes
+	 */
+	std::mutex m_FlushMutex;
+	/**
+	 * Flush thread waits for a snapshot
+	 */
+	std::atomic<bool> m_SnapshotRequested;
+	/**
+	 * Guards snapshot and flush thread stop flag
+	 */
+	std::mutex m_Mutex;
+	/**
+	 * Wakes flush thread up for snapshot or stop
+	 */
+	std::condition_variable m_Condition;
+	/**
+	 * Battery backed contents taken at frame end
+	 */
+	std::vector<std::uint8_t> m_Snapshot;
+	/**
+	 * Snapshot is taken and not flushed yet
+	 */
+	bool m_SnapshotReady;
+	/**
+	 * Flush thread should stop
+	 */
+	bool m_Stop;
+	/**
+	 * Background flush thread
+	 */
+	std::thread m_FlushThread;
+
+	/**
+	 * Maps the save file
+	 *
+	 * @return True if mapped
+	 */
+	bool mapFile();
+	/**
+	 * Unmaps the save file
+	 */
+	void unmapFile();
+	/**
+	 * Loads the save file into the buffer
+	 */
+	void loadFile();
+	/**
+	 * Writes dirty range to the save file
+	 *
+	 * @param offset Offset in battery backed part
+	 * @param size Size
+	 */
+	void writeRange(std::size_t offset, std::size_t size);
+	/**
+	 * Writes pages of battery backed part changed since last flush
+	 *
+	 * @param contents Current contents of battery backed part
+	 */
+	void writeChanges(const std::uint8_t *contents);
+	/**
+	 * Copies battery backed part for the flush thread
+	 */
+	void takeSnapshot();
+	/**
+	 * Flushes dirty pages periodically
+	 *
+	 * @param interval Flush interval
+	 */
+	void flushLoop(std::chrono::milliseconds interval);
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CSaveRAM() = delete;
+	/**
+	 * Allocates PRG RAM
+	 *
+	 * RAM is backed by the save file if the cart has battery and the save
+	 * file name is set.
+	 *
+	 * @param config NES config
+	 * @param minSize Smaller RAM is mirrored, so it is extended to this size
+	 */
+	CSaveRAM(const SNESConfig &config, std::size_t minSize);
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CSaveRAM(const CSaveRAM &s) = delete;
+	/**
+	 * Stops flushing, saves and releases RAM
+	 */
+	~CSaveRAM();
+
+	/**
+	 * Gets RAM data
+	 *
+	 * @return RAM data
+	 */
+	std::uint8_t *data() {
+		return m_Data;
+	}
+	/**
+	 * Gets RAM size
+	 *
+	 * @return RAM size
+	 */
+	std::size_t size() const {
+		return m_Size;
+	}
+	/**
+	 * Checks if there is no RAM
+	 *
+	 * @return True if empty
+	 */
+	bool empty() const {
+		return m_Size == 0;
+	}
+	/**
+	 * Checks if RAM is saved
+	 *
+	 * @return True if saved
+	 */
+	bool isSaved() const {
+		return !m_FileName.empty();
+	}
+	/**
+	 * Checks if RAM is a mapping of the save file
+	 *
+	 * @return True if mapped
+	 */
+	bool isMapped() const {
+		return m_Mapped;
+	}
+	/**
+	 * Hands a snapshot to the flush thread if it waits for one
+	 *
+	 * Called by the emulation thread at frame end.
+	 */
+	void handleFrameEnd() {
+		if (m_SnapshotRequested.load(std::memory_order_relaxed)) {
+			takeSnapshot();
+		}
+	}
+	/**
+	 * Writes dirty pages to the save file
+	 *
+	 * Called by the emulation thread, while the CPU does not write RAM.
+	 */
+	void flush();
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_SAVERAM_HPP_
@@ -0,0 +1,245 @@
+/**
+ * @file
+ *
+ * Defines memory search
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_SEARCH_HPP_
+#define INCLUDE_VPNES_CORE_SEARCH_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VPNES_SEARCH_SSE2
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+class CDebugger;
+
+/**
+ * Comparison of a value with its previous snapshot
+ */
+enum ESearchCompare {
+	SearchEqual,      //!< Value equals operand
+	SearchChanged,    //!< Value has changed
+	SearchUnchanged,  //!< Value has not changed
+	SearchIncreased,  //!< Value has increased
+	SearchDecreased,  //!< Value has decreased
+	SearchDelta       //!< Value has changed by operand (modulo 256)
+};
+
+/**
+ * Drops candidates that do not match comparison, one byte at a time
+ *
+ * @param candidates Candidate mask
+ * @param current Current snapshot
+ * @param previous Previous snapshot
+ * @param size Size in bytes
+ * @param compare Comparison
+ * @param operand Value for SearchEqual or delta for SearchDelta
+ */
+void refineScalar(std::uint8_t *candidates, const std::uint8_t *current,
+    const std::uint8_t *previous, std::size_t size, ESearchCompare compare,
+    std::uint8_t operand);
+#if defined(VPNES_SEARCH_SSE2)
+/**
+ * Drops candidates that do not match comparison, 16 bytes at a time
+ *
+ * @param candidates Candidate mask
+ * @param current Current snapshot
+ * @param previous Previous snapshot
+ * @param size Size in bytes (multiple of 16)
+ * @param compare Comparison
+ * @param operand Value for SearchEqual or delta for SearchDelta
+ */
+void refineSSE2(std::uint8_t *candidates, const std::uint8_t *current,
+    const std::uint8_t *previous, std::size_t size, ESearchCompare compare,
+    std::uint8_t operand);
+#endif
+
+/**
+ * Memory search over CPU RAM and PRG RAM
+ *
+ * Keeps a snapshot of searched memory and a candidate mask. Every refine
+ * takes a new snapshot, compares it with the previous one and drops
+ * candidates that do not match. Comparisons run on 16 bytes at once with
+ * SSE2, if available. Found addresses can be frozen: frozen values are
+ * written back through the debugger once per frame.
+ */
+class CMemorySearch {
+public:
+	/**
+	 * Searched address range
+	 */
+	struct SRegion {
+		/**
+		 * First address
+		 */
+		std::uint16_t First;
+		/**
+		 * Size
+		 */
+		std::size_t Size;
+	};
+	enum {
+		RegionCount = 2,     //!< Amount of regions
+		SearchSize = 0x2800  //!< Total size of regions
+	};
+	/**
+	 * Searched regions: CPU RAM and PRG RAM
+	 */
+	static const SRegion Regions[RegionCount];
+
+private:
+	/**
+	 * Debugger
+	 */
+	CDebugger *m_Debugger;
+	/**
+	 * Previous snapshot
+	 */
+	std::vector<std::uint8_t> m_Snapshot;
+	/**
+	 * Current snapshot
+	 */
+	std::vector<std::uint8_t> m_Current;
+	/**
+	 * Candidate mask (0xff for candidates)
+	 */
+	std::vector<std::uint8_t> m_Candidates;
+	/**
+	 * Frozen values
+	 */
+	std::map<std::uint16_t, std::uint8_t> m_Freezes;
+
+	/**
+	 * Reads searched memory
+	 *
+	 * @param snapshot Output buffer
+	 */
+	void takeSnapshot(std::vector<std::uint8_t> *snapshot);
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CMemorySearch() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param debugger Debugger
+	 */
+	explicit CMemorySearch(CDebugger *debugger)
+	    : m_Debugger(debugger)
+	    , m_Snapshot(SearchSize)
+	    , m_Current(SearchSize)
+	    , m_Candidates(SearchSize, 0xff)
+	    , m_Freezes() {
+	}
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CMemorySearch(const CMemorySearch &s) = delete;
+
+	/**
+	 * Starts new search
+	 *
+	 * Takes initial snapshot and makes every address a candidate.
+	 */
+	void start();
+	/**
+	 * Takes new snapshot and drops candidates that do not match
+	 *
+	 * @param compare Comparison
+	 * @param operand Value for SearchEqual or delta for SearchDelta
+	 * @return Amount of candidates left
+	 */
+	std::size_t refine(ESearchCompare compare, std::uint8_t operand = 0);
+	/**
+	 * Gets amount of candidates
+	 *
+	 * @return Amount of candidates
+	 */
+	std::size_t getCandidateCount() const;
+	/**
+	 * Gets candidate addresses
+	 *
+	 * @return Candidate addresses
+	 */
+	std::vector<std::uint16_t> getCandidates() const;
+	/**
+	 * Gets value of address in the last snapshot
+	 *
+	 * @param addr Searched address
+	 * @return Value
+	 */
+	std::uint8_t getValue(std::uint16_t addr) const;
+
+	/**
+	 * Freezes address
+	 *
+	 * @param addr Address
+	 * @param val Value
+	 */
+	void freeze(std::uint16_t addr, std::uint8_t val) {
+		m_Freezes[addr] = val;
+	}
+	/**
+	 * Removes freeze from address
+	 *
+	 * @param addr Address
+	 */
+	void unfreeze(std::uint16_t addr) {
+		m_Freezes.erase(addr);
+	}
+	/**
+	 * Gets frozen values
+	 *
+	 * @return Frozen values by address
+	 */
+	const std::map<std::uint16_t, std::uint8_t> &getFreezes() const {
+		return m_Freezes;
+	}
+	/**
+	 * Writes frozen values to memory
+	 */
+	void applyFreezes();
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_SEARCH_HPP_
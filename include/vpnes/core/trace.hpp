@@ -0,0 +1,392 @@
+/**
+ * @file
+ *
+ * Defines timeline tracer
+ *
+ * Tracing is compiled in only when VPNES_TRACE is defined. Records are
+ * collected into per-thread lock-free ring buffers and written by a
+ * background thread in Chrome trace event format.
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_TRACE_HPP_
+#define INCLUDE_VPNES_CORE_TRACE_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(VPNES_TRACE)
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Trace record
+ */
+struct STraceRecord {
+	/**
+	 * Record name (must stay valid while the tracer exists)
+	 */
+	const char *Name;
+	/**
+	 * Record category (must stay valid while the tracer exists)
+	 */
+	const char *Category;
+	/**
+	 * Start time in nanoseconds since tracer start
+	 */
+	std::uint64_t Timestamp;
+	/**
+	 * Duration in nanoseconds
+	 */
+	std::uint64_t Duration;
+	/**
+	 * Emulated clock ticks
+	 */
+	std::intmax_t Ticks;
+	/**
+	 * Phase ('X' for complete slice, 'i' for instant)
+	 */
+	char Phase;
+};
+
+/**
+ * Single-producer single-consumer ring of trace records
+ */
+class CTraceBuffer {
+public:
+	/**
+	 * Capacity of the ring (power of 2)
+	 */
+	static constexpr std::size_t Capacity = 1 << 16;
+
+private:
+	/**
+	 * Records
+	 */
+	std::unique_ptr<STraceRecord[]> m_Records;
+	/**
+	 * Write position (owned by producer)
+	 */
+	alignas(64) std::atomic<std::size_t> m_Head;
+	/**
+	 * Read position (owned by consumer)
+	 */
+	alignas(64) std::atomic<std::size_t> m_Tail;
+	/**
+	 * Amount of records lost due to overflow
+	 */
+	std::atomic<std::uint64_t> m_Dropped;
+	/**
+	 * Thread id reported in trace
+	 */
+	unsigned m_ThreadId;
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CTraceBuffer() = delete;
+	/**
+	 * Constructs the object
+	 *
+	 * @param threadId Thread id reported in trace
+	 */
+	explicit CTraceBuffer(unsigned threadId)
+	    : m_Records(new STraceRecord[Capacity])
+	    , m_Head(0)
+	    , m_Tail(0)
+	    , m_Dropped(0)
+	    , m_ThreadId(threadId) {
+	}
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CTraceBuffer(const CTraceBuffer &s) = delete;
+
+	/**
+	 * Pushes the record, never blocks
+	 *
+	 * @param record Record
+	 */
+	void push(const STraceRecord &record) {
+		std::size_t head = m_Head.load(std::memory_order_relaxed);
+		if (head - m_Tail.load(std::memory_order_acquire) >= Capacity) {
+			m_Dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		m_Records[head & (Capacity - 1)] = record;
+		m_Head.store(head + 1, std::memory_order_release);
+	}
+	/**
+	 * Pops all available records
+	 *
+	 * @param handler Handler called for every record
+	 */
+	template <class Handler>
+	void drain(Handler &&handler) {
+		std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+		std::size_t head = m_Head.load(std::memory_order_acquire);
+		for (; tail != head; ++tail) {
+			handler(m_Records[tail & (Capacity - 1)]);
+		}
+		m_Tail.store(tail, std::memory_order_release);
+	}
+	/**
+	 * Gets amount of lost records
+	 *
+	 * @return Amount of lost records
+	 */
+	std::uint64_t getDropped() const {
+		return m_Dropped.load(std::memory_order_relaxed);
+	}
+	/**
+	 * Gets thread id
+	 *
+	 * @return Thread id
+	 */
+	unsigned getThreadId() const {
+		return m_ThreadId;
+	}
+};
+
+/**
+ * Trace writer
+ *
+ * Output file of the global writer is set by the front-end before tracing
+ * starts (vpnes-trace.json by default). The file is finalized at exit.
+ * Other writers only take records pushed to buffers from addBuffer.
+ */
+class CTraceWriter {
+private:
+	/**
+	 * Time when tracing started
+	 */
+	std::chrono::steady_clock::time_point m_Start;
+	/**
+	 * Guards buffer list and name pool
+	 */
+	std::mutex m_Mutex;
+	/**
+	 * Signals writer thread
+	 */
+	std::condition_variable m_Signal;
+	/**
+	 * Per-thread buffers
+	 */
+	std::vector<std::unique_ptr<CTraceBuffer>> m_Buffers;
+	/**
+	 * Pool of dynamic names
+	 */
+	std::set<std::string> m_Names;
+	/**
+	 * Output file
+	 */
+	std::ofstream m_Output;
+	/**
+	 * Flag for first written record
+	 */
+	bool m_First;
+	/**
+	 * Stop flag
+	 */
+	bool m_Stop;
+	/**
+	 * Writer thread
+	 */
+	std::thread m_Thread;
+
+	/**
+	 * Gets output file name
+	 *
+	 * @return Output file name
+	 */
+	static std::string &getFileName() {
+		static std::string fileName("vpnes-trace.json");
+		return fileName;
+	}
+	/**
+	 * Writes all pending records
+	 */
+	void flush();
+	/**
+	 * Writer thread routine
+	 */
+	void run();
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CTraceWriter() = delete;
+	/**
+	 * Constructs the object and starts writer thread
+	 *
+	 * @param fileName Output file name
+	 */
+	explicit CTraceWriter(const std::string &fileName);
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CTraceWriter(const CTraceWriter &s) = delete;
+	/**
+	 * Finalizes output
+	 */
+	~CTraceWriter();
+
+	/**
+	 * Sets output file name, ignored once tracing has started
+	 *
+	 * @param fileName Output file name
+	 */
+	static void setFileName(const std::string &fileName) {
+		getFileName() = fileName;
+	}
+	/**
+	 * Gets tracer instance
+	 *
+	 * @return Tracer
+	 */
+	static CTraceWriter &getInstance() {
+		static CTraceWriter writer(getFileName());
+		return writer;
+	}
+	/**
+	 * Gets current trace time
+	 *
+	 * @return Nanoseconds since tracer start
+	 */
+	std::uint64_t getTimestamp() const {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		    std::chrono::steady_clock::now() - m_Start)
+		    .count();
+	}
+	/**
+	 * Registers a buffer for a producer thread
+	 *
+	 * @return New buffer
+	 */
+	CTraceBuffer *addBuffer();
+	/**
+	 * Adds a record from the calling thread to the global writer
+	 *
+	 * @param record Record
+	 */
+	static void addRecord(const STraceRecord &record) {
+		thread_local CTraceBuffer *buffer = getInstance().addBuffer();
+		buffer->push(record);
+	}
+	/**
+	 * Adds an instant record
+	 *
+	 * @param name Name
+	 * @param category Category
+	 * @param ticks Emulated clock ticks
+	 */
+	void addInstant(
+	    const char *name, const char *category, std::intmax_t ticks) {
+		addRecord({name, category, getTimestamp(), 0, ticks, 'i'});
+	}
+	/**
+	 * Gets persistent copy of the name
+	 *
+	 * @param name Name
+	 * @return Name valid while the tracer exists
+	 */
+	const char *getName(const std::string &name);
+};
+
+/**
+ * Traces a slice for the lifetime of the object
+ */
+class CTraceSlice {
+private:
+	/**
+	 * Pending record
+	 */
+	STraceRecord m_Record;
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CTraceSlice() = delete;
+	/**
+	 * Starts the slice
+	 *
+	 * @param name Name
+	 * @param category Category
+	 */
+	CTraceSlice(const char *name, const char *category)
+	    : m_Record{name, category,
+	          CTraceWriter::getInstance().getTimestamp(), 0, 0, 'X'} {
+	}
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CTraceSlice(const CTraceSlice &s) = delete;
+	/**
+	 * Finishes the slice
+	 */
+	~CTraceSlice() {
+		CTraceWriter &writer = CTraceWriter::getInstance();
+		m_Record.Duration = writer.getTimestamp() - m_Record.Timestamp;
+		writer.addRecord(m_Record);
+	}
+	/**
+	 * Sets emulated ticks reported with the slice
+	 *
+	 * @param ticks Clock ticks
+	 */
+	void setTicks(std::intmax_t ticks) {
+		m_Record.Ticks = ticks;
+	}
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // defined(VPNES_TRACE)
+
+#endif  // INCLUDE_VPNES_CORE_TRACE_HPP_
@@ -0,0 +1,281 @@
+/**
+ * @file
+ *
+ * Defines bus watch facility
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_CORE_WATCH_HPP_
+#define INCLUDE_VPNES_CORE_WATCH_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <bitset>
+#include <functional>
+#include <ostream>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Watched access type
+ */
+enum EWatchType {
+	WatchRead,   //!< Data read
+	WatchWrite,  //!< Data write
+	WatchExec,   //!< Opcode fetch
+	WatchTypes   //!< Number of access types
+};
+
+/**
+ * Owner of watchpoints
+ */
+enum EWatchLayer {
+	WatchLayerUser,         //!< Watchpoints set by front end
+	WatchLayerBreakpoints,  //!< Breakpoint pre-filter
+	WatchLayers             //!< Number of layers
+};
+
+/**
+ * Bulk watchpoints and access counters for a bus
+ *
+ * Watchpoints are kept in one bitmap per access type, so checking an
+ * access costs a single bit test regardless of how many are set. Each
+ * layer has its own bitmaps and handler, a combined bitmap filters
+ * accesses before dispatching them to the layers. Buses check isActive
+ * before accounting an access, so an unused watch costs one flag test.
+ */
+class CBusWatch {
+public:
+	/**
+	 * Watchpoint handler
+	 */
+	typedef std::function<void(EWatchType type, std::uint16_t addr,
+	    std::uint8_t val)>
+	    handler_t;
+
+private:
+	/**
+	 * Watchpoint bitmaps per layer
+	 */
+	std::array<std::array<std::bitset<0x10000>, WatchTypes>, WatchLayers>
+	    m_Watches;
+	/**
+	 * Watchpoints of all layers
+	 */
+	std::array<std::bitset<0x10000>, WatchTypes> m_Combined;
+	/**
+	 * Access counters (empty if disabled)
+	 */
+	std::vector<std::uint32_t> m_Counters;
+	/**
+	 * Watchpoint handlers per layer
+	 */
+	std::array<handler_t, WatchLayers> m_Handlers;
+	/**
+	 * Any watchpoint is set or counters are enabled
+	 */
+	bool m_Active;
+
+	/**
+	 * Calls handlers of layers watching the access
+	 *
+	 * @param type Access type
+	 * @param addr Address
+	 * @param val Value
+	 */
+	void dispatch(EWatchType type, std::uint16_t addr, std::uint8_t val);
+	/**
+	 * Rebuilds combined bitmap for an address
+	 *
+	 * @param type Access type
+	 * @param addr Address
+	 */
+	void combine(EWatchType type, std::size_t addr) {
+		bool watched = false;
+		for (const auto &watches : m_Watches) {
+			watched = watched || watches[type][addr];
+		}
+		m_Combined[type][addr] = watched;
+	}
+	/**
+	 * Updates active flag
+	 */
+	void updateActive() {
+		m_Active = !m_Counters.empty();
+		for (const auto &combined : m_Combined) {
+			m_Active = m_Active || combined.any();
+		}
+	}
+
+public:
+	/**
+	 * Constructs the object
+	 */
+	CBusWatch()
+	    : m_Watches()
+	    , m_Combined()
+	    , m_Counters()
+	    , m_Handlers()
+	    , m_Active() {
+	}
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CBusWatch(const CBusWatch &s) = delete;
+
+	/**
+	 * Checks if accesses have to be accounted
+	 *
+	 * @return True if any watchpoint is set or counters are enabled
+	 */
+	bool isActive() const {
+		return m_Active;
+	}
+	/**
+	 * Accounts an access
+	 *
+	 * @param type Access type
+	 * @param addr Address
+	 * @param val Value
+	 */
+	void access(EWatchType type, std::uint16_t addr, std::uint8_t val) {
+		if (!m_Counters.empty()) {
+			m_Counters[type * 0x10000 + addr]++;
+		}
+		if (m_Combined[type][addr]) {
+			dispatch(type, addr, val);
+		}
+	}
+	/**
+	 * Sets or clears watchpoints on a range
+	 *
+	 * @param type Access type
+	 * @param first First address
+	 * @param last Last address (inclusive)
+	 * @param enabled Set or clear
+	 * @param layer Layer
+	 */
+	void setWatch(EWatchType type, std::uint16_t first, std::uint16_t last,
+	    bool enabled = true, EWatchLayer layer = WatchLayerUser) {
+		for (std::size_t addr = first; addr <= last; addr++) {
+			m_Watches[layer][type][addr] = enabled;
+			combine(type, addr);
+		}
+		updateActive();
+	}
+	/**
+	 * Clears all watchpoints of a layer
+	 *
+	 * @param layer Layer
+	 */
+	void clearWatches(EWatchLayer layer = WatchLayerUser) {
+		for (std::size_t type = 0; type < WatchTypes; type++) {
+			m_Watches[layer][type].reset();
+			m_Combined[type].reset();
+			for (const auto &watches : m_Watches) {
+				m_Combined[type] |= watches[type];
+			}
+		}
+		updateActive();
+	}
+	/**
+	 * Checks if watchpoint is set
+	 *
+	 * @param type Access type
+	 * @param addr Address
+	 * @param layer Layer
+	 * @return True if set
+	 */
+	bool isWatched(EWatchType type, std::uint16_t addr,
+	    EWatchLayer layer = WatchLayerUser) const {
+		return m_Watches[layer][type][addr];
+	}
+	/**
+	 * Sets watchpoint handler of a layer
+	 *
+	 * Handler has to be set before any watchpoint of the layer is hit.
+	 *
+	 * @param handler Handler
+	 * @param layer Layer
+	 */
+	void setHandler(handler_t handler, EWatchLayer layer = WatchLayerUser) {
+		m_Handlers[layer] = handler;
+	}
+	/**
+	 * Enables or disables access counters
+	 *
+	 * Enabling resets the counters.
+	 *
+	 * @param enabled Enable or disable
+	 */
+	void setCounters(bool enabled) {
+		std::vector<std::uint32_t>().swap(m_Counters);
+		if (enabled) {
+			m_Counters.resize(WatchTypes * 0x10000);
+		}
+		updateActive();
+	}
+	/**
+	 * Gets access count
+	 *
+	 * @param type Access type
+	 * @param addr Address
+	 * @return Number of accesses (0 if counters are disabled)
+	 */
+	std::uint32_t getCount(EWatchType type, std::uint16_t addr) const {
+		return m_Counters.empty() ? 0 : m_Counters[type * 0x10000 + addr];
+	}
+	/**
+	 * Writes access counters as CSV
+	 *
+	 * Only addresses that were accessed are listed.
+	 *
+	 * @param out Output stream
+	 */
+	void writeCSV(std::ostream &out) const;
+	/**
+	 * Writes access counters as 256x256 PGM image
+	 *
+	 * Row is high address byte, column is low address byte, brightness is
+	 * logarithmic access count.
+	 *
+	 * @param out Output stream
+	 * @param type Access type
+	 */
+	void writePGM(std::ostream &out, EWatchType type) const;
+};
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_CORE_WATCH_HPP_
@@ -0,0 +1,159 @@
+/**
+ * @file
+ *
+ * Defines audio output
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef INCLUDE_VPNES_GUI_AUDIO_HPP_
+#define INCLUDE_VPNES_GUI_AUDIO_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/audioring.hpp>
+
+namespace vpnes {
+
+namespace gui {
+
+/**
+ * SDL audio output
+ *
+ * Samples are resampled with a ratio controlled by the fill level of the
+ * ring, so the queue stays around its target. Waiting for the device to
+ * drain the ring paces emulation.
+ */
+class CAudioOutput {
+private:
+	/**
+	 * Longest wait for the device in milliseconds
+	 */
+	enum { MaxWait = 100 };
+
+	/**
+	 * Audio device
+	 */
+	::SDL_AudioDeviceID m_Device;
+	/**
+	 * Device sample rate
+	 */
+	int m_SampleRate;
+	/**
+	 * Device buffer size in samples
+	 */
+	std::size_t m_DeviceSamples;
+	/**
+	 * Target fill level of the ring
+	 */
+	std::size_t m_Target;
+	/**
+	 * Queue between emulation and device
+	 */
+	core::CAudioRing m_Ring;
+	/**
+	 * Rate-controlled resampler
+	 */
+	core::CAudioResampler m_Resampler;
+	/**
+	 * Resampled samples
+	 */
+	std::vector<std::int16_t> m_Buffer;
+	/**
+	 * Last sample played (consumer)
+	 */
+	std::int16_t m_Played;
+
+	/**
+	 * SDL audio callback
+	 *
+	 * @param userData Audio output
+	 * @param stream Output buffer
+	 * @param len Size of buffer in bytes
+	 */
+	static void SDLCALL fillAudio(void *userData, ::Uint8 *stream, int len);
+	/**
+	 * Gets fill level the rate control aims for
+	 *
+	 * After sync() the device takes its buffer from the ring at once, so the
+	 * ring holds half a device buffer less than the target on average.
+	 *
+	 * @return Fill level
+	 */
+	double getSetPoint() const {
+		return m_Target - m_DeviceSamples / 2.0;
+	}
+
+public:
+	/**
+	 * Deleted default constructor
+	 */
+	CAudioOutput() = delete;
+	/**
+	 * Opens audio device
+	 *
+	 * @param sampleRate Requested sample rate
+	 * @param latency Latency in milliseconds
+	 */
+	CAudioOutput(int sampleRate, int latency);
+	/**
+	 * Deleted copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CAudioOutput(const CAudioOutput &s) = delete;
+	/**
+	 * Closes audio device
+	 */
+	~CAudioOutput();
+
+	/**
+	 * Gets device sample rate
+	 *
+	 * @return Sample rate
+	 */
+	int getSampleRate() const {
+		return m_SampleRate;
+	}
+	/**
+	 * Queues samples
+	 *
+	 * @param samples Samples
+	 * @param count Amount of samples
+	 */
+	void write(const std::int16_t *samples, std::size_t count);
+	/**
+	 * Waits until the device drains the ring to its target
+	 */
+	void sync();
+};
+
+}  // namespace gui
+
+}  // namespace vpnes
+
+#endif  // INCLUDE_VPNES_GUI_AUDIO_HPP_
@@ -30,8 +30,10 @@
 #include "config.h"
 #endif
 
+#include <cstdint>
 #include <fstream>
 #include <string>
+#include <vector>
 #include <vpnes/vpnes.hpp>
 
 namespace vpnes {
@@ -47,6 +49,34 @@ private:
 	 * File name
 	 */
 	std::string inputFile;
+	/**
+	 * Save file name
+	 */
+	std::string saveFile;
+	/**
+	 * Save file flush interval in milliseconds
+	 */
+	std::uint32_t saveInterval;
+	/**
+	 * Timeline trace file name
+	 */
+	std::string traceFile;
+	/**
+	 * Audio latency in milliseconds
+	 */
+	std::uint32_t audioLatency;
+	/**
+	 * Memory heat map file name prefix
+	 */
+	std::string heatMapPrefix;
+	/**
+	 * CPU instruction trace file name
+	 */
+	std::string cpuTraceFile;
+	/**
+	 * Cheat codes
+	 */
+	std::vector<std::string> cheats;
 
 protected:
 	/**
@@ -109,12 +139,131 @@ public:
 	void setInputFile(const char *fileName) {
 		inputFile = fileName;
 	}
+	/**
+	 * Gets input file path
+	 *
+	 * @return Input file path
+	 */
+	const std::string &getInputFileName() const noexcept {
+		return inputFile;
+	}
 	/**
 	 * Opens input file and constructs ifstream object
 	 *
 	 * @return std::ifstream for reading file
 	 */
 	std::ifstream getInputFile();
+	/**
+	 * Sets save file for battery backed RAM
+	 *
+	 * @param fileName Save file path (empty to not save)
+	 */
+	void setSaveFile(const char *fileName) {
+		saveFile = fileName;
+	}
+	/**
+	 * Gets save file path
+	 *
+	 * @return Save file path
+	 */
+	const std::string &getSaveFileName() const noexcept {
+		return saveFile;
+	}
+	/**
+	 * Sets save file flush interval
+	 *
+	 * @param interval Interval in milliseconds (0 to save on exit only)
+	 */
+	void setSaveInterval(std::uint32_t interval) {
+		saveInterval = interval;
+	}
+	/**
+	 * Gets save file flush interval
+	 *
+	 * @return Interval in milliseconds
+	 */
+	std::uint32_t getSaveInterval() const noexcept {
+		return saveInterval;
+	}
+	/**
+	 * Sets timeline trace file
+	 *
+	 * @param fileName Trace file path
+	 */
+	void setTraceFile(const char *fileName) {
+		traceFile = fileName;
+	}
+	/**
+	 * Gets timeline trace file path
+	 *
+	 * @return Trace file path
+	 */
+	const std::string &getTraceFileName() const noexcept {
+		return traceFile;
+	}
+	/**
+	 * Sets audio latency
+	 *
+	 * @param latency Latency in milliseconds (0 to disable audio)
+	 */
+	void setAudioLatency(std::uint32_t latency) {
+		audioLatency = latency;
+	}
+	/**
+	 * Gets audio latency
+	 *
+	 * @return Latency in milliseconds
+	 */
+	std::uint32_t getAudioLatency() const noexcept {
+		return audioLatency;
+	}
+	/**
+	 * Sets memory heat map file name prefix
+	 *
+	 * @param prefix File name prefix (empty to not write heat map)
+	 */
+	void setHeatMapPrefix(const char *prefix) {
+		heatMapPrefix = prefix;
+	}
+	/**
+	 * Gets memory heat map file name prefix
+	 *
+	 * @return File name prefix
+	 */
+	const std::string &getHeatMapPrefix() const noexcept {
+		return heatMapPrefix;
+	}
+	/**
+	 * Sets CPU instruction trace file
+	 *
+	 * @param fileName Trace file path (empty to not trace)
+	 */
+	void setCPUTraceFile(const char *fileName) {
+		cpuTraceFile = fileName;
+	}
+	/**
+	 * Gets CPU instruction trace file path
+	 *
+	 * @return Trace file path
+	 */
+	const std::string &getCPUTraceFileName() const noexcept {
+		return cpuTraceFile;
+	}
+	/**
+	 * Adds cheat code
+	 *
+	 * @param code Cheat code
+	 * @return True if code is valid
+	 */
+	bool addCheat(const std::string &code);
+	/**
+	 * Gets cheat codes
+	 *
+	 * @return Cheat codes
+	 */
+	const std::vector<std::string> &getCheats() const noexcept {
+		return cheats;
+	}
 };
 
 }  // namespace gui
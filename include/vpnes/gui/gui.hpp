@@ -32,12 +32,15 @@
 
 #include <SDL.h>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <chrono>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/gui/config.hpp>
+#include <vpnes/gui/audio.hpp>
 #include <vpnes/core/frontend.hpp>
 #include <vpnes/core/nes.hpp>
+#include <vpnes/core/watch.hpp>
 
 namespace vpnes {
 
@@ -80,6 +83,10 @@ protected:
 	 * Main screen buffer
 	 */
 	::SDL_Texture *m_ScreenBuffer;
+	/**
+	 * Audio output (paces emulation when present)
+	 */
+	std::unique_ptr<CAudioOutput> m_Audio;
 
 	/**
 	 * (Re-)init main window
@@ -88,6 +95,13 @@ protected:
 	 * @param height Height
 	 */
 	void initMainWindow(std::size_t width, std::size_t height);
+	/**
+	 * Writes CPU bus heatmap
+	 *
+	 * @param prefix File name prefix
+	 * @param watch CPU bus watch
+	 */
+	void writeHeatMap(const char *prefix, const core::CBusWatch &watch);
 
 public:
 	/**
@@ -118,6 +132,19 @@ public:
 	 * @param frameTime Frame time
 	 */
 	void handleFrameRender(double frameTime);
+	/**
+	 * Gets audio sample rate
+	 *
+	 * @return Sample rate or 0 if audio is not available
+	 */
+	int getSampleRate();
+	/**
+	 * Audio-ready callback
+	 *
+	 * @param samples Mono samples
+	 * @param count Amount of samples
+	 */
+	void handleAudioSamples(const std::int16_t *samples, std::size_t count);
 };
 
 }  // namespace gui
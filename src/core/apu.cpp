@@ -0,0 +1,597 @@
+/**
+ * @file
+ *
+ * Implements basic APU
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/apu.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace apu {
+
+/* CLengthCounter */
+
+/**
+ * Load values
+ */
+const std::uint8_t CLengthCounter::LengthTable[32] = {10, 254, 20, 2, 40, 4,
+    80, 6, 160, 8, 60, 10, 14, 12, 26, 14, 12, 16, 24, 18, 48, 20, 96, 22,
+    192, 24, 72, 26, 16, 28, 32, 30};
+
+/* CPulse */
+
+/**
+ * Duty cycle sequences
+ */
+const std::uint8_t CPulse::DutyTable[4][8] = {{0, 1, 0, 0, 0, 0, 0, 0},
+    {0, 1, 1, 0, 0, 0, 0, 0}, {0, 1, 1, 1, 1, 0, 0, 0},
+    {1, 0, 0, 1, 1, 1, 1, 1}};
+
+/**
+ * Writes register
+ *
+ * @param val Value
+ * @param reg Register number (0 .. 3)
+ */
+void CPulse::writeReg(std::uint8_t val, int reg) {
+	switch (reg) {
+	case 0:
+		m_Duty = val >> 6;
+		m_Length.setHalt(val & 0x20);
+		m_Envelope.write(val);
+		break;
+	case 1:
+		m_Sweep = val;
+		m_SweepReload = true;
+		break;
+	case 2:
+		m_Reload = (m_Reload & 0x0700) | val;
+		updatePeriod();
+		break;
+	default:
+		m_Reload = (m_Reload & 0x00ff) | ((val & 0x07) << 8);
+		updatePeriod();
+		m_Length.load(val);
+		m_Step = 0;
+		m_Envelope.restart();
+		break;
+	}
+}
+
+/**
+ * Clocks length counter and sweep (half frame)
+ */
+void CPulse::clockHalf() {
+	m_Length.clock();
+	if (m_SweepDivider == 0 && (m_Sweep & 0x80) && (m_Sweep & 0x07) &&
+	    !isMuted()) {
+		m_Reload = getSweepTarget();
+		updatePeriod();
+	}
+	if (m_SweepDivider == 0 || m_SweepReload) {
+		m_SweepDivider = (m_Sweep >> 4) & 0x07;
+		m_SweepReload = false;
+	} else {
+		m_SweepDivider--;
+	}
+}
+
+/**
+ * Gets cycles till next output change
+ *
+ * Steps of equal duty level are skipped at once.
+ *
+ * @return Cycles till next change or Idle
+ */
+ticks_t CPulse::getNext() const {
+	if (!isActive()) {
+		return Idle;
+	}
+	const std::uint8_t *duty = DutyTable[m_Duty];
+	ticks_t clocks = 1;
+	while (duty[(m_Step + clocks) & 0x07] == duty[m_Step]) {
+		clocks++;
+	}
+	return m_Counter + (clocks - 1) * m_Period;
+}
+
+/* CTriangle */
+
+/**
+ * Writes register
+ *
+ * @param val Value
+ * @param reg Register number (0 .. 3)
+ */
+void CTriangle::writeReg(std::uint8_t val, int reg) {
+	switch (reg) {
+	case 0:
+		m_Control = val;
+		m_Length.setHalt(val & 0x80);
+		break;
+	case 1:
+		break;
+	case 2:
+		m_Reload = (m_Reload & 0x0700) | val;
+		m_Period = m_Reload + 1;
+		break;
+	default:
+		m_Reload = (m_Reload & 0x00ff) | ((val & 0x07) << 8);
+		m_Period = m_Reload + 1;
+		m_Length.load(val);
+		m_LinearReload = true;
+		break;
+	}
+}
+
+/**
+ * Clocks linear counter (quarter frame)
+ */
+void CTriangle::clockQuarter() {
+	if (m_LinearReload) {
+		m_Linear = m_Control & 0x7f;
+	} else if (m_Linear > 0) {
+		m_Linear--;
+	}
+	if (!(m_Control & 0x80)) {
+		m_LinearReload = false;
+	}
+}
+
+/* CNoise */
+
+/**
+ * Timer periods
+ */
+const std::uint16_t CNoise::PeriodTable[16] = {4, 8, 16, 32, 64, 96, 128, 160,
+    202, 254, 380, 508, 762, 1016, 2034, 4068};
+
+/**
+ * Writes register
+ *
+ * @param val Value
+ * @param reg Register number (0 .. 3)
+ */
+void CNoise::writeReg(std::uint8_t val, int reg) {
+	switch (reg) {
+	case 0:
+		m_Length.setHalt(val & 0x20);
+		m_Envelope.write(val);
+		break;
+	case 1:
+		break;
+	case 2:
+		m_FeedbackBit = (val & 0x80) ? 6 : 1;
+		m_Period = PeriodTable[val & 0x0f];
+		break;
+	default:
+		m_Length.load(val);
+		m_Envelope.restart();
+		break;
+	}
+}
+
+/* CDMC */
+
+/**
+ * Timer periods
+ */
+const std::uint16_t CDMC::PeriodTable[16] = {428, 380, 340, 320, 286, 254,
+    226, 214, 190, 160, 142, 128, 106, 84, 72, 54};
+
+/**
+ * Writes register
+ *
+ * @param val Value
+ * @param reg Register number (0 .. 3)
+ */
+void CDMC::writeReg(std::uint8_t val, int reg) {
+	switch (reg) {
+	case 0:
+		m_Control = val;
+		m_Period = PeriodTable[val & 0x0f];
+		break;
+	case 1:
+		m_Level = val & 0x7f;
+		break;
+	case 2:
+		m_SampleAddress = val;
+		break;
+	default:
+		m_SampleLength = val;
+		break;
+	}
+}
+
+/**
+ * Fills sample buffer with fetched byte
+ *
+ * @param val Fetched byte
+ * @return True if sample has ended and IRQ should be raised
+ */
+bool CDMC::fill(std::uint8_t val) {
+	m_Buffer = val;
+	m_BufferFull = true;
+	m_Address = (m_Address == 0xffff) ? 0x8000 : m_Address + 1;
+	if (--m_BytesRemaining == 0) {
+		if (m_Control & 0x40) {
+			restart();
+		} else {
+			return isIRQEnabled();
+		}
+	}
+	return false;
+}
+
+/**
+ * Advances the channel
+ *
+ * @param cycles Amount of CPU cycles
+ */
+void CDMC::advance(ticks_t cycles) {
+	for (ticks_t clocks = clockTimer(cycles); clocks > 0; clocks--) {
+		if (m_Silence && !m_BufferFull) {
+			// Nothing but the bit counter changes till the buffer is filled
+			m_Bits = 8 - (8 - m_Bits + clocks) % 8;
+			break;
+		}
+		if (!m_Silence) {
+			if (m_Shift & 0x01) {
+				if (m_Level <= 125) {
+					m_Level += 2;
+				}
+			} else if (m_Level >= 2) {
+				m_Level -= 2;
+			}
+			m_Shift >>= 1;
+		}
+		if (--m_Bits == 0) {
+			m_Bits = 8;
+			m_Silence = !m_BufferFull;
+			m_Shift = m_Buffer;
+			m_BufferFull = false;
+		}
+	}
+}
+
+}  // namespace apu
+
+/* CAPU */
+
+/**
+ * Frame counter step times in CPU cycles (4-step and 5-step modes)
+ */
+const ticks_t CAPU::FrameSteps[2][5] = {
+    {7457, 14913, 22371, 29829, 0}, {7457, 14913, 22371, 29829, 37281}};
+
+/**
+ * Constructs the object
+ *
+ * @param motherBoard Motherboard
+ * @param cpu CPU
+ * @param frequency Frequency
+ * @param frameTime Basic frame time
+ */
+CAPU::CAPU(CMotherBoard *motherBoard, CCPU *cpu, double frequency,
+    ticks_t frameTime)
+    : CEventDevice()
+    , m_MotherBoard(motherBoard)
+    , m_CPU(cpu)
+    , m_IOBuf()
+    , m_Time()
+    , m_Pulse{apu::CPulse(true), apu::CPulse(false)}
+    , m_Triangle()
+    , m_Noise()
+    , m_DMC()
+    , m_FrameMode()
+    , m_FrameIRQInhibit()
+    , m_FrameIRQ()
+    , m_DMCIRQ()
+    , m_FrameStep()
+    , m_FrameStart()
+    , m_FrameReset()
+    , m_FrameEvent()
+    , m_DMCEvent()
+    , m_PulseTable()
+    , m_TNDTable()
+    , m_Output()
+    , m_Blip()
+    , m_Samples() {
+	for (int i = 1; i < 31; i++) {
+		m_PulseTable[i] = static_cast<float>(95.52 / (8128.0 / i + 100.0));
+	}
+	for (int i = 1; i < 203; i++) {
+		m_TNDTable[i] = static_cast<float>(163.67 / (24329.0 / i + 100.0));
+	}
+	CFrontEnd *frontEnd = m_MotherBoard->getFrontEnd();
+	int sampleRate = frontEnd ? frontEnd->getSampleRate() : 0;
+	if (sampleRate > 0) {
+		m_Blip.reset(new CBlipBuffer(frequency, sampleRate, frameTime));
+		m_Samples.resize(m_Blip->getMaxSamples());
+	}
+	m_FrameEvent = m_MotherBoard->registerEvent(this, m_MotherBoard,
+	    "APU_FRAME", FrameSteps[0][0] * CPUCycle, true, &CAPU::handleFrame);
+	m_DMCEvent = m_MotherBoard->registerEvent(
+	    this, m_MotherBoard, "APU_DMC", 0, false, &CAPU::handleDMC);
+}
+
+/**
+ * Renders channels up to the time
+ *
+ * Each step ends at the nearest output change of an active channel, so
+ * channel levels are constant inside the step.
+ *
+ * @param time Time
+ */
+void CAPU::render(ticks_t time) {
+	ticks_t cycles = (time - m_Time) / CPUCycle;
+	while (cycles > 0) {
+		ticks_t step = std::min({cycles, m_Pulse[0].getNext(),
+		    m_Pulse[1].getNext(), m_Triangle.getNext(), m_Noise.getNext(),
+		    m_DMC.getNext()});
+		m_Pulse[0].advance(step);
+		m_Pulse[1].advance(step);
+		m_Triangle.advance(step);
+		m_Noise.advance(step);
+		m_DMC.advance(step);
+		m_Time += step * CPUCycle;
+		cycles -= step;
+		updateOutput();
+	}
+}
+
+/**
+ * Resets the clock
+ *
+ * Happens on frame end, samples of the frame are passed to front-end.
+ *
+ * @param ticks Amount of ticks
+ */
+void CAPU::resetClock(ticks_t ticks) {
+	CEventDevice::resetClock(ticks);
+	if (m_Blip) {
+		m_Blip->endFrame(ticks);
+		std::size_t count =
+		    m_Blip->readSamples(m_Samples.data(), m_Samples.size());
+		m_MotherBoard->getFrontEnd()->handleAudioSamples(
+		    m_Samples.data(), count);
+	}
+	m_Time -= ticks;
+	m_FrameStart -= ticks;
+}
+
+/**
+ * Schedules next frame counter step
+ */
+void CAPU::scheduleFrame() {
+	if (m_FrameReset) {
+		m_FrameEvent->setFireTime(m_FrameStart);
+	} else {
+		m_FrameEvent->setFireTime(
+		    m_FrameStart + FrameSteps[m_FrameMode][m_FrameStep] * CPUCycle);
+	}
+}
+
+/**
+ * Fetches DMC byte if needed and schedules buffer event
+ *
+ * @param write CPU is writing
+ */
+void CAPU::updateDMC(bool write) {
+	if (m_DMC.isFetchNeeded()) {
+		m_CPU->stall(write ? 3 : 4);
+		if (m_DMC.fill(m_MotherBoard->getBusCPU()->readMemory(
+		        m_DMC.getAddress()))) {
+			m_DMCIRQ = true;
+			m_MotherBoard->setIRQ(CMotherBoard::IRQDMC, true);
+		}
+	}
+	ticks_t bufferEnd = m_DMC.getBufferEnd();
+	if (m_DMC.isPlaying() && bufferEnd != apu::CTimer::Idle) {
+		m_DMCEvent->setFireTime(m_Time + bufferEnd * CPUCycle);
+		if (!m_DMCEvent->isEnabled()) {
+			m_DMCEvent->setEnabled(true);
+		}
+	} else if (m_DMCEvent->isEnabled()) {
+		m_DMCEvent->setEnabled(false);
+	}
+}
+
+/**
+ * Clocks envelopes and linear counter
+ */
+void CAPU::clockQuarter() {
+	m_Pulse[0].clockQuarter();
+	m_Pulse[1].clockQuarter();
+	m_Triangle.clockQuarter();
+	m_Noise.clockQuarter();
+}
+
+/**
+ * Clocks length counters and sweeps
+ */
+void CAPU::clockHalf() {
+	m_Pulse[0].clockHalf();
+	m_Pulse[1].clockHalf();
+	m_Triangle.clockHalf();
+	m_Noise.clockHalf();
+}
+
+/**
+ * Handles frame counter step
+ *
+ * @param event Event
+ */
+void CAPU::handleFrame(CMotherBoard::CEvent *event) {
+	render(event->getFireTime());
+	if (m_FrameReset) {
+		// 5-step mode clocks units when sequencer restarts
+		m_FrameReset = false;
+		if (m_FrameMode) {
+			clockQuarter();
+			clockHalf();
+		}
+		scheduleFrame();
+		updateOutput();
+		return;
+	}
+	int lastStep = m_FrameMode ? 4 : 3;
+	if (!m_FrameMode || m_FrameStep != 3) {
+		clockQuarter();
+	}
+	if (m_FrameStep == 1 || m_FrameStep == lastStep) {
+		clockHalf();
+	}
+	if (m_FrameStep == lastStep) {
+		if (!m_FrameMode && !m_FrameIRQInhibit) {
+			m_FrameIRQ = true;
+			m_MotherBoard->setIRQ(CMotherBoard::IRQFrame, true);
+		}
+		m_FrameStart += (FrameSteps[m_FrameMode][lastStep] + 1) * CPUCycle;
+		m_FrameStep = 0;
+	} else {
+		m_FrameStep++;
+	}
+	scheduleFrame();
+	updateOutput();
+}
+
+/**
+ * Handles DMC buffer being emptied
+ *
+ * @param event Event
+ */
+void CAPU::handleDMC(CMotherBoard::CEvent *event) {
+	render(event->getFireTime());
+	updateDMC();
+}
+
+/**
+ * Reads register
+ *
+ * @param addr register address
+ */
+void CAPU::readReg(std::uint16_t addr) {
+	if ((addr & 0x1f) != 0x15) {
+		return;
+	}
+	render(m_MotherBoard->getPending());
+	m_IOBuf = (m_Pulse[0].isPlaying() ? 0x01 : 0x00) |
+	          (m_Pulse[1].isPlaying() ? 0x02 : 0x00) |
+	          (m_Triangle.isPlaying() ? 0x04 : 0x00) |
+	          (m_Noise.isPlaying() ? 0x08 : 0x00) |
+	          (m_DMC.isPlaying() ? 0x10 : 0x00) | (m_FrameIRQ ? 0x40 : 0x00) |
+	          (m_DMCIRQ ? 0x80 : 0x00);
+	m_FrameIRQ = false;
+	m_MotherBoard->setIRQ(CMotherBoard::IRQFrame, false);
+}
+
+/**
+ * Writes to register
+ *
+ * @param val Value
+ * @param addr Address
+ */
+void CAPU::writeReg(std::uint8_t val, std::uint16_t addr) {
+	render(m_MotherBoard->getPending());
+	switch (addr & 0x1f) {
+	case 0x00:
+	case 0x01:
+	case 0x02:
+	case 0x03:
+		m_Pulse[0].writeReg(val, addr & 0x03);
+		break;
+	case 0x04:
+	case 0x05:
+	case 0x06:
+	case 0x07:
+		m_Pulse[1].writeReg(val, addr & 0x03);
+		break;
+	case 0x08:
+	case 0x09:
+	case 0x0a:
+	case 0x0b:
+		m_Triangle.writeReg(val, addr & 0x03);
+		break;
+	case 0x0c:
+	case 0x0d:
+	case 0x0e:
+	case 0x0f:
+		m_Noise.writeReg(val, addr & 0x03);
+		break;
+	case 0x10:
+	case 0x11:
+	case 0x12:
+	case 0x13:
+		m_DMC.writeReg(val, addr & 0x03);
+		if (!m_DMC.isIRQEnabled()) {
+			m_DMCIRQ = false;
+			m_MotherBoard->setIRQ(CMotherBoard::IRQDMC, false);
+		}
+		updateDMC(true);
+		break;
+	case 0x15:
+		m_Pulse[0].setEnabled(val & 0x01);
+		m_Pulse[1].setEnabled(val & 0x02);
+		m_Triangle.setEnabled(val & 0x04);
+		m_Noise.setEnabled(val & 0x08);
+		m_DMC.setEnabled(val & 0x10);
+		m_DMCIRQ = false;
+		m_MotherBoard->setIRQ(CMotherBoard::IRQDMC, false);
+		updateDMC(true);
+		break;
+	case 0x17:
+		m_FrameMode = val & 0x80;
+		m_FrameIRQInhibit = val & 0x40;
+		if (m_FrameIRQInhibit) {
+			m_FrameIRQ = false;
+			m_MotherBoard->setIRQ(CMotherBoard::IRQFrame, false);
+		}
+		// Sequencer restarts 3 or 4 cycles later depending on APU cycle
+		m_FrameStart =
+		    m_Time +
+		    (((m_MotherBoard->getElapsedTicks() / CPUCycle) & 1) ? 4 : 3) *
+		        CPUCycle;
+		m_FrameStep = 0;
+		m_FrameReset = true;
+		scheduleFrame();
+		break;
+	default:
+		break;
+	}
+	updateOutput();
+}
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,291 @@
+/**
+ * @file
+ *
+ * Implements compressed ROM containers
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/archive.hpp>
+#include <vpnes/core/crc32.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace archive {
+
+/**
+ * Zip record signatures
+ */
+enum {
+	ZipLocalHeader = 0x04034b50,   //!< Local file header
+	ZipCentralHeader = 0x02014b50,  //!< Central directory header
+	ZipEndRecord = 0x06054b50       //!< End of central directory
+};
+
+/**
+ * Largest output we preallocate from sizes stored in archive
+ */
+static const std::size_t MaxPreallocated = 0x4000000;
+
+/**
+ * Checks that the range is inside the data
+ *
+ * @param size Data size
+ * @param offset Range offset
+ * @param bytes Range size
+ */
+static void checkRange(std::size_t size, std::size_t offset, std::size_t bytes) {
+	if (offset > size || bytes > size - offset) {
+		throw std::invalid_argument("Corrupted archive");
+	}
+}
+
+/**
+ * Reads little-endian value with bounds check
+ *
+ * @param data Data
+ * @param size Data size
+ * @param offset Value offset
+ * @param bytes Value size
+ * @return Value
+ */
+static std::uint32_t readValue(const std::uint8_t *data, std::size_t size,
+    std::size_t offset, std::size_t bytes) {
+	checkRange(size, offset, bytes);
+	std::uint32_t value = 0;
+	for (std::size_t i = 0; i < bytes; i++) {
+		value |= static_cast<std::uint32_t>(data[offset + i]) << (i * 8);
+	}
+	return value;
+}
+
+/**
+ * Checks if the name has .nes extension
+ *
+ * @param name Name
+ * @param length Name length
+ * @return True if ROM
+ */
+static bool isROMName(const std::uint8_t *name, std::size_t length) {
+	const char extension[] = ".nes";
+	if (length < 4) {
+		return false;
+	}
+	for (std::size_t i = 0; i < 4; i++) {
+		if (std::tolower(name[length - 4 + i]) != extension[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Inflates deflate or gzip stream into output buffer
+ *
+ * Output grows if it is too small.
+ *
+ * @param data Compressed data
+ * @param size Compressed size
+ * @param gzip Data is gzip stream (raw deflate otherwise)
+ * @param output Output buffer
+ */
+static void inflateData(const std::uint8_t *data, std::size_t size, bool gzip,
+    std::vector<std::uint8_t> *output) {
+#if defined(HAVE_ZLIB)
+	::z_stream stream;
+	std::memset(&stream, 0, sizeof(stream));
+	if (::inflateInit2(&stream, gzip ? 16 + MAX_WBITS : -MAX_WBITS) != Z_OK) {
+		throw std::runtime_error("Could not initialize zlib");
+	}
+	if (output->empty()) {
+		output->resize(size * 2 + 0x4000);
+	}
+	stream.next_in = const_cast<::Bytef *>(data);
+	stream.avail_in = static_cast<::uInt>(size);
+	int result;
+	do {
+		if (stream.total_out == output->size()) {
+			output->resize(output->size() * 2);
+		}
+		stream.next_out = output->data() + stream.total_out;
+		stream.avail_out =
+		    static_cast<::uInt>(output->size() - stream.total_out);
+		result = ::inflate(&stream, Z_NO_FLUSH);
+	} while (result == Z_OK);
+	output->resize(stream.total_out);
+	output->shrink_to_fit();
+	::inflateEnd(&stream);
+	if (result != Z_STREAM_END) {
+		throw std::invalid_argument("Corrupted archive");
+	}
+#else
+	throw std::invalid_argument("Compressed ROMs are not supported");
+#endif
+}
+
+/**
+ * Extracts ROM from gzip stream
+ *
+ * @param data File data
+ * @param size File size
+ * @return ROM file data
+ */
+static std::vector<std::uint8_t> extractGzip(
+    const std::uint8_t *data, std::size_t size) {
+	std::vector<std::uint8_t> output;
+	// Trailer keeps uncompressed size modulo 2^32
+	std::size_t expected = readValue(data, size, size - 4, 4);
+	if (expected > 0 && expected <= MaxPreallocated) {
+		output.resize(expected);
+	}
+	inflateData(data, size, true, &output);
+	return output;
+}
+
+/**
+ * Extracts first ROM from zip archive
+ *
+ * @param data File data
+ * @param size File size
+ * @return ROM file data
+ */
+static std::vector<std::uint8_t> extractZip(
+    const std::uint8_t *data, std::size_t size) {
+	if (size < 22) {
+		throw std::invalid_argument("Corrupted archive");
+	}
+	// End record is followed by a comment of up to 64 KB
+	std::size_t end = size - 22;
+	std::size_t last = end > 0xffff ? end - 0xffff : 0;
+	while (readValue(data, size, end, 4) != ZipEndRecord) {
+		if (end == last) {
+			throw std::invalid_argument("Corrupted archive");
+		}
+		end--;
+	}
+	std::size_t entries = readValue(data, size, end + 10, 2);
+	std::size_t offset = readValue(data, size, end + 16, 4);
+	for (std::size_t i = 0; i < entries; i++) {
+		if (readValue(data, size, offset, 4) != ZipCentralHeader) {
+			throw std::invalid_argument("Corrupted archive");
+		}
+		std::size_t flags = readValue(data, size, offset + 8, 2);
+		std::size_t method = readValue(data, size, offset + 10, 2);
+		std::uint32_t crc = readValue(data, size, offset + 16, 4);
+		std::size_t packedSize = readValue(data, size, offset + 20, 4);
+		std::size_t unpackedSize = readValue(data, size, offset + 24, 4);
+		std::size_t nameLength = readValue(data, size, offset + 28, 2);
+		std::size_t extraLength = readValue(data, size, offset + 30, 2);
+		std::size_t commentLength = readValue(data, size, offset + 32, 2);
+		std::size_t local = readValue(data, size, offset + 42, 4);
+		checkRange(size, offset + 46, nameLength);
+		if (!isROMName(data + offset + 46, nameLength)) {
+			offset += 46 + nameLength + extraLength + commentLength;
+			continue;
+		}
+		if ((flags & 0x01) || packedSize == 0xffffffff ||
+		    unpackedSize == 0xffffffff || (method != 0 && method != 8)) {
+			throw std::invalid_argument("Unsupported zip archive");
+		}
+		if (readValue(data, size, local, 4) != ZipLocalHeader) {
+			throw std::invalid_argument("Corrupted archive");
+		}
+		std::size_t start = local + 30 + readValue(data, size, local + 26, 2) +
+		                    readValue(data, size, local + 28, 2);
+		checkRange(size, start, packedSize);
+		std::vector<std::uint8_t> output;
+		if (method == 0) {
+			output.assign(data + start, data + start + packedSize);
+		} else {
+			// Stored size is checked after inflating, output grows on demand
+			if (unpackedSize > 0 && unpackedSize <= MaxPreallocated) {
+				output.resize(unpackedSize);
+			}
+			inflateData(data + start, packedSize, false, &output);
+		}
+		if (output.size() != unpackedSize ||
+		    updateCRC32(0, output.data(), output.size()) != crc) {
+			throw std::invalid_argument("Corrupted archive");
+		}
+		return output;
+	}
+	throw std::invalid_argument("No ROM in archive");
+}
+
+/**
+ * Detects container by its signature
+ *
+ * @param data File data
+ * @param size File size
+ * @return Container type
+ */
+EContainer detectContainer(const std::uint8_t *data, std::size_t size) {
+	if (size >= 18 && data[0] == 0x1f && data[1] == 0x8b) {
+		return ContainerGzip;
+	}
+	if (size >= 22 && readValue(data, size, 0, 4) == ZipLocalHeader) {
+		return ContainerZip;
+	}
+	return ContainerNone;
+}
+
+/**
+ * Decompresses ROM from container
+ *
+ * For zip archives the first entry with .nes extension is taken. Data is
+ * inflated directly from the input into the returned buffer.
+ *
+ * @param data File data
+ * @param size File size
+ * @return ROM file data
+ */
+std::vector<std::uint8_t> extractROM(
+    const std::uint8_t *data, std::size_t size) {
+	switch (detectContainer(data, size)) {
+	case ContainerGzip:
+		return extractGzip(data, size);
+	case ContainerZip:
+		return extractZip(data, size);
+	default:
+		return std::vector<std::uint8_t>(data, data + size);
+	}
+}
+
+}  // namespace archive
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,146 @@
+/**
+ * @file
+ *
+ * Implements audio sample queue and rate-controlled resampler
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/audioring.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/* CAudioRing */
+
+/**
+ * Constructs the object
+ *
+ * @param capacity Minimal capacity
+ */
+CAudioRing::CAudioRing(std::size_t capacity)
+    : m_Samples()
+    , m_Capacity(1)
+    , m_Head(0)
+    , m_Tail(0) {
+	while (m_Capacity < capacity) {
+		m_Capacity <<= 1;
+	}
+	m_Samples.reset(new std::int16_t[m_Capacity]);
+}
+
+/**
+ * Pushes samples, never blocks (called by producer)
+ *
+ * @param samples Samples
+ * @param count Amount of samples
+ * @return Amount of pushed samples
+ */
+std::size_t CAudioRing::push(const std::int16_t *samples, std::size_t count) {
+	std::size_t head = m_Head.load(std::memory_order_relaxed);
+	std::size_t tail = m_Tail.load(std::memory_order_acquire);
+	count = std::min(count, m_Capacity - (head - tail));
+	std::size_t pos = head & (m_Capacity - 1);
+	std::size_t first = std::min(count, m_Capacity - pos);
+	std::memcpy(m_Samples.get() + pos, samples, first * sizeof(std::int16_t));
+	std::memcpy(m_Samples.get(), samples + first,
+	    (count - first) * sizeof(std::int16_t));
+	m_Head.store(head + count, std::memory_order_release);
+	return count;
+}
+
+/**
+ * Pops samples, never blocks (called by consumer)
+ *
+ * @param samples Output buffer
+ * @param count Amount of requested samples
+ * @return Amount of popped samples
+ */
+std::size_t CAudioRing::pop(std::int16_t *samples, std::size_t count) {
+	std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+	std::size_t head = m_Head.load(std::memory_order_acquire);
+	count = std::min(count, head - tail);
+	std::size_t pos = tail & (m_Capacity - 1);
+	std::size_t first = std::min(count, m_Capacity - pos);
+	std::memcpy(samples, m_Samples.get() + pos, first * sizeof(std::int16_t));
+	std::memcpy(samples + first, m_Samples.get(),
+	    (count - first) * sizeof(std::int16_t));
+	m_Tail.store(tail + count, std::memory_order_release);
+	return count;
+}
+
+/* CAudioResampler */
+
+/**
+ * Gets current resampling ratio
+ *
+ * A queue below its set point gets slightly more samples and a queue above
+ * it slightly less.
+ *
+ * @return Output samples per input sample
+ */
+double CAudioResampler::getRatio() const {
+	double error =
+	    std::max(-1.0, std::min(1.0, (m_SetPoint - m_Level) / m_SetPoint));
+	return 1.0 + MaxRateDelta * error;
+}
+
+/**
+ * Resamples input
+ *
+ * @param samples Input samples
+ * @param count Amount of input samples
+ * @param level Current fill level of the queue
+ * @param output Resampled samples (replaced)
+ */
+void CAudioResampler::resample(const std::int16_t *samples, std::size_t count,
+    std::size_t level, std::vector<std::int16_t> *output) {
+	output->clear();
+	if (count == 0) {
+		return;
+	}
+	m_Level += (level - m_Level) / LevelSmoothing;
+	double step = 1.0 / getRatio();
+	double pos = m_Phase;
+	while (pos < count) {
+		std::size_t index = static_cast<std::size_t>(pos);
+		double prev = index > 0 ? samples[index - 1] : m_Last;
+		output->push_back(static_cast<std::int16_t>(
+		    std::lround(prev + (samples[index] - prev) * (pos - index))));
+		pos += step;
+	}
+	m_Phase = pos - count;
+	m_Last = samples[count - 1];
+}
+
+}  // namespace core
+
+}  // namespace vpnes
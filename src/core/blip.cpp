@@ -0,0 +1,181 @@
+/**
+ * @file
+ *
+ * Implements band-limited step buffer
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(__AVX__)
+#define VPNES_BLIP_AVX
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define VPNES_BLIP_SSE
+#include <xmmintrin.h>
+#endif
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/blip.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/* CBlipBuffer */
+
+/**
+ * Constructs the object
+ *
+ * @param frequency Clock frequency (milliseconds per tick)
+ * @param sampleRate Sample rate
+ * @param maxFrameTime Longest frame in ticks
+ */
+CBlipBuffer::CBlipBuffer(
+    double frequency, int sampleRate, ticks_t maxFrameTime)
+    : m_Kernel()
+    , m_Factor(static_cast<std::int64_t>(sampleRate * frequency / 1000.0 *
+                                         (std::int64_t(1) << FracBits)))
+    , m_Offset()
+    , m_Buffer()
+    , m_Integrator()
+    , m_DCLevel()
+    , m_HighPass()
+    , m_SampleRate(sampleRate)
+    , m_MaxFrameTime(maxFrameTime) {
+	if (sampleRate <= 0) {
+		throw std::invalid_argument("Invalid sample rate");
+	}
+	if (maxFrameTime <= 0) {
+		throw std::invalid_argument("Invalid frame time");
+	}
+	const double pi = std::acos(-1.0);
+	// Cut off slightly below Nyquist frequency, window keeps ripple low
+	const double cutoff = 0.9;
+	for (int phase = 0; phase < PhaseCount; phase++) {
+		double impulse[KernelSize];
+		double sum = 0.0;
+		for (int i = 0; i < KernelSize; i++) {
+			double x = i - (KernelSize / 2 - 1) -
+			           static_cast<double>(phase) / PhaseCount;
+			double w = x / (KernelSize / 2);
+			double window = 0.42 + 0.5 * std::cos(pi * w) +
+			                0.08 * std::cos(2.0 * pi * w);
+			double sinc =
+			    (x == 0.0) ? cutoff : std::sin(pi * cutoff * x) / (pi * x);
+			impulse[i] = sinc * window;
+			sum += impulse[i];
+		}
+		// Each impulse integrates into a unit step
+		for (int i = 0; i < KernelSize; i++) {
+			m_Kernel[phase][i] = static_cast<float>(impulse[i] / sum);
+		}
+	}
+	// DC blocker at 20 Hz
+	m_HighPass =
+	    static_cast<float>(1.0 - std::exp(-2.0 * pi * 20.0 / sampleRate));
+	m_Buffer.assign(getMaxSamples() + KernelSize + 2, 0.0f);
+}
+
+/**
+ * Adds amplitude change
+ *
+ * Impulse starts one sample after the position, so slightly negative time
+ * does not touch already finished samples. Buffer holds a frame of the
+ * longest length and impulses of the previous frame, so time must not
+ * exceed it.
+ *
+ * @param time Time relative to frame start (may be slightly negative)
+ * @param delta Amplitude delta
+ */
+void CBlipBuffer::addDelta(ticks_t time, float delta) {
+	std::int64_t pos =
+	    m_Offset + time * m_Factor + (std::int64_t(1) << FracBits);
+	assert(pos >= 0);
+	std::size_t index = static_cast<std::size_t>(pos >> FracBits);
+	assert(time <= m_MaxFrameTime);
+	assert(index + KernelSize <= m_Buffer.size());
+	const float *kernel =
+	    m_Kernel[(pos >> (FracBits - PhaseBits)) & (PhaseCount - 1)];
+	float *out = m_Buffer.data() + index;
+#if defined(VPNES_BLIP_AVX)
+	__m256 scale = _mm256_set1_ps(delta);
+	for (int i = 0; i < KernelSize; i += 8) {
+		_mm256_storeu_ps(out + i,
+		    _mm256_add_ps(_mm256_loadu_ps(out + i),
+		        _mm256_mul_ps(scale, _mm256_loadu_ps(kernel + i))));
+	}
+#elif defined(VPNES_BLIP_SSE)
+	__m128 scale = _mm_set1_ps(delta);
+	for (int i = 0; i < KernelSize; i += 4) {
+		_mm_storeu_ps(out + i,
+		    _mm_add_ps(_mm_loadu_ps(out + i),
+		        _mm_mul_ps(scale, _mm_loadu_ps(kernel + i))));
+	}
+#else
+	for (int i = 0; i < KernelSize; i++) {
+		out[i] += delta * kernel[i];
+	}
+#endif
+}
+
+/**
+ * Reads available samples
+ *
+ * Impulses are integrated into steps and DC level is removed.
+ *
+ * @param samples Output buffer
+ * @param count Buffer size
+ * @return Amount of read samples
+ */
+std::size_t CBlipBuffer::readSamples(std::int16_t *samples, std::size_t count) {
+	std::size_t available = getAvailable();
+	if (count > available) {
+		count = available;
+	}
+	for (std::size_t i = 0; i < count; i++) {
+		m_Integrator += m_Buffer[i];
+		float sample = m_Integrator - m_DCLevel;
+		m_DCLevel += sample * m_HighPass;
+		sample = std::min(std::max(sample * 32767.0f, -32768.0f), 32767.0f);
+		samples[i] = static_cast<std::int16_t>(sample);
+	}
+	// Impulses of pending deltas end at most KernelSize samples later
+	std::size_t used = std::min(available + KernelSize + 1, m_Buffer.size());
+	std::copy(m_Buffer.begin() + count, m_Buffer.begin() + used,
+	    m_Buffer.begin());
+	std::fill(m_Buffer.begin() + (used - count), m_Buffer.begin() + used,
+	    0.0f);
+	m_Offset -= static_cast<std::int64_t>(count) << FracBits;
+	return count;
+}
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,652 @@
+/**
+ * @file
+ *
+ * Implements conditional breakpoints
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cassert>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/breakpoint.hpp>
+#include <vpnes/core/debugger.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/* CExpression::CParser */
+
+/**
+ * Recursive-descent compiler
+ */
+class CExpression::CParser {
+private:
+	/**
+	 * Maximum nesting of unary operators and brackets
+	 */
+	enum { MaxNesting = 64 };
+
+	/**
+	 * Source
+	 */
+	const std::string &m_Source;
+	/**
+	 * Current position
+	 */
+	std::size_t m_Pos;
+	/**
+	 * Compiled expression
+	 */
+	CExpression *m_Expression;
+	/**
+	 * Current stack depth
+	 */
+	std::size_t m_Depth;
+	/**
+	 * Current nesting
+	 */
+	std::size_t m_Nesting;
+
+	/**
+	 * Throws compilation error
+	 *
+	 * @param message Message
+	 */
+	[[noreturn]] void fail(const char *message) {
+		throw std::invalid_argument(std::string(message) + " at position " +
+		                            std::to_string(m_Pos) + " in \"" +
+		                            m_Source + "\"");
+	}
+	/**
+	 * Skips white space
+	 */
+	void skipSpace() {
+		while (m_Pos < m_Source.size() &&
+		       std::isspace(static_cast<unsigned char>(m_Source[m_Pos]))) {
+			m_Pos++;
+		}
+	}
+	/**
+	 * Consumes a token if it is next
+	 *
+	 * @param token Token
+	 * @return True if consumed
+	 */
+	bool accept(const char *token) {
+		skipSpace();
+		std::size_t length = std::char_traits<char>::length(token);
+		if (m_Source.compare(m_Pos, length, token) != 0) {
+			return false;
+		}
+		if (std::isalpha(static_cast<unsigned char>(token[0])) &&
+		    m_Pos + length < m_Source.size() &&
+		    std::isalnum(static_cast<unsigned char>(m_Source[m_Pos + length]))) {
+			return false;
+		}
+		m_Pos += length;
+		return true;
+	}
+	/**
+	 * Emits an instruction
+	 *
+	 * @param operation Operation
+	 * @param operand Constant operand
+	 */
+	void emit(EOperation operation, std::int64_t operand = 0) {
+		switch (operation) {
+		case OpConst:
+		case OpValue:
+		case OpAddress:
+		case OpCycles:
+		case OpRegA:
+		case OpRegX:
+		case OpRegY:
+		case OpRegS:
+		case OpRegP:
+		case OpRegPC:
+			if (++m_Depth > MaxStack) {
+				fail("Expression is too complex");
+			}
+			break;
+		case OpMemory:
+		case OpNot:
+		case OpNegate:
+			break;
+		default:
+			m_Depth--;
+			break;
+		}
+		m_Expression->m_Code.push_back({operation, operand});
+	}
+	/**
+	 * Parses a number
+	 */
+	void parseNumber() {
+		int base = 10;
+		if (m_Source[m_Pos] == '$') {
+			base = 16;
+			m_Pos++;
+		} else if (m_Source.compare(m_Pos, 2, "0x") == 0 ||
+		           m_Source.compare(m_Pos, 2, "0X") == 0) {
+			base = 16;
+			m_Pos += 2;
+		}
+		std::size_t start = m_Pos;
+		std::int64_t value = 0;
+		while (m_Pos < m_Source.size() &&
+		       std::isxdigit(static_cast<unsigned char>(m_Source[m_Pos]))) {
+			char c = std::tolower(static_cast<unsigned char>(m_Source[m_Pos]));
+			int digit = std::isdigit(static_cast<unsigned char>(c))
+			                ? c - '0'
+			                : c - 'a' + 10;
+			if (digit >= base) {
+				break;
+			}
+			if (value > (std::numeric_limits<std::int64_t>::max() - digit) /
+			                base) {
+				fail("Number is too large");
+			}
+			value = value * base + digit;
+			m_Pos++;
+		}
+		if (m_Pos == start) {
+			fail("Number expected");
+		}
+		emit(OpConst, value);
+	}
+	/**
+	 * Parses an operand
+	 */
+	void parsePrimary() {
+		static const struct {
+			const char *Name;
+			EOperation Operation;
+		} names[] = {
+		    {"value", OpValue},
+		    {"addr", OpAddress},
+		    {"cycles", OpCycles},
+		    {"pc", OpRegPC},
+		    {"a", OpRegA},
+		    {"x", OpRegX},
+		    {"y", OpRegY},
+		    {"s", OpRegS},
+		    {"p", OpRegP},
+		};
+		skipSpace();
+		if (m_Pos >= m_Source.size()) {
+			fail("Operand expected");
+		}
+		if (accept("(")) {
+			parseOr();
+			if (!accept(")")) {
+				fail("')' expected");
+			}
+			return;
+		}
+		if (accept("[")) {
+			parseOr();
+			if (!accept("]")) {
+				fail("']' expected");
+			}
+			emit(OpMemory);
+			m_Expression->m_UsesDebugger = true;
+			return;
+		}
+		if (std::isdigit(static_cast<unsigned char>(m_Source[m_Pos])) ||
+		    m_Source[m_Pos] == '$') {
+			parseNumber();
+			return;
+		}
+		for (const auto &name : names) {
+			if (accept(name.Name)) {
+				if (name.Operation >= OpRegA && name.Operation <= OpRegPC) {
+					m_Expression->m_UsesRegisters = true;
+				}
+				if (name.Operation >= OpCycles &&
+				    name.Operation <= OpRegPC) {
+					m_Expression->m_UsesDebugger = true;
+				}
+				emit(name.Operation);
+				return;
+			}
+		}
+		fail("Unknown operand");
+	}
+	/**
+	 * Parses unary operators
+	 */
+	void parseUnary() {
+		if (++m_Nesting > MaxNesting) {
+			fail("Expression is too deep");
+		}
+		if (accept("!")) {
+			parseUnary();
+			emit(OpNot);
+		} else if (accept("-")) {
+			parseUnary();
+			emit(OpNegate);
+		} else {
+			parsePrimary();
+		}
+		m_Nesting--;
+	}
+	/**
+	 * Parses addition and subtraction
+	 */
+	void parseSum() {
+		parseUnary();
+		for (;;) {
+			if (accept("+")) {
+				parseUnary();
+				emit(OpAdd);
+			} else if (accept("-")) {
+				parseUnary();
+				emit(OpSubtract);
+			} else {
+				break;
+			}
+		}
+	}
+	/**
+	 * Parses bitwise and
+	 */
+	void parseBitAnd() {
+		parseSum();
+		while (!lookAhead("&&") && accept("&")) {
+			parseSum();
+			emit(OpBitAnd);
+		}
+	}
+	/**
+	 * Parses bitwise xor
+	 */
+	void parseBitXor() {
+		parseBitAnd();
+		while (accept("^")) {
+			parseBitAnd();
+			emit(OpBitXor);
+		}
+	}
+	/**
+	 * Parses bitwise or
+	 */
+	void parseBitOr() {
+		parseBitXor();
+		while (!lookAhead("||") && accept("|")) {
+			parseBitXor();
+			emit(OpBitOr);
+		}
+	}
+	/**
+	 * Checks next token without consuming it
+	 *
+	 * @param token Token
+	 * @return True if token is next
+	 */
+	bool lookAhead(const char *token) {
+		skipSpace();
+		return m_Source.compare(
+		           m_Pos, std::char_traits<char>::length(token), token) == 0;
+	}
+	/**
+	 * Parses comparison
+	 */
+	void parseCompare() {
+		static const struct {
+			const char *Token;
+			EOperation Operation;
+		} operators[] = {
+		    {"==", OpEqual},
+		    {"!=", OpNotEqual},
+		    {"<=", OpLessEqual},
+		    {">=", OpGreaterEqual},
+		    {"<", OpLess},
+		    {">", OpGreater},
+		};
+		parseBitOr();
+		for (const auto &op : operators) {
+			if (accept(op.Token)) {
+				parseBitOr();
+				emit(op.Operation);
+				return;
+			}
+		}
+	}
+	/**
+	 * Parses logical and
+	 */
+	void parseAnd() {
+		parseCompare();
+		while (accept("&&") || accept("and")) {
+			parseCompare();
+			emit(OpAnd);
+		}
+	}
+	/**
+	 * Parses logical or
+	 */
+	void parseOr() {
+		parseAnd();
+		while (accept("||") || accept("or")) {
+			parseAnd();
+			emit(OpOr);
+		}
+	}
+
+public:
+	/**
+	 * Constructs the object
+	 *
+	 * @param source Source
+	 * @param expression Compiled expression
+	 */
+	CParser(const std::string &source, CExpression *expression)
+	    : m_Source(source)
+	    , m_Pos(0)
+	    , m_Expression(expression)
+	    , m_Depth(0)
+	    , m_Nesting(0) {
+	}
+
+	/**
+	 * Compiles the source
+	 */
+	void compile() {
+		skipSpace();
+		if (m_Pos == m_Source.size()) {
+			emit(OpConst, 1);
+			return;
+		}
+		parseOr();
+		skipSpace();
+		if (m_Pos != m_Source.size()) {
+			fail("Unexpected symbol");
+		}
+		assert(m_Depth == 1);
+	}
+};
+
+/* CExpression */
+
+/**
+ * Converts result of unsigned arithmetic back to signed value
+ *
+ * @param value Unsigned value
+ * @return Two's complement value
+ */
+static std::int64_t wrap(std::uint64_t value) {
+	return static_cast<std::int64_t>(value);
+}
+
+/**
+ * Compiles the condition
+ *
+ * @param source Condition source
+ */
+CExpression::CExpression(const std::string &source)
+    : m_Code(), m_UsesRegisters(false), m_UsesDebugger(false) {
+	std::string lowerSource(source);
+	std::transform(lowerSource.begin(), lowerSource.end(),
+	    lowerSource.begin(),
+	    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	CParser(lowerSource, this).compile();
+}
+
+/**
+ * Evaluates the condition
+ *
+ * @param context Access data
+ * @return Result
+ */
+std::int64_t CExpression::evaluate(const SBreakContext &context) const {
+	std::int64_t stack[MaxStack];
+	std::int64_t *top = stack - 1;
+	SCPURegisters registers{};
+	if (m_UsesDebugger && context.Debugger == nullptr) {
+		throw std::invalid_argument("Condition needs debugger");
+	}
+	if (m_UsesRegisters) {
+		registers = context.Debugger->getCPURegisters();
+	}
+	for (const SInstruction &instruction : m_Code) {
+		switch (instruction.Operation) {
+		case OpConst:
+			*++top = instruction.Operand;
+			break;
+		case OpValue:
+			*++top = context.Value;
+			break;
+		case OpAddress:
+			*++top = context.Address;
+			break;
+		case OpCycles:
+			*++top = context.Debugger->getElapsedTicks() /
+			         context.Debugger->getCPUDivider();
+			break;
+		case OpRegA:
+			*++top = registers.A;
+			break;
+		case OpRegX:
+			*++top = registers.X;
+			break;
+		case OpRegY:
+			*++top = registers.Y;
+			break;
+		case OpRegS:
+			*++top = registers.S;
+			break;
+		case OpRegP:
+			*++top = registers.P;
+			break;
+		case OpRegPC:
+			*++top = registers.PC;
+			break;
+		case OpMemory:
+			*top = context.Debugger->directCPURead(
+			    static_cast<std::uint16_t>(*top));
+			break;
+		case OpNot:
+			*top = !*top;
+			break;
+		case OpNegate:
+			*top = wrap(0 - static_cast<std::uint64_t>(*top));
+			break;
+		case OpAdd:
+			top--;
+			top[0] = wrap(static_cast<std::uint64_t>(top[0]) +
+			              static_cast<std::uint64_t>(top[1]));
+			break;
+		case OpSubtract:
+			top--;
+			top[0] = wrap(static_cast<std::uint64_t>(top[0]) -
+			              static_cast<std::uint64_t>(top[1]));
+			break;
+		case OpBitAnd:
+			top--;
+			top[0] &= top[1];
+			break;
+		case OpBitOr:
+			top--;
+			top[0] |= top[1];
+			break;
+		case OpBitXor:
+			top--;
+			top[0] ^= top[1];
+			break;
+		case OpEqual:
+			top--;
+			top[0] = top[0] == top[1];
+			break;
+		case OpNotEqual:
+			top--;
+			top[0] = top[0] != top[1];
+			break;
+		case OpLess:
+			top--;
+			top[0] = top[0] < top[1];
+			break;
+		case OpLessEqual:
+			top--;
+			top[0] = top[0] <= top[1];
+			break;
+		case OpGreater:
+			top--;
+			top[0] = top[0] > top[1];
+			break;
+		case OpGreaterEqual:
+			top--;
+			top[0] = top[0] >= top[1];
+			break;
+		case OpAnd:
+			top--;
+			top[0] = top[0] && top[1];
+			break;
+		case OpOr:
+			top--;
+			top[0] = top[0] || top[1];
+			break;
+		}
+	}
+	return *top;
+}
+
+/* CBreakpoints */
+
+/**
+ * Checks breakpoints for watched access
+ *
+ * @param type Access type
+ * @param addr Address
+ * @param val Value
+ */
+void CBreakpoints::check(
+    EWatchType type, std::uint16_t addr, std::uint8_t val) {
+	const std::vector<SSegment> &segments = m_Segments[type];
+	auto segment = std::upper_bound(segments.begin(), segments.end(), addr,
+	    [](std::uint16_t addr, const SSegment &segment) {
+		    return addr < segment.First;
+	    });
+	if (segment == segments.begin()) {
+		return;
+	}
+	--segment;
+	SBreakContext context{m_Debugger, addr, val};
+	for (std::size_t index : segment->Breakpoints) {
+		const SBreakpoint &breakpoint = m_Breakpoints[index];
+		if (breakpoint.Condition.evaluate(context)) {
+			breakpoint.Handler(breakpoint.Id, addr, val);
+		}
+	}
+}
+
+/**
+ * Rebuilds watchpoint bitmaps and address segments
+ *
+ * Segments start at every first address and after every last address, so
+ * each of them is covered by the same breakpoints throughout.
+ */
+void CBreakpoints::updateWatches() {
+	CBusWatch *watch = m_Debugger->getWatchCPU();
+	watch->clearWatches(WatchLayerBreakpoints);
+	for (std::size_t type = 0; type < WatchTypes; type++) {
+		std::vector<std::uint32_t> bounds;
+		for (const SBreakpoint &breakpoint : m_Breakpoints) {
+			if (breakpoint.Type == type) {
+				bounds.push_back(breakpoint.First);
+				bounds.push_back(breakpoint.Last + 1u);
+			}
+		}
+		std::sort(bounds.begin(), bounds.end());
+		bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+		std::vector<SSegment> &segments = m_Segments[type];
+		segments.clear();
+		for (std::uint32_t first : bounds) {
+			segments.push_back({first, {}});
+			for (std::size_t i = 0; i < m_Breakpoints.size(); i++) {
+				const SBreakpoint &breakpoint = m_Breakpoints[i];
+				if (breakpoint.Type == type && first >= breakpoint.First &&
+				    first <= breakpoint.Last) {
+					segments.back().Breakpoints.push_back(i);
+				}
+			}
+		}
+	}
+	for (const SBreakpoint &breakpoint : m_Breakpoints) {
+		watch->setWatch(breakpoint.Type, breakpoint.First, breakpoint.Last,
+		    true, WatchLayerBreakpoints);
+	}
+	watch->setHandler(
+	    [this](EWatchType type, std::uint16_t addr, std::uint8_t val) {
+		    check(type, addr, val);
+	    },
+	    WatchLayerBreakpoints);
+}
+
+/**
+ * Adds a breakpoint
+ *
+ * @param type Access type
+ * @param first First address
+ * @param last Last address (inclusive)
+ * @param condition Condition source
+ * @param handler Handler called when condition holds
+ * @return Breakpoint identifier
+ */
+std::size_t CBreakpoints::add(EWatchType type, std::uint16_t first,
+    std::uint16_t last, const std::string &condition, handler_t handler) {
+	if (first > last) {
+		throw std::invalid_argument("Invalid breakpoint range");
+	}
+	m_Breakpoints.push_back(
+	    {m_NextId, type, first, last, CExpression(condition), handler});
+	updateWatches();
+	return m_NextId++;
+}
+
+/**
+ * Removes a breakpoint
+ *
+ * @param id Breakpoint identifier
+ */
+void CBreakpoints::remove(std::size_t id) {
+	m_Breakpoints.erase(std::remove_if(m_Breakpoints.begin(),
+	                        m_Breakpoints.end(),
+	                        [id](const SBreakpoint &breakpoint) {
+		                        return breakpoint.Id == id;
+	                        }),
+	    m_Breakpoints.end());
+	updateWatches();
+}
+
+}  // namespace core
+
+}  // namespace vpnes
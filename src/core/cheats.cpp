@@ -0,0 +1,132 @@
+/**
+ * @file
+ *
+ * Implements cheat codes
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/cheats.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Game Genie alphabet
+ */
+static const char GameGenieLetters[] = "APZLGITYEOXUKSVN";
+
+/**
+ * Decodes Game Genie code
+ *
+ * @param code Upper case code of 6 or 8 letters
+ * @return Decoded cheat
+ */
+static SCheatCode decodeGameGenie(const std::string &code) {
+	unsigned n[8];
+	for (std::size_t i = 0; i < code.size(); i++) {
+		const char *letter = std::strchr(GameGenieLetters, code[i]);
+		if (!letter || !*letter) {
+			throw std::invalid_argument("Invalid Game Genie code " + code);
+		}
+		n[i] = static_cast<unsigned>(letter - GameGenieLetters);
+	}
+	unsigned address = 0x8000 | ((n[3] & 7) << 12) | ((n[4] & 8) << 8) |
+	                   ((n[5] & 7) << 8) | ((n[1] & 8) << 4) |
+	                   ((n[2] & 7) << 4) | (n[3] & 8) | (n[4] & 7);
+	unsigned value = ((n[1] & 7) << 4) | ((n[0] & 8) << 4) | (n[0] & 7);
+	int compare = -1;
+	if (code.size() == 6) {
+		value |= n[5] & 8;
+	} else {
+		value |= n[7] & 8;
+		compare = static_cast<int>(((n[7] & 7) << 4) | ((n[6] & 8) << 4) |
+		                           (n[6] & 7) | (n[5] & 8));
+	}
+	return {static_cast<std::uint16_t>(address),
+	    static_cast<std::uint8_t>(value), compare};
+}
+
+/**
+ * Parses hexadecimal number
+ *
+ * @param code Upper case cheat code
+ * @param first First character
+ * @param size Amount of digits
+ * @return Value
+ */
+static unsigned parseHex(
+    const std::string &code, std::size_t first, std::size_t size) {
+	unsigned value = 0;
+	for (std::size_t i = first; i < first + size; i++) {
+		char digit = code[i];
+		if (!std::isxdigit(static_cast<unsigned char>(digit))) {
+			throw std::invalid_argument("Invalid cheat code " + code);
+		}
+		value <<= 4;
+		value |= digit <= '9' ? digit - '0' : digit - 'A' + 10;
+	}
+	return value;
+}
+
+/**
+ * Decodes cheat code
+ *
+ * @param code Cheat code
+ * @return Decoded cheat
+ */
+SCheatCode decodeCheat(const std::string &code) {
+	std::string upper;
+	for (char c : code) {
+		if (!std::isspace(static_cast<unsigned char>(c)) && c != '-') {
+			upper.push_back(static_cast<char>(
+			    std::toupper(static_cast<unsigned char>(c))));
+		}
+	}
+	if (upper.size() == 7 && upper[4] == ':') {
+		return {static_cast<std::uint16_t>(parseHex(upper, 0, 4)),
+		    static_cast<std::uint8_t>(parseHex(upper, 5, 2)), -1};
+	}
+	if (upper.size() == 10 && upper[4] == '?' && upper[7] == ':') {
+		return {static_cast<std::uint16_t>(parseHex(upper, 0, 4)),
+		    static_cast<std::uint8_t>(parseHex(upper, 8, 2)),
+		    static_cast<int>(parseHex(upper, 5, 2))};
+	}
+	if (upper.size() == 6 || upper.size() == 8) {
+		return decodeGameGenie(upper);
+	}
+	throw std::invalid_argument("Invalid cheat code " + code);
+}
+
+}  // namespace core
+
+}  // namespace vpnes
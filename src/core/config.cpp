@@ -27,13 +27,14 @@
 #include "config.h"
 #endif
 
-#include <cassert>
 #include <cstdint>
 #include <cstring>
-#include <utility>
-#include <fstream>
+#include <istream>
+#include <memory>
+#include <stdexcept>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/config.hpp>
+#include <vpnes/core/image.hpp>
 #include <vpnes/core/ines.hpp>
 #include <vpnes/core/factory.hpp>
 
@@ -41,27 +42,28 @@ namespace vpnes {
 
 namespace core {
 
-/**
- * Factory list
- */
-const NESFactory factoryList[MMCAmount] = {
-    &factory::factoryNROM,  // NROM-128
-    &factory::factoryNROM   // NROM-256
-};
-
 /* SNESConfig */
 
 /**
  * Default constructor
  */
 SNESConfig::SNESConfig()
-    : CHR()
+    : Image()
+    , CHR()
     , PRG()
     , Trainer()
     , PRGSize()
     , CHRSize()
     , RAMSize()
-    , MMCType()
+    , BatterySize()
+    , CHRRAMSize()
+    , CHRBatterySize()
+    , Mapper()
+    , Submapper()
+    , CRC32()
+    , SaveFile()
+    , SaveInterval()
+    , TraceFile()
     , Mirroring()
     , NESType() {
 }
@@ -70,20 +72,49 @@ SNESConfig::SNESConfig()
  * Configures the class
  *
  * @param appConfig Application configuration
- * @param inputFile Input file stream
+ * @param image ROM image
  */
-void SNESConfig::configure(
-    const gui::SApplicationConfig &appConfig, std::ifstream *inputFile) {
-	ines::SNESData nesData(inputFile);
+void SNESConfig::configure(const gui::SApplicationConfig &appConfig,
+    const std::shared_ptr<CROMImage> &image) {
+	ines::SNESData nesData(CROMImage::unpack(image));
 	PRGSize = nesData.PRGSize;
 	CHRSize = nesData.CHRSize;
 	RAMSize = nesData.RAMSize;
+	BatterySize = nesData.BatterySize;
+	CHRRAMSize = nesData.CHRRAMSize;
+	CHRBatterySize = nesData.CHRBatterySize;
+	Mapper = nesData.Mapper;
+	Submapper = nesData.Submapper;
+	CRC32 = nesData.CRC32;
+	SaveFile = appConfig.getSaveFileName();
+	SaveInterval = appConfig.getSaveInterval();
+	TraceFile = appConfig.getTraceFileName();
 	Mirroring = nesData.Mirroring;
-	MMCType = nesData.MMCType;
 	NESType = nesData.NESType;
-	PRG = std::move(nesData.PRG);
-	CHR = std::move(nesData.CHR);
-	Trainer = std::move(nesData.Trainer);
+	Image = nesData.Image;
+	PRG = nesData.PRG;
+	CHR = nesData.CHR;
+	Trainer = nesData.Trainer;
+}
+
+/**
+ * Configures the class from memory mapped input file
+ *
+ * @param appConfig Application configuration
+ */
+void SNESConfig::configure(const gui::SApplicationConfig &appConfig) {
+	configure(appConfig, CROMImage::map(appConfig.getInputFileName().c_str()));
+}
+
+/**
+ * Configures the class
+ *
+ * @param appConfig Application configuration
+ * @param inputFile Input file stream
+ */
+void SNESConfig::configure(
+    const gui::SApplicationConfig &appConfig, std::istream *inputFile) {
+	configure(appConfig, CROMImage::read(inputFile));
 }
 
 /**
@@ -93,8 +124,11 @@ void SNESConfig::configure(
  * @return Instance of NES
  */
 CNES *vpnes::core::SNESConfig::createInstance(CFrontEnd *frontEnd) {
-	assert(MMCType < MMCAmount);
-	return factoryList[MMCType](*this, frontEnd);
+	NESFactory factory = CMapperRegistry::find(Mapper, Submapper);
+	if (factory == nullptr) {
+		throw std::invalid_argument("Unsupported mapper");
+	}
+	return factory(*this, frontEnd);
 }
 
 }  // namespace core
@@ -45,16 +45,19 @@ namespace core {
 struct CCPU::opcodes {
 	/* Commands */
 	struct cmdPHA : cpu::Command {
+		static constexpr const char *Name = "PHA";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->m_A;
 		}
 	};
 	struct cmdPHP : cpu::Command {
+		static constexpr const char *Name = "PHP";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->packState() | CPUFlagBreak;
 		}
 	};
 	struct cmdPLA : cpu::Command {
+		static constexpr const char *Name = "PLA";
 		static void execute(CCPU *cpu) {
 			cpu->m_A = cpu->m_DB;
 			cpu->setNegativeFlag(cpu->m_A);
@@ -62,46 +65,55 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdPLP : cpu::Command {
+		static constexpr const char *Name = "PLP";
 		static void execute(CCPU *cpu) {
 			cpu->unpackState(cpu->m_DB);
 		}
 	};
 	struct cmdCLC : cpu::Command {
+		static constexpr const char *Name = "CLC";
 		static void execute(CCPU *cpu) {
 			cpu->m_Carry = 0;
 		}
 	};
 	struct cmdSEC : cpu::Command {
+		static constexpr const char *Name = "SEC";
 		static void execute(CCPU *cpu) {
 			cpu->m_Carry = CPUFlagCarry;
 		}
 	};
 	struct cmdCLD : cpu::Command {
+		static constexpr const char *Name = "CLD";
 		static void execute(CCPU *cpu) {
 			cpu->m_Decimal = 0;
 		}
 	};
 	struct cmdSED : cpu::Command {
+		static constexpr const char *Name = "SED";
 		static void execute(CCPU *cpu) {
 			cpu->m_Decimal = CPUFlagDecimal;
 		}
 	};
 	struct cmdCLI : cpu::Command {
+		static constexpr const char *Name = "CLI";
 		static void execute(CCPU *cpu) {
 			cpu->m_Interrupt = 0;
 		}
 	};
 	struct cmdSEI : cpu::Command {
+		static constexpr const char *Name = "SEI";
 		static void execute(CCPU *cpu) {
 			cpu->m_Interrupt = CPUFlagInterrupt;
 		}
 	};
 	struct cmdCLV : cpu::Command {
+		static constexpr const char *Name = "CLV";
 		static void execute(CCPU *cpu) {
 			cpu->m_Overflow = 0;
 		}
 	};
 	struct cmdTAX : cpu::Command {
+		static constexpr const char *Name = "TAX";
 		static void execute(CCPU *cpu) {
 			cpu->m_X = cpu->m_A;
 			cpu->setNegativeFlag(cpu->m_X);
@@ -109,6 +121,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdTAY : cpu::Command {
+		static constexpr const char *Name = "TAY";
 		static void execute(CCPU *cpu) {
 			cpu->m_Y = cpu->m_A;
 			cpu->setNegativeFlag(cpu->m_Y);
@@ -116,6 +129,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdTXA : cpu::Command {
+		static constexpr const char *Name = "TXA";
 		static void execute(CCPU *cpu) {
 			cpu->m_A = cpu->m_X;
 			cpu->setNegativeFlag(cpu->m_A);
@@ -123,6 +137,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdTYA : cpu::Command {
+		static constexpr const char *Name = "TYA";
 		static void execute(CCPU *cpu) {
 			cpu->m_A = cpu->m_Y;
 			cpu->setNegativeFlag(cpu->m_A);
@@ -130,11 +145,13 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdTXS : cpu::Command {
+		static constexpr const char *Name = "TXS";
 		static void execute(CCPU *cpu) {
 			cpu->m_S = cpu->m_X;
 		}
 	};
 	struct cmdTSX : cpu::Command {
+		static constexpr const char *Name = "TSX";
 		static void execute(CCPU *cpu) {
 			cpu->m_X = cpu->m_S;
 			cpu->setNegativeFlag(cpu->m_X);
@@ -142,6 +159,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdINX : cpu::Command {
+		static constexpr const char *Name = "INX";
 		static void execute(CCPU *cpu) {
 			++cpu->m_X;
 			cpu->setNegativeFlag(cpu->m_X);
@@ -149,6 +167,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdDEX : cpu::Command {
+		static constexpr const char *Name = "DEX";
 		static void execute(CCPU *cpu) {
 			--cpu->m_X;
 			cpu->setNegativeFlag(cpu->m_X);
@@ -156,6 +175,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdINY : cpu::Command {
+		static constexpr const char *Name = "INY";
 		static void execute(CCPU *cpu) {
 			++cpu->m_Y;
 			cpu->setNegativeFlag(cpu->m_Y);
@@ -163,6 +183,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdDEY : cpu::Command {
+		static constexpr const char *Name = "DEY";
 		static void execute(CCPU *cpu) {
 			--cpu->m_Y;
 			cpu->setNegativeFlag(cpu->m_Y);
@@ -170,46 +191,55 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdBCC : cpu::Command {
+		static constexpr const char *Name = "BCC";
 		static void execute(CCPU *cpu) {
 			cpu->m_BranchTaken = cpu->m_Carry == 0;
 		}
 	};
 	struct cmdBCS : cpu::Command {
+		static constexpr const char *Name = "BCS";
 		static void execute(CCPU *cpu) {
 			cpu->m_BranchTaken = cpu->m_Carry != 0;
 		}
 	};
 	struct cmdBNE : cpu::Command {
+		static constexpr const char *Name = "BNE";
 		static void execute(CCPU *cpu) {
 			cpu->m_BranchTaken = cpu->m_Zero == 0;
 		}
 	};
 	struct cmdBEQ : cpu::Command {
+		static constexpr const char *Name = "BEQ";
 		static void execute(CCPU *cpu) {
 			cpu->m_BranchTaken = cpu->m_Zero != 0;
 		}
 	};
 	struct cmdBPL : cpu::Command {
+		static constexpr const char *Name = "BPL";
 		static void execute(CCPU *cpu) {
 			cpu->m_BranchTaken = (cpu->m_Negative & CPUFlagNegative) == 0;
 		}
 	};
 	struct cmdBMI : cpu::Command {
+		static constexpr const char *Name = "BMI";
 		static void execute(CCPU *cpu) {
 			cpu->m_BranchTaken = (cpu->m_Negative & CPUFlagNegative) != 0;
 		}
 	};
 	struct cmdBVC : cpu::Command {
+		static constexpr const char *Name = "BVC";
 		static void execute(CCPU *cpu) {
 			cpu->m_BranchTaken = cpu->m_Overflow == 0;
 		}
 	};
 	struct cmdBVS : cpu::Command {
+		static constexpr const char *Name = "BVS";
 		static void execute(CCPU *cpu) {
 			cpu->m_BranchTaken = cpu->m_Overflow != 0;
 		}
 	};
 	struct cmdLDA : cpu::Command {
+		static constexpr const char *Name = "LDA";
 		static void execute(CCPU *cpu) {
 			cpu->m_A = cpu->m_DB;
 			cpu->setNegativeFlag(cpu->m_A);
@@ -217,11 +247,13 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSTA : cpu::Command {
+		static constexpr const char *Name = "STA";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->m_A;
 		}
 	};
 	struct cmdLDX : cpu::Command {
+		static constexpr const char *Name = "LDX";
 		static void execute(CCPU *cpu) {
 			cpu->m_X = cpu->m_DB;
 			cpu->setNegativeFlag(cpu->m_X);
@@ -229,11 +261,13 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSTX : cpu::Command {
+		static constexpr const char *Name = "STX";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->m_X;
 		}
 	};
 	struct cmdLDY : cpu::Command {
+		static constexpr const char *Name = "LDY";
 		static void execute(CCPU *cpu) {
 			cpu->m_Y = cpu->m_DB;
 			cpu->setNegativeFlag(cpu->m_Y);
@@ -241,11 +275,13 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSTY : cpu::Command {
+		static constexpr const char *Name = "STY";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->m_Y;
 		}
 	};
 	struct cmdAND : cpu::Command {
+		static constexpr const char *Name = "AND";
 		static void execute(CCPU *cpu) {
 			cpu->m_A &= cpu->m_DB;
 			cpu->setNegativeFlag(cpu->m_A);
@@ -253,6 +289,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdORA : cpu::Command {
+		static constexpr const char *Name = "ORA";
 		static void execute(CCPU *cpu) {
 			cpu->m_A |= cpu->m_DB;
 			cpu->setNegativeFlag(cpu->m_A);
@@ -260,6 +297,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdEOR : cpu::Command {
+		static constexpr const char *Name = "EOR";
 		static void execute(CCPU *cpu) {
 			cpu->m_A ^= cpu->m_DB;
 			cpu->setNegativeFlag(cpu->m_A);
@@ -267,6 +305,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdINC : cpu::Command {
+		static constexpr const char *Name = "INC";
 		static void execute(CCPU *cpu) {
 			++cpu->m_OP;
 			cpu->setNegativeFlag(cpu->m_OP);
@@ -275,6 +314,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdDEC : cpu::Command {
+		static constexpr const char *Name = "DEC";
 		static void execute(CCPU *cpu) {
 			--cpu->m_OP;
 			cpu->setNegativeFlag(cpu->m_OP);
@@ -283,6 +323,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdCMP : cpu::Command {
+		static constexpr const char *Name = "CMP";
 		static void execute(CCPU *cpu) {
 			std::uint16_t dummy = cpu->m_A - cpu->m_DB;
 			cpu->setCarryFlag(dummy < 0x0100);
@@ -291,6 +332,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdCPX : cpu::Command {
+		static constexpr const char *Name = "CPX";
 		static void execute(CCPU *cpu) {
 			std::uint16_t dummy = cpu->m_X - cpu->m_DB;
 			cpu->setCarryFlag(dummy < 0x0100);
@@ -299,6 +341,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdCPY : cpu::Command {
+		static constexpr const char *Name = "CPY";
 		static void execute(CCPU *cpu) {
 			std::uint16_t dummy = cpu->m_Y - cpu->m_DB;
 			cpu->setCarryFlag(dummy < 0x0100);
@@ -307,6 +350,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdBIT : cpu::Command {
+		static constexpr const char *Name = "BIT";
 		static void execute(CCPU *cpu) {
 			cpu->setOverflowFlag((cpu->m_DB & 0x40) != 0);
 			cpu->setNegativeFlag(cpu->m_DB);
@@ -314,6 +358,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdADC : cpu::Command {
+		static constexpr const char *Name = "ADC";
 		static void execute(CCPU *cpu) {
 			std::uint16_t dummy = cpu->m_DB + cpu->m_A + cpu->m_Carry;
 			cpu->setOverflowFlag(
@@ -325,6 +370,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSBC : cpu::Command {
+		static constexpr const char *Name = "SBC";
 		static void execute(CCPU *cpu) {
 			std::uint16_t dummy =
 			    cpu->m_A - cpu->m_DB - (cpu->m_Carry ^ CPUFlagCarry);
@@ -337,6 +383,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdROL : cpu::Command {
+		static constexpr const char *Name = "ROL";
 		static void execute(CCPU *cpu) {
 			std::uint8_t dummy = cpu->m_OP & 0x80;
 			cpu->m_OP <<= 1;
@@ -348,6 +395,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdROR : cpu::Command {
+		static constexpr const char *Name = "ROR";
 		static void execute(CCPU *cpu) {
 			std::uint8_t dummy = cpu->m_OP & 0x01;
 			cpu->m_OP >>= 1;
@@ -359,6 +407,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdASL : cpu::Command {
+		static constexpr const char *Name = "ASL";
 		static void execute(CCPU *cpu) {
 			cpu->setCarryFlag((cpu->m_OP & 0x80) != 0);
 			cpu->m_OP <<= 1;
@@ -368,6 +417,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdLSR : cpu::Command {
+		static constexpr const char *Name = "LSR";
 		static void execute(CCPU *cpu) {
 			cpu->setCarryFlag((cpu->m_OP & 0x01) != 0);
 			cpu->m_OP >>= 1;
@@ -377,6 +427,8 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdROLA : cpu::Command {
+		static constexpr const char *Name = "ROL";
+		enum { Accumulator = true };
 		static void execute(CCPU *cpu) {
 			std::uint8_t dummy = cpu->m_A & 0x80;
 			cpu->m_A <<= 1;
@@ -387,6 +439,8 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdRORA : cpu::Command {
+		static constexpr const char *Name = "ROR";
+		enum { Accumulator = true };
 		static void execute(CCPU *cpu) {
 			std::uint8_t dummy = cpu->m_A & 0x01;
 			cpu->m_A >>= 1;
@@ -397,6 +451,8 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdASLA : cpu::Command {
+		static constexpr const char *Name = "ASL";
+		enum { Accumulator = true };
 		static void execute(CCPU *cpu) {
 			cpu->setCarryFlag((cpu->m_A & 0x80) != 0);
 			cpu->m_A <<= 1;
@@ -405,6 +461,8 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdLSRA : cpu::Command {
+		static constexpr const char *Name = "LSR";
+		enum { Accumulator = true };
 		static void execute(CCPU *cpu) {
 			cpu->setCarryFlag((cpu->m_A & 0x01) != 0);
 			cpu->m_A >>= 1;
@@ -413,6 +471,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSLO : cpu::Command {
+		static constexpr const char *Name = "SLO";
 		static void execute(CCPU *cpu) {
 			cpu->setCarryFlag((cpu->m_OP & 0x80) != 0);
 			cpu->m_OP <<= 1;
@@ -423,6 +482,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdRLA : cpu::Command {
+		static constexpr const char *Name = "RLA";
 		static void execute(CCPU *cpu) {
 			std::uint8_t dummy = cpu->m_OP & 0x80;
 			cpu->m_OP <<= 1;
@@ -435,6 +495,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSRE : cpu::Command {
+		static constexpr const char *Name = "SRE";
 		static void execute(CCPU *cpu) {
 			cpu->setCarryFlag((cpu->m_OP & 0x01) != 0);
 			cpu->m_OP >>= 1;
@@ -445,6 +506,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdRRA : cpu::Command {
+		static constexpr const char *Name = "RRA";
 		static void execute(CCPU *cpu) {
 			std::uint8_t dummy = cpu->m_OP & 0x01;
 			cpu->m_OP >>= 1;
@@ -461,11 +523,13 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSAX : cpu::Command {
+		static constexpr const char *Name = "SAX";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->m_A & cpu->m_X;
 		}
 	};
 	struct cmdLAX : cpu::Command {
+		static constexpr const char *Name = "LAX";
 		static void execute(CCPU *cpu) {
 			cpu->m_A = cpu->m_DB;
 			cpu->m_X = cpu->m_DB;
@@ -474,6 +538,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdDCP : cpu::Command {
+		static constexpr const char *Name = "DCP";
 		static void execute(CCPU *cpu) {
 			std::uint16_t dummy = cpu->m_A - --cpu->m_OP;
 			cpu->setCarryFlag(dummy < 0x0100);
@@ -483,6 +548,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdISC : cpu::Command {
+		static constexpr const char *Name = "ISC";
 		static void execute(CCPU *cpu) {
 			++cpu->m_OP;
 			std::uint16_t dummy =
@@ -497,6 +563,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdANC : cpu::Command {
+		static constexpr const char *Name = "ANC";
 		static void execute(CCPU *cpu) {
 			cpu->m_A &= cpu->m_DB;
 			cpu->setCarryFlag((cpu->m_A & 0x80) != 0);
@@ -505,6 +572,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdALR : cpu::Command {
+		static constexpr const char *Name = "ALR";
 		static void execute(CCPU *cpu) {
 			cpu->m_A &= cpu->m_DB;
 			cpu->setCarryFlag((cpu->m_A & 0x01) != 0);
@@ -514,6 +582,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdARR : cpu::Command {
+		static constexpr const char *Name = "ARR";
 		static void execute(CCPU *cpu) {
 			cpu->m_A &= cpu->m_DB;
 			cpu->m_A >>= 1;
@@ -526,6 +595,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdXAA : cpu::Command {
+		static constexpr const char *Name = "XAA";
 		static void execute(CCPU *cpu) {
 			std::uint8_t dummy = cpu->m_X & cpu->m_A & cpu->m_DB;
 			cpu->setNegativeFlag(dummy);
@@ -534,6 +604,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdAXS : cpu::Command {
+		static constexpr const char *Name = "AXS";
 		static void execute(CCPU *cpu) {
 			cpu->m_X &= cpu->m_A;
 			cpu->setCarryFlag(cpu->m_X >= cpu->m_DB);
@@ -543,6 +614,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSHA : cpu::Command {
+		static constexpr const char *Name = "SHA";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->m_A & cpu->m_X & ((cpu->m_OP16 >> 8) + 1);
 			if ((cpu->m_AB & 0xff00) != (cpu->m_OP16 & 0xff00)) {
@@ -551,6 +623,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSHX : cpu::Command {
+		static constexpr const char *Name = "SHX";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->m_X & ((cpu->m_OP16 >> 8) + 1);
 			if ((cpu->m_AB & 0xff00) != (cpu->m_OP16 & 0xff00)) {
@@ -559,6 +632,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdSHY : cpu::Command {
+		static constexpr const char *Name = "SHY";
 		static void execute(CCPU *cpu) {
 			cpu->m_DB = cpu->m_Y & ((cpu->m_OP16 >> 8) + 1);
 			if ((cpu->m_AB & 0xff00) != (cpu->m_OP16 & 0xff00)) {
@@ -567,6 +641,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdTAS : cpu::Command {
+		static constexpr const char *Name = "TAS";
 		static void execute(CCPU *cpu) {
 			cpu->m_S = cpu->m_A & cpu->m_X;
 			cpu->m_DB = cpu->m_S & ((cpu->m_OP16 >> 8) + 1);
@@ -576,6 +651,7 @@ struct CCPU::opcodes {
 		}
 	};
 	struct cmdLAS : cpu::Command {
+		static constexpr const char *Name = "LAS";
 		static void execute(CCPU *cpu) {
 			cpu->m_S &= cpu->m_OP;
 			cpu->m_A = cpu->m_S;
@@ -584,6 +660,9 @@ struct CCPU::opcodes {
 			cpu->setZeroFlag(cpu->m_A);
 		}
 	};
+	struct cmdNOP : cpu::Command {
+		static constexpr const char *Name = "NOP";
+	};
 
 	/* Cycles */
 
@@ -593,9 +672,22 @@ struct CCPU::opcodes {
 	struct ParseNext : cpu::Cycle {
 		template <class Control>
 		static void execute(CCPU *cpu) {
+			if (cpu->m_InstructionTrace) {
+				cpu->traceInstruction();
+			}
 			if (!cpu->m_PendingINT) {
+#if defined(VPNES_PROFILE)
+				cpu->m_CodeProfile.enter(cpu->m_PC, cpu->m_InternalClock);
+#endif
+				CBusWatch *watch = cpu->m_MotherBoard->getBusCPU()->getWatch();
+				if (watch->isActive()) {
+					watch->access(WatchExec, cpu->m_PC, cpu->m_DB);
+				}
 				++cpu->m_PC;
 			} else {
+#if defined(VPNES_PROFILE)
+				cpu->m_CodeProfile.enterInterrupt(cpu->m_InternalClock);
+#endif
 				cpu->m_DB = 0;
 			}
 			cpu->m_AB = cpu->m_PC;
@@ -668,6 +760,8 @@ struct CCPU::opcodes {
 	 */
 	struct opBRK
 	    : cpu::Operation<BRK01, BRK02, BRK03, BRK04, BRK05, BRK06, ParseNext> {
+		static constexpr const char *Name = "BRK";
+		enum { Mode = ModeImplied };
 	};
 
 	/* RTI */
@@ -709,7 +803,10 @@ struct CCPU::opcodes {
 	 * RTI
 	 */
 	struct opRTI
-	    : cpu::Operation<RTI01, RTI02, RTI03, RTI04, RTI05, ParseNext> {};
+	    : cpu::Operation<RTI01, RTI02, RTI03, RTI04, RTI05, ParseNext> {
+		static constexpr const char *Name = "RTI";
+		enum { Mode = ModeImplied };
+	};
 
 	/* RTS */
 	struct RTS01 : cpu::Cycle {
@@ -749,7 +846,10 @@ struct CCPU::opcodes {
 	 * RTS
 	 */
 	struct opRTS
-	    : cpu::Operation<RTS01, RTS02, RTS03, RTS04, RTS05, ParseNext> {};
+	    : cpu::Operation<RTS01, RTS02, RTS03, RTS04, RTS05, ParseNext> {
+		static constexpr const char *Name = "RTS";
+		enum { Mode = ModeImplied };
+	};
 
 	/* PHA/PHP */
 	template <class Command>
@@ -773,7 +873,10 @@ struct CCPU::opcodes {
 	 * PHA/PHP
 	 */
 	template <class Command>
-	struct opPHR : cpu::Operation<PHR01<Command>, PHR02, ParseNext> {};
+	struct opPHR : cpu::Operation<PHR01<Command>, PHR02, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeImplied };
+	};
 
 	/* PLA/PLP */
 	struct PLR01 : cpu::Cycle {
@@ -801,7 +904,10 @@ struct CCPU::opcodes {
 	 * PLA/PLP
 	 */
 	template <class Command>
-	struct opPLR : cpu::Operation<PLR01, PLR02, PLR03<Command>, ParseNext> {};
+	struct opPLR : cpu::Operation<PLR01, PLR02, PLR03<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeImplied };
+	};
 
 	/* JSR */
 	struct JSR01 : cpu::Cycle {
@@ -847,7 +953,10 @@ struct CCPU::opcodes {
 	 * JSR
 	 */
 	struct opJSR
-	    : cpu::Operation<JSR01, JSR02, JSR03, JSR04, JSR05, ParseNext> {};
+	    : cpu::Operation<JSR01, JSR02, JSR03, JSR04, JSR05, ParseNext> {
+		static constexpr const char *Name = "JSR";
+		enum { Mode = ModeAbsolute };
+	};
 
 	/* JMP Absolute */
 	struct JMPAbs01 : cpu::Cycle {
@@ -869,7 +978,10 @@ struct CCPU::opcodes {
 	/**
 	 * JMP Absolute
 	 */
-	struct opJMPAbs : cpu::Operation<JMPAbs01, JMPAbs02, ParseNext> {};
+	struct opJMPAbs : cpu::Operation<JMPAbs01, JMPAbs02, ParseNext> {
+		static constexpr const char *Name = "JMP";
+		enum { Mode = ModeAbsolute };
+	};
 
 	/* JMP Absolute Indirect */
 	struct JMPAbsInd01 : cpu::Cycle {
@@ -908,7 +1020,10 @@ struct CCPU::opcodes {
 	 * JMP Absolute Indirect
 	 */
 	struct opJMPAbsInd : cpu::Operation<JMPAbsInd01, JMPAbsInd02, JMPAbsInd03,
-	                         JMPAbsInd04, ParseNext> {};
+	                         JMPAbsInd04, ParseNext> {
+		static constexpr const char *Name = "JMP";
+		enum { Mode = ModeIndirect };
+	};
 
 	/* Branches */
 	template <class Command>
@@ -949,7 +1064,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opBranch
-	    : cpu::Operation<Branch01<Command>, Branch02, Branch03, ParseNext> {};
+	    : cpu::Operation<Branch01<Command>, Branch02, Branch03, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeRelative };
+	};
 
 	/* Implied */
 	template <class Command>
@@ -965,7 +1083,10 @@ struct CCPU::opcodes {
 	 * Implied
 	 */
 	template <class Command>
-	struct opImp : cpu::Operation<Imp01<Command>, ParseNext> {};
+	struct opImp : cpu::Operation<Imp01<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = Command::Accumulator ? ModeAccumulator : ModeImplied };
+	};
 
 	/* Immediate */
 	template <class Command>
@@ -981,7 +1102,10 @@ struct CCPU::opcodes {
 	 * Immediate
 	 */
 	template <class Command>
-	struct opImm : cpu::Operation<Imm01<Command>, ParseNext> {};
+	struct opImm : cpu::Operation<Imm01<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeImmediate };
+	};
 
 	/* Absolute */
 	/* Read */
@@ -1016,6 +1140,8 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opReadAbs
 	    : cpu::Operation<ReadAbs01, ReadAbs02, ReadAbs03<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsolute };
 	};
 	/* Modify */
 	struct ModifyAbs01 : cpu::Cycle {
@@ -1063,7 +1189,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opModifyAbs : cpu::Operation<ModifyAbs01, ModifyAbs02, ModifyAbs03,
-	                         ModifyAbs04<Command>, ModifyAbs05, ParseNext> {};
+	                         ModifyAbs04<Command>, ModifyAbs05, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsolute };
+	};
 	/* Write */
 	struct WriteAbs01 : cpu::Cycle {
 		template <class Control>
@@ -1096,7 +1225,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opWriteAbs : cpu::Operation<WriteAbs01, WriteAbs02<Command>,
-	                        WriteAbs03, ParseNext> {};
+	                        WriteAbs03, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsolute };
+	};
 
 	/* Zero-page */
 	/* Read */
@@ -1121,7 +1253,10 @@ struct CCPU::opcodes {
 	 * Read Zero-page
 	 */
 	template <class Command>
-	struct opReadZP : cpu::Operation<ReadZP01, ReadZP02<Command>, ParseNext> {};
+	struct opReadZP : cpu::Operation<ReadZP01, ReadZP02<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPage };
+	};
 	/* Modify */
 	struct ModifyZP01 : cpu::Cycle {
 		template <class Control>
@@ -1160,7 +1295,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opModifyZP : cpu::Operation<ModifyZP01, ModifyZP02,
-	                        ModifyZP03<Command>, ModifyZP04, ParseNext> {};
+	                        ModifyZP03<Command>, ModifyZP04, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPage };
+	};
 	/* Write */
 	template <class Command>
 	struct WriteZP01 : cpu::Cycle {
@@ -1185,7 +1323,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opWriteZP
-	    : cpu::Operation<WriteZP01<Command>, WriteZP02, ParseNext> {};
+	    : cpu::Operation<WriteZP01<Command>, WriteZP02, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPage };
+	};
 
 	/* Zero-page X */
 	/* Read */
@@ -1219,6 +1360,8 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opReadZPX
 	    : cpu::Operation<ReadZPX01, ReadZPX02, ReadZPX03<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPageX };
 	};
 	/* Modify */
 	struct ModifyZPX01 : cpu::Cycle {
@@ -1265,7 +1408,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opModifyZPX : cpu::Operation<ModifyZPX01, ModifyZPX02, ModifyZPX03,
-	                         ModifyZPX04<Command>, ModifyZPX05, ParseNext> {};
+	                         ModifyZPX04<Command>, ModifyZPX05, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPageX };
+	};
 	/* Write */
 	struct WriteZPX01 : cpu::Cycle {
 		template <class Control>
@@ -1297,7 +1443,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opWriteZPX : cpu::Operation<WriteZPX01, WriteZPX02<Command>,
-	                        WriteZPX03, ParseNext> {};
+	                        WriteZPX03, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPageX };
+	};
 
 	/* Zero-page Y */
 	/* Read */
@@ -1331,6 +1480,8 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opReadZPY
 	    : cpu::Operation<ReadZPY01, ReadZPY02, ReadZPY03<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPageY };
 	};
 	/* Modify */
 	struct ModifyZPY01 : cpu::Cycle {
@@ -1377,7 +1528,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opModifyZPY : cpu::Operation<ModifyZPY01, ModifyZPY02, ModifyZPY03,
-	                         ModifyZPY04<Command>, ModifyZPY05, ParseNext> {};
+	                         ModifyZPY04<Command>, ModifyZPY05, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPageY };
+	};
 	/* Write */
 	struct WriteZPY01 : cpu::Cycle {
 		template <class Control>
@@ -1409,7 +1563,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opWriteZPY : cpu::Operation<WriteZPY01, WriteZPY02<Command>,
-	                        WriteZPY03, ParseNext> {};
+	                        WriteZPY03, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeZeroPageY };
+	};
 
 	/* Absolute X */
 	/* Read */
@@ -1456,7 +1613,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opReadAbsX : cpu::Operation<ReadAbsX01, ReadAbsX02, ReadAbsX03,
-	                        ReadAbsX04<Command>, ParseNext> {};
+	                        ReadAbsX04<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsoluteX };
+	};
 	/* Modify */
 	struct ModifyAbsX01 : cpu::Cycle {
 		template <class Control>
@@ -1514,7 +1674,10 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opModifyAbsX
 	    : cpu::Operation<ModifyAbsX01, ModifyAbsX02, ModifyAbsX03, ModifyAbsX04,
-	          ModifyAbsX05<Command>, ModifyAbsX06, ParseNext> {};
+	          ModifyAbsX05<Command>, ModifyAbsX06, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsoluteX };
+	};
 	/* Write */
 	struct WriteAbsX01 : cpu::Cycle {
 		template <class Control>
@@ -1557,7 +1720,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opWriteAbsX : cpu::Operation<WriteAbsX01, WriteAbsX02,
-	                         WriteAbsX03<Command>, WriteAbsX04, ParseNext> {};
+	                         WriteAbsX03<Command>, WriteAbsX04, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsoluteX };
+	};
 
 	/* Absolute Y */
 	/* Read */
@@ -1604,7 +1770,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opReadAbsY : cpu::Operation<ReadAbsY01, ReadAbsY02, ReadAbsY03,
-	                        ReadAbsY04<Command>, ParseNext> {};
+	                        ReadAbsY04<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsoluteY };
+	};
 	/* Modify */
 	struct ModifyAbsY01 : cpu::Cycle {
 		template <class Control>
@@ -1662,7 +1831,10 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opModifyAbsY
 	    : cpu::Operation<ModifyAbsY01, ModifyAbsY02, ModifyAbsY03, ModifyAbsY04,
-	          ModifyAbsY05<Command>, ModifyAbsY06, ParseNext> {};
+	          ModifyAbsY05<Command>, ModifyAbsY06, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsoluteY };
+	};
 	/* Write */
 	struct WriteAbsY01 : cpu::Cycle {
 		template <class Control>
@@ -1705,7 +1877,10 @@ struct CCPU::opcodes {
 	 */
 	template <class Command>
 	struct opWriteAbsY : cpu::Operation<WriteAbsY01, WriteAbsY02,
-	                         WriteAbsY03<Command>, WriteAbsY04, ParseNext> {};
+	                         WriteAbsY03<Command>, WriteAbsY04, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeAbsoluteY };
+	};
 
 	/* ZP X Indirect */
 	/* Read */
@@ -1754,7 +1929,10 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opReadZPXInd
 	    : cpu::Operation<ReadZPXInd01, ReadZPXInd02, ReadZPXInd03, ReadZPXInd04,
-	          ReadZPXInd05<Command>, ParseNext> {};
+	          ReadZPXInd05<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeIndirectX };
+	};
 	/* Modify */
 	struct ModifyZPXInd01 : cpu::Cycle {
 		template <class Control>
@@ -1817,7 +1995,10 @@ struct CCPU::opcodes {
 	struct opModifyZPXInd
 	    : cpu::Operation<ModifyZPXInd01, ModifyZPXInd02, ModifyZPXInd03,
 	          ModifyZPXInd04, ModifyZPXInd05, ModifyZPXInd06<Command>,
-	          ModifyZPXInd07, ParseNext> {};
+	          ModifyZPXInd07, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeIndirectX };
+	};
 	/* Write */
 	struct WriteZPXInd01 : cpu::Cycle {
 		template <class Control>
@@ -1865,7 +2046,10 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opWriteZPXInd
 	    : cpu::Operation<WriteZPXInd01, WriteZPXInd02, WriteZPXInd03,
-	          WriteZPXInd04<Command>, WriteZPXInd05, ParseNext> {};
+	          WriteZPXInd04<Command>, WriteZPXInd05, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeIndirectX };
+	};
 
 	/* ZP Y Indirect */
 	/* Read */
@@ -2255,7 +2439,10 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opReadZPIndY
 	    : cpu::Operation<ReadZPIndY01, ReadZPIndY02, ReadZPIndY03, ReadZPIndY04,
-	          ReadZPIndY05<Command>, ParseNext> {};
+	          ReadZPIndY05<Command>, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeIndirectY };
+	};
 	/* Modify */
 	struct ModifyZPIndY01 : cpu::Cycle {
 		template <class Control>
@@ -2321,7 +2508,10 @@ struct CCPU::opcodes {
 	struct opModifyZPIndY
 	    : cpu::Operation<ModifyZPIndY01, ModifyZPIndY02, ModifyZPIndY03,
 	          ModifyZPIndY04, ModifyZPIndY05, ModifyZPIndY06<Command>,
-	          ModifyZPIndY07, ParseNext> {};
+	          ModifyZPIndY07, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeIndirectY };
+	};
 	/* Write */
 	struct WriteZPIndY01 : cpu::Cycle {
 		template <class Control>
@@ -2372,7 +2562,10 @@ struct CCPU::opcodes {
 	template <class Command>
 	struct opWriteZPIndY
 	    : cpu::Operation<WriteZPIndY01, WriteZPIndY02, WriteZPIndY03,
-	          WriteZPIndY04<Command>, WriteZPIndY05, ParseNext> {};
+	          WriteZPIndY04<Command>, WriteZPIndY05, ParseNext> {
+		static constexpr const char *Name = Command::Name;
+		enum { Mode = ModeIndirectY };
+	};
 
 	/* RESET */
 	struct Reset00 : cpu::Cycle {
@@ -2669,34 +2862,34 @@ struct CCPU::opcodes {
 	    // BRK
 	    cpu::Opcode<0x00, opBRK>,
 	    // NOP
-	    cpu::Opcode<0xea, opImp<cpu::Command>>,
-	    cpu::Opcode<0x1a, opImp<cpu::Command>>,
-	    cpu::Opcode<0x3a, opImp<cpu::Command>>,
-	    cpu::Opcode<0x5a, opImp<cpu::Command>>,
-	    cpu::Opcode<0x7a, opImp<cpu::Command>>,
-	    cpu::Opcode<0xda, opImp<cpu::Command>>,
-	    cpu::Opcode<0xfa, opImp<cpu::Command>>,
-	    cpu::Opcode<0x80, opImm<cpu::Command>>,
-	    cpu::Opcode<0x82, opImm<cpu::Command>>,
-	    cpu::Opcode<0x89, opImm<cpu::Command>>,
-	    cpu::Opcode<0xc2, opImm<cpu::Command>>,
-	    cpu::Opcode<0xe2, opImm<cpu::Command>>,
-	    cpu::Opcode<0x04, opReadZP<cpu::Command>>,
-	    cpu::Opcode<0x44, opReadZP<cpu::Command>>,
-	    cpu::Opcode<0x64, opReadZP<cpu::Command>>,
-	    cpu::Opcode<0x14, opReadZPX<cpu::Command>>,
-	    cpu::Opcode<0x34, opReadZPX<cpu::Command>>,
-	    cpu::Opcode<0x54, opReadZPX<cpu::Command>>,
-	    cpu::Opcode<0x74, opReadZPX<cpu::Command>>,
-	    cpu::Opcode<0xd4, opReadZPX<cpu::Command>>,
-	    cpu::Opcode<0xf4, opReadZPX<cpu::Command>>,
-	    cpu::Opcode<0x0c, opReadAbs<cpu::Command>>,
-	    cpu::Opcode<0x1c, opReadAbsX<cpu::Command>>,
-	    cpu::Opcode<0x3c, opReadAbsX<cpu::Command>>,
-	    cpu::Opcode<0x5c, opReadAbsX<cpu::Command>>,
-	    cpu::Opcode<0x7c, opReadAbsX<cpu::Command>>,
-	    cpu::Opcode<0xdc, opReadAbsX<cpu::Command>>,
-	    cpu::Opcode<0xfc, opReadAbsX<cpu::Command>>,
+	    cpu::Opcode<0xea, opImp<cmdNOP>>,
+	    cpu::Opcode<0x1a, opImp<cmdNOP>>,
+	    cpu::Opcode<0x3a, opImp<cmdNOP>>,
+	    cpu::Opcode<0x5a, opImp<cmdNOP>>,
+	    cpu::Opcode<0x7a, opImp<cmdNOP>>,
+	    cpu::Opcode<0xda, opImp<cmdNOP>>,
+	    cpu::Opcode<0xfa, opImp<cmdNOP>>,
+	    cpu::Opcode<0x80, opImm<cmdNOP>>,
+	    cpu::Opcode<0x82, opImm<cmdNOP>>,
+	    cpu::Opcode<0x89, opImm<cmdNOP>>,
+	    cpu::Opcode<0xc2, opImm<cmdNOP>>,
+	    cpu::Opcode<0xe2, opImm<cmdNOP>>,
+	    cpu::Opcode<0x04, opReadZP<cmdNOP>>,
+	    cpu::Opcode<0x44, opReadZP<cmdNOP>>,
+	    cpu::Opcode<0x64, opReadZP<cmdNOP>>,
+	    cpu::Opcode<0x14, opReadZPX<cmdNOP>>,
+	    cpu::Opcode<0x34, opReadZPX<cmdNOP>>,
+	    cpu::Opcode<0x54, opReadZPX<cmdNOP>>,
+	    cpu::Opcode<0x74, opReadZPX<cmdNOP>>,
+	    cpu::Opcode<0xd4, opReadZPX<cmdNOP>>,
+	    cpu::Opcode<0xf4, opReadZPX<cmdNOP>>,
+	    cpu::Opcode<0x0c, opReadAbs<cmdNOP>>,
+	    cpu::Opcode<0x1c, opReadAbsX<cmdNOP>>,
+	    cpu::Opcode<0x3c, opReadAbsX<cmdNOP>>,
+	    cpu::Opcode<0x5c, opReadAbsX<cmdNOP>>,
+	    cpu::Opcode<0x7c, opReadAbsX<cmdNOP>>,
+	    cpu::Opcode<0xdc, opReadAbsX<cmdNOP>>,
+	    cpu::Opcode<0xfc, opReadAbsX<cmdNOP>>,
 
 	    // Undocumented
 
@@ -2820,8 +3013,7 @@ struct CCPU::opcodes {
 			cpu->m_MotherBoard->getBusCPU()->writeMemory(cpu->m_DB, cpu->m_AB);
 			break;
 		}
-		// TODO(me) : Use CPU divider
-		cpu->m_InternalClock += 12;
+		cpu->m_InternalClock += cpu->m_Divider;
 		return true;
 	}
 };
@@ -2832,11 +3024,13 @@ struct CCPU::opcodes {
  * Constructs the object
  *
  * @param motherBoard Motherboard
+ * @param divider Ticks per CPU cycle
  */
-CCPU::CCPU(CMotherBoard *motherBoard)
+CCPU::CCPU(CMotherBoard *motherBoard, ticks_t divider)
     : CClockedDevice()
     , m_MotherBoard(motherBoard)
     , m_InternalClock()
+    , m_Divider(divider)
     , m_CurrentIndex(opcodes::control::ResetIndex)
     , m_RAM{}
     , m_PendingIRQ()
@@ -2859,7 +3053,43 @@ CCPU::CCPU(CMotherBoard *motherBoard)
     , m_Decimal()
     , m_Interrupt()
     , m_Zero()
-    , m_Carry() {
+    , m_Carry()
+    , m_InstructionTrace() {
+}
+
+/**
+ * Writes current instruction or taken interrupt to trace
+ *
+ * Opcode fetched before a taken interrupt is discarded, so interrupt records
+ * have zero bytes.
+ */
+void CCPU::traceInstruction() {
+	CBus *bus = m_MotherBoard->getBusCPU();
+	SInstructionRecord record{};
+	record.PC = m_PC;
+	record.Interrupt = m_PendingINT;
+	if (!m_PendingINT) {
+		record.Bytes[0] = m_DB;
+		record.Bytes[1] = bus->readMemory(m_PC + 1, true);
+		record.Bytes[2] = bus->readMemory(m_PC + 2, true);
+	}
+	record.A = m_A;
+	record.X = m_X;
+	record.Y = m_Y;
+	record.S = m_S;
+	record.P = packState();
+	record.Cycle = (m_MotherBoard->getElapsedTicks() - m_Divider) / m_Divider;
+	m_InstructionTrace->add(record);
+}
+
+/**
+ * Gets instruction info
+ *
+ * @param opcode Opcode
+ * @return Mnemonic and addressing mode
+ */
+const SInstructionInfo &CCPU::getInstructionInfo(std::uint8_t opcode) {
+	return opcodes::control::getInstructionInfo(opcode);
 }
 
 /**
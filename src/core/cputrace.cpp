@@ -0,0 +1,354 @@
+/**
+ * @file
+ *
+ * Implements CPU instruction trace
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/cputrace.hpp>
+#include <vpnes/core/disasm.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Trace file signature
+ */
+static const char TraceSignature[8] = {'V', 'P', 'N', 'E', 'S', 'T', 'R', 'C'};
+
+/**
+ * Trace format version
+ */
+static const std::uint16_t TraceVersion = 2;
+
+/**
+ * Writes little-endian value
+ *
+ * @param out Output stream
+ * @param value Value
+ * @param size Size in bytes
+ */
+static void writeValue(
+    std::ostream &out, std::uint32_t value, std::size_t size) {
+	for (std::size_t i = 0; i < size; i++) {
+		out.put(static_cast<char>(value >> (i * 8)));
+	}
+}
+
+/**
+ * Reads little-endian value
+ *
+ * @param in Input stream
+ * @param size Size in bytes
+ * @return Value
+ */
+static std::uint32_t readValue(std::istream &in, std::size_t size) {
+	std::uint32_t value = 0;
+	for (std::size_t i = 0; i < size; i++) {
+		value |= static_cast<std::uint32_t>(in.get() & 0xff) << (i * 8);
+	}
+	return value;
+}
+
+/**
+ * Prints hexadecimal byte
+ *
+ * @param out Output stream
+ * @param value Value
+ */
+static void printByte(std::ostream &out, std::uint8_t value) {
+	out << std::setw(2) << static_cast<unsigned>(value);
+}
+
+/* CInstructionTrace */
+
+/**
+ * Opens the trace
+ *
+ * @param fileName Output file
+ */
+CInstructionTrace::CInstructionTrace(const char *fileName)
+    : m_Output(fileName, std::ofstream::binary)
+    , m_Buffers{std::vector<std::uint8_t>(RecordSize * BlockRecords),
+          std::vector<std::uint8_t>(RecordSize * BlockRecords)}
+    , m_Active(0)
+    , m_Used(0)
+    , m_PendingSize(0)
+    , m_Pending(false)
+    , m_Stop(false)
+    , m_Mutex()
+    , m_Signal()
+    , m_Thread() {
+	if (!m_Output.is_open()) {
+		throw std::invalid_argument(
+		    std::string("Could not open trace file ") + fileName);
+	}
+	m_Output.write(TraceSignature, sizeof(TraceSignature));
+	writeValue(m_Output, TraceVersion, 2);
+	writeValue(m_Output, RecordSize, 2);
+#if defined(HAVE_ZLIB)
+	writeValue(m_Output, CompressionZlib, 1);
+#else
+	writeValue(m_Output, CompressionNone, 1);
+#endif
+	m_Thread = std::thread(&CInstructionTrace::run, this);
+}
+
+/**
+ * Flushes and closes the trace
+ */
+CInstructionTrace::~CInstructionTrace() {
+	if (m_Used > 0) {
+		submit();
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Signal.notify_all();
+	m_Thread.join();
+}
+
+/**
+ * Passes active block to writer
+ */
+void CInstructionTrace::submit() {
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Signal.wait(lock, [this]() { return !m_Pending; });
+	m_Pending = true;
+	m_PendingSize = m_Used;
+	m_Active ^= 1;
+	m_Used = 0;
+	lock.unlock();
+	m_Signal.notify_all();
+}
+
+/**
+ * Writes a block
+ *
+ * @param data Block data
+ * @param size Block size
+ */
+void CInstructionTrace::writeBlock(
+    const std::uint8_t *data, std::size_t size) {
+#if defined(HAVE_ZLIB)
+	std::vector<std::uint8_t> compressed(::compressBound(size));
+	::uLongf compressedSize = compressed.size();
+	if (::compress2(compressed.data(), &compressedSize, data, size,
+	        Z_BEST_SPEED) == Z_OK &&
+	    compressedSize < size) {
+		writeValue(m_Output, compressedSize, 4);
+		writeValue(m_Output, size, 4);
+		m_Output.write(
+		    reinterpret_cast<const char *>(compressed.data()), compressedSize);
+		return;
+	}
+#endif
+	writeValue(m_Output, size, 4);
+	writeValue(m_Output, size, 4);
+	m_Output.write(reinterpret_cast<const char *>(data), size);
+}
+
+/**
+ * Writer thread routine
+ */
+void CInstructionTrace::run() {
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	for (;;) {
+		m_Signal.wait(lock, [this]() { return m_Pending || m_Stop; });
+		if (!m_Pending) {
+			break;
+		}
+		const std::uint8_t *data = m_Buffers[m_Active ^ 1].data();
+		std::size_t size = m_PendingSize;
+		lock.unlock();
+		writeBlock(data, size);
+		lock.lock();
+		m_Pending = false;
+		m_Signal.notify_all();
+	}
+	m_Output.flush();
+}
+
+/* CInstructionTraceReader */
+
+/**
+ * Reads trace header
+ *
+ * @param input Input stream
+ */
+CInstructionTraceReader::CInstructionTraceReader(std::istream &input)
+    : m_Input(input)
+    , m_Compression(CInstructionTrace::CompressionNone)
+    , m_Block()
+    , m_Pos(0) {
+	char signature[sizeof(TraceSignature)];
+	m_Input.read(signature, sizeof(signature));
+	if (!m_Input ||
+	    std::memcmp(signature, TraceSignature, sizeof(signature)) != 0) {
+		throw std::invalid_argument("Not an instruction trace");
+	}
+	if (readValue(m_Input, 2) != TraceVersion ||
+	    readValue(m_Input, 2) != CInstructionTrace::RecordSize) {
+		throw std::invalid_argument("Unsupported trace version");
+	}
+	m_Compression =
+	    static_cast<CInstructionTrace::ECompression>(readValue(m_Input, 1));
+	switch (m_Compression) {
+	case CInstructionTrace::CompressionNone:
+#if defined(HAVE_ZLIB)
+	case CInstructionTrace::CompressionZlib:
+#endif
+		break;
+	default:
+		throw std::invalid_argument("Unsupported trace compression");
+	}
+}
+
+/**
+ * Reads next block
+ *
+ * @return False at the end of trace
+ */
+bool CInstructionTraceReader::readBlock() {
+	std::uint32_t storedSize = readValue(m_Input, 4);
+	std::uint32_t size = readValue(m_Input, 4);
+	if (!m_Input) {
+		return false;
+	}
+	std::vector<std::uint8_t> stored(storedSize);
+	m_Input.read(reinterpret_cast<char *>(stored.data()), storedSize);
+	if (!m_Input || size % CInstructionTrace::RecordSize != 0) {
+		throw std::invalid_argument("Truncated trace");
+	}
+	m_Pos = 0;
+	if (storedSize == size) {
+		m_Block.swap(stored);
+		return true;
+	}
+#if defined(HAVE_ZLIB)
+	m_Block.resize(size);
+	::uLongf blockSize = size;
+	if (::uncompress(m_Block.data(), &blockSize, stored.data(), storedSize) ==
+	        Z_OK &&
+	    blockSize == size) {
+		return true;
+	}
+#endif
+	throw std::invalid_argument("Corrupted trace");
+}
+
+/**
+ * Reads next record
+ *
+ * @param record Record
+ * @return False at the end of trace
+ */
+bool CInstructionTraceReader::read(SInstructionRecord *record) {
+	while (m_Pos >= m_Block.size()) {
+		if (!readBlock()) {
+			return false;
+		}
+	}
+	const std::uint8_t *data = m_Block.data() + m_Pos;
+	record->PC = data[0] | (data[1] << 8);
+	record->Bytes[0] = data[2];
+	record->Bytes[1] = data[3];
+	record->Bytes[2] = data[4];
+	record->A = data[5];
+	record->X = data[6];
+	record->Y = data[7];
+	record->S = data[8];
+	record->P = data[9];
+	record->Cycle = 0;
+	for (std::size_t i = 0; i < 8; i++) {
+		record->Cycle |= static_cast<std::uint64_t>(data[10 + i]) << (i * 8);
+	}
+	record->Interrupt = data[18] != 0;
+	m_Pos += CInstructionTrace::RecordSize;
+	return true;
+}
+
+/**
+ * Prints binary instruction trace as text
+ *
+ * @param in Trace stream
+ * @param out Output stream
+ */
+void dumpInstructionTrace(std::istream &in, std::ostream &out) {
+	CInstructionTraceReader reader(in);
+	CDisassembler disassembler;
+	SInstructionRecord record;
+	std::ios_base::fmtflags flags = out.flags();
+	char fill = out.fill();
+	out << std::uppercase << std::hex << std::setfill('0');
+	while (reader.read(&record)) {
+		std::size_t length =
+		    record.Interrupt ? 0 : getInstructionLength(record.Bytes[0]);
+		out << std::setw(4) << record.PC << "  ";
+		for (std::size_t i = 0; i < 3; i++) {
+			if (i < length) {
+				printByte(out, record.Bytes[i]);
+				out << ' ';
+			} else {
+				out << "   ";
+			}
+		}
+		out << ' ' << std::left << std::setfill(' ') << std::setw(32)
+		    << (record.Interrupt
+		               ? "INTERRUPT"
+		               : disassembler.disassemble(record.PC, record.Bytes))
+		    << std::right
+		    << std::setfill('0') << "A:";
+		printByte(out, record.A);
+		out << " X:";
+		printByte(out, record.X);
+		out << " Y:";
+		printByte(out, record.Y);
+		out << " P:";
+		printByte(out, record.P);
+		out << " SP:";
+		printByte(out, record.S);
+		out << " CYC:" << std::dec << record.Cycle << std::hex << '\n';
+	}
+	out.fill(fill);
+	out.flags(flags);
+}
+
+}  // namespace core
+
+}  // namespace vpnes
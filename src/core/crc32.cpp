@@ -0,0 +1,104 @@
+/**
+ * @file
+ *
+ * Implements CRC32 checksum
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/crc32.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Slicing-by-8 lookup tables
+ */
+struct SCRC32Tables {
+	/**
+	 * Tables
+	 */
+	std::uint32_t Table[8][256];
+
+	/**
+	 * Generates the tables
+	 */
+	constexpr SCRC32Tables() : Table() {
+		for (std::uint32_t i = 0; i < 256; i++) {
+			std::uint32_t crc = i;
+			for (int bit = 0; bit < 8; bit++) {
+				crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+			}
+			Table[0][i] = crc;
+		}
+		for (std::uint32_t i = 0; i < 256; i++) {
+			for (int slice = 1; slice < 8; slice++) {
+				std::uint32_t crc = Table[slice - 1][i];
+				Table[slice][i] = (crc >> 8) ^ Table[0][crc & 0xff];
+			}
+		}
+	}
+};
+
+/**
+ * CRC32 tables
+ */
+static constexpr SCRC32Tables CRC32Tables;
+
+/**
+ * Updates CRC32 (IEEE 802.3, as used by ROM databases)
+ *
+ * Processes eight bytes per step using slicing-by-8 tables.
+ *
+ * @param crc Previous CRC32 (0 for the first block)
+ * @param data Data
+ * @param size Data size
+ * @return Updated CRC32
+ */
+std::uint32_t updateCRC32(
+    std::uint32_t crc, const std::uint8_t *data, std::size_t size) {
+	const auto &table = CRC32Tables.Table;
+	crc = ~crc;
+	for (; size >= 8; size -= 8, data += 8) {
+		std::uint32_t low = crc ^ (data[0] | (data[1] << 8) |
+		                              (data[2] << 16) |
+		                              (static_cast<std::uint32_t>(data[3]) << 24));
+		crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+		      table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+		      table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^
+		      table[0][data[7]];
+	}
+	for (; size > 0; size--, data++) {
+		crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xff];
+	}
+	return ~crc;
+}
+
+}  // namespace core
+
+}  // namespace vpnes
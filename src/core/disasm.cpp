@@ -0,0 +1,199 @@
+/**
+ * @file
+ *
+ * Implements 6502 disassembler
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/cpu.hpp>
+#include <vpnes/core/disasm.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Gets length of 6502 instruction
+ *
+ * @param opcode Opcode
+ * @return Length in bytes
+ */
+std::size_t getInstructionLength(std::uint8_t opcode) {
+	switch (CCPU::getInstructionInfo(opcode).Mode) {
+	case ModeImplied:
+	case ModeAccumulator:
+		return 1;
+	case ModeAbsolute:
+	case ModeAbsoluteX:
+	case ModeAbsoluteY:
+	case ModeIndirect:
+		return 3;
+	default:
+		return 2;
+	}
+}
+
+/* CDisassembler */
+
+/**
+ * Gets cache entry
+ *
+ * @param addr Address
+ * @return Cache entry
+ */
+CDisassembler::SEntry &CDisassembler::getEntry(std::uint16_t addr) {
+	std::unique_ptr<SEntry[]> &bank = m_Banks[addr / BankSize];
+	if (!bank) {
+		bank.reset(new SEntry[BankSize]());
+	}
+	return bank[addr % BankSize];
+}
+
+/**
+ * Decodes instruction without cache
+ *
+ * @param addr Instruction address
+ * @param bytes Instruction bytes (up to 3)
+ * @param text Output buffer of at least MaxText characters
+ */
+void CDisassembler::format(
+    std::uint16_t addr, const std::uint8_t *bytes, char *text) {
+	const SInstructionInfo &info = CCPU::getInstructionInfo(bytes[0]);
+	unsigned zp = bytes[1];
+	unsigned abs = bytes[1] | (bytes[2] << 8);
+	switch (info.Mode) {
+	case ModeImplied:
+		std::snprintf(text, MaxText, "%s", info.Name);
+		break;
+	case ModeAccumulator:
+		std::snprintf(text, MaxText, "%s A", info.Name);
+		break;
+	case ModeImmediate:
+		std::snprintf(text, MaxText, "%s #$%02X", info.Name, zp);
+		break;
+	case ModeZeroPage:
+		std::snprintf(text, MaxText, "%s $%02X", info.Name, zp);
+		break;
+	case ModeZeroPageX:
+		std::snprintf(text, MaxText, "%s $%02X,X", info.Name, zp);
+		break;
+	case ModeZeroPageY:
+		std::snprintf(text, MaxText, "%s $%02X,Y", info.Name, zp);
+		break;
+	case ModeAbsolute:
+		std::snprintf(text, MaxText, "%s $%04X", info.Name, abs);
+		break;
+	case ModeAbsoluteX:
+		std::snprintf(text, MaxText, "%s $%04X,X", info.Name, abs);
+		break;
+	case ModeAbsoluteY:
+		std::snprintf(text, MaxText, "%s $%04X,Y", info.Name, abs);
+		break;
+	case ModeIndirect:
+		std::snprintf(text, MaxText, "%s ($%04X)", info.Name, abs);
+		break;
+	case ModeIndirectX:
+		std::snprintf(text, MaxText, "%s ($%02X,X)", info.Name, zp);
+		break;
+	case ModeIndirectY:
+		std::snprintf(text, MaxText, "%s ($%02X),Y", info.Name, zp);
+		break;
+	case ModeRelative:
+		std::snprintf(text, MaxText, "%s $%04X", info.Name,
+		    static_cast<std::uint16_t>(
+		        addr + 2 + static_cast<std::int8_t>(bytes[1])));
+		break;
+	}
+}
+
+/**
+ * Decodes instruction
+ *
+ * @param addr Instruction address
+ * @param bytes Instruction bytes (up to 3)
+ * @return Decoded text valid until next call for the same address
+ */
+const char *CDisassembler::disassemble(
+    std::uint16_t addr, const std::uint8_t *bytes) {
+	SEntry &entry = getEntry(addr);
+	std::size_t length = getInstructionLength(bytes[0]);
+	bool valid = entry.Valid;
+	for (std::size_t i = 0; valid && i < length; i++) {
+		valid = entry.Bytes[i] == bytes[i];
+	}
+	if (!valid) {
+		for (std::size_t i = 0; i < 3; i++) {
+			entry.Bytes[i] = i < length ? bytes[i] : 0;
+		}
+		format(addr, entry.Bytes, entry.Text);
+		entry.Valid = true;
+	}
+	return entry.Text;
+}
+
+/**
+ * Decodes instruction from memory
+ *
+ * @param addr Instruction address
+ * @param read Memory reader
+ * @return Decoded text valid until next call for the same address
+ */
+const char *CDisassembler::disassemble(
+    std::uint16_t addr, const reader_t &read) {
+	std::uint8_t bytes[3] = {read(addr), 0, 0};
+	std::size_t length = getInstructionLength(bytes[0]);
+	for (std::size_t i = 1; i < length; i++) {
+		bytes[i] = read(static_cast<std::uint16_t>(addr + i));
+	}
+	return disassemble(addr, bytes);
+}
+
+/**
+ * Drops cached instructions
+ *
+ * @param first First address
+ * @param last Last address (inclusive)
+ */
+void CDisassembler::invalidate(std::uint16_t first, std::uint16_t last) {
+	for (std::size_t addr = first; addr <= last; addr++) {
+		std::unique_ptr<SEntry[]> &bank = m_Banks[addr / BankSize];
+		if (!bank) {
+			addr |= BankSize - 1;
+		} else if (addr % BankSize == 0 && last - addr >= BankSize - 1) {
+			bank.reset();
+			addr += BankSize - 1;
+		} else {
+			bank[addr % BankSize].Valid = false;
+		}
+	}
+}
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,91 @@
+/**
+ * @file
+ *
+ * Implements mapper registry
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdint>
+#include <stdexcept>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/factory.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Registered factories by mapper number
+ *
+ * Constant initialized, so it is ready before any registrar runs.
+ */
+static const CMapperRegistry::SEntry
+    *registryTable[CMapperRegistry::MapperCount];
+
+/* CMapperRegistry */
+
+/**
+ * Registers factory
+ *
+ * Mapper number out of range is a programming error, it terminates static
+ * initialization, so it does not get unnoticed in release builds.
+ *
+ * @param mapper Mapper number
+ * @param entry Registered factory
+ */
+void CMapperRegistry::add(std::uint16_t mapper, SEntry *entry) {
+	if (mapper >= MapperCount) {
+		throw std::invalid_argument("Invalid mapper number");
+	}
+	entry->Next = registryTable[mapper];
+	registryTable[mapper] = entry;
+}
+
+/**
+ * Finds factory
+ *
+ * @param mapper Mapper number
+ * @param submapper Submapper number
+ * @return Factory or nullptr if mapper is not supported
+ */
+NESFactory CMapperRegistry::find(std::uint16_t mapper, std::uint8_t submapper) {
+	if (mapper >= MapperCount) {
+		return nullptr;
+	}
+	NESFactory factory = nullptr;
+	for (const SEntry *entry = registryTable[mapper]; entry;
+	     entry = entry->Next) {
+		if (entry->Submapper == submapper) {
+			return entry->Factory;
+		} else if (entry->Submapper == AnySubmapper) {
+			factory = entry->Factory;
+		}
+	}
+	return factory;
+}
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,197 @@
+/**
+ * @file
+ *
+ * Implements ROM image storage
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(HAVE_SYS_MMAN_H)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/archive.hpp>
+#include <vpnes/core/image.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/* CROMImage */
+
+/**
+ * Takes over the mapping
+ *
+ * @param data Mapped data
+ * @param size Mapped size
+ */
+CROMImage::CROMImage(const std::uint8_t *data, std::size_t size)
+    : m_Data(data), m_Size(size), m_Buffer(), m_Mapped(true) {
+}
+
+/**
+ * Takes over the buffer
+ *
+ * @param buffer Image data
+ */
+CROMImage::CROMImage(std::vector<std::uint8_t> &&buffer)
+    : m_Data(), m_Size(), m_Buffer(std::move(buffer)), m_Mapped(false) {
+	m_Data = m_Buffer.data();
+	m_Size = m_Buffer.size();
+}
+
+/**
+ * Unmaps the image
+ */
+CROMImage::~CROMImage() {
+	if (!m_Mapped) {
+		return;
+	}
+#if defined(HAVE_SYS_MMAN_H)
+	::munmap(const_cast<std::uint8_t *>(m_Data), m_Size);
+#elif defined(_WIN32)
+	::UnmapViewOfFile(m_Data);
+#endif
+}
+
+/**
+ * Maps the file
+ *
+ * Falls back to reading the file if mapping is not supported.
+ *
+ * @param fileName File name
+ * @return ROM image
+ */
+std::shared_ptr<CROMImage> CROMImage::map(const char *fileName) {
+#if defined(HAVE_SYS_MMAN_H)
+	int file = ::open(fileName, O_RDONLY);
+	if (file < 0) {
+		throw std::invalid_argument(
+		    std::string("Could not open ROM file ") + fileName);
+	}
+	struct stat info;
+	void *data = MAP_FAILED;
+	if (::fstat(file, &info) == 0 && info.st_size > 0) {
+		data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	::close(file);
+	if (data != MAP_FAILED) {
+		return std::shared_ptr<CROMImage>(new CROMImage(
+		    static_cast<const std::uint8_t *>(data), info.st_size));
+	}
+#elif defined(_WIN32)
+	HANDLE file = ::CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ,
+	    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw std::invalid_argument(
+		    std::string("Could not open ROM file ") + fileName);
+	}
+	LARGE_INTEGER size;
+	const void *data = nullptr;
+	if (::GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+		HANDLE mapping =
+		    ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) {
+			// View keeps the mapping alive after the handles are closed
+			data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			::CloseHandle(mapping);
+		}
+	}
+	::CloseHandle(file);
+	if (data) {
+		return std::shared_ptr<CROMImage>(
+		    new CROMImage(static_cast<const std::uint8_t *>(data),
+		        static_cast<std::size_t>(size.QuadPart)));
+	}
+#endif
+	std::ifstream input(fileName, std::ifstream::binary);
+	if (!input.is_open()) {
+		throw std::invalid_argument(
+		    std::string("Could not open ROM file ") + fileName);
+	}
+	return read(&input);
+}
+
+/**
+ * Reads the stream to the end
+ *
+ * @param input Input stream
+ * @return ROM image
+ */
+std::shared_ptr<CROMImage> CROMImage::read(std::istream *input) {
+	std::vector<std::uint8_t> buffer;
+	char block[0x4000];
+	while (input->read(block, sizeof(block)) || input->gcount() > 0) {
+		buffer.insert(buffer.end(), block, block + input->gcount());
+	}
+	return std::make_shared<CROMImage>(std::move(buffer));
+}
+
+/**
+ * Decompresses the image if it is a zip or gzip container
+ *
+ * @param image ROM image
+ * @return Decompressed image or the same image if not compressed
+ */
+std::shared_ptr<CROMImage> CROMImage::unpack(
+    const std::shared_ptr<CROMImage> &image) {
+	if (archive::detectContainer(image->data(), image->size()) ==
+	    archive::ContainerNone) {
+		return image;
+	}
+	return std::make_shared<CROMImage>(
+	    archive::extractROM(image->data(), image->size()));
+}
+
+/**
+ * Gets a view into the image
+ *
+ * @param offset Offset
+ * @param size Size
+ * @return View
+ */
+CROMSpan CROMImage::getSpan(std::size_t offset, std::size_t size) const {
+	if (offset > m_Size || size > m_Size - offset) {
+		throw std::invalid_argument("Truncated ROM file");
+	}
+	return CROMSpan(m_Data + offset, size);
+}
+
+}  // namespace core
+
+}  // namespace vpnes
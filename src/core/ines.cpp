@@ -29,11 +29,15 @@
 
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <stdexcept>
-#include <fstream>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/core/config.hpp>
+#include <vpnes/core/factory.hpp>
+#include <vpnes/core/image.hpp>
 #include <vpnes/core/ines.hpp>
+#include <vpnes/core/crc32.hpp>
+#include <vpnes/core/romdb.hpp>
 
 namespace vpnes {
 
@@ -41,78 +45,173 @@ namespace core {
 
 namespace ines {
 
+/**
+ * Decodes NES 2.0 ROM size
+ *
+ * @param lsb Size LSB
+ * @param msb Size MSB
+ * @param unit Size unit
+ * @return Size in bytes
+ */
+static std::size_t getROMSize(
+    std::uint8_t lsb, std::uint8_t msb, std::size_t unit) {
+	if (msb != 0x0f) {
+		return ((msb << 8) | lsb) * unit;
+	}
+	// Exponent-multiplier notation: 2^E * (MM * 2 + 1)
+	std::size_t exponent = lsb >> 2;
+	if (exponent >= 30) {
+		throw std::invalid_argument("Wrong ROM size");
+	}
+	return (static_cast<std::size_t>(1) << exponent) * ((lsb & 0x03) * 2 + 1);
+}
+
+/**
+ * Decodes NES 2.0 RAM size
+ *
+ * @param shift Shift count
+ * @return Size in bytes
+ */
+static std::size_t getRAMSize(std::uint8_t shift) {
+	return shift ? static_cast<std::size_t>(64) << shift : 0;
+}
+
 /* SNESData */
 
 /**
- * Constructs the structure from the data
+ * Constructs the structure from the image
+ *
+ * Banks are views into the image, nothing is copied.
  *
- * @param ROM
+ * @param image ROM image
  */
-SNESData::SNESData(std::ifstream *ROM) : PRG(), CHR(), Trainer() {
+SNESData::SNESData(const std::shared_ptr<CROMImage> &image)
+    : Image(image), PRG(), CHR(), Trainer() {
 	const char *iNESSignature = "NES\32";
-	uint8_t mapper;
 	iNES_Header header;
+	std::size_t offset = sizeof(header);
 
-	ROM->read(reinterpret_cast<char *>(&header), sizeof(header));
+	std::memcpy(&header, Image->getSpan(0, sizeof(header)).data(),
+	    sizeof(header));
 	if (strncmp(header.Signature, iNESSignature, 4)) {
 		throw std::invalid_argument("Unknown file format");
 	}
-	if ((header.Flags_ex & 0x0c) == 0x08) {
-		throw std::invalid_argument("Wrong version");
-	}
-	PRGSize = header.PRGSize * 0x4000;
-	CHRSize = header.CHRSize * 0x2000;
 	switch (header.Flags & 0x09) {
 	case 0x01:
 		Mirroring = MirroringVertical;
 		break;
 	case 0x08:
+	case 0x09:
 		Mirroring = MirroringFourScreens;
 		break;
 	default:
 		Mirroring = MirroringHorizontal;
 	}
-	BatterySize = (header.Flags & 0x02) ? 0x2000 : 0;
-	mapper = header.Flags >> 4;
+	if ((header.Flags_ex & 0x0c) == 0x08) {
+		NES20_Header header20;
+		std::memcpy(&header20, &header, sizeof(header20));
+		parseNES20(header20);
+	} else {
+		parseINES(header);
+	}
+	if (header.Flags & 0x04) {
+		Trainer = Image->getSpan(offset, 0x0200);
+		offset += Trainer.size();
+	}
+	PRG = Image->getSpan(offset, PRGSize);
+	offset += PRGSize;
+	CHR = Image->getSpan(offset, CHRSize);
+	applyDatabase();
+	if (CMapperRegistry::find(Mapper, Submapper) == nullptr) {
+		throw std::invalid_argument("Unsupported mapper");
+	}
+}
+
+/**
+ * Parses iNES header
+ *
+ * @param header Header
+ */
+void SNESData::parseINES(const iNES_Header &header) {
+	std::size_t ramSize;
+
+	PRGSize = header.PRGSize * 0x4000;
+	CHRSize = header.CHRSize * 0x2000;
+	CHRRAMSize = CHRSize ? 0 : 0x2000;
+	CHRBatterySize = 0;
+	Mapper = header.Flags >> 4;
+	Submapper = 0;
 	if (header.BadROM) {
 		NESType = NESTypeNTSC;
-		RAMSize = 0;
+		ramSize = 0x2000;
 	} else {
-		mapper |= header.Flags_ex & 0xf0;
-		switch (header.TV_system) {
-		case 0x02:
-			NESType = NESTypePAL;
-			break;
-		default:
-			NESType = NESTypeNTSC;
-		}
-		RAMSize = (header.RAMSize == 0 && !(header.Flags_unofficial & 0x10))
+		Mapper |= header.Flags_ex & 0xf0;
+		NESType = (header.TV_system & 0x01) ? NESTypePAL : NESTypeNTSC;
+		ramSize = (header.RAMSize == 0 && !(header.Flags_unofficial & 0x10))
 		              ? 0x2000
 		              : header.RAMSize * 0x2000;
 	}
-	if (header.Flags & 0x04) {
-		Trainer.resize(0x0200);
-		ROM->read(
-		    reinterpret_cast<char *>(Trainer.data()), 0x0200 * sizeof(uint8_t));
-	}
-	PRG.resize(PRGSize);
-	ROM->read(reinterpret_cast<char *>(PRG.data()), PRGSize * sizeof(uint8_t));
-	if (CHRSize) {
-		CHR.resize(CHRSize);
-		ROM->read(
-		    reinterpret_cast<char *>(CHR.data()), CHRSize * sizeof(uint8_t));
+	if (header.Flags & 0x02) {
+		RAMSize = 0;
+		BatterySize = ramSize;
+	} else {
+		RAMSize = header.BadROM ? 0 : ramSize;
+		BatterySize = 0;
 	}
-	switch (mapper) {
-	case 0:
-		if (PRGSize > 0x4000) {
-			MMCType = MMCNROM256;
-		} else {
-			MMCType = MMCNROM128;
-		}
+}
+
+/**
+ * Parses NES 2.0 header
+ *
+ * @param header Header
+ */
+void SNESData::parseNES20(const NES20_Header &header) {
+	PRGSize = getROMSize(header.PRGSize, header.ROMSize_ex & 0x0f, 0x4000);
+	CHRSize = getROMSize(header.CHRSize, header.ROMSize_ex >> 4, 0x2000);
+	RAMSize = getRAMSize(header.RAMSize & 0x0f);
+	BatterySize = getRAMSize(header.RAMSize >> 4);
+	CHRRAMSize = getRAMSize(header.CHRRAMSize & 0x0f);
+	CHRBatterySize = getRAMSize(header.CHRRAMSize >> 4);
+	Mapper = (header.Flags >> 4) | (header.Flags_ex & 0xf0) |
+	         ((header.Mapper_ex & 0x0f) << 8);
+	Submapper = header.Mapper_ex >> 4;
+	switch (header.Timing & 0x03) {
+	case 0x01:
+		NESType = NESTypePAL;
+		break;
+	case 0x02:
+		NESType = NESTypeMultiRegion;
+		break;
+	case 0x03:
+		NESType = NESTypeDendy;
 		break;
 	default:
-		throw std::invalid_argument("Unsupported mapper");
+		NESType = NESTypeNTSC;
+	}
+}
+
+/**
+ * Corrects header data from ROM database
+ *
+ * @return True if ROM is known
+ */
+bool SNESData::applyDatabase() {
+	CRC32 = updateCRC32(0, PRG.data(), PRG.size());
+	CRC32 = updateCRC32(CRC32, CHR.data(), CHR.size());
+	const romdb::SROMInfo *info = romdb::findROM(CRC32);
+	if (!info) {
+		return false;
+	}
+	Mapper = info->Mapper;
+	Submapper = info->Submapper;
+	if (Mirroring != MirroringFourScreens) {
+		Mirroring = info->Mirroring;
 	}
+	RAMSize = info->RAMSize;
+	BatterySize = info->BatterySize;
+	CHRRAMSize = info->CHRRAMSize;
+	CHRBatterySize = 0;
+	return true;
 }
 
 }  // namespace ines
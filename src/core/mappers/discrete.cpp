@@ -0,0 +1,91 @@
+/**
+ * @file
+ *
+ * Implements discrete logic mappers (UxROM, CNROM, AxROM)
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/factory.hpp>
+#include <vpnes/core/mappers/helper.hpp>
+#include <vpnes/core/mappers/discrete.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace factory {
+
+/**
+ * Discrete mapper NES factory
+ *
+ * @param config NES config
+ * @param frontEnd Front-end
+ * @return NES
+ */
+template <class Mapper>
+static CNES *factoryDiscrete(const SNESConfig &config, CFrontEnd *frontEnd) {
+	return factoryNES<Mapper>(config, frontEnd);
+}
+
+/**
+ * Registers UxROM (mapper 2)
+ */
+static CMapperRegistrar registrarUxROM(
+    2, CMapperRegistry::AnySubmapper, &factoryDiscrete<CUxROM>);
+/**
+ * Registers UxROM without bus conflicts (mapper 2, submapper 1)
+ */
+static CMapperRegistrar registrarUxROMNoConflicts(
+    2, 1, &factoryDiscrete<CDiscrete<false, 0x4000, 0, false>>);
+/**
+ * Registers CNROM (mapper 3)
+ */
+static CMapperRegistrar registrarCNROM(
+    3, CMapperRegistry::AnySubmapper, &factoryDiscrete<CCNROM>);
+/**
+ * Registers CNROM without bus conflicts (mapper 3, submapper 1)
+ */
+static CMapperRegistrar registrarCNROMNoConflicts(
+    3, 1, &factoryDiscrete<CDiscrete<false, 0, 0x2000, false>>);
+/**
+ * Registers AxROM (mapper 7)
+ */
+static CMapperRegistrar registrarAxROM(
+    7, CMapperRegistry::AnySubmapper, &factoryDiscrete<CAxROM>);
+/**
+ * Registers AMROM with bus conflicts (mapper 7, submapper 2)
+ */
+static CMapperRegistrar registrarAMROM(
+    7, 2, &factoryDiscrete<CDiscrete<true, 0x8000, 0, true>>);
+
+}  // namespace factory
+
+}  // namespace core
+
+}  // namespace vpnes
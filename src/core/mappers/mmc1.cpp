@@ -0,0 +1,263 @@
+/**
+ * @file
+ *
+ * Implements MMC1 (SxROM)
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/factory.hpp>
+#include <vpnes/core/mappers/helper.hpp>
+#include <vpnes/core/mappers/mmc1.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace factory {
+
+/**
+ * MMC1 NES factory
+ *
+ * @param config NES config
+ * @param frontEnd Front-end
+ * @return NES
+ */
+static CNES *factoryMMC1(const SNESConfig &config, CFrontEnd *frontEnd) {
+	return factoryNES<CMMC1>(config, frontEnd);
+}
+
+/**
+ * Registers MMC1 (mapper 1)
+ */
+static CMapperRegistrar registrarMMC1(
+    1, CMapperRegistry::AnySubmapper, &factoryMMC1);
+
+}  // namespace factory
+
+/* CMMC1 */
+
+/**
+ * Constructs the object
+ *
+ * @param motherBoard Motherboard
+ * @param config NES config
+ */
+CMMC1::CMMC1(CMotherBoard *motherBoard, const SNESConfig &config)
+    : m_MotherBoard(motherBoard)
+    , m_Image(config.Image)
+    , m_PRG(config.PRG)
+    , m_CHR(config.CHR)
+    , m_CHRRAM()
+    , m_RAM(config, 0x2000)
+    , m_NameTable(config.Mirroring == MirroringHorizontal ||
+                          config.Mirroring == MirroringVertical
+                      ? config.Mirroring
+                      : MirroringSingleScreen1)
+    , m_CHRBank()
+    , m_Shift()
+    , m_ShiftCount()
+    , m_LastWrite(-2 * CPUCycle)
+    , m_Control(ControlPRGMode)
+    , m_CHRReg0()
+    , m_CHRReg1()
+    , m_PRGReg()
+    , m_RAMEnabled()
+    , m_RAMMap()
+    , m_PRGMap()
+    , m_CHRMap() {
+	if (m_CHR.empty()) {
+		m_CHRRAM.assign(config.CHRRAMSize + config.CHRBatterySize, 0);
+		m_CHR = CROMSpan(m_CHRRAM.data(), m_CHRRAM.size());
+		m_CHRBank = 2;
+	}
+	if (m_PRG.size() < 0x4000 || m_PRG.size() > 0x80000 ||
+	    (m_PRG.size() & (m_PRG.size() - 1)) || m_CHR.size() < 0x2000 ||
+	    m_CHR.size() > 0x20000 || (m_CHR.size() & (m_CHR.size() - 1)) ||
+	    m_RAM.size() > 0x8000 || (m_RAM.size() & (m_RAM.size() - 1))) {
+		throw std::invalid_argument("Invalid ROM parameters");
+	}
+	switch (config.Mirroring) {
+	case MirroringHorizontal:
+		m_Control |= 0x03;
+		break;
+	case MirroringVertical:
+		m_Control |= 0x02;
+		break;
+	default:
+		break;
+	}
+	EMirroring mirroring;
+	m_RAMEnabled = !m_RAM.empty();
+	getMapping(&m_RAMMap, m_PRGMap, m_CHRMap, &mirroring);
+}
+
+/**
+ * Calculates mapping from registers
+ *
+ * @param ramMap PRG RAM bank
+ * @param prgMap PRG ROM banks
+ * @param chrMap CHR banks
+ * @param mirroring Mirroring
+ */
+void CMMC1::getMapping(std::uint8_t **ramMap, std::uint8_t **prgMap,
+    std::uint8_t **chrMap, EMirroring *mirroring) {
+	// SXROM and SOROM select PRG RAM bank with CHR bank 0 register
+	if (m_RAM.size() > 0x4000) {
+		*ramMap = m_RAM.data() + (m_CHRReg0 & 0x0c) * 0x0800;
+	} else if (m_RAM.size() > 0x2000) {
+		*ramMap = m_RAM.data() + (m_CHRReg0 & 0x08) * 0x0400;
+	} else {
+		*ramMap = m_RAM.data();
+	}
+	// SUROM selects 256 KB PRG ROM half with CHR bank 0 register
+	std::size_t outerBank = m_CHRReg0 & 0x10;
+	std::size_t bank = m_PRGReg & 0x0f;
+	switch ((m_Control & ControlPRGMode) >> 2) {
+	case 0:
+	case 1:
+		prgMap[0] = getPRG(outerBank | (bank & 0x0e));
+		prgMap[1] = getPRG(outerBank | bank | 0x01);
+		break;
+	case 2:
+		prgMap[0] = getPRG(outerBank);
+		prgMap[1] = getPRG(outerBank | bank);
+		break;
+	default:
+		prgMap[0] = getPRG(outerBank | bank);
+		prgMap[1] = getPRG(outerBank | 0x0f);
+		break;
+	}
+	if (m_Control & ControlCHRMode) {
+		chrMap[0] = getCHR(m_CHRReg0);
+		chrMap[1] = getCHR(m_CHRReg1);
+	} else {
+		chrMap[0] = getCHR(m_CHRReg0 & 0x1e);
+		chrMap[1] = getCHR(m_CHRReg0 | 0x01);
+	}
+	switch (m_Control & ControlMirroring) {
+	case 0:
+		*mirroring = MirroringSingleScreen1;
+		break;
+	case 1:
+		*mirroring = MirroringSingleScreen2;
+		break;
+	case 2:
+		*mirroring = MirroringVertical;
+		break;
+	default:
+		*mirroring = MirroringHorizontal;
+		break;
+	}
+}
+
+/**
+ * Writes MMC1 register
+ *
+ * MMC1 ignores a write on the cycle right after another write, so
+ * read-modify-write instructions load only their first (unmodified) value.
+ *
+ * @param val Value
+ * @param addr Address
+ */
+void CMMC1::writeReg(std::uint8_t val, std::uint16_t addr) {
+	ticks_t time = m_MotherBoard->getElapsedTicks();
+	bool consecutive = (time - m_LastWrite) <= CPUCycle;
+	m_LastWrite = time;
+	if (consecutive) {
+		return;
+	}
+	if (val & 0x80) {
+		m_Shift = 0;
+		m_ShiftCount = 0;
+		m_Control |= ControlPRGMode;
+		updateMapping();
+		return;
+	}
+	m_Shift |= (val & 0x01) << m_ShiftCount;
+	if (++m_ShiftCount < 5) {
+		return;
+	}
+	switch (addr & 0x6000) {
+	case 0x0000:
+		m_Control = m_Shift;
+		break;
+	case 0x2000:
+		m_CHRReg0 = m_Shift;
+		break;
+	case 0x4000:
+		m_CHRReg1 = m_Shift;
+		break;
+	default:
+		m_PRGReg = m_Shift;
+		break;
+	}
+	m_Shift = 0;
+	m_ShiftCount = 0;
+	updateMapping();
+}
+
+/**
+ * Remaps bank windows changed by the registers
+ */
+void CMMC1::updateMapping() {
+	std::uint8_t *ramMap;
+	std::uint8_t *prgMap[2];
+	std::uint8_t *chrMap[2];
+	EMirroring mirroring;
+	CBus *busCPU = m_MotherBoard->getBusCPU();
+	CBus *busPPU = m_MotherBoard->getBusPPU();
+	getMapping(&ramMap, prgMap, chrMap, &mirroring);
+	if (ramMap != m_RAMMap) {
+		m_RAMMap = ramMap;
+		busCPU->switchBank(this, 1, m_RAMMap);
+	}
+	for (std::size_t i = 0; i < 2; i++) {
+		if (prgMap[i] != m_PRGMap[i]) {
+			m_PRGMap[i] = prgMap[i];
+			busCPU->switchBank(this, 2 + i, m_PRGMap[i]);
+		}
+		if (chrMap[i] != m_CHRMap[i]) {
+			m_CHRMap[i] = chrMap[i];
+			busPPU->switchBank(this, m_CHRBank + i, m_CHRMap[i]);
+		}
+	}
+	m_NameTable.setMirroring(mirroring, busPPU, this, 4);
+	// MMC1B disables PRG RAM with bit 4 of PRG bank register
+	bool ramEnabled = !m_RAM.empty() && !(m_PRGReg & 0x10);
+	if (ramEnabled != m_RAMEnabled) {
+		m_RAMEnabled = ramEnabled;
+		busCPU->updatePatches();
+	}
+}
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,407 @@
+/**
+ * @file
+ *
+ * Implements MMC3 (TxROM)
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/factory.hpp>
+#include <vpnes/core/mappers/helper.hpp>
+#include <vpnes/core/mappers/mmc3.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace factory {
+
+/**
+ * MMC3 NES factory
+ *
+ * @param config NES config
+ * @param frontEnd Front-end
+ * @return NES
+ */
+static CNES *factoryMMC3(const SNESConfig &config, CFrontEnd *frontEnd) {
+	return factoryNES<CMMC3>(config, frontEnd);
+}
+
+/**
+ * Registers MMC3 (mapper 4)
+ */
+static CMapperRegistrar registrarMMC3(
+    4, CMapperRegistry::AnySubmapper, &factoryMMC3);
+
+}  // namespace factory
+
+/* CMMC3 */
+
+/**
+ * Constructs the object
+ *
+ * @param motherBoard Motherboard
+ * @param config NES config
+ */
+template <class Config>
+CMMC3<Config>::CMMC3(CMotherBoard *motherBoard, const SNESConfig &config)
+    : m_MotherBoard(motherBoard)
+    , m_Image(config.Image)
+    , m_PRG(config.PRG)
+    , m_CHR(config.CHR)
+    , m_CHRRAM()
+    , m_RAM(config, 0x2000)
+    , m_NameTable(config.Mirroring == MirroringFourScreens ||
+                          config.Mirroring == MirroringHorizontal
+                      ? config.Mirroring
+                      : MirroringVertical)
+    , m_CHRBank()
+    , m_BankSelect()
+    , m_Banks{0, 2, 4, 5, 6, 7, 0, 1}
+    , m_Mirroring(config.Mirroring == MirroringHorizontal)
+    , m_RAMProtect(0x80)
+    , m_PRGMap()
+    , m_CHRMap()
+    , m_IRQLatch()
+    , m_IRQCounter()
+    , m_IRQReload()
+    , m_IRQEnabled()
+    , m_IRQTime()
+    , m_PPUControl()
+    , m_PPUMask()
+    , m_IRQEvent() {
+	if (m_CHR.empty()) {
+		m_CHRRAM.assign(config.CHRRAMSize + config.CHRBatterySize, 0);
+		m_CHR = CROMSpan(m_CHRRAM.data(), m_CHRRAM.size());
+		m_CHRBank = 8;
+	}
+	if (m_PRG.size() < 0x4000 || m_PRG.size() > 0x80000 ||
+	    (m_PRG.size() & (m_PRG.size() - 1)) || m_CHR.size() < 0x2000 ||
+	    m_CHR.size() > 0x40000 || (m_CHR.size() & (m_CHR.size() - 1)) ||
+	    m_RAM.size() > 0x2000) {
+		throw std::invalid_argument("Invalid ROM parameters");
+	}
+	EMirroring mirroring;
+	getMapping(m_PRGMap, m_CHRMap, &mirroring);
+	m_IRQEvent = m_MotherBoard->registerEvent(
+	    this, m_MotherBoard, "MMC3_IRQ", 0, false, &CMMC3::handleIRQ);
+}
+
+/**
+ * Calculates mapping from registers
+ *
+ * @param prgMap PRG ROM banks
+ * @param chrMap CHR banks
+ * @param mirroring Mirroring
+ */
+template <class Config>
+void CMMC3<Config>::getMapping(
+    std::uint8_t **prgMap, std::uint8_t **chrMap, EMirroring *mirroring) {
+	std::size_t lastBank = m_PRG.size() / 0x2000 - 1;
+	std::size_t swap = (m_BankSelect & 0x40) ? 2 : 0;
+	prgMap[swap] = getPRG(m_Banks[6]);
+	prgMap[1] = getPRG(m_Banks[7]);
+	prgMap[2 - swap] = getPRG(lastBank - 1);
+	prgMap[3] = getPRG(lastBank);
+	std::size_t invert = (m_BankSelect & 0x80) ? 4 : 0;
+	chrMap[invert] = getCHR(m_Banks[0] & 0xfe);
+	chrMap[invert + 1] = getCHR(m_Banks[0] | 0x01);
+	chrMap[invert + 2] = getCHR(m_Banks[1] & 0xfe);
+	chrMap[invert + 3] = getCHR(m_Banks[1] | 0x01);
+	for (std::size_t i = 0; i < 4; i++) {
+		chrMap[(invert ^ 4) + i] = getCHR(m_Banks[2 + i]);
+	}
+	if (m_NameTable.hasFourScreens()) {
+		*mirroring = MirroringFourScreens;
+	} else if (m_Mirroring & 0x01) {
+		*mirroring = MirroringHorizontal;
+	} else {
+		*mirroring = MirroringVertical;
+	}
+}
+
+/**
+ * Remaps bank windows changed by the registers
+ */
+template <class Config>
+void CMMC3<Config>::updateMapping() {
+	std::uint8_t *prgMap[4];
+	std::uint8_t *chrMap[8];
+	EMirroring mirroring;
+	CBus *busCPU = m_MotherBoard->getBusCPU();
+	CBus *busPPU = m_MotherBoard->getBusPPU();
+	getMapping(prgMap, chrMap, &mirroring);
+	for (std::size_t i = 0; i < 4; i++) {
+		if (prgMap[i] != m_PRGMap[i]) {
+			m_PRGMap[i] = prgMap[i];
+			busCPU->switchBank(this, 3 + i, m_PRGMap[i]);
+		}
+	}
+	for (std::size_t i = 0; i < 8; i++) {
+		if (chrMap[i] != m_CHRMap[i]) {
+			m_CHRMap[i] = chrMap[i];
+			busPPU->switchBank(this, m_CHRBank + i, m_CHRMap[i]);
+		}
+	}
+	m_NameTable.setMirroring(mirroring, busPPU, this, 16);
+}
+
+/**
+ * Writes MMC3 register
+ *
+ * @param val Value
+ * @param addr Address
+ */
+template <class Config>
+void CMMC3<Config>::writeReg(std::uint8_t val, std::uint16_t addr) {
+	switch (addr & 0xe001) {
+	case 0x8000:
+		m_BankSelect = val;
+		updateMapping();
+		break;
+	case 0x8001:
+		m_Banks[m_BankSelect & 0x07] = val;
+		updateMapping();
+		break;
+	case 0xa000:
+		m_Mirroring = val;
+		updateMapping();
+		break;
+	case 0xa001:
+		if ((m_RAMProtect ^ val) & 0xc0) {
+			m_RAMProtect = val;
+			m_MotherBoard->getBusCPU()->updatePatches();
+		}
+		break;
+	case 0xc000:
+		syncCounter();
+		m_IRQLatch = val;
+		scheduleIRQ();
+		break;
+	case 0xc001:
+		syncCounter();
+		m_IRQCounter = 0;
+		m_IRQReload = true;
+		scheduleIRQ();
+		break;
+	case 0xe000:
+		syncCounter();
+		m_IRQEnabled = false;
+		m_MotherBoard->setIRQ(CMotherBoard::IRQMMC, false);
+		scheduleIRQ();
+		break;
+	default:
+		syncCounter();
+		m_IRQEnabled = true;
+		scheduleIRQ();
+		break;
+	}
+}
+
+/**
+ * Tracks PPU control and mask registers
+ *
+ * Rises predicted from the previous settings are counted up to the write
+ * before the new settings are used.
+ *
+ * @param val Value
+ * @param addr Address
+ */
+template <class Config>
+void CMMC3<Config>::writePPUReg(std::uint8_t val, std::uint16_t addr) {
+	syncCounter();
+	if (addr & 0x01) {
+		m_PPUMask = val;
+	} else {
+		m_PPUControl = val;
+	}
+	scheduleIRQ();
+}
+
+/**
+ * Gets time of A12 rise in scanline
+ *
+ * A12 rises once per rendered line when background and sprites use
+ * different pattern tables. With sprites at 0x1000 it happens on sprite
+ * fetches (dot 260), with background at 0x1000 on the first background
+ * fetch for next line (dot 324). 8x16 sprites fetch unused slots from
+ * 0x1000.
+ *
+ * @return Offset in scanline or negative if counter is not clocked
+ */
+template <class Config>
+ticks_t CMMC3<Config>::getRiseOffset() const {
+	if (!(m_PPUMask & 0x18)) {
+		return -1;
+	}
+	bool objectHigh = m_PPUControl & 0x28;
+	bool backgroundHigh = m_PPUControl & 0x10;
+	if (objectHigh && !backgroundHigh) {
+		return 260 * DotTime;
+	} else if (!objectHigh && backgroundHigh) {
+		return 324 * DotTime;
+	}
+	return -1;
+}
+
+/**
+ * Counts A12 rises since power up
+ *
+ * Rises happen on visible lines and on pre-render line.
+ *
+ * @param time Elapsed ticks
+ * @param offset Offset of rise in scanline
+ * @return Amount of rises at or before the time
+ */
+template <class Config>
+ticks_t CMMC3<Config>::countRises(ticks_t time, ticks_t offset) {
+	ticks_t rises = (time / FrameTime) * RisesPerFrame;
+	ticks_t frameTime = time % FrameTime;
+	if (frameTime >= offset) {
+		ticks_t lines = (frameTime - offset) / ScanlineTime + 1;
+		rises += (lines < VisibleLines) ? lines : VisibleLines;
+	}
+	if (frameTime >= PreRenderTime + offset) {
+		rises++;
+	}
+	return rises;
+}
+
+/**
+ * Gets time of A12 rise
+ *
+ * @param rise Rise number since power up (from 1)
+ * @param offset Offset of rise in scanline
+ * @return Elapsed ticks
+ */
+template <class Config>
+ticks_t CMMC3<Config>::getRiseTime(ticks_t rise, ticks_t offset) {
+	ticks_t frame = (rise - 1) / RisesPerFrame;
+	ticks_t line = (rise - 1) % RisesPerFrame;
+	ticks_t lineTime =
+	    (line < VisibleLines) ? line * ScanlineTime : PreRenderTime;
+	return frame * FrameTime + lineTime + offset;
+}
+
+/**
+ * Clocks the counter
+ *
+ * Zero counter or pending reload loads the latch, otherwise the counter is
+ * decremented. The whole run is computed at once.
+ *
+ * @param clocks Amount of clocks
+ * @return True if the counter became zero on any clock
+ */
+template <class Config>
+bool CMMC3<Config>::clockCounter(ticks_t clocks) {
+	if (clocks <= 0) {
+		return false;
+	}
+	bool zero = false;
+	if (m_IRQReload || m_IRQCounter == 0) {
+		m_IRQCounter = m_IRQLatch;
+		m_IRQReload = false;
+		zero = m_IRQCounter == 0;
+		clocks--;
+	}
+	if (clocks < m_IRQCounter) {
+		m_IRQCounter -= clocks;
+		return zero;
+	}
+	// Counter reaches zero and then repeats latch + 1 clocks period
+	clocks = (clocks - m_IRQCounter) % (m_IRQLatch + 1);
+	m_IRQCounter = clocks ? m_IRQLatch - (clocks - 1) : 0;
+	return true;
+}
+
+/**
+ * Advances the counter to current time
+ */
+template <class Config>
+void CMMC3<Config>::syncCounter() {
+	ticks_t time = m_MotherBoard->getElapsedTicks();
+	ticks_t offset = getRiseOffset();
+	if (offset >= 0 && time > m_IRQTime &&
+	    clockCounter(
+	        countRises(time, offset) - countRises(m_IRQTime, offset)) &&
+	    m_IRQEnabled) {
+		m_MotherBoard->setIRQ(CMotherBoard::IRQMMC, true);
+	}
+	m_IRQTime = time;
+}
+
+/**
+ * Schedules IRQ event at the rise that reaches zero
+ *
+ * Nothing is scheduled while IRQ is disabled or the counter is not clocked.
+ */
+template <class Config>
+void CMMC3<Config>::scheduleIRQ() {
+	ticks_t offset = getRiseOffset();
+	if (!m_IRQEnabled || offset < 0) {
+		if (m_IRQEvent->isEnabled()) {
+			m_IRQEvent->setEnabled(false);
+		}
+		return;
+	}
+	ticks_t clocks;
+	if (m_IRQReload || m_IRQCounter == 0) {
+		clocks = m_IRQLatch + 1;
+	} else {
+		clocks = m_IRQCounter;
+	}
+	ticks_t time = getRiseTime(countRises(m_IRQTime, offset) + clocks, offset);
+	// Event time is relative to current clock base
+	m_IRQEvent->setFireTime(time - m_MotherBoard->getElapsedTicks() +
+	                        m_MotherBoard->getPending());
+	if (!m_IRQEvent->isEnabled()) {
+		m_IRQEvent->setEnabled(true);
+	}
+}
+
+/**
+ * Handles IRQ event
+ *
+ * @param event Event
+ */
+template <class Config>
+void CMMC3<Config>::handleIRQ(CMotherBoard::CEvent *event) {
+	syncCounter();
+	scheduleIRQ();
+}
+
+/**
+ * MMC3 with NTSC timings
+ */
+template class CMMC3<factory::SConfigNTSC>;
+
+}  // namespace core
+
+}  // namespace vpnes
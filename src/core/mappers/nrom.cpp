@@ -48,10 +48,16 @@ namespace factory {
  * @param frontEnd Front-end
  * @return NES
  */
-CNES *factoryNROM(const SNESConfig &config, CFrontEnd *frontEnd) {
+static CNES *factoryNROM(const SNESConfig &config, CFrontEnd *frontEnd) {
 	return factoryNES<CNROM>(config, frontEnd);
 }
 
+/**
+ * Registers NROM (mapper 0)
+ */
+static CMapperRegistrar registrarNROM(
+    0, CMapperRegistry::AnySubmapper, &factoryNROM);
+
 }  // namespace factory
 
 /* CNROM */
@@ -63,21 +69,22 @@ CNES *factoryNROM(const SNESConfig &config, CFrontEnd *frontEnd) {
  * @param config NES config
  */
 CNROM::CNROM(CMotherBoard *motherBoard, const SNESConfig &config)
-    : m_PRG(config.PRG)
+    : m_Image(config.Image)
+    , m_PRG(config.PRG)
     , m_CHR(config.CHR)
-    , m_RAM(config.RAMSize)
-    , m_Mirroring(config.Mirroring) {
-	if (m_CHR.size() == 0) {
-		m_CHR.assign(0x2000, 0);
+    , m_CHRRAM()
+    , m_RAM(config, 0x0800)
+    , m_NameTable(config.Mirroring) {
+	if (m_CHR.empty()) {
+		m_CHRRAM.assign(config.CHRRAMSize + config.CHRBatterySize, 0);
+		m_CHR = CROMSpan(m_CHRRAM.data(), m_CHRRAM.size());
 		m_CHRBank = 1;
 	} else {
 		m_CHRBank = 0;
 	}
 	if ((m_PRG.size() != 0x4000 && m_PRG.size() != 0x8000) ||
-	    (m_Mirroring != MirroringHorizontal &&
-	        m_Mirroring != MirroringVertical) ||
 	    m_CHR.size() != 0x2000 || m_RAM.size() > 0x2000 ||
-	    (m_RAM.size() & 0x07ff)) {
+	    (m_RAM.size() & (m_RAM.size() - 1))) {
 		throw std::invalid_argument("Invalid ROM parameters");
 	}
 }
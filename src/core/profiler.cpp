@@ -0,0 +1,223 @@
+/**
+ * @file
+ *
+ * Implements simulation profiler
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <iomanip>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/profiler.hpp>
+#include <vpnes/core/disasm.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Maximum size of detected loop body
+ */
+static const std::size_t MaxLoopSize = 0x0400;
+
+/**
+ * Checks if instruction can close a loop
+ *
+ * @param opcode Opcode
+ * @return True for branches and jumps
+ */
+static bool isLoopBranch(std::uint8_t opcode) {
+	return (opcode & 0x1f) == 0x10 || opcode == 0x4c || opcode == 0x6c;
+}
+
+/**
+ * Prints instruction bytes and text
+ *
+ * @param out Output stream
+ * @param addr Instruction address
+ * @param read Memory reader
+ */
+static void dumpInstruction(std::ostream &out, std::uint16_t addr,
+    const CCodeProfile::reader_t &read) {
+	std::uint8_t bytes[3] = {read(addr), 0, 0};
+	std::size_t length = getInstructionLength(bytes[0]);
+	char text[CDisassembler::MaxText];
+	out << std::hex << std::setfill('0');
+	for (std::size_t i = 0; i < 3; i++) {
+		if (i < length) {
+			if (i > 0) {
+				bytes[i] = read(static_cast<std::uint16_t>(addr + i));
+			}
+			out << ' ' << std::setw(2) << static_cast<int>(bytes[i]);
+		} else {
+			out << "   ";
+		}
+	}
+	CDisassembler::format(addr, bytes, text);
+	out << std::dec << std::setfill(' ') << "  " << std::left << std::setw(14)
+	    << text << std::right;
+}
+
+/* CCodeProfile */
+
+/**
+ * Prints hottest addresses and loops
+ *
+ * @param out Output stream
+ * @param count Number of entries in each list
+ * @param divider Ticks per cycle
+ * @param read Memory reader for opcode bytes
+ */
+void CCodeProfile::dump(std::ostream &out, std::size_t count,
+    std::intmax_t divider, const reader_t &read) const {
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	std::vector<std::uint64_t> prefix(0x10001);
+	std::vector<std::uint16_t> hot;
+	std::vector<std::uint16_t> loops;
+	for (std::size_t addr = 0; addr < 0x10000; addr++) {
+		prefix[addr + 1] = prefix[addr] + m_Ticks[addr];
+		if (m_Ticks[addr] > 0) {
+			hot.push_back(static_cast<std::uint16_t>(addr));
+		}
+		if (m_Jumps[addr] > 0 && addr - m_JumpTargets[addr] < MaxLoopSize &&
+		    isLoopBranch(read(static_cast<std::uint16_t>(addr)))) {
+			loops.push_back(static_cast<std::uint16_t>(addr));
+		}
+	}
+	std::uint64_t total = prefix[0x10000] + m_InterruptTicks;
+	if (total == 0) {
+		return;
+	}
+	auto getLoopTicks = [&](std::uint16_t addr) {
+		return prefix[addr + 1] - prefix[m_JumpTargets[addr]];
+	};
+	std::size_t hotCount = std::min(count, hot.size());
+	std::partial_sort(hot.begin(), hot.begin() + hotCount, hot.end(),
+	    [&](std::uint16_t a, std::uint16_t b) {
+		    return m_Ticks[a] > m_Ticks[b];
+	    });
+	std::size_t loopCount = std::min(count, loops.size());
+	std::partial_sort(loops.begin(), loops.begin() + loopCount, loops.end(),
+	    [&](std::uint16_t a, std::uint16_t b) {
+		    return getLoopTicks(a) > getLoopTicks(b);
+	    });
+	out << std::noshowbase << std::fixed << std::setprecision(2);
+	out << "Hot addresses:" << std::endl;
+	out << "  addr   bytes     instruction       " << std::setw(14) << "cycles"
+	    << std::setw(9) << "%" << std::endl;
+	for (std::size_t i = 0; i < hotCount; i++) {
+		std::uint16_t addr = hot[i];
+		out << "  $" << std::hex << std::setfill('0') << std::setw(4) << addr
+		    << std::dec << std::setfill(' ') << ' ';
+		dumpInstruction(out, addr, read);
+		out << "    " << std::setw(14) << m_Ticks[addr] / divider
+		    << std::setw(9) << m_Ticks[addr] * 100.0 / total << std::endl;
+	}
+	out << "Hot loops:" << std::endl;
+	out << "  range         branch   instruction       " << std::setw(12)
+	    << "iterations"
+	    << std::setw(14) << "cycles" << std::setw(9) << "%" << std::endl;
+	for (std::size_t i = 0; i < loopCount; i++) {
+		std::uint16_t addr = loops[i];
+		std::uint64_t ticks = getLoopTicks(addr);
+		out << "  $" << std::hex << std::setfill('0') << std::setw(4)
+		    << m_JumpTargets[addr] << "-$" << std::setw(4) << addr << std::dec
+		    << std::setfill(' ') << ' ';
+		dumpInstruction(out, addr, read);
+		out << "    " << std::setw(12) << m_Jumps[addr] << std::setw(14)
+		    << ticks / divider << std::setw(9) << ticks * 100.0 / total
+		    << std::endl;
+	}
+	out << "Interrupts: " << m_Interrupts << " taken, "
+	    << m_InterruptTicks / divider << " cycles, "
+	    << m_InterruptTicks * 100.0 / total << "%" << std::endl;
+	out.precision(precision);
+	out.flags(flags);
+}
+
+/**
+ * Gets human-readable type name
+ *
+ * @param name Implementation-defined type name
+ * @return Readable name
+ */
+std::string getReadableTypeName(const char *name) {
+#if defined(__GNUG__)
+	int status = 0;
+	char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+	if (status == 0 && demangled) {
+		std::string result(demangled);
+		std::free(demangled);
+		return result;
+	}
+#endif
+	return name;
+}
+
+/**
+ * Prints profiling data as table
+ *
+ * @param out Output stream
+ * @param title Table title
+ * @param data Profiling data
+ */
+void dumpProfile(
+    std::ostream &out, const char *title, const ProfileData &data) {
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::dec << std::noshowbase;
+	out << title << ':' << std::endl;
+	out << std::left << std::setw(32) << "  name" << std::right
+	    << std::setw(14) << "calls" << std::setw(16) << "ticks"
+	    << std::setw(14) << "host ms" << std::setw(12) << "ns/call"
+	    << std::endl;
+	for (const SProfileRecord &record : data) {
+		out << "  " << std::left << std::setw(30) << record.Name << std::right
+		    << std::setw(14) << record.Calls << std::setw(16) << record.Ticks
+		    << std::setw(14) << std::fixed << std::setprecision(3)
+		    << record.Nanoseconds / 1e6 << std::setw(12)
+		    << std::setprecision(1)
+		    << (record.Calls ? static_cast<double>(record.Nanoseconds) /
+		                           record.Calls
+		                     : 0.0)
+		    << std::endl;
+	}
+	out.precision(precision);
+	out.flags(flags);
+}
+
+}  // namespace core
+
+}  // namespace vpnes
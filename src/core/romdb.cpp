@@ -0,0 +1,98 @@
+/**
+ * @file
+ *
+ * Implements built-in ROM database
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/romdb.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+namespace romdb {
+
+/**
+ * Known cartridges sorted by CRC32
+ *
+ * CRC32 covers PRG and CHR ROM without header, as in NesCartDB. Entries are
+ * generated from NesCartDB XML export with src/tools/romdb.py.
+ */
+static constexpr SROMInfo ROMDatabase[] = {
+    // Super Mario Bros. (World)
+    {0x3337ec46, 0, 0, MirroringVertical, 0, 0, 0},
+    // The Legend of Zelda (USA)
+    {0x3fe272fb, 1, 0, MirroringHorizontal, 0, 0x2000, 0x2000},
+};
+
+/**
+ * Checks that the database is sorted
+ *
+ * @return True if sorted
+ */
+static constexpr bool isSorted() {
+	for (std::size_t i = 1; i < std::size(ROMDatabase); i++) {
+		if (ROMDatabase[i - 1].CRC32 >= ROMDatabase[i].CRC32) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(isSorted(), "ROM database must be sorted by CRC32");
+
+/**
+ * Looks up the cartridge
+ *
+ * The database is a flat array sorted by CRC32 and searched by binary
+ * search.
+ *
+ * @param crc CRC32 of PRG and CHR ROM
+ * @return Cartridge info or nullptr if unknown
+ */
+const SROMInfo *findROM(std::uint32_t crc) {
+	const SROMInfo *iter = std::lower_bound(std::begin(ROMDatabase),
+	    std::end(ROMDatabase), crc,
+	    [](const SROMInfo &info, std::uint32_t value) {
+		    return info.CRC32 < value;
+	    });
+	if (iter == std::end(ROMDatabase) || iter->CRC32 != crc) {
+		return nullptr;
+	}
+	return iter;
+}
+
+}  // namespace romdb
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,334 @@
+/**
+ * @file
+ *
+ * Implements battery backed RAM
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(HAVE_SYS_MMAN_H)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/saveram.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/* CSaveRAM */
+
+/**
+ * Allocates PRG RAM
+ *
+ * @param config NES config
+ * @param minSize Smaller RAM is mirrored, so it is extended to this size
+ */
+CSaveRAM::CSaveRAM(const SNESConfig &config, std::size_t minSize)
+    : m_Data()
+    , m_Size(config.RAMSize + config.BatterySize)
+    , m_SaveOffset()
+    , m_SaveSize()
+    , m_Buffer()
+    , m_Mapped(false)
+    , m_FileName()
+    , m_PageSize(0x1000)
+    , m_Flushed()
+    , m_FlushMutex()
+    , m_SnapshotRequested(false)
+    , m_Mutex()
+    , m_Condition()
+    , m_Snapshot()
+    , m_SnapshotReady(false)
+    , m_Stop(false)
+    , m_FlushThread() {
+	if (m_Size != 0 && m_Size < minSize) {
+		m_Size = minSize;
+	}
+	if (config.BatterySize != 0) {
+		m_FileName = config.SaveFile;
+	}
+	if (isSaved()) {
+		// Work RAM comes first, the rest is battery backed
+		m_SaveOffset = config.RAMSize;
+		m_SaveSize = m_Size - m_SaveOffset;
+		m_Mapped = mapFile();
+	}
+	if (!m_Mapped) {
+		m_Buffer.assign(m_Size, 0);
+		m_Data = m_Buffer.data();
+		if (isSaved()) {
+			loadFile();
+		}
+	}
+	if (isSaved()) {
+		m_Flushed.assign(m_Data + m_SaveOffset, m_Data + m_Size);
+		if (config.SaveInterval != 0) {
+			m_Snapshot.resize(m_SaveSize);
+			m_FlushThread = std::thread(&CSaveRAM::flushLoop, this,
+			    std::chrono::milliseconds(config.SaveInterval));
+		}
+	}
+}
+
+/**
+ * Stops flushing, saves and releases RAM
+ */
+CSaveRAM::~CSaveRAM() {
+	if (m_FlushThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_Condition.notify_one();
+		m_FlushThread.join();
+	}
+	if (isSaved()) {
+		flush();
+	}
+	if (m_Mapped) {
+		unmapFile();
+	}
+}
+
+/**
+ * Maps the save file
+ *
+ * Battery backed part is mapped over anonymous work RAM, so it has to start
+ * on a page boundary.
+ *
+ * @return True if mapped
+ */
+bool CSaveRAM::mapFile() {
+#if defined(HAVE_SYS_MMAN_H)
+	long pageSize = ::sysconf(_SC_PAGESIZE);
+	if (pageSize > 0) {
+		m_PageSize = static_cast<std::size_t>(pageSize);
+	}
+	if (m_SaveOffset % m_PageSize != 0) {
+		return false;
+	}
+	int file = ::open(m_FileName.c_str(), O_RDWR | O_CREAT, 0644);
+	if (file < 0) {
+		return false;
+	}
+	void *data = ::mmap(nullptr, m_Size, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	void *save = MAP_FAILED;
+	struct stat info;
+	// Save file is only extended, so RAM size mismatch never loses data
+	if (data != MAP_FAILED && ::fstat(file, &info) == 0 &&
+	    (static_cast<std::size_t>(info.st_size) >= m_SaveSize ||
+	        ::ftruncate(file, m_SaveSize) == 0)) {
+		save = ::mmap(static_cast<std::uint8_t *>(data) + m_SaveOffset,
+		    m_SaveSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, file,
+		    0);
+	}
+	::close(file);
+	if (save == MAP_FAILED) {
+		if (data != MAP_FAILED) {
+			::munmap(data, m_Size);
+		}
+		return false;
+	}
+	m_Data = static_cast<std::uint8_t *>(data);
+	return true;
+#elif defined(_WIN32)
+	// Only RAM without work RAM part is mapped
+	if (m_SaveOffset != 0) {
+		return false;
+	}
+	HANDLE file = ::CreateFileA(m_FileName.c_str(),
+	    GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+	    FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	void *data = nullptr;
+	LARGE_INTEGER size;
+	bool extended = ::GetFileSizeEx(file, &size) &&
+	                static_cast<std::size_t>(size.QuadPart) >= m_SaveSize;
+	if (!extended) {
+		// Save file is only extended, so RAM size mismatch never loses data
+		size.QuadPart = m_SaveSize;
+		extended = ::SetFilePointerEx(file, size, nullptr, FILE_BEGIN) &&
+		           ::SetEndOfFile(file);
+	}
+	if (extended) {
+		HANDLE mapping = ::CreateFileMappingA(
+		    file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+		if (mapping) {
+			// View keeps the mapping alive after the handles are closed
+			data = ::MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, m_SaveSize);
+			::CloseHandle(mapping);
+		}
+	}
+	::CloseHandle(file);
+	if (!data) {
+		return false;
+	}
+	m_Data = static_cast<std::uint8_t *>(data);
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Unmaps the save file
+ */
+void CSaveRAM::unmapFile() {
+#if defined(HAVE_SYS_MMAN_H)
+	::munmap(m_Data, m_Size);
+#elif defined(_WIN32)
+	::UnmapViewOfFile(m_Data);
+#endif
+}
+
+/**
+ * Loads the save file into the buffer
+ */
+void CSaveRAM::loadFile() {
+	std::ifstream input(m_FileName, std::ifstream::binary);
+	if (input.is_open()) {
+		input.read(reinterpret_cast<char *>(m_Data + m_SaveOffset), m_SaveSize);
+	}
+}
+
+/**
+ * Writes dirty range to the save file
+ *
+ * @param offset Offset in battery backed part
+ * @param size Size
+ */
+void CSaveRAM::writeRange(std::size_t offset, std::size_t size) {
+	if (m_Mapped) {
+#if defined(HAVE_SYS_MMAN_H)
+		::msync(m_Data + m_SaveOffset + offset, size, MS_SYNC);
+#elif defined(_WIN32)
+		::FlushViewOfFile(m_Data + m_SaveOffset + offset, size);
+#endif
+		return;
+	}
+	std::fstream output(
+	    m_FileName, std::fstream::binary | std::fstream::in | std::fstream::out);
+	if (!output.is_open()) {
+		output.open(m_FileName, std::fstream::binary | std::fstream::out);
+		offset = 0;
+		size = m_SaveSize;
+	}
+	output.seekp(offset);
+	output.write(reinterpret_cast<const char *>(m_Flushed.data() + offset),
+	    static_cast<std::streamsize>(size));
+}
+
+/**
+ * Writes pages of battery backed part changed since last flush
+ *
+ * @param contents Current contents of battery backed part
+ */
+void CSaveRAM::writeChanges(const std::uint8_t *contents) {
+	std::lock_guard<std::mutex> lock(m_FlushMutex);
+	std::size_t dirtyBegin = m_SaveSize;
+	for (std::size_t offset = 0; offset < m_SaveSize; offset += m_PageSize) {
+		std::size_t size = std::min(m_PageSize, m_SaveSize - offset);
+		bool dirty = std::memcmp(contents + offset, m_Flushed.data() + offset,
+		                 size) != 0;
+		if (dirty) {
+			std::memcpy(m_Flushed.data() + offset, contents + offset, size);
+			if (dirtyBegin == m_SaveSize) {
+				dirtyBegin = offset;
+			}
+		} else if (dirtyBegin != m_SaveSize) {
+			writeRange(dirtyBegin, offset - dirtyBegin);
+			dirtyBegin = m_SaveSize;
+		}
+	}
+	if (dirtyBegin != m_SaveSize) {
+		writeRange(dirtyBegin, m_SaveSize - dirtyBegin);
+	}
+}
+
+/**
+ * Writes dirty pages to the save file
+ */
+void CSaveRAM::flush() {
+	writeChanges(m_Data + m_SaveOffset);
+}
+
+/**
+ * Copies battery backed part for the flush thread
+ */
+void CSaveRAM::takeSnapshot() {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::memcpy(m_Snapshot.data(), m_Data + m_SaveOffset, m_SaveSize);
+		m_SnapshotReady = true;
+		m_SnapshotRequested.store(false, std::memory_order_relaxed);
+	}
+	m_Condition.notify_one();
+}
+
+/**
+ * Flushes dirty pages periodically
+ *
+ * RAM is written by the emulation thread without locks, so the thread waits
+ * for a snapshot taken at frame end instead of reading RAM itself.
+ *
+ * @param interval Flush interval
+ */
+void CSaveRAM::flushLoop(std::chrono::milliseconds interval) {
+	std::vector<std::uint8_t> contents(m_SaveSize);
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (!m_Condition.wait_for(lock, interval, [this] { return m_Stop; })) {
+		m_SnapshotRequested.store(true, std::memory_order_relaxed);
+		m_Condition.wait(lock, [this] { return m_Stop || m_SnapshotReady; });
+		if (!m_SnapshotReady) {
+			break;
+		}
+		m_SnapshotReady = false;
+		contents.swap(m_Snapshot);
+		lock.unlock();
+		writeChanges(contents.data());
+		lock.lock();
+	}
+}
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,301 @@
+/**
+ * @file
+ *
+ * Implements memory search
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/search.hpp>
+#include <vpnes/core/debugger.hpp>
+#if defined(VPNES_SEARCH_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Drops candidates that do not match comparison, one byte at a time
+ *
+ * @param candidates Candidate mask
+ * @param current Current snapshot
+ * @param previous Previous snapshot
+ * @param size Size in bytes
+ * @param compare Comparison of current and previous values
+ */
+template <class Compare>
+static void refineBlock(std::uint8_t *candidates, const std::uint8_t *current,
+    const std::uint8_t *previous, std::size_t size, Compare compare) {
+	for (std::size_t i = 0; i < size; i++) {
+		if (!compare(current[i], previous[i])) {
+			candidates[i] = 0;
+		}
+	}
+}
+
+/**
+ * Drops candidates that do not match comparison, one byte at a time
+ *
+ * @param candidates Candidate mask
+ * @param current Current snapshot
+ * @param previous Previous snapshot
+ * @param size Size in bytes
+ * @param compare Comparison
+ * @param operand Value for SearchEqual or delta for SearchDelta
+ */
+void refineScalar(std::uint8_t *candidates, const std::uint8_t *current,
+    const std::uint8_t *previous, std::size_t size, ESearchCompare compare,
+    std::uint8_t operand) {
+	switch (compare) {
+	case SearchEqual:
+		refineBlock(candidates, current, previous, size,
+		    [&](std::uint8_t c, std::uint8_t p) { return c == operand; });
+		break;
+	case SearchChanged:
+		refineBlock(candidates, current, previous, size,
+		    [](std::uint8_t c, std::uint8_t p) { return c != p; });
+		break;
+	case SearchUnchanged:
+		refineBlock(candidates, current, previous, size,
+		    [](std::uint8_t c, std::uint8_t p) { return c == p; });
+		break;
+	case SearchIncreased:
+		refineBlock(candidates, current, previous, size,
+		    [](std::uint8_t c, std::uint8_t p) { return c > p; });
+		break;
+	case SearchDecreased:
+		refineBlock(candidates, current, previous, size,
+		    [](std::uint8_t c, std::uint8_t p) { return c < p; });
+		break;
+	case SearchDelta:
+		refineBlock(candidates, current, previous, size,
+		    [&](std::uint8_t c, std::uint8_t p) {
+			    return static_cast<std::uint8_t>(c - p) == operand;
+		    });
+		break;
+	default:
+		throw std::invalid_argument("Unknown search comparison");
+	}
+}
+
+#if defined(VPNES_SEARCH_SSE2)
+/**
+ * Drops candidates that do not match comparison, 16 bytes at a time
+ *
+ * @param candidates Candidate mask
+ * @param current Current snapshot
+ * @param previous Previous snapshot
+ * @param size Size in bytes (multiple of 16)
+ * @param compare Comparison of current and previous values
+ */
+template <class Compare>
+static void refineVector(std::uint8_t *candidates, const std::uint8_t *current,
+    const std::uint8_t *previous, std::size_t size, Compare compare) {
+	for (std::size_t i = 0; i < size; i += 16) {
+		__m128i cur = _mm_loadu_si128(
+		    reinterpret_cast<const __m128i *>(current + i));
+		__m128i prev = _mm_loadu_si128(
+		    reinterpret_cast<const __m128i *>(previous + i));
+		__m128i *mask = reinterpret_cast<__m128i *>(candidates + i);
+		_mm_storeu_si128(
+		    mask, _mm_and_si128(_mm_loadu_si128(mask), compare(cur, prev)));
+	}
+}
+
+/**
+ * Drops candidates that do not match comparison, 16 bytes at a time
+ *
+ * @param candidates Candidate mask
+ * @param current Current snapshot
+ * @param previous Previous snapshot
+ * @param size Size in bytes (multiple of 16)
+ * @param compare Comparison
+ * @param operand Value for SearchEqual or delta for SearchDelta
+ */
+void refineSSE2(std::uint8_t *candidates, const std::uint8_t *current,
+    const std::uint8_t *previous, std::size_t size, ESearchCompare compare,
+    std::uint8_t operand) {
+	__m128i value = _mm_set1_epi8(static_cast<char>(operand));
+	switch (compare) {
+	case SearchEqual:
+		refineVector(candidates, current, previous, size,
+		    [&](__m128i c, __m128i p) { return _mm_cmpeq_epi8(c, value); });
+		break;
+	case SearchChanged:
+		refineVector(candidates, current, previous, size,
+		    [](__m128i c, __m128i p) {
+			    return _mm_andnot_si128(
+			        _mm_cmpeq_epi8(c, p), _mm_set1_epi8(-1));
+		    });
+		break;
+	case SearchUnchanged:
+		refineVector(candidates, current, previous, size,
+		    [](__m128i c, __m128i p) { return _mm_cmpeq_epi8(c, p); });
+		break;
+	case SearchIncreased:
+		refineVector(candidates, current, previous, size,
+		    [](__m128i c, __m128i p) {
+			    return _mm_andnot_si128(_mm_cmpeq_epi8(c, p),
+			        _mm_cmpeq_epi8(_mm_max_epu8(c, p), c));
+		    });
+		break;
+	case SearchDecreased:
+		refineVector(candidates, current, previous, size,
+		    [](__m128i c, __m128i p) {
+			    return _mm_andnot_si128(_mm_cmpeq_epi8(c, p),
+			        _mm_cmpeq_epi8(_mm_min_epu8(c, p), c));
+		    });
+		break;
+	case SearchDelta:
+		refineVector(candidates, current, previous, size,
+		    [&](__m128i c, __m128i p) {
+			    return _mm_cmpeq_epi8(_mm_sub_epi8(c, p), value);
+		    });
+		break;
+	default:
+		throw std::invalid_argument("Unknown search comparison");
+	}
+}
+#endif
+
+/* CMemorySearch */
+
+/**
+ * Searched regions: CPU RAM and PRG RAM
+ */
+const CMemorySearch::SRegion CMemorySearch::Regions[RegionCount] = {
+    {0x0000, 0x0800}, {0x6000, 0x2000}};
+
+/**
+ * Reads searched memory
+ *
+ * @param snapshot Output buffer
+ */
+void CMemorySearch::takeSnapshot(std::vector<std::uint8_t> *snapshot) {
+	std::size_t pos = 0;
+	for (const SRegion &region : Regions) {
+		for (std::size_t i = 0; i < region.Size; i++) {
+			(*snapshot)[pos++] = m_Debugger->directCPURead(
+			    static_cast<std::uint16_t>(region.First + i));
+		}
+	}
+}
+
+/**
+ * Starts new search
+ */
+void CMemorySearch::start() {
+	takeSnapshot(&m_Snapshot);
+	std::fill(m_Candidates.begin(), m_Candidates.end(), 0xff);
+}
+
+/**
+ * Takes new snapshot and drops candidates that do not match
+ *
+ * @param compare Comparison
+ * @param operand Value for SearchEqual or delta for SearchDelta
+ * @return Amount of candidates left
+ */
+std::size_t CMemorySearch::refine(
+    ESearchCompare compare, std::uint8_t operand) {
+	takeSnapshot(&m_Current);
+#if defined(VPNES_SEARCH_SSE2)
+	refineSSE2(m_Candidates.data(), m_Current.data(), m_Snapshot.data(),
+	    SearchSize, compare, operand);
+#else
+	refineScalar(m_Candidates.data(), m_Current.data(), m_Snapshot.data(),
+	    SearchSize, compare, operand);
+#endif
+	m_Snapshot.swap(m_Current);
+	return getCandidateCount();
+}
+
+/**
+ * Gets amount of candidates
+ *
+ * @return Amount of candidates
+ */
+std::size_t CMemorySearch::getCandidateCount() const {
+	return SearchSize -
+	       std::count(m_Candidates.begin(), m_Candidates.end(), 0);
+}
+
+/**
+ * Gets candidate addresses
+ *
+ * @return Candidate addresses
+ */
+std::vector<std::uint16_t> CMemorySearch::getCandidates() const {
+	std::vector<std::uint16_t> candidates;
+	std::size_t pos = 0;
+	for (const SRegion &region : Regions) {
+		for (std::size_t i = 0; i < region.Size; i++) {
+			if (m_Candidates[pos++]) {
+				candidates.push_back(
+				    static_cast<std::uint16_t>(region.First + i));
+			}
+		}
+	}
+	return candidates;
+}
+
+/**
+ * Gets value of address in the last snapshot
+ *
+ * @param addr Searched address
+ * @return Value
+ */
+std::uint8_t CMemorySearch::getValue(std::uint16_t addr) const {
+	std::size_t pos = 0;
+	for (const SRegion &region : Regions) {
+		std::size_t offset = addr - region.First;
+		if (addr >= region.First && offset < region.Size) {
+			return m_Snapshot[pos + offset];
+		}
+		pos += region.Size;
+	}
+	throw std::invalid_argument("Address is not searched");
+}
+
+/**
+ * Writes frozen values to memory
+ */
+void CMemorySearch::applyFreezes() {
+	for (const auto &freeze : m_Freezes) {
+		m_Debugger->directCPUWrite(freeze.first, freeze.second);
+	}
+}
+
+}  // namespace core
+
+}  // namespace vpnes
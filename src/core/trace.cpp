@@ -0,0 +1,200 @@
+/**
+ * @file
+ *
+ * Implements timeline tracer
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vpnes/core/trace.hpp>
+
+#if defined(VPNES_TRACE)
+
+#include <cstdint>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vpnes/vpnes.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/**
+ * Period of writing records
+ */
+static const std::chrono::milliseconds FlushPeriod(20);
+
+/**
+ * Writes JSON string
+ *
+ * @param out Output stream
+ * @param str String
+ */
+static void writeString(std::ostream &out, const char *str) {
+	out << '"';
+	for (; *str; ++str) {
+		if (*str == '"' || *str == '\\') {
+			out << '\\';
+		}
+		out << *str;
+	}
+	out << '"';
+}
+
+/**
+ * Writes time in microseconds
+ *
+ * @param out Output stream
+ * @param nanoseconds Time in nanoseconds
+ */
+static void writeTime(std::ostream &out, std::uint64_t nanoseconds) {
+	out << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0')
+	    << nanoseconds % 1000;
+}
+
+/* CTraceWriter */
+
+/**
+ * Constructs the object and starts writer thread
+ *
+ * @param fileName Output file name
+ */
+CTraceWriter::CTraceWriter(const std::string &fileName)
+    : m_Start(std::chrono::steady_clock::now())
+    , m_Mutex()
+    , m_Signal()
+    , m_Buffers()
+    , m_Names()
+    , m_Output()
+    , m_First(true)
+    , m_Stop(false)
+    , m_Thread() {
+	m_Output.open(fileName);
+	if (!m_Output.is_open()) {
+		std::clog << "Could not open trace file" << std::endl;
+	}
+	m_Output << std::dec << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	m_Thread = std::thread(&CTraceWriter::run, this);
+}
+
+/**
+ * Finalizes output
+ */
+CTraceWriter::~CTraceWriter() {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Signal.notify_one();
+	m_Thread.join();
+	std::uint64_t dropped = 0;
+	for (const auto &buffer : m_Buffers) {
+		dropped += buffer->getDropped();
+	}
+	m_Output << "\n],\"otherData\":{\"dropped\":" << dropped << "}}\n";
+	if (dropped > 0) {
+		std::clog << "Trace buffer overflow: " << std::dec << dropped
+		          << " records dropped" << std::endl;
+	}
+}
+
+/**
+ * Registers a buffer for a producer thread
+ *
+ * @return New buffer
+ */
+CTraceBuffer *CTraceWriter::addBuffer() {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Buffers.emplace_back(new CTraceBuffer(m_Buffers.size() + 1));
+	return m_Buffers.back().get();
+}
+
+/**
+ * Gets persistent copy of the name
+ *
+ * @param name Name
+ * @return Name valid while the tracer exists
+ */
+const char *CTraceWriter::getName(const std::string &name) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Names.insert(name).first->c_str();
+}
+
+/**
+ * Writes all pending records
+ */
+void CTraceWriter::flush() {
+	std::size_t bufferCount;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		bufferCount = m_Buffers.size();
+	}
+	for (std::size_t i = 0; i < bufferCount; i++) {
+		CTraceBuffer *buffer;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			buffer = m_Buffers[i].get();
+		}
+		buffer->drain([&](const STraceRecord &record) {
+			m_Output << (m_First ? "\n" : ",\n") << "{\"name\":";
+			m_First = false;
+			writeString(m_Output, record.Name);
+			m_Output << ",\"cat\":";
+			writeString(m_Output, record.Category);
+			m_Output << ",\"ph\":\"" << record.Phase << "\",\"ts\":";
+			writeTime(m_Output, record.Timestamp);
+			if (record.Phase == 'X') {
+				m_Output << ",\"dur\":";
+				writeTime(m_Output, record.Duration);
+			} else {
+				m_Output << ",\"s\":\"g\"";
+			}
+			m_Output << ",\"pid\":1,\"tid\":" << buffer->getThreadId()
+			         << ",\"args\":{\"ticks\":" << record.Ticks << "}}";
+		});
+	}
+	m_Output.flush();
+}
+
+/**
+ * Writer thread routine
+ */
+void CTraceWriter::run() {
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (!m_Stop) {
+		m_Signal.wait_for(lock, FlushPeriod);
+		lock.unlock();
+		flush();
+		lock.lock();
+	}
+	lock.unlock();
+	flush();
+}
+
+}  // namespace core
+
+}  // namespace vpnes
+
+#endif  // defined(VPNES_TRACE)
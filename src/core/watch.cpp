@@ -0,0 +1,109 @@
+/**
+ * @file
+ *
+ * Implements bus watch facility
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <ostream>
+#include <iomanip>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/watch.hpp>
+
+namespace vpnes {
+
+namespace core {
+
+/* CBusWatch */
+
+/**
+ * Calls handlers of layers watching the access
+ *
+ * @param type Access type
+ * @param addr Address
+ * @param val Value
+ */
+void CBusWatch::dispatch(
+    EWatchType type, std::uint16_t addr, std::uint8_t val) {
+	for (std::size_t layer = 0; layer < WatchLayers; layer++) {
+		if (m_Watches[layer][type][addr]) {
+			m_Handlers[layer](type, addr, val);
+		}
+	}
+}
+
+/**
+ * Writes access counters as CSV
+ *
+ * @param out Output stream
+ */
+void CBusWatch::writeCSV(std::ostream &out) const {
+	std::ios_base::fmtflags flags = out.flags();
+	out << std::noshowbase << "address,reads,writes,executes" << std::endl;
+	for (std::size_t addr = 0; !m_Counters.empty() && addr < 0x10000;
+	     addr++) {
+		std::uint32_t reads = m_Counters[WatchRead * 0x10000 + addr];
+		std::uint32_t writes = m_Counters[WatchWrite * 0x10000 + addr];
+		std::uint32_t executes = m_Counters[WatchExec * 0x10000 + addr];
+		if (reads == 0 && writes == 0 && executes == 0) {
+			continue;
+		}
+		out << std::hex << std::setfill('0') << std::setw(4) << addr
+		    << std::dec << ',' << reads << ',' << writes << ',' << executes
+		    << '\n';
+	}
+	out.fill(' ');
+	out.flags(flags);
+}
+
+/**
+ * Writes access counters as 256x256 PGM image
+ *
+ * @param out Output stream
+ * @param type Access type
+ */
+void CBusWatch::writePGM(std::ostream &out, EWatchType type) const {
+	std::ios_base::fmtflags flags = out.flags();
+	std::uint32_t maxCount = 0;
+	if (!m_Counters.empty()) {
+		auto first = m_Counters.begin() + type * 0x10000;
+		maxCount = *std::max_element(first, first + 0x10000);
+	}
+	double scale = maxCount > 0 ? 255.0 / std::log1p(maxCount) : 0.0;
+	out << std::dec << std::noshowbase << "P5\n256 256\n255\n";
+	for (std::size_t addr = 0; addr < 0x10000; addr++) {
+		std::uint32_t count = getCount(type, static_cast<std::uint16_t>(addr));
+		out.put(static_cast<char>(std::log1p(count) * scale));
+	}
+	out.flags(flags);
+}
+
+}  // namespace core
+
+}  // namespace vpnes
@@ -0,0 +1,152 @@
+/**
+ * @file
+ *
+ * Implements audio output
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/gui/audio.hpp>
+
+namespace vpnes {
+
+namespace gui {
+
+/* CAudioOutput */
+
+/**
+ * Opens audio device
+ *
+ * The device buffer takes about a tenth of the latency. The rest is left for
+ * the ring, which has to hold a whole frame of samples on top of its target
+ * right after the frame is queued.
+ *
+ * @param sampleRate Requested sample rate
+ * @param latency Latency in milliseconds
+ */
+CAudioOutput::CAudioOutput(int sampleRate, int latency)
+    : m_Device()
+    , m_SampleRate()
+    , m_DeviceSamples()
+    , m_Target()
+    , m_Ring(static_cast<std::size_t>(sampleRate) / 4)
+    , m_Resampler()
+    , m_Buffer()
+    , m_Played() {
+	::SDL_AudioSpec desired, obtained;
+	SDL_zero(desired);
+	desired.freq = sampleRate;
+	desired.format = AUDIO_S16SYS;
+	desired.channels = 1;
+	desired.samples = 64;
+	while (desired.samples * 2 * 10000 <= sampleRate * latency) {
+		desired.samples *= 2;
+	}
+	desired.callback = &CAudioOutput::fillAudio;
+	desired.userdata = this;
+	m_Device = ::SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained,
+	    SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+	if (m_Device == 0) {
+		throw std::invalid_argument(SDL_GetError());
+	}
+	m_SampleRate = obtained.freq;
+	m_DeviceSamples = obtained.samples;
+	std::size_t limit = static_cast<std::size_t>(m_SampleRate) * latency / 1000;
+	std::size_t frame = m_SampleRate / 60;
+	if (limit > frame + 2 * m_DeviceSamples) {
+		m_Target = limit - frame - m_DeviceSamples;
+	} else {
+		m_Target = m_DeviceSamples;
+	}
+	m_Resampler.setSetPoint(getSetPoint());
+	m_Buffer.reserve(frame * 2);
+	::SDL_PauseAudioDevice(m_Device, 0);
+}
+
+/**
+ * Closes audio device
+ */
+CAudioOutput::~CAudioOutput() {
+	::SDL_CloseAudioDevice(m_Device);
+}
+
+/**
+ * SDL audio callback
+ *
+ * Holds the last played level on underrun, so starving device does not click.
+ *
+ * @param userData Audio output
+ * @param stream Output buffer
+ * @param len Size of buffer in bytes
+ */
+void SDLCALL CAudioOutput::fillAudio(void *userData, ::Uint8 *stream, int len) {
+	CAudioOutput *output = static_cast<CAudioOutput *>(userData);
+	std::int16_t *samples = reinterpret_cast<std::int16_t *>(stream);
+	std::size_t count = len / sizeof(std::int16_t);
+	std::size_t popped = output->m_Ring.pop(samples, count);
+	if (popped > 0) {
+		output->m_Played = samples[popped - 1];
+	}
+	std::fill(samples + popped, samples + count, output->m_Played);
+}
+
+/**
+ * Queues samples
+ *
+ * @param samples Samples
+ * @param count Amount of samples
+ */
+void CAudioOutput::write(const std::int16_t *samples, std::size_t count) {
+	m_Resampler.resample(samples, count, m_Ring.getSize(), &m_Buffer);
+	m_Ring.push(m_Buffer.data(), m_Buffer.size());
+}
+
+/**
+ * Waits until the device drains the ring to its target
+ *
+ * Gives up after MaxWait, so a stalled device does not hang emulation.
+ */
+void CAudioOutput::sync() {
+	std::chrono::steady_clock::time_point start =
+	    std::chrono::steady_clock::now();
+	while (m_Ring.getSize() > m_Target) {
+		if (std::chrono::steady_clock::now() - start >
+		    std::chrono::milliseconds(MaxWait)) {
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+}  // namespace gui
+
+}  // namespace vpnes
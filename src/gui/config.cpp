@@ -28,20 +28,64 @@
 #endif
 
 #include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vpnes/core/cheats.hpp>
 #include <vpnes/gui/config.hpp>
 
 namespace vpnes {
 
 namespace gui {
 
+namespace {
+
+/**
+ * Reads unsigned number from environment variable
+ *
+ * Invalid value is reported and ignored.
+ *
+ * @param name Variable name
+ * @param max Maximum value
+ * @param value Read value (unchanged if variable is not set or invalid)
+ */
+void getEnvNumber(const char *name, std::uint32_t max, std::uint32_t *value) {
+	const char *var = std::getenv(name);
+	if (!var) {
+		return;
+	}
+	char *end = nullptr;
+	errno = 0;
+	unsigned long number = std::strtoul(var, &end, 10);
+	if (!std::isdigit(static_cast<unsigned char>(*var)) || *end != '\0' ||
+	    errno == ERANGE || number > max) {
+		std::cerr << "Invalid " << name << " value, ignored: " << var
+		          << std::endl;
+		return;
+	}
+	*value = static_cast<std::uint32_t>(number);
+}
+
+}  // namespace
+
 /* SApplicationConfig */
 
 /**
  * Sets default values
  */
-SApplicationConfig::SApplicationConfig() : inputFile() {
+SApplicationConfig::SApplicationConfig()
+    : inputFile()
+    , saveFile()
+    , saveInterval(5000)
+    , traceFile("vpnes-trace.json")
+    , audioLatency(30)
+    , heatMapPrefix()
+    , cpuTraceFile()
+    , cheats() {
 }
 
 /**
@@ -55,6 +99,47 @@ void SApplicationConfig::parseOptions(int argc, char **argv) {
 	if (argc >= 2) {
 		setInputFile(argv[1]);
 	}
+	const char *traceFileVar = std::getenv("VPNES_TRACE_FILE");
+	if (traceFileVar) {
+		setTraceFile(traceFileVar);
+	}
+	getEnvNumber("VPNES_SAVE_INTERVAL", 24 * 60 * 60 * 1000, &saveInterval);
+	getEnvNumber("VPNES_AUDIO_LATENCY", 1000, &audioLatency);
+	const char *heatMapVar = std::getenv("VPNES_HEATMAP");
+	if (heatMapVar) {
+		setHeatMapPrefix(heatMapVar);
+	}
+	const char *cpuTraceVar = std::getenv("VPNES_CPU_TRACE");
+	if (cpuTraceVar) {
+		setCPUTraceFile(cpuTraceVar);
+	}
+	const char *cheatsVar = std::getenv("VPNES_CHEATS");
+	if (cheatsVar) {
+		std::istringstream codes(cheatsVar);
+		std::string code;
+		while (std::getline(codes, code, ',')) {
+			if (!code.empty() && !addCheat(code)) {
+				std::cerr << "Invalid cheat code, ignored: " << code
+				          << std::endl;
+			}
+		}
+	}
+}
+
+/**
+ * Adds cheat code
+ *
+ * @param code Cheat code
+ * @return True if code is valid
+ */
+bool SApplicationConfig::addCheat(const std::string &code) {
+	try {
+		core::decodeCheat(code);
+	} catch (const std::invalid_argument &) {
+		return false;
+	}
+	cheats.push_back(code);
+	return true;
 }
 
 /**
@@ -35,6 +35,7 @@
 #include <exception>
 #include <stdexcept>
 #include <memory>
+#include <string>
 #include <chrono>
 #include <thread>
 #include <iostream>
@@ -43,6 +44,7 @@
 #include <vpnes/vpnes.hpp>
 #include <vpnes/gui/config.hpp>
 #include <vpnes/gui/gui.hpp>
+#include <vpnes/gui/audio.hpp>
 #include <vpnes/core/config.hpp>
 #include <vpnes/core/nes.hpp>
 
@@ -62,7 +64,8 @@ CGUI::CGUI()
     , m_Config()
     , m_Window()
     , m_Renderer()
-    , m_ScreenBuffer() {
+    , m_ScreenBuffer()
+    , m_Audio() {
 	std::atexit(::SDL_Quit);
 }
 
@@ -110,6 +113,33 @@ void CGUI::initMainWindow(std::size_t width, std::size_t height) {
 	}
 }
 
+/**
+ * Writes CPU bus heatmap
+ *
+ * Writes access counters to prefix.csv and images to prefix-read.pgm,
+ * prefix-write.pgm and prefix-exec.pgm.
+ *
+ * @param prefix File name prefix
+ * @param watch CPU bus watch
+ */
+void CGUI::writeHeatMap(const char *prefix, const core::CBusWatch &watch) {
+	static const struct {
+		core::EWatchType Type;
+		const char *Suffix;
+	} images[] = {
+	    {core::WatchRead, "-read.pgm"},
+	    {core::WatchWrite, "-write.pgm"},
+	    {core::WatchExec, "-exec.pgm"},
+	};
+	std::ofstream csv(std::string(prefix) + ".csv");
+	watch.writeCSV(csv);
+	for (const auto &image : images) {
+		std::ofstream pgm(
+		    std::string(prefix) + image.Suffix, std::ofstream::binary);
+		watch.writePGM(pgm, image.Type);
+	}
+}
+
 /**
  * Starts GUI
  *
@@ -128,16 +158,48 @@ int CGUI::startGUI(int argc, char **argv) {
 		if (::SDL_Init(SDL_INIT_EVERYTHING) < 0) {
 			throw std::invalid_argument(SDL_GetError());
 		}
-		std::ifstream inputFile = m_Config.getInputFile();
+		if (m_Config.getSaveFileName().empty()) {
+			std::string saveFile = m_Config.getInputFileName();
+			std::size_t extension = saveFile.find_last_of("./\\");
+			if (extension != std::string::npos && saveFile[extension] == '.') {
+				saveFile.erase(extension);
+			}
+			m_Config.setSaveFile((saveFile + ".sav").c_str());
+		}
+		int audioLatency = static_cast<int>(m_Config.getAudioLatency());
+		if (audioLatency > 0) {
+			try {
+				m_Audio.reset(new CAudioOutput(48000, audioLatency));
+			} catch (const std::invalid_argument &e) {
+				std::cerr << "Audio is disabled: " << e.what() << std::endl;
+			}
+		}
 		core::SNESConfig nesConfig;
-		nesConfig.configure(m_Config, &inputFile);
-		inputFile.close();
+		nesConfig.configure(m_Config);
 		initMainWindow(512, 448);
 		m_NES.reset(nesConfig.createInstance(this));
 		m_Jitter = 0;
 		m_TimeOverhead = 0;
 		m_Time = std::chrono::high_resolution_clock::now();
+		const std::string &heatMap = m_Config.getHeatMapPrefix();
+		core::CBusWatch *watch = m_NES->getDebugger()->getWatchCPU();
+		if (!heatMap.empty()) {
+			watch->setCounters(true);
+		}
+		for (const std::string &code : m_Config.getCheats()) {
+			m_NES->getDebugger()->addCheat(code);
+		}
+		const std::string &cpuTrace = m_Config.getCPUTraceFileName();
+		if (!cpuTrace.empty()) {
+			m_NES->getDebugger()->startInstructionTrace(cpuTrace.c_str());
+		}
 		m_NES->powerUp();
+		if (!cpuTrace.empty()) {
+			m_NES->getDebugger()->stopInstructionTrace();
+		}
+		if (!heatMap.empty()) {
+			writeHeatMap(heatMap.c_str(), *watch);
+		}
 	} catch (const std::invalid_argument &e) {
 		std::cerr << e.what() << std::endl;
 	} catch (const std::exception &e) {
@@ -154,6 +216,7 @@ int CGUI::startGUI(int argc, char **argv) {
  */
 void CGUI::handleFrameRender(double frameTime) {
 	::SDL_Event event;
+	m_NES->getDebugger()->getMemorySearch()->applyFreezes();
 	::SDL_RenderCopy(m_Renderer, m_ScreenBuffer, nullptr, nullptr);
 	::SDL_RenderPresent(m_Renderer);
 	while (::SDL_PollEvent(&event)) {
@@ -183,6 +246,10 @@ void CGUI::handleFrameRender(double frameTime) {
 		curFrame = 0;
 	}
 #else
+	if (m_Audio) {
+		m_Audio->sync();
+		return;
+	}
 	std::chrono::high_resolution_clock::time_point lastTime = m_Time;
 	m_Jitter += frameTime;
 	if (m_Jitter > m_TimeOverhead) {
@@ -204,6 +271,27 @@ void CGUI::handleFrameRender(double frameTime) {
 #endif
 }
 
+/**
+ * Gets audio sample rate
+ *
+ * @return Sample rate or 0 if audio is not available
+ */
+int CGUI::getSampleRate() {
+	return m_Audio ? m_Audio->getSampleRate() : 0;
+}
+
+/**
+ * Audio-ready callback
+ *
+ * @param samples Mono samples
+ * @param count Amount of samples
+ */
+void CGUI::handleAudioSamples(const std::int16_t *samples, std::size_t count) {
+	if (m_Audio) {
+		m_Audio->write(samples, count);
+	}
+}
+
 }  // namespace gui
 
 }  // namespace vpnes
@@ -0,0 +1,713 @@
+/**
+ * @file
+ * Throughput benchmarks
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/bus.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/crc32.hpp>
+#include <vpnes/core/nes.hpp>
+#include <vpnes/core/profiler.hpp>
+#include "../fixture.hpp"
+
+namespace vpnes {
+
+namespace core {
+
+namespace bench {
+
+/**
+ * Warm-up runs per scenario
+ */
+static const int WarmUp = 2;
+/**
+ * Measured runs per scenario
+ */
+static const int Repetitions = 10;
+/**
+ * Frames emulated per run
+ */
+static const int FramesPerRun = 120;
+/**
+ * Bus accesses per run
+ */
+static const std::size_t AccessesPerRun = 0x100000;
+/**
+ * Event fires per run
+ */
+static const std::size_t FiresPerRun = 0x40000;
+/**
+ * Bank switches per run
+ */
+static const std::size_t SwitchesPerRun = 0x4000;
+/**
+ * Bytes hashed per run
+ */
+static const std::size_t HashedBytes = 0x80000;
+/**
+ * Instructions entered per run
+ */
+static const std::size_t InstructionsPerRun = 0x100000;
+
+/**
+ * Keeps computed values alive
+ */
+static volatile std::uint8_t Sink;
+
+/**
+ * Host clock
+ */
+typedef std::chrono::steady_clock hostClock;
+
+/**
+ * Measurement of single run
+ */
+struct SMeasure {
+	/**
+	 * Host nanoseconds
+	 */
+	double Nanoseconds;
+	/**
+	 * Operations done
+	 */
+	double Operations;
+	/**
+	 * Emulated CPU cycles
+	 */
+	double Cycles;
+	/**
+	 * Emulated frames
+	 */
+	double Frames;
+};
+
+/**
+ * Benchmark scenario
+ */
+struct SScenario {
+	/**
+	 * Name
+	 */
+	const char *Name;
+	/**
+	 * Single run
+	 */
+	std::function<SMeasure()> Run;
+};
+
+/**
+ * Makes NROM image with program placed at $8000
+ *
+ * NMI and IRQ vectors point to RTI at $8100.
+ *
+ * @param program Program code
+ * @return PRG ROM followed by CHR ROM
+ */
+static std::vector<std::uint8_t> makeBenchROM(
+    std::initializer_list<std::uint8_t> program) {
+	std::vector<std::uint8_t> rom = makeProgramROM(program, 0xea);
+	rom[0x0100] = 0x40;  // RTI
+	rom[0x7ffa] = 0x00;  // NMI vector
+	rom[0x7ffb] = 0x81;
+	rom[0x7ffe] = 0x00;  // IRQ vector
+	rom[0x7fff] = 0x81;
+	return rom;
+}
+
+/**
+ * Runs NES program
+ *
+ * @param program Program code
+ * @param sampleRate Audio sample rate or 0 for no audio
+ * @return Measurement
+ */
+static SMeasure runProgram(
+    std::initializer_list<std::uint8_t> program, int sampleRate = 0) {
+	STestConfig config(makeBenchROM(program), 0x8000);
+	config.RAMSize = 0x2000;
+	CFrameFrontEnd frontEnd(FramesPerRun, sampleRate);
+	std::unique_ptr<CNES> nes(config.createInstance(&frontEnd));
+	frontEnd.setNES(nes.get());
+	auto start = hostClock::now();
+	nes->powerUp();
+	auto end = hostClock::now();
+	SMeasure measure{};
+	measure.Nanoseconds =
+	    std::chrono::duration<double, std::nano>(end - start).count();
+	measure.Cycles = static_cast<double>(
+	    nes->getDebugger()->getElapsedTicks() /
+	    nes->getDebugger()->getCPUDivider());
+	measure.Operations = measure.Cycles;
+	measure.Frames = FramesPerRun;
+	return measure;
+}
+
+/**
+ * CPU-only loop
+ *
+ * @return Measurement
+ */
+static SMeasure runCPULoop() {
+	return runProgram({
+	    0xa2, 0x00,        // LDX #$00
+	    0xa0, 0x00,        // LDY #$00
+	    0x18,              // loop: CLC
+	    0x69, 0x01,        // ADC #$01
+	    0x85, 0x10,        // STA $10
+	    0xe6, 0x11,        // INC $11
+	    0xb5, 0x20,        // LDA $20,X
+	    0x9d, 0x00, 0x03,  // STA $0300,X
+	    0xe8,              // INX
+	    0xc8,              // INY
+	    0xd0, 0xf0,        // BNE loop
+	    0x4c, 0x04, 0x80   // JMP loop
+	});
+}
+
+/**
+ * Full frame with PPU register traffic
+ *
+ * @return Measurement
+ */
+static SMeasure runFrames() {
+	return runProgram({
+	    0xad, 0x02, 0x20,  // loop: LDA $2002
+	    0xa9, 0x20,        // LDA #$20
+	    0x8d, 0x06, 0x20,  // STA $2006
+	    0xa9, 0x00,        // LDA #$00
+	    0x8d, 0x06, 0x20,  // STA $2006
+	    0xa2, 0x20,        // LDX #$20
+	    0x8d, 0x07, 0x20,  // fill: STA $2007
+	    0xca,              // DEX
+	    0xd0, 0xfa,        // BNE fill
+	    0x4c, 0x00, 0x80   // JMP loop
+	});
+}
+
+/**
+ * Idle frames with background and sprites enabled in $2001
+ *
+ * PPU does not render yet, so this measures the frame loop only.
+ *
+ * @return Measurement
+ */
+static SMeasure runIdleFrames() {
+	return runProgram({
+	    0xa9, 0x1e,        // LDA #$1e
+	    0x8d, 0x01, 0x20,  // STA $2001
+	    0xa9, 0x80,        // LDA #$80
+	    0x8d, 0x00, 0x20,  // STA $2000
+	    0x4c, 0x0a, 0x80   // loop: JMP loop
+	});
+}
+
+/**
+ * Pulse, triangle and noise tones with 48 kHz audio output
+ *
+ * @return Measurement
+ */
+static SMeasure runAudio() {
+	return runProgram(
+	    {
+	        0xa9, 0x0f, 0x8d, 0x15, 0x40,  // Enable channels
+	        0xa9, 0xbf, 0x8d, 0x00, 0x40,  // Pulse: 50%, volume 15
+	        0xa9, 0xfd, 0x8d, 0x02, 0x40,  // Pulse: 440 Hz
+	        0xa9, 0x00, 0x8d, 0x03, 0x40,  //
+	        0xa9, 0xff, 0x8d, 0x08, 0x40,  // Triangle: halted counters
+	        0xa9, 0x7f, 0x8d, 0x0a, 0x40,  // Triangle: 440 Hz
+	        0xa9, 0x00, 0x8d, 0x0b, 0x40,  //
+	        0xa9, 0x3f, 0x8d, 0x0c, 0x40,  // Noise: volume 15
+	        0xa9, 0x04, 0x8d, 0x0e, 0x40,  // Noise: period 64
+	        0xa9, 0x00, 0x8d, 0x0f, 0x40,  //
+	        0x4c, 0x32, 0x80               // loop: JMP loop
+	    },
+	    48000);
+}
+
+/**
+ * Device with RAM and hooks
+ */
+class CBenchDevice : public CDevice {
+public:
+	/**
+	 * Bus config
+	 */
+	struct BusConfig : BusConfigBase<CBenchDevice> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::BankConfig<banks::ReadWrite<0x0000, 0x8000, 0x0800>>
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CBenchDevice *device) {
+			BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
+			    writeBuf, device->m_RAM);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			return addr < 0x8000;
+		}
+	};
+
+	/**
+	 * RAM
+	 */
+	std::uint8_t m_RAM[0x0800];
+	/**
+	 * Hook calls
+	 */
+	std::size_t m_Calls;
+
+	/**
+	 * Constructs the object
+	 */
+	CBenchDevice() : m_RAM{}, m_Calls() {
+	}
+	/**
+	 * Read hook
+	 *
+	 * @param addr Address
+	 */
+	void readHook(std::uint16_t addr) {
+		m_Calls++;
+	}
+	/**
+	 * Write hook
+	 *
+	 * @param val Value
+	 * @param addr Address
+	 */
+	void writeHook(std::uint8_t val, std::uint16_t addr) {
+		m_Calls++;
+	}
+};
+
+/**
+ * Bus instrumentation
+ */
+enum EBusInstrument {
+	BusPlain,    //!< No instrumentation
+	BusHooked,   //!< Hook on every address
+	BusWatched,  //!< Watchpoint on every address
+	BusPatched   //!< Read patches on some addresses
+};
+
+/**
+ * Bus accesses
+ *
+ * @param write Write or read
+ * @param instrument Instrumentation
+ * @return Measurement
+ */
+static SMeasure runBus(bool write, EBusInstrument instrument) {
+	CBenchDevice device;
+	CBusConfig<CBenchDevice::BusConfig> bus(0x40, &device);
+	switch (instrument) {
+	case BusHooked:
+		for (std::uint16_t addr = 0x0000; addr < 0x0800; addr++) {
+			bus.addPreReadHook(addr, &device, &CBenchDevice::readHook);
+			bus.addWriteHook(addr, &device, &CBenchDevice::writeHook);
+		}
+		break;
+	case BusWatched:
+		bus.getWatch()->setHandler(
+		    [&](EWatchType type, std::uint16_t addr, std::uint8_t val) {
+			    device.writeHook(val, addr);
+		    });
+		bus.getWatch()->setWatch(WatchRead, 0x0000, 0x07ff);
+		bus.getWatch()->setWatch(WatchWrite, 0x0000, 0x07ff);
+		break;
+	case BusPatched:
+		for (std::uint16_t addr = 0x0000; addr < 0x0800; addr += 0x40) {
+			bus.addPatch(addr, 0xea);
+		}
+		break;
+	default:
+		break;
+	}
+	std::uint8_t sum = 0;
+	auto start = hostClock::now();
+	for (std::size_t i = 0; i < AccessesPerRun; i++) {
+		std::uint16_t addr = (i * 0x35) & 0x07ff;
+		if (write) {
+			bus.writeMemory(static_cast<std::uint8_t>(i), addr);
+		} else {
+			sum += bus.readMemory(addr);
+		}
+	}
+	auto end = hostClock::now();
+	Sink = sum;
+	SMeasure measure{};
+	measure.Nanoseconds =
+	    std::chrono::duration<double, std::nano>(end - start).count();
+	measure.Operations = AccessesPerRun;
+	return measure;
+}
+
+/**
+ * Device with switchable 1 KB windows (like CHR banks)
+ */
+class CBankDevice : public CDevice {
+public:
+	/**
+	 * Bus config
+	 */
+	struct BusConfig : BusConfigBase<CBankDevice> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::BankConfig<banks::ReadOnly<0x0000, 0x0400, 0x0400>,
+		    banks::ReadOnly<0x0400, 0x0400, 0x0400>,
+		    banks::ReadOnly<0x0800, 0x0400, 0x0400>,
+		    banks::ReadOnly<0x0c00, 0x0400, 0x0400>>
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CBankDevice *device) {
+			BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
+			    writeBuf, device->m_ROM, device->m_ROM, device->m_ROM,
+			    device->m_ROM);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			return addr < 0x1000;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(
+		    std::uint16_t addr, const CBankDevice &device) {
+			return addr >> 10;
+		}
+	};
+
+	/**
+	 * ROM
+	 */
+	std::uint8_t m_ROM[0x8000];
+
+	/**
+	 * Constructs the object
+	 */
+	CBankDevice() : m_ROM{} {
+	}
+};
+
+/**
+ * Bank switches
+ *
+ * @return Measurement
+ */
+static SMeasure runBankSwitch() {
+	CBankDevice device;
+	CBusConfig<CBankDevice::BusConfig> bus(0x40, &device);
+	auto start = hostClock::now();
+	for (std::size_t i = 0; i < SwitchesPerRun; i++) {
+		bus.switchBank(
+		    &device, i & 0x03, device.m_ROM + ((i * 0x0400) & 0x7fff));
+	}
+	auto end = hostClock::now();
+	Sink = bus.readMemory(0x0000);
+	SMeasure measure{};
+	measure.Nanoseconds =
+	    std::chrono::duration<double, std::nano>(end - start).count();
+	measure.Operations = SwitchesPerRun;
+	return measure;
+}
+
+/**
+ * Scheduler that keeps rescheduling its events
+ */
+class CBenchScheduler : public CGeneratorDevice, public CEventManager {
+private:
+	/**
+	 * Fires left
+	 */
+	std::size_t m_FiresLeft;
+
+protected:
+	/**
+	 * Executes the simulation
+	 */
+	void execute() {
+	}
+
+public:
+	/**
+	 * Amount of events
+	 */
+	enum { EventCount = 16 };
+
+	/**
+	 * Constructs the object
+	 *
+	 * @param fires Amount of fires
+	 */
+	explicit CBenchScheduler(std::size_t fires)
+	    : CGeneratorDevice(true), CEventManager(), m_FiresLeft(fires) {
+		static const char *names[EventCount] = {"EV0", "EV1", "EV2", "EV3",
+		    "EV4", "EV5", "EV6", "EV7", "EV8", "EV9", "EV10", "EV11", "EV12",
+		    "EV13", "EV14", "EV15"};
+		for (int i = 0; i < EventCount; i++) {
+			registerEvent(this, this, names[i], i + 1, true,
+			    &CBenchScheduler::handleEvent);
+		}
+	}
+	/**
+	 * Event handler
+	 *
+	 * @param event Event
+	 */
+	void handleEvent(CEvent *event) {
+		if (--m_FiresLeft == 0) {
+			setEnabled(false);
+		}
+		event->setFireTime(event->getFireTime() + 7 + (m_FiresLeft & 0x0f));
+	}
+	/**
+	 * Gets pending time
+	 *
+	 * @return Pending time
+	 */
+	ticks_t getPending() const {
+		return m_Clock;
+	}
+};
+
+/**
+ * Event reschedules
+ *
+ * @return Measurement
+ */
+static SMeasure runEvents() {
+	CBenchScheduler scheduler(FiresPerRun);
+	auto start = hostClock::now();
+	scheduler.simulate();
+	auto end = hostClock::now();
+	SMeasure measure{};
+	measure.Nanoseconds =
+	    std::chrono::duration<double, std::nano>(end - start).count();
+	measure.Operations = FiresPerRun;
+	return measure;
+}
+
+/**
+ * ROM hashing
+ *
+ * @return Measurement
+ */
+static SMeasure runCRC32() {
+	std::vector<std::uint8_t> rom(HashedBytes);
+	for (std::size_t i = 0; i < rom.size(); i++) {
+		rom[i] = static_cast<std::uint8_t>(i * 0x35 + (i >> 8));
+	}
+	auto start = hostClock::now();
+	std::uint32_t crc = updateCRC32(0, rom.data(), rom.size());
+	auto end = hostClock::now();
+	Sink = static_cast<std::uint8_t>(crc);
+	SMeasure measure{};
+	measure.Nanoseconds =
+	    std::chrono::duration<double, std::nano>(end - start).count();
+	measure.Operations = HashedBytes;
+	return measure;
+}
+
+/**
+ * Code profiler fed with the instruction stream of cpu_loop
+ *
+ * Reports host time per instruction only, which is what a VPNES_PROFILE
+ * build adds to every instruction. Cycles are not reported, since they
+ * would give a meaningless emulation speed.
+ *
+ * @return Measurement
+ */
+static SMeasure runCodeProfile() {
+	static const std::uint16_t addresses[] = {
+	    0x8004, 0x8005, 0x8007, 0x8009, 0x800b, 0x800d, 0x8010, 0x8011, 0x8012};
+	static const ticks_t cycles[] = {2, 2, 3, 5, 4, 5, 2, 2, 3};
+	static const std::size_t loopSize = sizeof(cycles) / sizeof(cycles[0]);
+	std::unique_ptr<CCodeProfile> profile(new CCodeProfile());
+	ticks_t clock = 0;
+	auto start = hostClock::now();
+	for (std::size_t i = 0; i < InstructionsPerRun; i++) {
+		std::size_t index = i % loopSize;
+		profile->enter(addresses[index], clock);
+		clock += cycles[index];
+	}
+	auto end = hostClock::now();
+	SMeasure measure{};
+	measure.Nanoseconds =
+	    std::chrono::duration<double, std::nano>(end - start).count();
+	measure.Operations = InstructionsPerRun;
+	Sink = static_cast<std::uint8_t>(profile->getTicks(addresses[0]));
+	return measure;
+}
+
+/**
+ * Runs scenario and prints its JSON report
+ *
+ * @param scenario Scenario
+ */
+static void runScenario(const SScenario &scenario) {
+	for (int i = 0; i < WarmUp; i++) {
+		scenario.Run();
+	}
+	std::vector<SMeasure> runs;
+	for (int i = 0; i < Repetitions; i++) {
+		runs.push_back(scenario.Run());
+	}
+	std::sort(runs.begin(), runs.end(),
+	    [](const SMeasure &left, const SMeasure &right) {
+		    return left.Nanoseconds < right.Nanoseconds;
+	    });
+	const SMeasure &median = runs[runs.size() / 2];
+	double seconds = median.Nanoseconds / 1e9;
+	std::cout << "    {\"name\": \"" << scenario.Name << "\", \"ops\": "
+	          << static_cast<std::uint64_t>(median.Operations)
+	          << ", \"ns_per_op\": " << median.Nanoseconds / median.Operations
+	          << ", \"min_ns_per_op\": "
+	          << runs.front().Nanoseconds / runs.front().Operations;
+	if (median.Cycles > 0) {
+		std::cout << ", \"emulated_mhz\": " << median.Cycles / seconds / 1e6;
+	}
+	if (median.Frames > 0) {
+		std::cout << ", \"fps\": " << median.Frames / seconds;
+	}
+	std::cout << "}";
+}
+
+/**
+ * Runs all scenarios and prints JSON report
+ */
+static void runBenchmarks() {
+	const SScenario scenarios[] = {
+	    {"cpu_loop", runCPULoop},
+	    {"code_profile", runCodeProfile},
+	    {"bus_read", []() { return runBus(false, BusPlain); }},
+	    {"bus_read_hooked", []() { return runBus(false, BusHooked); }},
+	    {"bus_read_watched", []() { return runBus(false, BusWatched); }},
+	    {"bus_read_patched", []() { return runBus(false, BusPatched); }},
+	    {"bus_write", []() { return runBus(true, BusPlain); }},
+	    {"bus_write_hooked", []() { return runBus(true, BusHooked); }},
+	    {"bus_write_watched", []() { return runBus(true, BusWatched); }},
+	    {"bank_switch_1k", runBankSwitch},
+	    {"event_storm", runEvents},
+	    {"rom_crc32", runCRC32},
+	    {"frame_nrom", runFrames},
+	    {"frame_idle_ppumask", runIdleFrames},
+	    {"apu_audio", runAudio},
+	};
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "{\n  \"warmup\": " << WarmUp
+	          << ",\n  \"repetitions\": " << Repetitions
+	          << ",\n  \"benchmarks\": [\n";
+	bool first = true;
+	for (const SScenario &scenario : scenarios) {
+		if (!first) {
+			std::cout << ",\n";
+		}
+		first = false;
+		runScenario(scenario);
+	}
+	std::cout << "\n  ]\n}" << std::endl;
+}
+
+}  // namespace bench
+
+}  // namespace core
+
+}  // namespace vpnes
+
+/**
+ * Entry point for benchmarks
+ *
+ * Prints JSON report to standard output.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Array of command line arguments
+ * @return Exit code
+ */
+int main(int argc, char **argv) {
+	try {
+		vpnes::core::bench::runBenchmarks();
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
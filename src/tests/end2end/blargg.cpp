@@ -0,0 +1,135 @@
+/**
+ * @file
+ * Implements blargg test protocol helpers
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdint>
+#include <cctype>
+#include <stdexcept>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/nes.hpp>
+#include "blargg.hpp"
+
+/* CTestFrontEnd */
+
+/**
+ * Frame-ready callback
+ *
+ * @param frameTime Frame time
+ */
+void CTestFrontEnd::handleFrameRender(double frameTime) {
+	m_Jitter += frameTime;
+	auto millTime = static_cast<std::int64_t>(m_Jitter);
+	m_Time += std::chrono::duration_cast<duration_t>(
+	    std::chrono::milliseconds(millTime));
+	m_Jitter -= millTime;
+	if (m_Time > m_TimeLimit) {
+		throw std::runtime_error("Timeout");
+	}
+}
+
+/**
+ * Checks if NES is in valid state for test debug output
+ *
+ * @param nes NES
+ * @return Is valid or not
+ */
+static bool checkValidState(vpnes::core::CNES *nes) {
+	auto debugger = nes->getDebugger();
+	return debugger->directCPURead(0x6001) == 0xde &&
+	       debugger->directCPURead(0x6002) == 0xb0 &&
+	       debugger->directCPURead(0x6003) == 0x61;
+}
+
+/**
+ * Runs blargg test
+ *
+ * Test reports its status at $6000 and prints text from $6004.
+ *
+ * @param nesConfig Configured NES
+ * @param timeLimit Emulated time limit
+ * @return Test result
+ */
+SBlarggResult runBlarggTest(
+    vpnes::core::SNESConfig *nesConfig, CTestFrontEnd::duration_t timeLimit) {
+	SBlarggResult result{};
+	bool inProgress = false;
+	auto frontEnd = std::make_unique<CTestFrontEnd>(timeLimit);
+	std::unique_ptr<vpnes::core::CNES> nes(
+	    nesConfig->createInstance(frontEnd.get()));
+	nes->getDebugger()->hookCPUWrite(0x6000, [&](std::uint16_t addr,
+	                                             std::uint8_t val) {
+		std::uint16_t readAddress;
+		std::stringstream str;
+		switch (val) {
+		case 0x80:  // Start test
+			if (inProgress) {
+				throw std::invalid_argument("wrong state");
+			}
+			inProgress = true;
+			break;
+		case 0x81:  // Input required - skipping
+			if (!checkValidState(nes.get()) || !inProgress) {
+				throw std::invalid_argument("wrong state");
+			}
+			nes->turnOff();
+			result.Passed = true;
+			break;
+		default:
+			if (!checkValidState(nes.get()) || !inProgress) {
+				throw std::invalid_argument("wrong state");
+			}
+			if (val >= 0x80) {
+				throw std::invalid_argument("wrong result code");
+			}
+			for (readAddress = 0x6004; readAddress < 0x8000; ++readAddress) {
+				std::uint8_t readValue =
+				    nes->getDebugger()->directCPURead(readAddress);
+				if (readValue == 0) {
+					break;
+				}
+				if (!std::isalnum(readValue) && !std::ispunct(readValue) &&
+				    !std::isspace(readValue)) {
+					throw std::invalid_argument(
+					    "tried to print an invalid character");
+				}
+				str << readValue;
+			}
+			result.Output = str.str();
+			nes->turnOff();
+			result.Passed = val == 0;
+		}
+	});
+	nes->powerUp();
+	result.Cycles = nes->getDebugger()->getElapsedTicks() /
+	                nes->getDebugger()->getCPUDivider();
+	return result;
+}
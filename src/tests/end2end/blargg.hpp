@@ -0,0 +1,121 @@
+/**
+ * @file
+ * Defines blargg test protocol helpers
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef SRC_TESTS_END2END_BLARGG_HPP_
+#define SRC_TESTS_END2END_BLARGG_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/frontend.hpp>
+#include <vpnes/core/config.hpp>
+
+/**
+ * Frontend for testing
+ */
+class CTestFrontEnd : public vpnes::core::CFrontEnd {
+public:
+	/**
+	 * Duration type
+	 */
+	typedef std::chrono::high_resolution_clock::duration duration_t;
+
+private:
+	/**
+	 * Jitter
+	 */
+	double m_Jitter;
+	/**
+	 * Current time
+	 */
+	duration_t m_Time;
+	/**
+	 * Time limit
+	 */
+	duration_t m_TimeLimit;
+
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param timeLimit Running time limit
+	 */
+	explicit CTestFrontEnd(duration_t timeLimit)
+	    : m_Jitter(), m_Time(), m_TimeLimit(timeLimit) {
+	}
+	/**
+	 * Deleted default copy constructor
+	 *
+	 * @param s Copied value
+	 */
+	CTestFrontEnd(const CTestFrontEnd &s) = delete;
+	/**
+	 * Destructor
+	 */
+	~CTestFrontEnd() = default;
+	/**
+	 * Frame-ready callback
+	 *
+	 * @param frameTime Frame time
+	 */
+	void handleFrameRender(double frameTime);
+};
+
+/**
+ * Result of blargg test
+ */
+struct SBlarggResult {
+	/**
+	 * Passed or not
+	 */
+	bool Passed;
+	/**
+	 * Text printed by the test
+	 */
+	std::string Output;
+	/**
+	 * Emulated CPU cycles
+	 */
+	vpnes::core::ticks_t Cycles;
+};
+
+/**
+ * Runs blargg test
+ *
+ * Test reports its status at $6000 and prints text from $6004.
+ *
+ * @param nesConfig Configured NES
+ * @param timeLimit Emulated time limit
+ * @return Test result
+ */
+SBlarggResult runBlarggTest(
+    vpnes::core::SNESConfig *nesConfig, CTestFrontEnd::duration_t timeLimit);
+
+#endif  // SRC_TESTS_END2END_BLARGG_HPP_
@@ -26,18 +26,14 @@
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
-#include <cctype>
 #include <stdexcept>
-#include <memory>
 #include <chrono>
 #include <string>
 #include <iostream>
-#include <sstream>
-#include <fstream>
 #include <vpnes/vpnes.hpp>
 #include <vpnes/gui/config.hpp>
-#include <vpnes/core/frontend.hpp>
 #include <vpnes/core/config.hpp>
+#include "blargg.hpp"
 
 /**
  * Configuration for end-to-end testing
@@ -75,79 +71,6 @@ public:
 	}
 };
 
-/**
- * Frontend for testing
- */
-class CTestFrontEnd : public vpnes::core::CFrontEnd {
-public:
-	/**
-	 * Duration type
-	 */
-	typedef std::chrono::high_resolution_clock::duration duration_t;
-
-private:
-	/**
-	 * Jitter
-	 */
-	double m_Jitter;
-	/**
-	 * Current time
-	 */
-	duration_t m_Time;
-	/**
-	 * Time limit
-	 */
-	duration_t m_TimeLimit;
-
-public:
-	/**
-	 * Constructor
-	 *
-	 * @param timeLimit Running time limit
-	 */
-	explicit CTestFrontEnd(duration_t timeLimit)
-	    : m_Jitter(), m_Time(), m_TimeLimit(timeLimit) {
-	}
-	/**
-	 * Deleted default copy constructor
-	 *
-	 * @param s Copied value
-	 */
-	CTestFrontEnd(const CTestFrontEnd &s) = delete;
-	/**
-	 * Destructor
-	 */
-	~CTestFrontEnd() = default;
-	/**
-	 * Frame-ready callback
-	 *
-	 * @param frameTime Frame time
-	 */
-	void handleFrameRender(double frameTime) {
-		m_Jitter += frameTime;
-		auto millTime = static_cast<std::int64_t>(m_Jitter);
-		m_Time += std::chrono::duration_cast<duration_t>(
-		    std::chrono::milliseconds(millTime));
-		m_Jitter -= millTime;
-		if (m_Time > m_TimeLimit) {
-			throw std::runtime_error("Timeout");
-		}
-	}
-};
-
-/**
- * Checks if NES is in valid state for test debug output
- *
- * @param nes NES
- * @return Is valid or not
- */
-bool checkValidState(vpnes::core::CNES *nes) {
-	auto debugger = nes->getDebugger();
-	return debugger->directCPURead(0x6001) == 0xde &&
-	       debugger->directCPURead(0x6002) == 0xb0 &&
-	       debugger->directCPURead(0x6003) == 0x61;
-}
-
 /**
  * Entry point for e2e tester
  *
@@ -165,64 +88,14 @@ int main(int argc, char **argv) {
 		if (!config.hasTimeout()) {
 			throw std::invalid_argument("No timeout specified");
 		}
-		std::ifstream inputFile = config.getInputFile();
 		vpnes::core::SNESConfig nesConfig;
-		nesConfig.configure(config, &inputFile);
-		inputFile.close();
-		int result = EXIT_FAILURE;
-		bool inProgress = false;
+		nesConfig.configure(config);
 		auto time = std::chrono::seconds(config.getTimeout());
-		auto frontEnd = std::make_unique<CTestFrontEnd>(time);
-		std::unique_ptr<vpnes::core::CNES> nes(
-		    nesConfig.createInstance(frontEnd.get()));
-		nes->getDebugger()->hookCPUWrite(0x6000, [&](std::uint16_t addr,
-		                                             std::uint8_t val) {
-			std::uint16_t readAddress;
-			std::stringstream str;
-			switch (val) {
-			case 0x80:  // Start test
-				if (inProgress) {
-					throw std::invalid_argument("wrong state");
-				}
-				inProgress = true;
-				break;
-			case 0x81:  // Input required - skipping
-				if (!checkValidState(nes.get()) || !inProgress) {
-					throw std::invalid_argument("wrong state");
-				}
-				nes->turnOff();
-				result = EXIT_SUCCESS;
-				break;
-			default:
-				if (!checkValidState(nes.get()) || !inProgress) {
-					throw std::invalid_argument("wrong state");
-				}
-				if (val >= 0x80) {
-					throw std::invalid_argument("wrong result code");
-				}
-				for (readAddress = 0x6004; readAddress < 0x8000;
-				     ++readAddress) {
-					std::uint8_t readValue =
-					    nes->getDebugger()->directCPURead(readAddress);
-					if (readValue == 0) {
-						break;
-					}
-					if (!std::isalnum(readValue) && !std::ispunct(readValue) &&
-					    !std::isspace(readValue)) {
-						throw std::invalid_argument(
-						    "tried to print an invalid character");
-					}
-					str << readValue;
-				}
-				std::cout << str.str() << std::endl;
-				nes->turnOff();
-				if (val == 0) {
-					result = EXIT_SUCCESS;
-				}
-			}
-		});
-		nes->powerUp();
-		return result;
+		SBlarggResult result = runBlarggTest(&nesConfig, time);
+		if (!result.Output.empty()) {
+			std::cout << result.Output << std::endl;
+		}
+		return result.Passed ? EXIT_SUCCESS : EXIT_FAILURE;
 	} catch (const std::invalid_argument &e) {
 		std::cerr << e.what() << std::endl;
 		return EXIT_FAILURE;
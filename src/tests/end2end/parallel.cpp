@@ -0,0 +1,220 @@
+/**
+ * @file
+ * Parallel end-to-end test runner
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <iostream>
+#include <sstream>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/gui/config.hpp>
+#include <vpnes/core/config.hpp>
+#include "blargg.hpp"
+
+/**
+ * Test ROM and its outcome
+ */
+struct STestEntry {
+	/**
+	 * Path to ROM
+	 */
+	std::string Path;
+	/**
+	 * Test result
+	 */
+	SBlarggResult Result;
+	/**
+	 * Error message
+	 */
+	std::string Error;
+	/**
+	 * Host time spent on test
+	 */
+	std::chrono::steady_clock::duration WallTime;
+};
+
+/**
+ * Time limit for each test
+ */
+static const std::chrono::seconds TimeLimit(60);
+
+/**
+ * Default location of test ROMs relative to source directory
+ */
+static const char DefaultTests[] = "tests/blargg/cpu/instr";
+
+/**
+ * Adds ROMs from path
+ *
+ * @param path ROM or directory with ROMs
+ * @param roms List of ROMs
+ */
+static void addROMs(const std::string &path, std::vector<std::string> *roms) {
+	struct stat info;
+	if (::stat(path.c_str(), &info) != 0) {
+		throw std::invalid_argument("Could not open " + path);
+	}
+	if (!S_ISDIR(info.st_mode)) {
+		roms->push_back(path);
+		return;
+	}
+	DIR *dir = ::opendir(path.c_str());
+	if (!dir) {
+		throw std::invalid_argument("Could not open " + path);
+	}
+	std::vector<std::string> found;
+	while (struct dirent *entry = ::readdir(dir)) {
+		std::string name = entry->d_name;
+		for (const char *extension : {".nes", ".nes.gz", ".zip"}) {
+			std::size_t length = std::strlen(extension);
+			if (name.size() > length &&
+			    name.compare(name.size() - length, length, extension) == 0) {
+				found.push_back(path + "/" + name);
+				break;
+			}
+		}
+	}
+	::closedir(dir);
+	std::sort(found.begin(), found.end());
+	roms->insert(roms->end(), found.begin(), found.end());
+}
+
+/**
+ * Runs single test
+ *
+ * @param entry Test entry
+ */
+static void runEntry(STestEntry *entry) {
+	auto start = std::chrono::steady_clock::now();
+	try {
+		vpnes::gui::SApplicationConfig config;
+		config.setInputFile(entry->Path.c_str());
+		vpnes::core::SNESConfig nesConfig;
+		nesConfig.configure(config);
+		entry->Result = runBlarggTest(&nesConfig, TimeLimit);
+	} catch (const std::exception &e) {
+		entry->Result.Passed = false;
+		entry->Error = e.what();
+	}
+	entry->WallTime = std::chrono::steady_clock::now() - start;
+}
+
+/**
+ * Prints multiline text as TAP diagnostics
+ *
+ * @param text Text
+ */
+static void printDiagnostics(const std::string &text) {
+	std::istringstream lines(text);
+	std::string line;
+	while (std::getline(lines, line)) {
+		std::cout << "# " << line << '\n';
+	}
+}
+
+/**
+ * Entry point for parallel e2e tester
+ *
+ * Runs every given ROM (or every *.nes, *.nes.gz and *.zip in given
+ * directories) on its own NES instance using a thread pool and reports
+ * results in TAP format. Each worker loads and decompresses its own ROMs,
+ * so archives are decoded in parallel.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Array of command line arguments
+ * @return Exit code
+ */
+int main(int argc, char **argv) {
+	std::vector<std::string> roms;
+	try {
+		if (argc < 2) {
+			const char *srcDir = std::getenv("srcdir");
+			addROMs(std::string(srcDir ? srcDir : ".") + "/" + DefaultTests,
+			    &roms);
+		}
+		for (int i = 1; i < argc; i++) {
+			addROMs(argv[i], &roms);
+		}
+	} catch (const std::invalid_argument &e) {
+		std::cout << "Bail out! " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::vector<STestEntry> entries(roms.size());
+	for (std::size_t i = 0; i < roms.size(); i++) {
+		entries[i].Path = roms[i];
+	}
+	std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = std::min(threadCount, entries.size());
+	std::atomic<std::size_t> nextEntry(0);
+	std::vector<std::thread> pool;
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < threadCount; i++) {
+		pool.emplace_back([&]() {
+			for (;;) {
+				std::size_t index = nextEntry++;
+				if (index >= entries.size()) {
+					break;
+				}
+				runEntry(&entries[index]);
+			}
+		});
+	}
+	for (std::thread &thread : pool) {
+		thread.join();
+	}
+	auto totalTime = std::chrono::steady_clock::now() - start;
+	bool passed = true;
+	std::cout << "1.." << entries.size() << '\n';
+	for (std::size_t i = 0; i < entries.size(); i++) {
+		const STestEntry &entry = entries[i];
+		auto wallTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+		    entry.WallTime);
+		std::string name = entry.Path.substr(entry.Path.rfind('/') + 1);
+		passed = passed && entry.Result.Passed;
+		std::cout << (entry.Result.Passed ? "ok " : "not ok ") << (i + 1)
+		          << " - " << name << " (" << entry.Result.Cycles
+		          << " cycles, " << wallTime.count() << " ms)\n";
+		if (!entry.Error.empty()) {
+			printDiagnostics(entry.Error);
+		} else if (!entry.Result.Passed) {
+			printDiagnostics(entry.Result.Output);
+		}
+	}
+	std::cout << "# " << threadCount << " threads, "
+	          << std::chrono::duration_cast<std::chrono::milliseconds>(
+	                 totalTime)
+	                 .count()
+	          << " ms total" << std::endl;
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file
+ * Defines NES fixtures shared by unit tests and benchmarks
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifndef SRC_TESTS_FIXTURE_HPP_
+#define SRC_TESTS_FIXTURE_HPP_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/frontend.hpp>
+#include <vpnes/core/image.hpp>
+#include <vpnes/core/mboard.hpp>
+#include <vpnes/core/nes.hpp>
+
+/**
+ * Front-end turning NES off after some frames
+ */
+class CFrameFrontEnd : public vpnes::core::CFrontEnd {
+private:
+	/**
+	 * Controlled NES
+	 */
+	vpnes::core::CNES *m_NES;
+	/**
+	 * Frames left to run (0 to run until turned off)
+	 */
+	int m_FramesLeft;
+	/**
+	 * Audio sample rate
+	 */
+	int m_SampleRate;
+
+public:
+	/**
+	 * Constructs the object
+	 *
+	 * @param frames Amount of frames (0 to run until turned off)
+	 * @param sampleRate Audio sample rate or 0 for no audio
+	 */
+	explicit CFrameFrontEnd(int frames = 0, int sampleRate = 0)
+	    : m_NES(), m_FramesLeft(frames), m_SampleRate(sampleRate) {
+	}
+	/**
+	 * Sets controlled NES
+	 *
+	 * @param nes NES
+	 */
+	void setNES(vpnes::core::CNES *nes) {
+		m_NES = nes;
+	}
+	/**
+	 * Frame-ready callback
+	 *
+	 * @param frameTime Frame time
+	 */
+	void handleFrameRender(double frameTime) {
+		if (m_FramesLeft > 0 && --m_FramesLeft == 0 && m_NES) {
+			m_NES->turnOff();
+		}
+	}
+	/**
+	 * Gets audio sample rate
+	 *
+	 * @return Sample rate
+	 */
+	int getSampleRate() {
+		return m_SampleRate;
+	}
+};
+
+/**
+ * NTSC config on an in-memory ROM image
+ *
+ * CHR ROM follows PRG ROM in the image, a cartridge without CHR ROM gets
+ * 8 KB CHR RAM.
+ */
+struct STestConfig : vpnes::core::SNESConfig {
+	/**
+	 * Constructs the object
+	 *
+	 * @param rom PRG ROM followed by CHR ROM
+	 * @param prgSize PRG ROM size
+	 * @param mapper Mapper number
+	 */
+	STestConfig(std::vector<std::uint8_t> rom, std::size_t prgSize,
+	    std::uint16_t mapper = 0) {
+		std::size_t chrSize = rom.size() - prgSize;
+		Image = std::make_shared<vpnes::core::CROMImage>(std::move(rom));
+		PRG = Image->getSpan(0, prgSize);
+		CHR = Image->getSpan(prgSize, chrSize);
+		PRGSize = prgSize;
+		CHRSize = chrSize;
+		CHRRAMSize = chrSize == 0 ? 0x2000 : 0;
+		Mapper = mapper;
+		Mirroring = vpnes::core::MirroringVertical;
+		NESType = vpnes::core::NESTypeNTSC;
+	}
+};
+
+/**
+ * Makes NROM-256 image running a program
+ *
+ * @param program Program placed at $8000, also the reset vector
+ * @param fill Value of unused PRG ROM bytes
+ * @return PRG ROM followed by 8 KB CHR ROM
+ */
+inline std::vector<std::uint8_t> makeProgramROM(
+    std::initializer_list<std::uint8_t> program, std::uint8_t fill = 0) {
+	std::vector<std::uint8_t> rom(0x8000, fill);
+	std::copy(program.begin(), program.end(), rom.begin());
+	rom[0x7ffc] = 0x00;  // Reset vector
+	rom[0x7ffd] = 0x80;
+	rom.resize(0x8000 + 0x2000, 0);
+	return rom;
+}
+
+/**
+ * Makes image with numbered banks
+ *
+ * The first byte of every 16 KB PRG ROM bank is its number, the first byte
+ * of every CHR ROM bank is its number with bit 7 set.
+ *
+ * @param prgSize PRG ROM size
+ * @param chrSize CHR ROM size
+ * @param chrBankSize CHR ROM bank size
+ * @param fill Value of other bytes
+ * @return PRG ROM followed by CHR ROM
+ */
+inline std::vector<std::uint8_t> makeNumberedROM(std::size_t prgSize,
+    std::size_t chrSize, std::size_t chrBankSize, std::uint8_t fill = 0) {
+	std::vector<std::uint8_t> rom(prgSize + chrSize, fill);
+	for (std::size_t bank = 0; bank < prgSize / 0x4000; bank++) {
+		rom[bank * 0x4000] = static_cast<std::uint8_t>(bank);
+	}
+	for (std::size_t bank = 0; bank < chrSize / chrBankSize; bank++) {
+		rom[prgSize + bank * chrBankSize] =
+		    static_cast<std::uint8_t>(0x80 | bank);
+	}
+	return rom;
+}
+
+/**
+ * Mapper on its own buses with controlled time
+ *
+ * Clock base is never reset, so event time is elapsed time.
+ */
+template <class Mapper>
+class CMapperBoard {
+private:
+	/**
+	 * Front-end
+	 */
+	CFrameFrontEnd m_FrontEnd;
+	/**
+	 * Motherboard
+	 */
+	vpnes::core::CMotherBoard m_MotherBoard;
+	/**
+	 * Mapper
+	 */
+	Mapper m_Mapper;
+
+public:
+	/**
+	 * Constructs the object
+	 *
+	 * @param config NES config
+	 */
+	explicit CMapperBoard(const vpnes::core::SNESConfig &config)
+	    : m_FrontEnd()
+	    , m_MotherBoard(&m_FrontEnd)
+	    , m_Mapper(&m_MotherBoard, config) {
+		m_MotherBoard.addBusCPU(&m_Mapper);
+		m_MotherBoard.addBusPPU(&m_Mapper);
+	}
+
+	/**
+	 * Gets motherboard
+	 *
+	 * @return Motherboard
+	 */
+	vpnes::core::CMotherBoard *getMotherBoard() {
+		return &m_MotherBoard;
+	}
+	/**
+	 * Gets current time
+	 *
+	 * @return Elapsed ticks
+	 */
+	vpnes::core::ticks_t getClock() const {
+		return m_MotherBoard.getClock();
+	}
+	/**
+	 * Sets current time
+	 *
+	 * @param time Elapsed ticks
+	 */
+	void setClock(vpnes::core::ticks_t time) {
+		m_MotherBoard.setClock(time);
+	}
+	/**
+	 * Writes CPU bus
+	 *
+	 * @param addr Address
+	 * @param val Value
+	 */
+	void write(std::uint16_t addr, std::uint8_t val) {
+		m_MotherBoard.getBusCPU()->writeMemory(val, addr);
+	}
+	/**
+	 * Reads CPU bus
+	 *
+	 * @param addr Address
+	 * @return Value
+	 */
+	std::uint8_t readCPU(std::uint16_t addr) {
+		return m_MotherBoard.getBusCPU()->readMemory(addr, true);
+	}
+	/**
+	 * Reads PPU bus
+	 *
+	 * @param addr Address
+	 * @return Value
+	 */
+	std::uint8_t readPPU(std::uint16_t addr) {
+		return m_MotherBoard.getBusPPU()->readMemory(addr, true);
+	}
+	/**
+	 * Writes PPU bus
+	 *
+	 * @param addr Address
+	 * @param val Value
+	 */
+	void writePPU(std::uint16_t addr, std::uint8_t val) {
+		m_MotherBoard.getBusPPU()->writeMemory(val, addr, true);
+	}
+	/**
+	 * Checks if IRQ line is asserted
+	 *
+	 * @return True if asserted
+	 */
+	bool isIRQ() const {
+		return m_MotherBoard.isIRQ();
+	}
+};
+
+#endif  // SRC_TESTS_FIXTURE_HPP_
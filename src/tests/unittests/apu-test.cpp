@@ -0,0 +1,108 @@
+/**
+ * @file
+ * APU unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <vpnes/core/apu.hpp>
+
+using vpnes::core::ticks_t;
+using vpnes::core::apu::CTimer;
+using vpnes::core::apu::CPulse;
+using vpnes::core::apu::CTriangle;
+using vpnes::core::apu::CDMC;
+
+BOOST_AUTO_TEST_CASE(apu_pulse) {
+	CPulse pulse(true);
+	pulse.setEnabled(true);
+	pulse.writeReg(0xbf, 0);  // 50% duty, constant volume 15
+	pulse.writeReg(0x10, 2);
+	pulse.writeReg(0x08, 3);
+	BOOST_REQUIRE(pulse.isActive());
+	BOOST_CHECK_EQUAL(pulse.getLevel(), 0);
+	ticks_t next = pulse.getNext();
+	pulse.advance(next);
+	BOOST_CHECK_EQUAL(pulse.getLevel(), 15);
+	// Four steps of equal level are skipped at once
+	BOOST_CHECK_EQUAL(pulse.getNext(), 4 * (0x10 + 1) * 2);
+	pulse.advance(pulse.getNext() - 1);
+	BOOST_CHECK_EQUAL(pulse.getLevel(), 15);
+	pulse.advance(1);
+	BOOST_CHECK_EQUAL(pulse.getLevel(), 0);
+	// Timer below 8 mutes the channel
+	pulse.writeReg(0x07, 2);
+	BOOST_CHECK(!pulse.isActive());
+	BOOST_CHECK_EQUAL(pulse.getNext(), CTimer::Idle);
+	pulse.writeReg(0x10, 2);
+	pulse.setEnabled(false);
+	BOOST_CHECK(!pulse.isPlaying());
+	BOOST_CHECK(!pulse.isActive());
+}
+
+BOOST_AUTO_TEST_CASE(apu_triangle) {
+	CTriangle triangle;
+	triangle.setEnabled(true);
+	triangle.writeReg(0x7f, 0);
+	triangle.writeReg(0x10, 2);
+	triangle.writeReg(0x08, 3);
+	BOOST_CHECK(!triangle.isActive());
+	triangle.clockQuarter();
+	BOOST_REQUIRE(triangle.isActive());
+	BOOST_CHECK_EQUAL(triangle.getLevel(), 15);
+	triangle.advance(triangle.getNext());
+	BOOST_CHECK_EQUAL(triangle.getLevel(), 14);
+	triangle.advance(triangle.getNext() + 0x11 * 29);
+	BOOST_CHECK_EQUAL(triangle.getLevel(), 15);
+	// Linear counter silences the channel, output holds
+	for (int i = 0; i < 0x80; i++) {
+		triangle.clockQuarter();
+	}
+	BOOST_CHECK(!triangle.isActive());
+	BOOST_CHECK_EQUAL(triangle.getLevel(), 15);
+}
+
+BOOST_AUTO_TEST_CASE(apu_dmc) {
+	CDMC dmc;
+	dmc.writeReg(0x8f, 0);
+	dmc.writeReg(0x10, 1);
+	dmc.writeReg(0x00, 3);
+	dmc.setEnabled(true);
+	BOOST_REQUIRE(dmc.isPlaying());
+	BOOST_REQUIRE(dmc.isFetchNeeded());
+	BOOST_CHECK_EQUAL(dmc.getAddress(), 0xc000);
+	// Single byte sample ends with IRQ
+	BOOST_CHECK(dmc.fill(0xff));
+	BOOST_CHECK(!dmc.isPlaying());
+	BOOST_CHECK(!dmc.isFetchNeeded());
+	BOOST_CHECK_EQUAL(dmc.getLevel(), 0x10);
+	dmc.advance(dmc.getBufferEnd());
+	BOOST_CHECK_EQUAL(dmc.getBufferEnd(), CTimer::Idle);
+	dmc.advance(8 * 54);
+	BOOST_CHECK_EQUAL(dmc.getLevel(), 0x10 + 8 * 2);
+	// Silent channel keeps its level
+	dmc.advance(100 * 54);
+	BOOST_CHECK_EQUAL(dmc.getLevel(), 0x10 + 8 * 2);
+	BOOST_CHECK_EQUAL(dmc.getNext(), CTimer::Idle);
+}
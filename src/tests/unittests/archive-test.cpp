@@ -0,0 +1,270 @@
+/**
+ * @file
+ * Archive unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <vpnes/core/archive.hpp>
+#include <vpnes/core/crc32.hpp>
+
+using namespace vpnes::core;
+using namespace vpnes::core::archive;
+
+namespace {
+
+/**
+ * Zip entry
+ */
+struct SZipEntry {
+	/**
+	 * Name
+	 */
+	std::string Name;
+	/**
+	 * Uncompressed data
+	 */
+	std::vector<std::uint8_t> Data;
+	/**
+	 * Deflate data (store otherwise)
+	 */
+	bool Deflate;
+	/**
+	 * CRC32 written to archive
+	 */
+	std::uint32_t CRC32;
+	/**
+	 * Uncompressed size written to archive
+	 */
+	std::uint32_t Size;
+};
+
+/**
+ * Makes ROM-like data
+ *
+ * @param size Size
+ * @return Data
+ */
+std::vector<std::uint8_t> makeROM(std::size_t size) {
+	std::vector<std::uint8_t> rom(size);
+	for (std::size_t i = 0; i < size; i++) {
+		rom[i] = static_cast<std::uint8_t>((i * 7) ^ (i >> 9));
+	}
+	std::memcpy(rom.data(), "NES\x1a", 4);
+	return rom;
+}
+
+/**
+ * Makes zip entry with valid CRC32 and size
+ *
+ * @param name Name
+ * @param data Uncompressed data
+ * @param deflate Deflate data
+ * @return Entry
+ */
+SZipEntry makeEntry(
+    const char *name, const std::vector<std::uint8_t> &data, bool deflate) {
+	return {name, data, deflate, updateCRC32(0, data.data(), data.size()),
+	    static_cast<std::uint32_t>(data.size())};
+}
+
+/**
+ * Appends little-endian value
+ *
+ * @param output Output
+ * @param value Value
+ * @param bytes Value size
+ */
+void putValue(
+    std::vector<std::uint8_t> *output, std::uint32_t value, std::size_t bytes) {
+	for (std::size_t i = 0; i < bytes; i++) {
+		output->push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+	}
+}
+
+#if defined(HAVE_ZLIB)
+/**
+ * Compresses data
+ *
+ * @param data Data
+ * @param gzip Make gzip stream (raw deflate otherwise)
+ * @return Compressed data
+ */
+std::vector<std::uint8_t> compress(
+    const std::vector<std::uint8_t> &data, bool gzip) {
+	::z_stream stream;
+	std::memset(&stream, 0, sizeof(stream));
+	BOOST_REQUIRE_EQUAL(::deflateInit2(&stream, Z_BEST_COMPRESSION,
+	                        Z_DEFLATED, gzip ? 16 + MAX_WBITS : -MAX_WBITS, 8,
+	                        Z_DEFAULT_STRATEGY),
+	    Z_OK);
+	std::vector<std::uint8_t> output(::deflateBound(&stream, data.size()) + 32);
+	stream.next_in = const_cast<::Bytef *>(data.data());
+	stream.avail_in = static_cast<::uInt>(data.size());
+	stream.next_out = output.data();
+	stream.avail_out = static_cast<::uInt>(output.size());
+	BOOST_REQUIRE_EQUAL(::deflate(&stream, Z_FINISH), Z_STREAM_END);
+	output.resize(stream.total_out);
+	::deflateEnd(&stream);
+	return output;
+}
+#endif
+
+/**
+ * Makes zip archive
+ *
+ * @param entries Entries
+ * @return Archive data
+ */
+std::vector<std::uint8_t> makeZip(const std::vector<SZipEntry> &entries) {
+	std::vector<std::uint8_t> zip;
+	std::vector<std::uint8_t> directory;
+	for (const SZipEntry &entry : entries) {
+		std::vector<std::uint8_t> packed = entry.Data;
+#if defined(HAVE_ZLIB)
+		if (entry.Deflate) {
+			packed = compress(entry.Data, false);
+		}
+#endif
+		std::uint32_t local = static_cast<std::uint32_t>(zip.size());
+		for (std::vector<std::uint8_t> *header : {&zip, &directory}) {
+			bool central = header == &directory;
+			putValue(header, central ? 0x02014b50 : 0x04034b50, 4);
+			if (central) {
+				putValue(header, 20, 2);  // Made by
+			}
+			putValue(header, 20, 2);  // Version needed
+			putValue(header, 0, 2);   // Flags
+			putValue(header, entry.Deflate ? 8 : 0, 2);
+			putValue(header, 0, 4);  // Time and date
+			putValue(header, entry.CRC32, 4);
+			putValue(header, static_cast<std::uint32_t>(packed.size()), 4);
+			putValue(header, entry.Size, 4);
+			putValue(header, static_cast<std::uint32_t>(entry.Name.size()), 2);
+			putValue(header, 0, 2);  // Extra length
+			if (central) {
+				putValue(header, 0, 2);  // Comment length
+				putValue(header, 0, 2);  // Disk
+				putValue(header, 0, 2);  // Internal attributes
+				putValue(header, 0, 4);  // External attributes
+				putValue(header, local, 4);
+			}
+			header->insert(header->end(), entry.Name.begin(), entry.Name.end());
+		}
+		zip.insert(zip.end(), packed.begin(), packed.end());
+	}
+	std::uint32_t offset = static_cast<std::uint32_t>(zip.size());
+	zip.insert(zip.end(), directory.begin(), directory.end());
+	putValue(&zip, 0x06054b50, 4);
+	putValue(&zip, 0, 4);  // Disks
+	putValue(&zip, static_cast<std::uint32_t>(entries.size()), 2);
+	putValue(&zip, static_cast<std::uint32_t>(entries.size()), 2);
+	putValue(&zip, static_cast<std::uint32_t>(directory.size()), 4);
+	putValue(&zip, offset, 4);
+	putValue(&zip, 0, 2);  // Comment length
+	return zip;
+}
+
+/**
+ * Extracts ROM from archive data
+ *
+ * @param data Archive data
+ * @return ROM data
+ */
+std::vector<std::uint8_t> extract(const std::vector<std::uint8_t> &data) {
+	return extractROM(data.data(), data.size());
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(archive_plain) {
+	std::vector<std::uint8_t> rom = makeROM(0x6010);
+	BOOST_CHECK_EQUAL(detectContainer(rom.data(), rom.size()), ContainerNone);
+	BOOST_CHECK(extract(rom) == rom);
+}
+
+BOOST_AUTO_TEST_CASE(archive_zip_stored) {
+	std::vector<std::uint8_t> rom = makeROM(0x6010);
+	std::vector<std::uint8_t> zip =
+	    makeZip({makeEntry("readme.txt", {'h', 'i'}, false),
+	        makeEntry("Game.NES", rom, false)});
+	BOOST_CHECK_EQUAL(detectContainer(zip.data(), zip.size()), ContainerZip);
+	BOOST_CHECK(extract(zip) == rom);
+}
+
+BOOST_AUTO_TEST_CASE(archive_zip_errors) {
+	std::vector<std::uint8_t> rom = makeROM(0x6010);
+	SZipEntry entry = makeEntry("game.nes", rom, false);
+	entry.CRC32 ^= 1;
+	BOOST_CHECK_THROW(extract(makeZip({entry})), std::invalid_argument);
+	entry = makeEntry("game.nes", rom, false);
+	entry.Size++;
+	BOOST_CHECK_THROW(extract(makeZip({entry})), std::invalid_argument);
+	BOOST_CHECK_THROW(extract(makeZip({makeEntry("game.txt", rom, false)})),
+	    std::invalid_argument);
+	std::vector<std::uint8_t> zip =
+	    makeZip({makeEntry("game.nes", rom, false)});
+	zip.resize(zip.size() - 10);
+	BOOST_CHECK_THROW(extract(zip), std::invalid_argument);
+}
+
+#if defined(HAVE_ZLIB)
+BOOST_AUTO_TEST_CASE(archive_zip_deflated) {
+	std::vector<std::uint8_t> rom = makeROM(0x40010);
+	BOOST_CHECK(extract(makeZip({makeEntry("game.nes", rom, true)})) == rom);
+	SZipEntry entry = makeEntry("game.nes", rom, true);
+	entry.CRC32 ^= 0x80000000;
+	BOOST_CHECK_THROW(extract(makeZip({entry})), std::invalid_argument);
+	// Stored sizes are not trusted for preallocation
+	entry = makeEntry("game.nes", rom, true);
+	entry.Size = 0xfffffff0;
+	BOOST_CHECK_THROW(extract(makeZip({entry})), std::invalid_argument);
+	entry.Size = 0x10;
+	BOOST_CHECK_THROW(extract(makeZip({entry})), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(archive_gzip) {
+	std::vector<std::uint8_t> rom = makeROM(0x40010);
+	std::vector<std::uint8_t> gzip = compress(rom, true);
+	BOOST_CHECK_EQUAL(detectContainer(gzip.data(), gzip.size()), ContainerGzip);
+	BOOST_CHECK(extract(gzip) == rom);
+	// Wrong size in trailer fails the gzip check after inflating
+	gzip[gzip.size() - 1] ^= 0x80;
+	BOOST_CHECK_THROW(extract(gzip), std::invalid_argument);
+	gzip = compress(rom, true);
+	gzip[gzip.size() - 8] ^= 0x01;
+	BOOST_CHECK_THROW(extract(gzip), std::invalid_argument);
+	gzip.resize(gzip.size() / 2);
+	BOOST_CHECK_THROW(extract(gzip), std::invalid_argument);
+}
+#endif
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * Audio queue and resampler unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vpnes/core/audioring.hpp>
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Resamples frames at a fixed queue level
+ *
+ * @param resampler Resampler
+ * @param frames Amount of frames
+ * @param level Queue level
+ * @return Amount of output samples of the last frame
+ */
+std::size_t runFrames(
+    CAudioResampler *resampler, int frames, std::size_t level) {
+	std::vector<std::int16_t> input(800, 100);
+	std::vector<std::int16_t> output;
+	for (int i = 0; i < frames; i++) {
+		resampler->resample(input.data(), input.size(), level, &output);
+		// Ratio never exceeds its limits
+		BOOST_REQUIRE_LE(output.size(), 800 * 1.005 + 1);
+		BOOST_REQUIRE_GE(output.size(), 800 * 0.995 - 1);
+		for (std::int16_t sample : output) {
+			BOOST_REQUIRE_EQUAL(sample, 100);
+		}
+	}
+	return output.size();
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(audioring_empty_full) {
+	CAudioRing ring(5);
+	BOOST_CHECK_EQUAL(ring.getCapacity(), 8);
+	std::int16_t samples[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+	std::int16_t out[10] = {};
+	BOOST_CHECK_EQUAL(ring.pop(out, 10), 0);
+	BOOST_CHECK_EQUAL(ring.push(samples, 10), 8);
+	BOOST_CHECK_EQUAL(ring.getSize(), 8);
+	BOOST_CHECK_EQUAL(ring.push(samples, 1), 0);
+	BOOST_CHECK_EQUAL(ring.pop(out, 10), 8);
+	BOOST_CHECK_EQUAL(out[7], 8);
+	BOOST_CHECK_EQUAL(ring.getSize(), 0);
+	BOOST_CHECK_EQUAL(ring.pop(out, 1), 0);
+}
+
+BOOST_AUTO_TEST_CASE(audioring_wraparound) {
+	CAudioRing ring(8);
+	std::int16_t samples[6] = {1, 2, 3, 4, 5, 6};
+	std::int16_t out[8] = {};
+	BOOST_CHECK_EQUAL(ring.push(samples, 6), 6);
+	BOOST_CHECK_EQUAL(ring.pop(out, 4), 4);
+	// Both calls below cross the end of the ring
+	BOOST_CHECK_EQUAL(ring.push(samples, 6), 6);
+	BOOST_CHECK_EQUAL(ring.getSize(), 8);
+	BOOST_CHECK_EQUAL(ring.pop(out, 8), 8);
+	const std::int16_t expected[8] = {5, 6, 1, 2, 3, 4, 5, 6};
+	BOOST_CHECK_EQUAL_COLLECTIONS(out, out + 8, expected, expected + 8);
+}
+
+BOOST_AUTO_TEST_CASE(audioring_resample_ratio) {
+	CAudioResampler resampler(1000.0);
+	// Queue at its set point passes samples through, one sample late
+	std::int16_t ramp[4] = {40, 60, 80, 100};
+	std::vector<std::int16_t> output;
+	resampler.resample(ramp, 4, 1000, &output);
+	BOOST_CHECK_EQUAL(resampler.getRatio(), 1.0);
+	const std::int16_t expected[4] = {0, 40, 60, 80};
+	BOOST_CHECK_EQUAL_COLLECTIONS(
+	    output.begin(), output.end(), expected, expected + 4);
+	// Empty queue raises the ratio up to its limit, gradually
+	std::size_t first = runFrames(&resampler, 1, 0);
+	BOOST_CHECK_LT(resampler.getRatio(), 1.0 + CAudioResampler::MaxRateDelta);
+	BOOST_CHECK_LE(first, 801);
+	runFrames(&resampler, 300, 0);
+	BOOST_CHECK_CLOSE(
+	    resampler.getRatio(), 1.0 + CAudioResampler::MaxRateDelta, 0.01);
+	// Overfull queue lowers it
+	runFrames(&resampler, 300, 5000);
+	BOOST_CHECK_CLOSE(
+	    resampler.getRatio(), 1.0 - CAudioResampler::MaxRateDelta, 0.01);
+	// Output keeps the ratio over many frames
+	std::vector<std::int16_t> input(800, 100);
+	std::size_t total = 0;
+	for (int i = 0; i < 100; i++) {
+		resampler.resample(input.data(), input.size(), 5000, &output);
+		total += output.size();
+	}
+	BOOST_CHECK_CLOSE(total / 80000.0, 1.0 - CAudioResampler::MaxRateDelta,
+	    0.01);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * Band-limited step buffer unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vpnes/core/blip.hpp>
+
+using vpnes::core::CBlipBuffer;
+
+/**
+ * NTSC clock frequency (milliseconds per tick)
+ */
+static const double frequency = 44.0 / 945000.0;
+/**
+ * NTSC frame time in ticks
+ */
+static const vpnes::core::ticks_t frameTime = 357368;
+
+BOOST_AUTO_TEST_CASE(blip_step) {
+	CBlipBuffer blip(frequency, 48000, frameTime);
+	std::vector<std::int16_t> samples(blip.getMaxSamples());
+	blip.addDelta(10000, 0.5f);
+	blip.endFrame(frameTime);
+	BOOST_REQUIRE_EQUAL(blip.getAvailable(), 798);
+	std::size_t count = blip.readSamples(samples.data(), samples.size());
+	BOOST_REQUIRE_EQUAL(count, 798);
+	BOOST_CHECK_EQUAL(blip.getAvailable(), 0);
+	// Step at sample 22 is delayed by half of the impulse
+	BOOST_CHECK_EQUAL(samples[0], 0);
+	BOOST_CHECK_EQUAL(samples[20], 0);
+	BOOST_CHECK_GT(samples[40], 15000);
+	BOOST_CHECK_LT(samples[40], 16500);
+	// DC level decays
+	BOOST_CHECK_LT(samples[797], samples[40]);
+	BOOST_CHECK_GT(samples[797], 0);
+}
+
+BOOST_AUTO_TEST_CASE(blip_frames) {
+	CBlipBuffer blip(frequency, 44100, frameTime);
+	std::vector<std::int16_t> samples(blip.getMaxSamples());
+	std::size_t total = 0;
+	for (int frame = 0; frame < 60; frame++) {
+		// Square wave with level changes at frame boundaries
+		for (int i = -11; i < frameTime; i += 2000) {
+			blip.addDelta(i, ((i / 2000) & 1) ? -0.25f : 0.25f);
+		}
+		blip.endFrame(frameTime);
+		total += blip.readSamples(samples.data(), samples.size());
+	}
+	double expected = 60 * frameTime * frequency * 44.1;
+	BOOST_CHECK_LE(total, expected);
+	BOOST_CHECK_GE(total, expected - 1);
+	for (std::size_t i = 0; i < samples.size(); i++) {
+		BOOST_CHECK_GT(samples[i], -32768);
+		BOOST_CHECK_LT(samples[i], 32767);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(blip_frame_end) {
+	CBlipBuffer blip(frequency, 48000, frameTime);
+	std::vector<std::int16_t> samples(blip.getMaxSamples());
+	// Delta at the end of the longest frame is kept for the next frame
+	blip.addDelta(frameTime - 1, 0.5f);
+	blip.endFrame(frameTime);
+	BOOST_CHECK_EQUAL(blip.readSamples(samples.data(), samples.size()),
+	    blip.getMaxSamples() - 1);
+	BOOST_CHECK_EQUAL(samples[0], 0);
+	blip.endFrame(frameTime);
+	BOOST_REQUIRE_GT(blip.readSamples(samples.data(), samples.size()), 20);
+	BOOST_CHECK_GT(samples[20], 15000);
+}
@@ -0,0 +1,174 @@
+/**
+ * @file
+ * Breakpoint condition unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vpnes/core/breakpoint.hpp>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/debugger.hpp>
+#include <vpnes/core/nes.hpp>
+#include "../fixture.hpp"
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Makes NROM image storing 1 to 5 at $10
+ *
+ * @return PRG ROM followed by CHR ROM
+ */
+std::vector<std::uint8_t> makeStoreROM() {
+	return makeProgramROM({
+	    0xa2, 0x00,       // LDX #$00
+	    0xe8,             // loop: INX
+	    0x86, 0x10,       // STX $10
+	    0xe0, 0x05,       // CPX #$05
+	    0xd0, 0xf9,       // BNE loop
+	    0x4c, 0x09, 0x80  // end: JMP end
+	});
+}
+
+}  // namespace
+
+/**
+ * Evaluates condition without CPU state
+ *
+ * @param source Condition
+ * @param addr Address
+ * @param val Value
+ * @return Result
+ */
+static std::int64_t evaluate(
+    const char *source, std::uint16_t addr, std::uint8_t val) {
+	return CExpression(source).evaluate(SBreakContext{nullptr, addr, val});
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_empty_condition) {
+	BOOST_CHECK(evaluate("", 0x0000, 0x00));
+	BOOST_CHECK(evaluate("  ", 0x0000, 0x00));
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_arithmetic) {
+	BOOST_CHECK_EQUAL(evaluate("1 + 2 - 4", 0, 0), -1);
+	BOOST_CHECK_EQUAL(evaluate("$f0 & 0x3c | 1", 0, 0), 0x31);
+	BOOST_CHECK_EQUAL(evaluate("-(2 - 5)", 0, 0), 3);
+	BOOST_CHECK_EQUAL(evaluate("value ^ $ff", 0, 0x0f), 0xf0);
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_logic) {
+	BOOST_CHECK(evaluate("value == 0x80 and addr >= $6000", 0x6000, 0x80));
+	BOOST_CHECK(!evaluate("value == 0x80 && addr < $6000", 0x6000, 0x80));
+	BOOST_CHECK(evaluate("VALUE != 1 || ADDR == 0", 0x1234, 0x01) == 0);
+	BOOST_CHECK(evaluate("!(value <= 3) or 0", 0, 4));
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_precedence) {
+	BOOST_CHECK_EQUAL(evaluate("2 | 1 ^ 3 & 5 + 1", 0, 0), 3);
+	BOOST_CHECK_EQUAL(evaluate("8 - 4 - 2", 0, 0), 2);
+	BOOST_CHECK(evaluate("value & 1 == 1", 0, 0x03));
+	BOOST_CHECK(!evaluate("value & 4 == 4", 0, 0x03));
+	BOOST_CHECK(evaluate("value | 1 == 3 && 1 || 0", 0, 0x02));
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_needs_debugger) {
+	BOOST_CHECK_THROW(evaluate("cycles > 0", 0, 0), std::invalid_argument);
+	BOOST_CHECK_THROW(evaluate("[$10] == 0", 0, 0), std::invalid_argument);
+	BOOST_CHECK_THROW(evaluate("a == 0", 0, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_bus) {
+	STestConfig config(makeStoreROM(), 0x8000);
+	CFrameFrontEnd frontEnd(1);
+	std::unique_ptr<CNES> nes(config.createInstance(&frontEnd));
+	frontEnd.setNES(nes.get());
+	CDebugger *debugger = nes->getDebugger();
+	std::vector<std::uint8_t> watched;
+	debugger->getWatchCPU()->setHandler(
+	    [&](EWatchType type, std::uint16_t addr, std::uint8_t val) {
+		    watched.push_back(val);
+	    });
+	debugger->getWatchCPU()->setWatch(WatchWrite, 0x0010, 0x0010);
+	std::vector<std::pair<std::size_t, std::uint8_t>> hits;
+	auto handler = [&](std::size_t id, std::uint16_t addr, std::uint8_t val) {
+		BOOST_CHECK_EQUAL(addr, 0x0010);
+		hits.emplace_back(id, val);
+	};
+	std::size_t value = debugger->getBreakpoints()->add(
+	    WatchWrite, 0x0010, 0x0010, "value == 3", handler);
+	std::size_t registers = debugger->getBreakpoints()->add(
+	    WatchWrite, 0x0000, 0x00ff, "x == 4 and cycles > 0", handler);
+	std::size_t removed = debugger->getBreakpoints()->add(
+	    WatchWrite, 0x0008, 0x0020, "", handler);
+	debugger->getBreakpoints()->add(
+	    WatchRead, 0x0010, 0x0010, "", handler);
+	debugger->getBreakpoints()->remove(removed);
+	BOOST_CHECK(debugger->getWatchCPU()->isWatched(WatchWrite, 0x0010));
+	nes->powerUp();
+	BOOST_CHECK(watched == std::vector<std::uint8_t>({1, 2, 3, 4, 5}));
+	BOOST_REQUIRE_EQUAL(hits.size(), 2);
+	BOOST_CHECK_EQUAL(hits[0].first, value);
+	BOOST_CHECK_EQUAL(hits[0].second, 3);
+	BOOST_CHECK_EQUAL(hits[1].first, registers);
+	BOOST_CHECK_EQUAL(hits[1].second, 4);
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_syntax_errors) {
+	BOOST_CHECK_THROW(CExpression("value =="), std::invalid_argument);
+	BOOST_CHECK_THROW(CExpression("(value"), std::invalid_argument);
+	BOOST_CHECK_THROW(CExpression("[addr"), std::invalid_argument);
+	BOOST_CHECK_THROW(CExpression("value 1"), std::invalid_argument);
+	BOOST_CHECK_THROW(CExpression("foo"), std::invalid_argument);
+	BOOST_CHECK_THROW(CExpression("$"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(breakpoint_limits) {
+	BOOST_CHECK_EQUAL(evaluate("9223372036854775807", 0, 0), INT64_MAX);
+	BOOST_CHECK_EQUAL(evaluate("$7fffffffffffffff", 0, 0), INT64_MAX);
+	BOOST_CHECK_THROW(
+	    CExpression("9223372036854775808"), std::invalid_argument);
+	BOOST_CHECK_THROW(CExpression("$10000000000000000"), std::invalid_argument);
+	// Arithmetic wraps around
+	BOOST_CHECK_EQUAL(evaluate("-9223372036854775807 - 1", 0, 0), INT64_MIN);
+	BOOST_CHECK_EQUAL(
+	    evaluate("-(-9223372036854775807 - 1)", 0, 0), INT64_MIN);
+	BOOST_CHECK_EQUAL(evaluate("9223372036854775807 + 1", 0, 0), INT64_MIN);
+	// Nesting is limited
+	std::string nested = std::string(63, '-').append("1");
+	BOOST_CHECK_EQUAL(evaluate(nested.c_str(), 0, 0), -1);
+	BOOST_CHECK_THROW(
+	    CExpression(std::string(64, '!').append("1")), std::invalid_argument);
+	BOOST_CHECK_THROW(CExpression(std::string(100000, '(').append("1")),
+	    std::invalid_argument);
+}
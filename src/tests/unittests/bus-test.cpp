@@ -0,0 +1,284 @@
+/**
+ * @file
+ * Bus unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <vpnes/core/bus.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/mappers/nametable.hpp>
+
+using namespace vpnes::core;  // NOLINT(build/namespaces)
+
+/**
+ * Device with switchable ROM window and RAM window
+ */
+struct CSwitchDevice : CDevice {
+	/**
+	 * Bus config
+	 */
+	struct BusConfig : BusConfigBase<CSwitchDevice> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::BankConfig<banks::ReadOnly<0x8000, 0x2000, 0x2000>,
+		    banks::ReadWrite<0xa000, 0x0400, 0x0400>>
+		    BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CSwitchDevice *device) {
+			BankConfig::mapIO(iterRead, iterWrite, iterMod, openBus, dummy,
+			    writeBuf, device->ROM, device->RAM);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			return addr >= 0x8000 && addr < 0xa400;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(
+		    std::uint16_t addr, const CSwitchDevice &device) {
+			return addr >= 0xa000;
+		}
+	};
+
+	/**
+	 * ROM
+	 */
+	std::uint8_t ROM[0x4000];
+	/**
+	 * RAM
+	 */
+	std::uint8_t RAM[0x0800];
+
+	/**
+	 * Fills ROM with page numbers
+	 */
+	CSwitchDevice() : ROM(), RAM() {
+		for (std::size_t i = 0; i < sizeof(ROM); i++) {
+			ROM[i] = static_cast<std::uint8_t>(i >> 8);
+		}
+	}
+};
+
+/**
+ * Device with nametable windows only
+ */
+struct CNameTableDevice : CDevice {
+	/**
+	 * Bus config
+	 */
+	struct BusConfig : BusConfigBase<CNameTableDevice> {
+		/**
+		 * Banks config
+		 */
+		typedef banks::NameTableConfig<> BankConfig;
+
+		/**
+		 * Maps IO
+		 *
+		 * @param iterRead Read iterator
+		 * @param iterWrite Write iterator
+		 * @param iterMod Mod iterator
+		 * @param openBus Open bus
+		 * @param dummy Dummy write
+		 * @param writeBuf Write bus
+		 * @param device Device
+		 */
+		static void mapIO(MemoryMap::iterator iterRead,
+		    MemoryMap::iterator iterWrite, MemoryMap::iterator iterMod,
+		    std::uint8_t *openBus, std::uint8_t *dummy, std::uint8_t *writeBuf,
+		    CNameTableDevice *device) {
+			device->NameTable.mapIO<BankConfig>(
+			    iterRead, iterWrite, iterMod, openBus, dummy, writeBuf);
+		}
+		/**
+		 * Checks if device is enabled
+		 *
+		 * @param addr Address
+		 * @return True if enabled
+		 */
+		static bool isDeviceEnabled(std::uint16_t addr) {
+			return addr >= 0x2000 && addr < 0x4000;
+		}
+		/**
+		 * Determines active bank
+		 *
+		 * @param addr Address
+		 * @param device Device
+		 * @return Active bank
+		 */
+		static std::size_t getBank(
+		    std::uint16_t addr, const CNameTableDevice &device) {
+			return CNameTable::getWindow(addr);
+		}
+	};
+
+	/**
+	 * Nametable
+	 */
+	CNameTable NameTable;
+
+	/**
+	 * Constructs the object
+	 *
+	 * @param mirroring Initial mirroring
+	 */
+	explicit CNameTableDevice(EMirroring mirroring) : NameTable(mirroring) {
+	}
+};
+
+/**
+ * Device recording register writes
+ */
+struct CRegisterDevice : CSwitchDevice {
+	/**
+	 * Written address-value pairs
+	 */
+	std::vector<std::pair<std::uint16_t, std::uint8_t>> Writes;
+
+	/**
+	 * Records a write
+	 *
+	 * @param val Value
+	 * @param addr Address
+	 */
+	void writeReg(std::uint8_t val, std::uint16_t addr) {
+		Writes.emplace_back(addr, val);
+	}
+};
+
+BOOST_AUTO_TEST_CASE(bus_switch_bank) {
+	CSwitchDevice device;
+	CBusConfig<CSwitchDevice::BusConfig> bus(0x40, &device);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x9f00), 0x1f);
+	bus.switchBank(&device, 0, device.ROM + 0x2000);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8000), 0x20);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x9f00), 0x3f);
+	bus.writeMemory(0x05, 0xa001);
+	bus.switchBank(&device, 1, device.RAM + 0x0400);
+	BOOST_CHECK_EQUAL(bus.readMemory(0xa001), 0x00);
+	bus.writeMemory(0x06, 0xa001);
+	BOOST_CHECK_EQUAL(device.RAM[0x0401], 0x06);
+	bus.switchBank(&device, 1, device.RAM);
+	BOOST_CHECK_EQUAL(bus.readMemory(0xa001), 0x05);
+}
+
+BOOST_AUTO_TEST_CASE(bus_switch_bank_patched) {
+	CSwitchDevice device;
+	CBusConfig<CSwitchDevice::BusConfig> bus(0x40, &device);
+	bus.addPatch(0x8001, 0x77);
+	bus.addPatch(0x8002, 0x88, 0x20);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8001), 0x77);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8002), 0x00);
+	bus.switchBank(&device, 0, device.ROM + 0x2000);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8000), 0x20);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8001), 0x77);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8002), 0x88);
+	bus.switchBank(&device, 0, device.ROM);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8002), 0x00);
+	BOOST_CHECK_EQUAL(device.ROM[0x0001], 0x00);
+}
+
+BOOST_AUTO_TEST_CASE(bus_switch_bank_invalid) {
+	CSwitchDevice device;
+	CBusConfig<CSwitchDevice::BusConfig> bus(0x40, &device);
+	bus.addPatch(0x8001, 0x77);
+	BOOST_CHECK_THROW(
+	    bus.switchBank(&device, 2, device.ROM), std::out_of_range);
+	// Mapping and patches are kept
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8100), 0x01);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8001), 0x77);
+	std::uint8_t *bufs[] = {device.ROM + 0x2000, device.RAM};
+	BOOST_CHECK_THROW(bus.switchBanks(&device, 1, bufs, 2), std::out_of_range);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x8001), 0x77);
+}
+
+BOOST_AUTO_TEST_CASE(bus_nametable_mirroring) {
+	CNameTableDevice device(MirroringHorizontal);
+	CBusConfig<CNameTableDevice::BusConfig> bus(0x40, &device);
+	bus.writeMemory(0x11, 0x2001);
+	bus.writeMemory(0x22, 0x2c01);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x2401), 0x11);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x2801), 0x22);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x3401), 0x11);
+	device.NameTable.setMirroring(MirroringVertical, &bus, &device, 0);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x2801), 0x11);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x2401), 0x22);
+	device.NameTable.setMirroring(MirroringSingleScreen2, &bus, &device, 0);
+	BOOST_CHECK_EQUAL(bus.readMemory(0x3801), 0x22);
+	CNameTableDevice fourScreens(MirroringFourScreens);
+	CBusConfig<CNameTableDevice::BusConfig> busFour(0x40, &fourScreens);
+	for (std::uint16_t addr = 0x2000; addr < 0x3000; addr += 0x0400) {
+		busFour.writeMemory(static_cast<std::uint8_t>(addr >> 8), addr);
+	}
+	BOOST_CHECK_EQUAL(busFour.readMemory(0x2800), 0x28);
+	BOOST_CHECK_EQUAL(busFour.readMemory(0x3c00), 0x2c);
+}
+
+BOOST_AUTO_TEST_CASE(bus_write_hook_range) {
+	CRegisterDevice device;
+	CBusConfig<CSwitchDevice::BusConfig> bus(0x40, &device);
+	bus.addWriteHook(0x9000, 0xffff, &device, &CRegisterDevice::writeReg);
+	bus.addWriteHook(0x8000, &device, &CRegisterDevice::writeReg);
+	bus.writeMemory(0x01, 0x8000);
+	bus.writeMemory(0x02, 0x8fff);
+	bus.writeMemory(0x03, 0x9000);
+	bus.writeMemory(0x04, 0xffff);
+	bus.writeMemory(0x05, 0x8000, true);
+	BOOST_REQUIRE_EQUAL(device.Writes.size(), 3);
+	BOOST_CHECK_EQUAL(device.Writes[0].first, 0x8000);
+	BOOST_CHECK_EQUAL(device.Writes[1].first, 0x9000);
+	BOOST_CHECK_EQUAL(device.Writes[2].first, 0xffff);
+	BOOST_CHECK_EQUAL(device.Writes[2].second, 0x04);
+}
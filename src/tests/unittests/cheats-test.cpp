@@ -0,0 +1,61 @@
+/**
+ * @file
+ * Cheat code unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include <vpnes/core/cheats.hpp>
+
+using vpnes::core::SCheatCode;
+using vpnes::core::decodeCheat;
+
+BOOST_AUTO_TEST_CASE(cheats_game_genie) {
+	SCheatCode cheat = decodeCheat("SXIOPO");
+	BOOST_CHECK_EQUAL(cheat.Address, 0x91d9);
+	BOOST_CHECK_EQUAL(cheat.Value, 0xad);
+	BOOST_CHECK_EQUAL(cheat.Compare, -1);
+	cheat = decodeCheat("yeuzugaa");
+	BOOST_CHECK_EQUAL(cheat.Address, 0xacb3);
+	BOOST_CHECK_EQUAL(cheat.Value, 0x07);
+	BOOST_CHECK_EQUAL(cheat.Compare, 0x00);
+}
+
+BOOST_AUTO_TEST_CASE(cheats_raw) {
+	SCheatCode cheat = decodeCheat("075a:09");
+	BOOST_CHECK_EQUAL(cheat.Address, 0x075a);
+	BOOST_CHECK_EQUAL(cheat.Value, 0x09);
+	BOOST_CHECK_EQUAL(cheat.Compare, -1);
+	cheat = decodeCheat("C000?A9:EA");
+	BOOST_CHECK_EQUAL(cheat.Address, 0xc000);
+	BOOST_CHECK_EQUAL(cheat.Value, 0xea);
+	BOOST_CHECK_EQUAL(cheat.Compare, 0xa9);
+}
+
+BOOST_AUTO_TEST_CASE(cheats_invalid) {
+	BOOST_CHECK_THROW(decodeCheat("SXIOPB"), std::invalid_argument);
+	BOOST_CHECK_THROW(decodeCheat("SXIOP"), std::invalid_argument);
+	BOOST_CHECK_THROW(decodeCheat("075G:09"), std::invalid_argument);
+}
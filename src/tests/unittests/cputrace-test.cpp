@@ -0,0 +1,174 @@
+/**
+ * @file
+ * Instruction trace unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/cputrace.hpp>
+#include <vpnes/core/debugger.hpp>
+#include <vpnes/core/nes.hpp>
+#include "../fixture.hpp"
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Trace file used by tests
+ */
+const char TraceFile[] = "cputrace-test.trc";
+
+/**
+ * Reads all records of trace file
+ *
+ * @return Records
+ */
+std::vector<SInstructionRecord> readTrace() {
+	std::ifstream input(TraceFile, std::ifstream::binary);
+	CInstructionTraceReader reader(input);
+	std::vector<SInstructionRecord> records;
+	SInstructionRecord record;
+	while (reader.read(&record)) {
+		records.push_back(record);
+	}
+	return records;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(cputrace_round_trip) {
+	// More records than fit a block, so blocks are handed over and the
+	// last one is flushed on close
+	const std::size_t count = CInstructionTrace::BlockRecords * 2 + 5;
+	{
+		CInstructionTrace trace(TraceFile);
+		for (std::size_t i = 0; i < count; i++) {
+			SInstructionRecord record{};
+			record.PC = static_cast<std::uint16_t>(0x8000 + i * 3);
+			record.Interrupt = i % 100 == 99;
+			if (!record.Interrupt) {
+				record.Bytes[0] = 0xad;
+				record.Bytes[1] = static_cast<std::uint8_t>(i);
+				record.Bytes[2] = static_cast<std::uint8_t>(i >> 8);
+			}
+			record.A = static_cast<std::uint8_t>(i);
+			record.X = static_cast<std::uint8_t>(i >> 1);
+			record.Y = static_cast<std::uint8_t>(i >> 2);
+			record.S = 0xfd;
+			record.P = 0x24;
+			record.Cycle = (UINT64_C(1) << 40) + i * 4;
+			trace.add(record);
+		}
+	}
+	std::vector<SInstructionRecord> records = readTrace();
+	std::remove(TraceFile);
+	BOOST_REQUIRE_EQUAL(records.size(), count);
+	for (std::size_t i = 0; i < count; i++) {
+		const SInstructionRecord &record = records[i];
+		BOOST_REQUIRE_EQUAL(
+		    record.PC, static_cast<std::uint16_t>(0x8000 + i * 3));
+		BOOST_REQUIRE_EQUAL(record.Interrupt, i % 100 == 99);
+		BOOST_REQUIRE_EQUAL(record.Bytes[0], record.Interrupt ? 0x00 : 0xad);
+		BOOST_REQUIRE_EQUAL(record.Bytes[1],
+		    record.Interrupt ? 0x00 : static_cast<std::uint8_t>(i));
+		BOOST_REQUIRE_EQUAL(record.A, static_cast<std::uint8_t>(i));
+		BOOST_REQUIRE_EQUAL(record.X, static_cast<std::uint8_t>(i >> 1));
+		BOOST_REQUIRE_EQUAL(record.Y, static_cast<std::uint8_t>(i >> 2));
+		BOOST_REQUIRE_EQUAL(record.S, 0xfd);
+		BOOST_REQUIRE_EQUAL(record.P, 0x24);
+		BOOST_REQUIRE_EQUAL(record.Cycle, (UINT64_C(1) << 40) + i * 4);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(cputrace_interrupts) {
+	std::vector<std::uint8_t> rom = makeProgramROM({
+	    0xa9, 0x00,        // LDA #$00
+	    0x8d, 0x17, 0x40,  // STA $4017
+	    0x58,              // CLI
+	    0x4c, 0x06, 0x80   // loop: JMP loop
+	});
+	rom[0x0100] = 0xad;  // irq: LDA $4015
+	rom[0x0101] = 0x15;
+	rom[0x0102] = 0x40;
+	rom[0x0103] = 0x40;  // RTI
+	rom[0x7ffe] = 0x00;  // IRQ vector
+	rom[0x7fff] = 0x81;
+	STestConfig config(std::move(rom), 0x8000);
+	CFrameFrontEnd frontEnd(2);
+	std::unique_ptr<CNES> nes(config.createInstance(&frontEnd));
+	frontEnd.setNES(nes.get());
+	nes->getDebugger()->startInstructionTrace(TraceFile);
+	nes->powerUp();
+	nes->getDebugger()->stopInstructionTrace();
+	std::vector<SInstructionRecord> records = readTrace();
+	BOOST_REQUIRE_GE(records.size(), 4);
+	BOOST_CHECK_EQUAL(records[0].PC, 0x8000);
+	BOOST_CHECK_EQUAL(records[0].Bytes[0], 0xa9);
+	// Frame IRQ is taken in the loop, handler runs next
+	std::size_t interrupts = 0;
+	for (std::size_t i = 1; i < records.size(); i++) {
+		BOOST_REQUIRE_GT(records[i].Cycle, records[i - 1].Cycle);
+		if (records[i].Interrupt) {
+			interrupts++;
+			BOOST_CHECK_EQUAL(records[i].PC, 0x8006);
+			BOOST_CHECK_EQUAL(records[i].Bytes[0], 0x00);
+			BOOST_REQUIRE_LT(i + 1, records.size());
+			BOOST_CHECK_EQUAL(records[i + 1].PC, 0x8100);
+			BOOST_CHECK_EQUAL(records[i + 1].Cycle, records[i].Cycle + 7);
+		}
+	}
+	BOOST_CHECK_GE(interrupts, 1);
+	// Decoded text shows the same records
+	std::ifstream input(TraceFile, std::ifstream::binary);
+	std::ostringstream text;
+	dumpInstructionTrace(input, text);
+	input.close();
+	std::remove(TraceFile);
+	std::istringstream lines(text.str());
+	std::string line;
+	std::size_t count = 0, decodedInterrupts = 0;
+	while (std::getline(lines, line)) {
+		if (count == 0) {
+			BOOST_CHECK_EQUAL(line.substr(0, 16), "8000  A9 00     ");
+		}
+		if (line.find("INTERRUPT") != std::string::npos) {
+			BOOST_CHECK_EQUAL(line.substr(0, 4), "8006");
+			decodedInterrupts++;
+		}
+		count++;
+	}
+	BOOST_CHECK_EQUAL(count, records.size());
+	BOOST_CHECK_EQUAL(decodedInterrupts, interrupts);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file
+ * Event device unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <vpnes/core/device.hpp>
+
+using vpnes::core::CEventDevice;
+using vpnes::core::ticks_t;
+
+namespace {
+
+/**
+ * Device recording fired events
+ */
+class CTestDevice : public CEventDevice {
+public:
+	/**
+	 * Test event
+	 */
+	typedef CLocalEvent<CTestDevice, CEventDevice> CTestEvent;
+	/**
+	 * Fired events in firing order
+	 */
+	std::vector<CEvent *> m_Fired;
+
+	/**
+	 * Event handler, fires event once
+	 *
+	 * @param event Event
+	 */
+	void handleEvent(CEvent *event) {
+		m_Fired.push_back(event);
+		event->setEnabled(false);
+	}
+	/**
+	 * Gets pending time
+	 *
+	 * @return Pending time
+	 */
+	ticks_t getPending() const {
+		return 0;
+	}
+
+protected:
+	/**
+	 * Simulation routine
+	 */
+	void execute() {
+	}
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(device_event_order) {
+	CTestDevice device;
+	CTestDevice::CTestEvent late(
+	    "late", 30, true, &device, &device, &CTestDevice::handleEvent);
+	CTestDevice::CTestEvent early(
+	    "early", 10, true, &device, &device, &CTestDevice::handleEvent);
+	CTestDevice::CTestEvent same(
+	    "same", 10, true, &device, &device, &CTestDevice::handleEvent);
+	device.registerDeviceEvent(&late);
+	device.registerDeviceEvent(&early);
+	device.registerDeviceEvent(&same);
+	// Both events at 10 fire in registration order, the later one waits
+	device.simulate(20);
+	BOOST_CHECK_EQUAL(device.getClock(), 20);
+	BOOST_REQUIRE_EQUAL(device.m_Fired.size(), 2);
+	BOOST_CHECK(device.m_Fired[0] == &early);
+	BOOST_CHECK(device.m_Fired[1] == &same);
+	device.simulate(40);
+	BOOST_CHECK_EQUAL(device.getClock(), 40);
+	BOOST_REQUIRE_EQUAL(device.m_Fired.size(), 3);
+	BOOST_CHECK(device.m_Fired[2] == &late);
+}
+
+BOOST_AUTO_TEST_CASE(device_event_tie) {
+	// Order of events sharing a time does not depend on their addresses
+	CTestDevice device;
+	CTestDevice::CTestEvent events[4] = {
+	    {"0", 10, true, &device, &device, &CTestDevice::handleEvent},
+	    {"1", 10, true, &device, &device, &CTestDevice::handleEvent},
+	    {"2", 10, true, &device, &device, &CTestDevice::handleEvent},
+	    {"3", 10, true, &device, &device, &CTestDevice::handleEvent}};
+	for (int i : {2, 0, 3, 1}) {
+		device.registerDeviceEvent(&events[i]);
+	}
+	device.simulate(20);
+	BOOST_REQUIRE_EQUAL(device.m_Fired.size(), 4);
+	BOOST_CHECK(device.m_Fired[0] == &events[2]);
+	BOOST_CHECK(device.m_Fired[1] == &events[0]);
+	BOOST_CHECK(device.m_Fired[2] == &events[3]);
+	BOOST_CHECK(device.m_Fired[3] == &events[1]);
+	// Rescheduled event keeps its place among events sharing a time
+	device.m_Fired.clear();
+	for (int i : {1, 0, 3, 2}) {
+		events[i].setFireTime(30);
+		events[i].setEnabled(true);
+	}
+	device.simulate(40);
+	BOOST_REQUIRE_EQUAL(device.m_Fired.size(), 4);
+	BOOST_CHECK(device.m_Fired[0] == &events[2]);
+	BOOST_CHECK(device.m_Fired[3] == &events[1]);
+}
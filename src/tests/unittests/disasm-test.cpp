@@ -0,0 +1,91 @@
+/**
+ * @file
+ * Disassembler unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <string>
+#include <vpnes/core/disasm.hpp>
+
+using vpnes::core::CDisassembler;
+using vpnes::core::getInstructionLength;
+
+/**
+ * Disassembles instruction without cache
+ *
+ * @param addr Address
+ * @param b0 Opcode
+ * @param b1 First operand byte
+ * @param b2 Second operand byte
+ * @return Instruction text
+ */
+static std::string format(std::uint16_t addr, std::uint8_t b0,
+    std::uint8_t b1 = 0, std::uint8_t b2 = 0) {
+	std::uint8_t bytes[3] = {b0, b1, b2};
+	char text[CDisassembler::MaxText];
+	CDisassembler::format(addr, bytes, text);
+	return text;
+}
+
+BOOST_AUTO_TEST_CASE(disasm_addressing_modes) {
+	BOOST_CHECK_EQUAL(format(0xc000, 0x4c, 0xf5, 0xc5), "JMP $C5F5");
+	BOOST_CHECK_EQUAL(format(0xc000, 0x6c, 0x00, 0x02), "JMP ($0200)");
+	BOOST_CHECK_EQUAL(format(0xc000, 0xa9, 0x10), "LDA #$10");
+	BOOST_CHECK_EQUAL(format(0xc000, 0xb6, 0x10), "LDX $10,Y");
+	BOOST_CHECK_EQUAL(format(0xc000, 0x9d, 0x00, 0x03), "STA $0300,X");
+	BOOST_CHECK_EQUAL(format(0xc000, 0xa1, 0x80), "LDA ($80,X)");
+	BOOST_CHECK_EQUAL(format(0xc000, 0x91, 0x80), "STA ($80),Y");
+	BOOST_CHECK_EQUAL(format(0xc000, 0x0a), "ASL A");
+	BOOST_CHECK_EQUAL(format(0xc000, 0x60), "RTS");
+	BOOST_CHECK_EQUAL(format(0xc000, 0xd0, 0xfe), "BNE $C000");
+	BOOST_CHECK_EQUAL(format(0xfff0, 0x10, 0x7f), "BPL $0071");
+	BOOST_CHECK_EQUAL(format(0xc000, 0xa7, 0x10), "LAX $10");
+	BOOST_CHECK_EQUAL(format(0xc000, 0x02), "JAM");
+}
+
+BOOST_AUTO_TEST_CASE(disasm_lengths) {
+	BOOST_CHECK_EQUAL(getInstructionLength(0x00), 1);
+	BOOST_CHECK_EQUAL(getInstructionLength(0x20), 3);
+	BOOST_CHECK_EQUAL(getInstructionLength(0x80), 2);
+	BOOST_CHECK_EQUAL(getInstructionLength(0xfc), 3);
+	BOOST_CHECK_EQUAL(getInstructionLength(0xea), 1);
+}
+
+BOOST_AUTO_TEST_CASE(disasm_cache) {
+	CDisassembler disassembler;
+	std::uint8_t bytes[3] = {0xad, 0x00, 0x20};
+	std::string text = disassembler.disassemble(0x8000, bytes);
+	BOOST_CHECK_EQUAL(text, "LDA $2000");
+	bytes[2] = 0x40;
+	BOOST_CHECK_EQUAL(disassembler.disassemble(0x8000, bytes), "LDA $4000");
+	disassembler.invalidate(0x0000, 0xffff);
+	std::uint8_t memory[3] = {0xe8, 0xff, 0xff};
+	BOOST_CHECK_EQUAL(disassembler.disassemble(0x8000,
+	                      [&](std::uint16_t addr) {
+		                      return memory[addr - 0x8000];
+	                      }),
+	    "INX");
+}
@@ -0,0 +1,151 @@
+/**
+ * @file
+ * Discrete logic mappers unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/mappers/discrete.hpp>
+#include "../fixture.hpp"
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Offset of PRG ROM byte conflicting with latch writes
+ */
+const std::uint16_t ConflictOffset = 0x0010;
+/**
+ * Value of conflicting PRG ROM byte
+ */
+const std::uint8_t ConflictValue = 0x05;
+
+/**
+ * Discrete mapper config with numbered banks
+ *
+ * ROM is filled with 0xff, so latch writes do not conflict. Banks are
+ * numbered by 16 KB PRG and 8 KB CHR. Every PRG ROM bank has ConflictValue
+ * at ConflictOffset.
+ */
+struct SDiscreteConfig : STestConfig {
+	/**
+	 * Constructs the object
+	 *
+	 * @param prgSize PRG ROM size
+	 * @param chrSize CHR ROM size (0 for 8 KB CHR RAM)
+	 */
+	SDiscreteConfig(std::size_t prgSize, std::size_t chrSize)
+	    : STestConfig(makeDiscreteROM(prgSize, chrSize), prgSize) {
+	}
+
+	/**
+	 * Makes image with numbered banks and conflicting bytes
+	 *
+	 * @param prgSize PRG ROM size
+	 * @param chrSize CHR ROM size
+	 * @return PRG ROM followed by CHR ROM
+	 */
+	static std::vector<std::uint8_t> makeDiscreteROM(
+	    std::size_t prgSize, std::size_t chrSize) {
+		std::vector<std::uint8_t> rom =
+		    makeNumberedROM(prgSize, chrSize, 0x2000, 0xff);
+		for (std::size_t bank = 0; bank < prgSize / 0x4000; bank++) {
+			rom[bank * 0x4000 + ConflictOffset] = ConflictValue;
+		}
+		return rom;
+	}
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(discrete_uxrom) {
+	SDiscreteConfig config(0x20000, 0);
+	CMapperBoard<CUxROM> board(config);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 7);
+	board.write(0xc020, 0x03);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 3);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 7);
+	// Banks beyond ROM size wrap around
+	board.write(0x8020, 0x0e);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 6);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 7);
+	// Latch is ANDed with ROM byte at the address
+	board.write(0xc000 + ConflictOffset, 0x06);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0x06 & ConflictValue);
+	board.write(0x8000 + ConflictOffset, 0x03);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0x03 & ConflictValue);
+	// CHR RAM
+	board.writePPU(0x1234, 0x5a);
+	BOOST_CHECK_EQUAL(board.readPPU(0x1234), 0x5a);
+	// Submapper 1 has no bus conflicts
+	CMapperBoard<CDiscrete<false, 0x4000, 0, false>> noConflicts(config);
+	noConflicts.write(0xc000 + ConflictOffset, 0x06);
+	BOOST_CHECK_EQUAL(noConflicts.readCPU(0x8000), 0x06);
+}
+
+BOOST_AUTO_TEST_CASE(discrete_cnrom) {
+	SDiscreteConfig config(0x8000, 0x8000);
+	CMapperBoard<CCNROM> board(config);
+	BOOST_CHECK_EQUAL(board.readPPU(0x0000), 0x80);
+	board.write(0x8020, 0x02);
+	BOOST_CHECK_EQUAL(board.readPPU(0x0000), 0x82);
+	// PRG ROM is fixed
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 1);
+	board.write(0xc000 + ConflictOffset, 0x03);
+	BOOST_CHECK_EQUAL(board.readPPU(0x0000), 0x80 | (0x03 & ConflictValue));
+	CMapperBoard<CDiscrete<false, 0, 0x2000, false>> noConflicts(config);
+	noConflicts.write(0xc000 + ConflictOffset, 0x03);
+	BOOST_CHECK_EQUAL(noConflicts.readPPU(0x0000), 0x83);
+}
+
+BOOST_AUTO_TEST_CASE(discrete_axrom) {
+	SDiscreteConfig config(0x40000, 0);
+	CMapperBoard<CAxROM> board(config);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 1);
+	// Bits 0-3 select 32 KB bank, bit 4 selects single screen
+	board.write(0x8000 + ConflictOffset, 0x03);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 6);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 7);
+	board.writePPU(0x2000, 0x11);
+	BOOST_CHECK_EQUAL(board.readPPU(0x2c00), 0x11);
+	board.write(0x8020, 0x17);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 14);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 15);
+	board.writePPU(0x2400, 0x22);
+	BOOST_CHECK_EQUAL(board.readPPU(0x2800), 0x22);
+	board.write(0x8020, 0x07);
+	BOOST_CHECK_EQUAL(board.readPPU(0x2800), 0x11);
+	// AMROM has bus conflicts
+	CMapperBoard<CDiscrete<true, 0x8000, 0, true>> conflicts(config);
+	conflicts.write(0x8000 + ConflictOffset, 0x03);
+	BOOST_CHECK_EQUAL(conflicts.readCPU(0x8000), 2);
+}
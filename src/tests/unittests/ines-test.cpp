@@ -0,0 +1,132 @@
+/**
+ * @file
+ * ROM header unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/crc32.hpp>
+#include <vpnes/core/factory.hpp>
+#include <vpnes/core/image.hpp>
+#include <vpnes/core/ines.hpp>
+#include <vpnes/core/romdb.hpp>
+
+using vpnes::core::CROMImage;
+using vpnes::core::ines::SNESData;
+
+/**
+ * Builds ROM image
+ *
+ * @param header Header bytes
+ * @param size Data size after header
+ * @return ROM image
+ */
+static std::shared_ptr<CROMImage> makeImage(
+    std::vector<std::uint8_t> header, std::size_t size) {
+	header.resize(16 + size, 0);
+	return std::make_shared<CROMImage>(std::move(header));
+}
+
+BOOST_AUTO_TEST_CASE(ines_v1) {
+	SNESData data(makeImage(
+	    {'N', 'E', 'S', 0x1a, 2, 1, 0x03, 0x00, 0, 0, 0, 0, 0, 0, 0, 0},
+	    0x8000 + 0x2000));
+	BOOST_CHECK_EQUAL(data.PRGSize, 0x8000);
+	BOOST_CHECK_EQUAL(data.CHRSize, 0x2000);
+	BOOST_CHECK_EQUAL(data.RAMSize, 0);
+	BOOST_CHECK_EQUAL(data.BatterySize, 0x2000);
+	BOOST_CHECK_EQUAL(data.CHRRAMSize, 0);
+	BOOST_CHECK_EQUAL(data.Mapper, 0);
+	BOOST_CHECK(data.Mirroring == vpnes::core::MirroringVertical);
+	BOOST_CHECK_EQUAL(data.PRG.data(), data.Image->data() + 16);
+}
+
+BOOST_AUTO_TEST_CASE(ines_nes20) {
+	SNESData data(makeImage({'N', 'E', 'S', 0x1a, 1, 0, 0x00, 0x08, 0x00,
+	                            0x00, 0x05, 0x07, 0x03, 0, 0, 0},
+	    0x4000));
+	BOOST_CHECK_EQUAL(data.PRGSize, 0x4000);
+	BOOST_CHECK_EQUAL(data.CHRSize, 0);
+	BOOST_CHECK_EQUAL(data.RAMSize, 0x0800);
+	BOOST_CHECK_EQUAL(data.BatterySize, 0);
+	BOOST_CHECK_EQUAL(data.CHRRAMSize, 0x2000);
+	BOOST_CHECK_EQUAL(data.Submapper, 0);
+	BOOST_CHECK(data.NESType == vpnes::core::NESTypeDendy);
+	BOOST_CHECK_EQUAL(data.Mapper, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ines_nes20_exponent) {
+	// 2^14 * 1 bytes of PRG in exponent-multiplier notation
+	SNESData data(makeImage({'N', 'E', 'S', 0x1a, 14 << 2, 1, 0x00, 0x08,
+	                            0x00, 0x0f, 0x00, 0x00, 0x00, 0, 0, 0},
+	    0x4000 + 0x2000));
+	BOOST_CHECK_EQUAL(data.PRGSize, 0x4000);
+	BOOST_CHECK_EQUAL(data.CHRSize, 0x2000);
+	BOOST_CHECK_EQUAL(data.RAMSize, 0);
+	BOOST_CHECK_THROW(SNESData(makeImage({'N', 'E', 'S', 0x1a, 2, 1, 0x00,
+	                                         0x08, 0, 0, 0, 0, 0, 0, 0, 0},
+	                      0x4000)),
+	    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(ines_crc32) {
+	const std::uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	BOOST_CHECK_EQUAL(vpnes::core::updateCRC32(0, check, 9), 0xcbf43926);
+	BOOST_CHECK_EQUAL(vpnes::core::updateCRC32(
+	                      vpnes::core::updateCRC32(0, check, 4), check + 4, 5),
+	    0xcbf43926);
+}
+
+BOOST_AUTO_TEST_CASE(ines_database) {
+	const vpnes::core::romdb::SROMInfo *info =
+	    vpnes::core::romdb::findROM(0x3337ec46);
+	BOOST_REQUIRE(info != nullptr);
+	BOOST_CHECK_EQUAL(info->Mapper, 0);
+	BOOST_CHECK(vpnes::core::romdb::findROM(0x00000001) == nullptr);
+	BOOST_CHECK(vpnes::core::romdb::findROM(0xffffffff) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ines_mapper_registry) {
+	using vpnes::core::CMapperRegistry;
+	BOOST_CHECK(CMapperRegistry::find(0, 0) != nullptr);
+	BOOST_CHECK(CMapperRegistry::find(0, 5) == CMapperRegistry::find(0, 0));
+	BOOST_CHECK(CMapperRegistry::find(2, 1) != nullptr);
+	BOOST_CHECK(CMapperRegistry::find(2, 1) != CMapperRegistry::find(2, 0));
+	BOOST_CHECK(CMapperRegistry::find(0x0fff, 0) == nullptr);
+	CMapperRegistry::SEntry entry{CMapperRegistry::AnySubmapper, nullptr};
+	BOOST_CHECK_THROW(
+	    CMapperRegistry::add(CMapperRegistry::MapperCount, &entry),
+	    std::invalid_argument);
+	BOOST_CHECK_THROW(SNESData(makeImage({'N', 'E', 'S', 0x1a, 1, 1, 0xf0,
+	                                         0xf8, 0x0f, 0, 0, 0, 0, 0, 0, 0},
+	                      0x4000 + 0x2000)),
+	    std::invalid_argument);
+}
@@ -0,0 +1,326 @@
+/**
+ * @file
+ * Motherboard unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/debugger.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/mboard.hpp>
+#include <vpnes/core/nes.hpp>
+#include <vpnes/core/profiler.hpp>
+#include <vpnes/core/watch.hpp>
+#include "../fixture.hpp"
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Makes NROM config running a PPU register loop
+ *
+ * @return Config
+ */
+STestConfig makeLoopConfig() {
+	std::vector<std::uint8_t> rom = makeProgramROM({
+	    0xad, 0x02, 0x20,  // loop: LDA $2002
+	    0x8d, 0x07, 0x20,  // STA $2007
+	    0x4c, 0x00, 0x80   // JMP loop
+	});
+	return STestConfig(std::move(rom), 0x8000);
+}
+
+/**
+ * Device running in fixed steps, polling IRQ line after each one
+ */
+class CStepDevice : public CClockedDevice {
+private:
+	/**
+	 * Motherboard
+	 */
+	CMotherBoard *m_MotherBoard;
+	/**
+	 * Step length
+	 */
+	ticks_t m_Step;
+
+protected:
+	/**
+	 * Simulation routine
+	 */
+	void execute() {
+		while (m_Time < m_Clock) {
+			m_Time += m_Step;
+			if (m_Time == m_ScheduleTime) {
+				m_Event->setFireTime(m_EventTime);
+				m_Event->setEnabled(true);
+			}
+			if (m_IRQTime < 0 && m_MotherBoard->isIRQ()) {
+				m_IRQTime = m_Time;
+			}
+		}
+	}
+	/**
+	 * Synchronizes the clock
+	 *
+	 * @param ticks New clock value
+	 */
+	void sync(ticks_t ticks) {
+		m_Clock = ticks;
+	}
+
+public:
+	/**
+	 * Internal time
+	 */
+	ticks_t m_Time;
+	/**
+	 * Internal time when the event is scheduled
+	 */
+	ticks_t m_ScheduleTime;
+	/**
+	 * Scheduled event
+	 */
+	CMotherBoard::CEvent *m_Event;
+	/**
+	 * Time of scheduled event
+	 */
+	ticks_t m_EventTime;
+	/**
+	 * Internal time when IRQ is seen (-1 if not yet)
+	 */
+	ticks_t m_IRQTime;
+
+	/**
+	 * Constructs the object
+	 *
+	 * @param motherBoard Motherboard
+	 * @param step Step length
+	 */
+	CStepDevice(CMotherBoard *motherBoard, ticks_t step)
+	    : m_MotherBoard(motherBoard)
+	    , m_Step(step)
+	    , m_Time()
+	    , m_ScheduleTime(-1)
+	    , m_Event()
+	    , m_EventTime()
+	    , m_IRQTime(-1) {
+	}
+	/**
+	 * Gets pending time
+	 *
+	 * @return Pending time
+	 */
+	ticks_t getPending() const {
+		return m_Time;
+	}
+};
+
+/**
+ * Motherboard running two step devices
+ */
+class CStepBoard {
+private:
+	/**
+	 * Front-end
+	 */
+	CFrameFrontEnd m_FrontEnd;
+
+public:
+	/**
+	 * Motherboard
+	 */
+	CMotherBoard m_MotherBoard;
+	/**
+	 * Device scheduling the event
+	 */
+	CStepDevice m_First;
+	/**
+	 * Device running after the first one
+	 */
+	CStepDevice m_Second;
+	/**
+	 * Scheduled event
+	 */
+	CMotherBoard::CEvent *m_Event;
+	/**
+	 * Times of first device, second device and motherboard at the event
+	 */
+	std::vector<ticks_t> m_EventClocks;
+
+	/**
+	 * Constructs the object
+	 *
+	 * @param firstStep Step of the first device
+	 * @param secondStep Step of the second device
+	 * @param endTime Time when motherboard stops
+	 */
+	CStepBoard(ticks_t firstStep, ticks_t secondStep, ticks_t endTime)
+	    : m_FrontEnd()
+	    , m_MotherBoard(&m_FrontEnd)
+	    , m_First(&m_MotherBoard, firstStep)
+	    , m_Second(&m_MotherBoard, secondStep)
+	    , m_Event()
+	    , m_EventClocks() {
+		m_MotherBoard.registerSimDevices(&m_First, &m_Second);
+		m_Event = m_MotherBoard.registerEvent(
+		    this, &m_MotherBoard, "EVENT", 0, false, &CStepBoard::handleEvent);
+		m_MotherBoard.registerEvent(
+		    this, &m_MotherBoard, "END", endTime, true, &CStepBoard::handleEnd);
+		m_First.m_Event = m_Event;
+	}
+
+	/**
+	 * Records clocks and asserts IRQ
+	 *
+	 * @param event Event
+	 */
+	void handleEvent(CMotherBoard::CEvent *event) {
+		m_EventClocks = {m_First.m_Time, m_Second.m_Time,
+		    m_MotherBoard.getClock()};
+		m_MotherBoard.setIRQ(CMotherBoard::IRQMMC, true);
+		event->setEnabled(false);
+	}
+	/**
+	 * Stops the motherboard
+	 *
+	 * @param event Event
+	 */
+	void handleEnd(CMotherBoard::CEvent *event) {
+		m_MotherBoard.setEnabled(false);
+		event->setEnabled(false);
+	}
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(mboard_device_ticks) {
+	STestConfig config = makeLoopConfig();
+	CFrameFrontEnd frontEnd(9);
+	std::unique_ptr<CNES> nes(config.createInstance(&frontEnd));
+	frontEnd.setNES(nes.get());
+	nes->powerUp();
+	BOOST_CHECK_GT(nes->getDebugger()->getElapsedTicks(), 8 * 4 * 341 * 262);
+	// Devices advance by the same ticks across frame ends (profile builds)
+	ProfileData profile = nes->getDebugger()->getDeviceProfile();
+	for (const SProfileRecord &record : profile) {
+		BOOST_CHECK_EQUAL(record.Ticks, profile.front().Ticks);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(mboard_timings) {
+	STestConfig config = makeLoopConfig();
+	CFrameFrontEnd frontEnd(1);
+	config.NESType = NESTypeMultiRegion;
+	BOOST_CHECK(std::unique_ptr<CNES>(config.createInstance(&frontEnd)));
+	config.NESType = NESTypePAL;
+	BOOST_CHECK_THROW(config.createInstance(&frontEnd), std::invalid_argument);
+	config.NESType = NESTypeDendy;
+	BOOST_CHECK_THROW(config.createInstance(&frontEnd), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(mboard_event_preemption) {
+	CStepBoard board(10, 5, 100);
+	// Event at 35 is scheduled by the first device at 30
+	board.m_First.m_ScheduleTime = 30;
+	board.m_First.m_EventTime = 35;
+	board.m_MotherBoard.simulate();
+	// Devices stop at the event instead of the end point
+	BOOST_REQUIRE_EQUAL(board.m_EventClocks.size(), 3);
+	BOOST_CHECK_EQUAL(board.m_EventClocks[0], 40);
+	BOOST_CHECK_EQUAL(board.m_EventClocks[1], 35);
+	BOOST_CHECK_EQUAL(board.m_EventClocks[2], 35);
+	BOOST_CHECK_EQUAL(board.m_First.m_Time, 100);
+	BOOST_CHECK_EQUAL(board.m_Second.m_Time, 100);
+}
+
+BOOST_AUTO_TEST_CASE(mboard_irq_latency) {
+	CStepBoard board(3, 3, 300);
+	board.m_First.m_ScheduleTime = 30;
+	board.m_First.m_EventTime = 100;
+	board.m_MotherBoard.simulate();
+	// IRQ raised at 100 is seen on the next step, not at the end point
+	BOOST_CHECK_EQUAL(board.m_First.m_IRQTime, 105);
+	BOOST_CHECK_EQUAL(board.m_Second.m_IRQTime, 105);
+}
+
+BOOST_AUTO_TEST_CASE(mboard_irq_sources) {
+	CFrameFrontEnd frontEnd;
+	CMotherBoard motherBoard(&frontEnd);
+	BOOST_CHECK(!motherBoard.isIRQ());
+	motherBoard.setIRQ(CMotherBoard::IRQMMC, true);
+	motherBoard.setIRQ(CMotherBoard::IRQFrame, true);
+	// Releasing one source keeps the line asserted by the other
+	motherBoard.setIRQ(CMotherBoard::IRQMMC, false);
+	BOOST_CHECK(motherBoard.isIRQ());
+	motherBoard.setIRQ(CMotherBoard::IRQDMC, false);
+	BOOST_CHECK(motherBoard.isIRQ());
+	motherBoard.setIRQ(CMotherBoard::IRQFrame, false);
+	BOOST_CHECK(!motherBoard.isIRQ());
+}
+
+BOOST_AUTO_TEST_CASE(mboard_frame_irq) {
+	std::vector<std::uint8_t> rom = makeProgramROM({
+	    0xa9, 0x00,        // LDA #$00
+	    0x8d, 0x17, 0x40,  // STA $4017
+	    0x58,              // CLI
+	    0x4c, 0x06, 0x80   // loop: JMP loop
+	});
+	rom[0x0100] = 0x4c;  // irq: JMP irq
+	rom[0x0101] = 0x00;
+	rom[0x0102] = 0x81;
+	rom[0x7ffe] = 0x00;  // IRQ vector
+	rom[0x7fff] = 0x81;
+	STestConfig config(std::move(rom), 0x8000);
+	CFrameFrontEnd frontEnd(2);
+	std::unique_ptr<CNES> nes(config.createInstance(&frontEnd));
+	frontEnd.setNES(nes.get());
+	CDebugger *debugger = nes->getDebugger();
+	ticks_t writeTime = -1, irqTime = -1;
+	debugger->getWatchCPU()->setHandler(
+	    [&](EWatchType type, std::uint16_t addr, std::uint8_t val) {
+		    if (type == WatchWrite) {
+			    writeTime = debugger->getElapsedTicks();
+		    } else if (irqTime < 0) {
+			    irqTime = debugger->getElapsedTicks();
+		    }
+	    });
+	debugger->getWatchCPU()->setWatch(WatchWrite, 0x4017, 0x4017);
+	debugger->getWatchCPU()->setWatch(WatchExec, 0x8100, 0x8100);
+	nes->powerUp();
+	BOOST_REQUIRE_GE(writeTime, 0);
+	BOOST_REQUIRE_GE(irqTime, 0);
+	// Frame IRQ comes 29829 cycles after the delayed reset, the handler
+	// starts after the polled instruction and the interrupt sequence
+	ticks_t cycles = (irqTime - writeTime) / debugger->getCPUDivider();
+	BOOST_CHECK_GE(cycles, 29829 + 3 + 7);
+	BOOST_CHECK_LE(cycles, 29829 + 4 + 4 + 7);
+}
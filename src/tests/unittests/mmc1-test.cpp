@@ -0,0 +1,245 @@
+/**
+ * @file
+ * MMC1 mapper unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/mappers/mmc1.hpp>
+#include "../fixture.hpp"
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * MMC1 config with numbered 16 KB PRG and 4 KB CHR banks
+ */
+struct SMMC1Config : STestConfig {
+	/**
+	 * Constructs the object
+	 *
+	 * @param prgSize PRG ROM size
+	 * @param chrSize CHR ROM size (0 for 8 KB CHR RAM)
+	 * @param ramSize PRG RAM size
+	 */
+	SMMC1Config(std::size_t prgSize, std::size_t chrSize, std::size_t ramSize)
+	    : STestConfig(makeNumberedROM(prgSize, chrSize, 0x1000), prgSize, 1) {
+		RAMSize = ramSize;
+	}
+};
+
+/**
+ * MMC1 on its own buses with CPU cycle timed writes
+ */
+class CMMC1Board : public CMapperBoard<CMMC1> {
+private:
+	/**
+	 * Master clock ticks in CPU cycle
+	 */
+	enum { CPUCycle = 12 };
+
+public:
+	/**
+	 * Constructs the object
+	 *
+	 * @param config NES config
+	 */
+	explicit CMMC1Board(const SNESConfig &config)
+	    : CMapperBoard<CMMC1>(config) {
+	}
+
+	/**
+	 * Writes CPU bus after some CPU cycles
+	 *
+	 * @param addr Address
+	 * @param val Value
+	 * @param cycles CPU cycles since previous write
+	 */
+	void write(std::uint16_t addr, std::uint8_t val, int cycles = 2) {
+		setClock(getClock() + cycles * CPUCycle);
+		CMapperBoard<CMMC1>::write(addr, val);
+	}
+	/**
+	 * Loads MMC1 register through the shift register
+	 *
+	 * @param addr Register address
+	 * @param val Value
+	 */
+	void load(std::uint16_t addr, std::uint8_t val) {
+		for (int bit = 0; bit < 5; bit++) {
+			write(addr, (val >> bit) & 0x01);
+		}
+	}
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(mmc1_shift_register) {
+	SMMC1Config config(0x40000, 0x20000, 0);
+	CMMC1Board board(config);
+	// Power-up fixes the last bank at 0xc000
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 15);
+	// Bits are shifted in LSB first, the fifth write selects the register
+	board.write(0xe000, 0x00);
+	board.write(0xe000, 0x00);
+	board.write(0xe000, 0x01);
+	board.write(0xe000, 0x01);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 15);
+	board.write(0x8000, 0x00);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 15);
+	board.load(0xe000, 0x05);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 5);
+	// Reset drops partial value and restores PRG mode 3
+	board.load(0x8000, 0x00);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 4);
+	board.write(0xe000, 0x01);
+	board.write(0xe000, 0x01);
+	board.write(0xe000, 0x80);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 5);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 15);
+	board.load(0xe000, 0x02);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 2);
+}
+
+BOOST_AUTO_TEST_CASE(mmc1_prg_modes) {
+	SMMC1Config config(0x40000, 0x20000, 0);
+	CMMC1Board board(config);
+	board.load(0xe000, 0x05);
+	// Mode 3: switchable 0x8000, fixed last bank
+	board.load(0x8000, 0x0c);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 5);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 15);
+	// Mode 2: fixed first bank, switchable 0xc000
+	board.load(0x8000, 0x08);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 5);
+	// Modes 0 and 1: 32 KB, low bit ignored
+	board.load(0x8000, 0x00);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 4);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 5);
+	board.load(0x8000, 0x04);
+	board.load(0xe000, 0x0a);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 10);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 11);
+}
+
+BOOST_AUTO_TEST_CASE(mmc1_chr_modes) {
+	SMMC1Config config(0x40000, 0x20000, 0);
+	CMMC1Board board(config);
+	board.load(0xa000, 0x03);
+	board.load(0xc000, 0x07);
+	// 8 KB mode ignores CHR bank 1 and low bit of CHR bank 0
+	board.load(0x8000, 0x0e);
+	BOOST_CHECK_EQUAL(board.readPPU(0x0000), 0x82);
+	BOOST_CHECK_EQUAL(board.readPPU(0x1000), 0x83);
+	// 4 KB mode
+	board.load(0x8000, 0x1e);
+	BOOST_CHECK_EQUAL(board.readPPU(0x0000), 0x83);
+	BOOST_CHECK_EQUAL(board.readPPU(0x1000), 0x87);
+	board.load(0xc000, 0x1f);
+	BOOST_CHECK_EQUAL(board.readPPU(0x1000), 0x9f);
+	// Mirroring
+	board.writePPU(0x2000, 0x11);
+	board.writePPU(0x2400, 0x22);
+	BOOST_CHECK_EQUAL(board.readPPU(0x2800), 0x11);
+	board.load(0x8000, 0x1f);
+	BOOST_CHECK_EQUAL(board.readPPU(0x2400), board.readPPU(0x2000));
+	BOOST_CHECK_NE(board.readPPU(0x2800), board.readPPU(0x2000));
+	board.load(0x8000, 0x1c);
+	board.writePPU(0x2000, 0x33);
+	BOOST_CHECK_EQUAL(board.readPPU(0x2c00), 0x33);
+	board.load(0x8000, 0x1d);
+	board.writePPU(0x2000, 0x44);
+	BOOST_CHECK_EQUAL(board.readPPU(0x2c00), 0x44);
+	board.load(0x8000, 0x1c);
+	BOOST_CHECK_EQUAL(board.readPPU(0x2c00), 0x33);
+}
+
+BOOST_AUTO_TEST_CASE(mmc1_surom) {
+	SMMC1Config config(0x80000, 0, 0x2000);
+	CMMC1Board board(config);
+	// CHR bank 0 bit 4 selects 256 KB half for both windows
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 15);
+	board.load(0xe000, 0x02);
+	board.load(0xa000, 0x10);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 18);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 31);
+	board.load(0x8000, 0x08);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 16);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 18);
+	board.load(0xa000, 0x00);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 0);
+	BOOST_CHECK_EQUAL(board.readCPU(0xc000), 2);
+	// CHR RAM is writable
+	board.writePPU(0x1234, 0x5a);
+	BOOST_CHECK_EQUAL(board.readPPU(0x1234), 0x5a);
+}
+
+BOOST_AUTO_TEST_CASE(mmc1_sorom) {
+	SMMC1Config config(0x40000, 0, 0x4000);
+	CMMC1Board board(config);
+	// CHR bank 0 bit 3 selects 8 KB PRG RAM bank
+	board.write(0x6000, 0x11);
+	board.load(0xa000, 0x08);
+	BOOST_CHECK_EQUAL(board.readCPU(0x6000), 0x00);
+	board.write(0x6000, 0x22);
+	board.load(0xa000, 0x00);
+	BOOST_CHECK_EQUAL(board.readCPU(0x6000), 0x11);
+	board.load(0xa000, 0x08);
+	BOOST_CHECK_EQUAL(board.readCPU(0x6000), 0x22);
+	// PRG bank bit 4 disables PRG RAM
+	board.load(0xe000, 0x10);
+	board.write(0x6000, 0x33);
+	board.load(0xe000, 0x00);
+	BOOST_CHECK_EQUAL(board.readCPU(0x6000), 0x22);
+}
+
+BOOST_AUTO_TEST_CASE(mmc1_consecutive_write) {
+	SMMC1Config config(0x40000, 0x20000, 0);
+	CMMC1Board board(config);
+	// Second write of read-modify-write comes on the next cycle and is lost
+	for (int bit = 0; bit < 5; bit++) {
+		board.write(0xe000, (0x03 >> bit) & 0x01);
+		board.write(0xe000, 0x01, 1);
+	}
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 3);
+	// Reset on the next cycle after a write is lost too
+	board.write(0xe000, 0x01);
+	board.write(0xe000, 0x80, 1);
+	board.write(0xe000, 0x00);
+	board.write(0xe000, 0x00);
+	board.write(0xe000, 0x00);
+	board.write(0xe000, 0x00);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 1);
+	// Two cycles apart both count
+	board.write(0xe000, 0x80);
+	board.load(0xe000, 0x06);
+	BOOST_CHECK_EQUAL(board.readCPU(0x8000), 6);
+}
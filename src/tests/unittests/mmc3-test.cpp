@@ -0,0 +1,177 @@
+/**
+ * @file
+ * MMC3 mapper unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/device.hpp>
+#include <vpnes/core/mappers/helper.hpp>
+#include <vpnes/core/mappers/mmc3.hpp>
+#include "../fixture.hpp"
+
+using namespace vpnes::core;
+using vpnes::core::factory::SConfigNTSC;
+
+namespace {
+
+/**
+ * Ticks in scanline
+ */
+const ticks_t ScanlineTime = SConfigNTSC::ScanlineTime;
+/**
+ * A12 rise on sprite fetches (sprites at 0x1000)
+ */
+const ticks_t ObjectRise = 260 * SConfigNTSC::DotTime;
+/**
+ * A12 rise on background fetches (background at 0x1000)
+ */
+const ticks_t BackgroundRise = 324 * SConfigNTSC::DotTime;
+
+/**
+ * MMC3 on its own buses with timed writes
+ */
+class CMMC3Board : public CMapperBoard<CMMC3<SConfigNTSC>> {
+public:
+	/**
+	 * Constructs the object
+	 *
+	 * @param config NES config
+	 */
+	explicit CMMC3Board(const SNESConfig &config)
+	    : CMapperBoard<CMMC3<SConfigNTSC>>(config) {
+	}
+
+	/**
+	 * Writes CPU bus at the time
+	 *
+	 * @param time Elapsed ticks
+	 * @param addr Address
+	 * @param val Value
+	 */
+	void write(ticks_t time, std::uint16_t addr, std::uint8_t val) {
+		setClock(time);
+		CMapperBoard<CMMC3<SConfigNTSC>>::write(addr, val);
+	}
+	/**
+	 * Checks if IRQ event is scheduled
+	 *
+	 * @return True if scheduled
+	 */
+	bool isScheduled() {
+		return getMotherBoard()->getEvent("MMC3_IRQ").isEnabled();
+	}
+	/**
+	 * Gets scheduled IRQ time
+	 *
+	 * @return Elapsed ticks
+	 */
+	ticks_t getIRQTime() {
+		return getMotherBoard()->getEvent("MMC3_IRQ").getFireTime();
+	}
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(mmc3_irq_reload) {
+	STestConfig config(makeNumberedROM(0x8000, 0x2000, 0x0400), 0x8000, 4);
+	CMMC3Board board(config);
+	board.write(0, 0x2000, 0x08);
+	board.write(0, 0x2001, 0x18);
+	board.write(0, 0xc000, 3);
+	board.write(0, 0xc001, 0);
+	BOOST_CHECK(!board.isScheduled());
+	board.write(0, 0xe001, 0);
+	// Reload takes a clock, then 3 clocks down to zero
+	ticks_t time = 3 * ScanlineTime + ObjectRise;
+	BOOST_REQUIRE(board.isScheduled());
+	BOOST_CHECK_EQUAL(board.getIRQTime(), time);
+	board.write(time - 1, 0x2001, 0x18);
+	BOOST_CHECK(!board.isIRQ());
+	board.write(time, 0x2001, 0x18);
+	BOOST_CHECK(board.isIRQ());
+	// Acknowledge keeps counting, next period is latch + 1
+	board.write(time, 0xe000, 0);
+	BOOST_CHECK(!board.isIRQ());
+	BOOST_CHECK(!board.isScheduled());
+	board.write(time, 0xe001, 0);
+	BOOST_CHECK_EQUAL(board.getIRQTime(), 7 * ScanlineTime + ObjectRise);
+	// Last rise of the frame is on pre-render line
+	board.write(time, 0xc000, 236);
+	board.write(time, 0xc001, 0);
+	BOOST_CHECK_EQUAL(board.getIRQTime(), 261 * ScanlineTime + ObjectRise);
+	board.write(261 * ScanlineTime + ObjectRise, 0x2001, 0x18);
+	BOOST_CHECK(board.isIRQ());
+}
+
+BOOST_AUTO_TEST_CASE(mmc3_irq_latch_zero) {
+	STestConfig config(makeNumberedROM(0x8000, 0x2000, 0x0400), 0x8000, 4);
+	CMMC3Board board(config);
+	board.write(0, 0x2000, 0x10);
+	board.write(0, 0x2001, 0x08);
+	board.write(0, 0xc000, 0);
+	board.write(0, 0xc001, 0);
+	board.write(0, 0xe001, 0);
+	// Zero latch asserts IRQ on every rise
+	BOOST_CHECK_EQUAL(board.getIRQTime(), BackgroundRise);
+	board.write(BackgroundRise, 0x2001, 0x08);
+	BOOST_CHECK(board.isIRQ());
+	board.write(BackgroundRise + 1, 0xe000, 0);
+	board.write(BackgroundRise + 1, 0xe001, 0);
+	BOOST_CHECK(!board.isIRQ());
+	BOOST_CHECK_EQUAL(board.getIRQTime(), ScanlineTime + BackgroundRise);
+	board.write(ScanlineTime + BackgroundRise, 0x2001, 0x08);
+	BOOST_CHECK(board.isIRQ());
+}
+
+BOOST_AUTO_TEST_CASE(mmc3_irq_ppu_changes) {
+	STestConfig config(makeNumberedROM(0x8000, 0x2000, 0x0400), 0x8000, 4);
+	CMMC3Board board(config);
+	board.write(0, 0x2000, 0x08);
+	board.write(0, 0x2001, 0x18);
+	board.write(0, 0xc000, 10);
+	board.write(0, 0xc001, 0);
+	board.write(0, 0xe001, 0);
+	BOOST_CHECK_EQUAL(board.getIRQTime(), 10 * ScanlineTime + ObjectRise);
+	// Rises of lines 0-5 are counted with old settings, counter is 5
+	ticks_t time = 5 * ScanlineTime + ObjectRise + 1;
+	board.write(time, 0x2000, 0x10);
+	BOOST_CHECK_EQUAL(board.getIRQTime(), 9 * ScanlineTime + BackgroundRise);
+	// Same pattern table for background and sprites stops the counter
+	board.write(time, 0x2000, 0x18);
+	BOOST_CHECK(!board.isScheduled());
+	board.write(8 * ScanlineTime, 0x2000, 0x10);
+	BOOST_CHECK_EQUAL(board.getIRQTime(), 12 * ScanlineTime + BackgroundRise);
+	// So does disabled rendering
+	board.write(9 * ScanlineTime, 0x2001, 0x00);
+	BOOST_CHECK(!board.isScheduled());
+	board.write(20 * ScanlineTime, 0x2001, 0x18);
+	BOOST_CHECK_EQUAL(board.getIRQTime(), 23 * ScanlineTime + BackgroundRise);
+	board.write(23 * ScanlineTime + BackgroundRise - 1, 0x2001, 0x18);
+	BOOST_CHECK(!board.isIRQ());
+	board.write(23 * ScanlineTime + BackgroundRise, 0x2001, 0x18);
+	BOOST_CHECK(board.isIRQ());
+}
@@ -0,0 +1,138 @@
+/**
+ * @file
+ * Code profiler unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/debugger.hpp>
+#include <vpnes/core/nes.hpp>
+#include <vpnes/core/profiler.hpp>
+#include "../fixture.hpp"
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Loop program placed at $8000
+ */
+const std::vector<std::uint8_t> LoopProgram = {
+    0xa2, 0x03,       // LDX #$03
+    0xca,             // loop: DEX
+    0xd0, 0xfd,       // BNE loop
+    0x4c, 0x05, 0x80  // end: JMP end
+};
+
+/**
+ * Reads loop program
+ *
+ * @param addr Address
+ * @return Value
+ */
+std::uint8_t readLoop(std::uint16_t addr) {
+	std::size_t offset = addr - 0x8000;
+	return offset < LoopProgram.size() ? LoopProgram[offset] : 0;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(profiler_code_loop) {
+	// Instruction stream of the loop program at 12 ticks per cycle
+	static const std::pair<std::uint16_t, int> stream[] = {{0x8000, 0},
+	    {0x8002, 2}, {0x8003, 4}, {0x8002, 7}, {0x8003, 9}, {0x8002, 12},
+	    {0x8003, 14}, {0x8005, 16}, {0x8005, 19}, {0x0000, 22},
+	    {0x8005, 29}, {0x8005, 32}};
+	CCodeProfile profile;
+	for (const auto &instruction : stream) {
+		if (instruction.first == 0) {
+			profile.enterInterrupt(instruction.second * 12);
+		} else {
+			profile.enter(instruction.first, instruction.second * 12);
+		}
+	}
+	BOOST_CHECK_EQUAL(profile.getTicks(0x8000), 2 * 12);
+	BOOST_CHECK_EQUAL(profile.getTicks(0x8002), 6 * 12);
+	BOOST_CHECK_EQUAL(profile.getTicks(0x8003), 8 * 12);
+	BOOST_CHECK_EQUAL(profile.getTicks(0x8005), 9 * 12);
+	BOOST_CHECK_EQUAL(profile.getInterrupts(), 1);
+	BOOST_CHECK_EQUAL(profile.getInterruptTicks(), 7 * 12);
+	// Taken branches and jumps to self are backward transfers, a return
+	// from interrupt is not
+	BOOST_CHECK_EQUAL(profile.getJumps(0x8003), 2);
+	BOOST_CHECK_EQUAL(profile.getJumpTarget(0x8003), 0x8002);
+	BOOST_CHECK_EQUAL(profile.getJumps(0x8005), 2);
+	BOOST_CHECK_EQUAL(profile.getJumps(0x8002), 0);
+	std::ostringstream report;
+	profile.dump(report, 2, 12, readLoop);
+	BOOST_CHECK_EQUAL(report.str(),
+	    "Hot addresses:\n"
+	    "  addr   bytes     instruction               cycles        %\n"
+	    "  $8005  4c 05 80  JMP $8005                      9    28.12\n"
+	    "  $8003  d0 fd     BNE $8002                      8    25.00\n"
+	    "Hot loops:\n"
+	    "  range         branch   instruction         iterations"
+	    "        cycles        %\n"
+	    "  $8002-$8003  d0 fd     BNE $8002                    2"
+	    "            14    43.75\n"
+	    "  $8005-$8005  4c 05 80  JMP $8005                    2"
+	    "             9    28.12\n"
+	    "Interrupts: 1 taken, 7 cycles, 21.88%\n");
+}
+
+#if defined(VPNES_PROFILE)
+BOOST_AUTO_TEST_CASE(profiler_code_nes) {
+	std::vector<std::uint8_t> rom = makeProgramROM({});
+	std::copy(LoopProgram.begin(), LoopProgram.end(), rom.begin());
+	STestConfig config(std::move(rom), 0x8000);
+	CFrameFrontEnd frontEnd(1);
+	std::unique_ptr<CNES> nes(config.createInstance(&frontEnd));
+	frontEnd.setNES(nes.get());
+	nes->powerUp();
+	std::ostringstream report;
+	nes->getDebugger()->dumpCodeProfile(report, 2);
+	std::string text = report.str();
+	// The jump to self takes most of the frame, the countdown loop is second
+	std::size_t hot = text.find("Hot addresses:\n");
+	BOOST_REQUIRE(hot != std::string::npos);
+	hot = text.find('\n', text.find('\n', hot) + 1) + 1;
+	BOOST_CHECK_EQUAL(text.substr(hot, 9), "  $8005  ");
+	std::size_t loops = text.find("Hot loops:\n");
+	BOOST_REQUIRE(loops != std::string::npos);
+	loops = text.find('\n', text.find('\n', loops) + 1) + 1;
+	BOOST_CHECK_EQUAL(text.substr(loops, 15), "  $8005-$8005  ");
+	BOOST_CHECK(
+	    text.find("  $8002-$8003  d0 fd     BNE $8002                    2") !=
+	    std::string::npos);
+	BOOST_CHECK(text.find("Interrupts: 0 taken") != std::string::npos);
+}
+#endif
@@ -0,0 +1,149 @@
+/**
+ * @file
+ * Battery backed RAM unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/saveram.hpp>
+
+using vpnes::core::CSaveRAM;
+using vpnes::core::SNESConfig;
+
+/**
+ * Save file used by tests
+ */
+static const char saveFile[] = "saveram-test.sav";
+
+/**
+ * Reads save file
+ *
+ * @return Save file contents
+ */
+static std::vector<std::uint8_t> readSave() {
+	std::ifstream input(saveFile, std::ifstream::binary);
+	return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(input),
+	    std::istreambuf_iterator<char>());
+}
+
+BOOST_AUTO_TEST_CASE(saveram_persist) {
+	std::remove(saveFile);
+	SNESConfig config;
+	config.RAMSize = 0;
+	config.BatterySize = 0x1000;
+	config.SaveFile = saveFile;
+	config.SaveInterval = 0;
+	{
+		CSaveRAM ram(config, 0x2000);
+		BOOST_REQUIRE_EQUAL(ram.size(), 0x2000);
+		BOOST_CHECK(ram.isSaved());
+		ram.data()[0x0000] = 0x12;
+		ram.data()[0x1fff] = 0x34;
+	}
+	std::vector<std::uint8_t> save = readSave();
+	BOOST_REQUIRE_EQUAL(save.size(), 0x2000);
+	BOOST_CHECK_EQUAL(save[0x0000], 0x12);
+	BOOST_CHECK_EQUAL(save[0x1fff], 0x34);
+	{
+		CSaveRAM ram(config, 0x2000);
+		BOOST_CHECK_EQUAL(ram.data()[0x0000], 0x12);
+		BOOST_CHECK_EQUAL(ram.data()[0x1fff], 0x34);
+	}
+	config.BatterySize = 0;
+	config.RAMSize = 0x2000;
+	{
+		CSaveRAM ram(config, 0x2000);
+		BOOST_CHECK(!ram.isSaved());
+		BOOST_CHECK_EQUAL(ram.data()[0x0000], 0x00);
+		ram.data()[0x0000] = 0x56;
+	}
+	BOOST_CHECK_EQUAL(readSave()[0x0000], 0x12);
+	std::remove(saveFile);
+}
+
+BOOST_AUTO_TEST_CASE(saveram_flush_thread) {
+	std::remove(saveFile);
+	SNESConfig config;
+	// Battery backed part is not page aligned, so it is written back
+	config.RAMSize = 0x0800;
+	config.BatterySize = 0x1800;
+	config.SaveFile = saveFile;
+	config.SaveInterval = 1;
+	{
+		CSaveRAM ram(config, 0x2000);
+		BOOST_CHECK(!ram.isMapped());
+		ram.data()[0x0900] = 0x78;
+		// Flush thread does not read RAM without frame end
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		BOOST_CHECK(readSave().empty());
+		std::vector<std::uint8_t> save;
+		for (int i = 0; i < 1000; i++) {
+			ram.handleFrameEnd();
+			save = readSave();
+			if (save.size() == 0x1800 && save[0x0100] == 0x78) {
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		BOOST_REQUIRE_EQUAL(save.size(), 0x1800);
+		BOOST_CHECK_EQUAL(save[0x0100], 0x78);
+	}
+	std::remove(saveFile);
+}
+
+BOOST_AUTO_TEST_CASE(saveram_battery_part) {
+	std::remove(saveFile);
+	SNESConfig config;
+	config.RAMSize = 0x2000;
+	config.BatterySize = 0x2000;
+	config.SaveFile = saveFile;
+	config.SaveInterval = 0;
+	{
+		CSaveRAM ram(config, 0x2000);
+		BOOST_REQUIRE_EQUAL(ram.size(), 0x4000);
+		ram.data()[0x0000] = 0x11;
+		ram.data()[0x2000] = 0x22;
+		ram.data()[0x3fff] = 0x33;
+	}
+	// Work RAM is not saved
+	std::vector<std::uint8_t> save = readSave();
+	BOOST_REQUIRE_EQUAL(save.size(), 0x2000);
+	BOOST_CHECK_EQUAL(save[0x0000], 0x22);
+	BOOST_CHECK_EQUAL(save[0x1fff], 0x33);
+	{
+		CSaveRAM ram(config, 0x2000);
+		BOOST_CHECK_EQUAL(ram.data()[0x0000], 0x00);
+		BOOST_CHECK_EQUAL(ram.data()[0x2000], 0x22);
+		BOOST_CHECK_EQUAL(ram.data()[0x3fff], 0x33);
+	}
+	std::remove(saveFile);
+}
@@ -0,0 +1,199 @@
+/**
+ * @file
+ * Memory search unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <vpnes/core/config.hpp>
+#include <vpnes/core/debugger.hpp>
+#include <vpnes/core/nes.hpp>
+#include <vpnes/core/search.hpp>
+#include "../fixture.hpp"
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Comparisons with operands they use
+ */
+const std::pair<ESearchCompare, std::uint8_t> Comparisons[] = {
+    {SearchEqual, 0x05}, {SearchChanged, 0}, {SearchUnchanged, 0},
+    {SearchIncreased, 0}, {SearchDecreased, 0}, {SearchDelta, 0x02},
+    {SearchDelta, 0xfe}};
+
+/**
+ * Reference comparison
+ *
+ * @param compare Comparison
+ * @param operand Operand
+ * @param cur Current value
+ * @param prev Previous value
+ * @return True if value matches
+ */
+bool matches(ESearchCompare compare, std::uint8_t operand, std::uint8_t cur,
+    std::uint8_t prev) {
+	switch (compare) {
+	case SearchEqual:
+		return cur == operand;
+	case SearchChanged:
+		return cur != prev;
+	case SearchUnchanged:
+		return cur == prev;
+	case SearchIncreased:
+		return cur > prev;
+	case SearchDecreased:
+		return cur < prev;
+	default:
+		return static_cast<std::uint8_t>(cur - prev) == operand;
+	}
+}
+
+/**
+ * Searches for changes of $10-$14 from 5, 5, 5, 5, $ff to 5, 7, 3, 6, 1
+ *
+ * @param debugger Debugger
+ * @param compare Comparison
+ * @param operand Operand
+ * @return Candidates in $10-$14
+ */
+std::vector<std::uint16_t> searchChanges(
+    CDebugger *debugger, ESearchCompare compare, std::uint8_t operand) {
+	static const std::uint8_t before[] = {0x05, 0x05, 0x05, 0x05, 0xff};
+	static const std::uint8_t after[] = {0x05, 0x07, 0x03, 0x06, 0x01};
+	for (std::uint16_t i = 0; i < 5; i++) {
+		debugger->directCPUWrite(0x10 + i, before[i]);
+	}
+	debugger->getMemorySearch()->start();
+	for (std::uint16_t i = 0; i < 5; i++) {
+		debugger->directCPUWrite(0x10 + i, after[i]);
+	}
+	debugger->getMemorySearch()->refine(compare, operand);
+	std::vector<std::uint16_t> candidates =
+	    debugger->getMemorySearch()->getCandidates();
+	candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+	                     [](std::uint16_t addr) {
+		                     return addr < 0x10 || addr > 0x14;
+	                     }),
+	    candidates.end());
+	return candidates;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(search_refine_block) {
+	std::mt19937 random(1);
+	std::vector<std::uint8_t> previous(0x1000), current(0x1000);
+	for (std::size_t i = 0; i < previous.size(); i++) {
+		previous[i] = static_cast<std::uint8_t>(random());
+		// Keep plenty of equal, close and wrapping values
+		current[i] = static_cast<std::uint8_t>(
+		    previous[i] + static_cast<int>(random() % 5) - 2);
+	}
+	for (const auto &comparison : Comparisons) {
+		std::vector<std::uint8_t> initial(previous.size());
+		for (std::uint8_t &candidate : initial) {
+			candidate = (random() & 3) != 0 ? 0xff : 0x00;
+		}
+		std::vector<std::uint8_t> scalar(initial);
+		refineScalar(scalar.data(), current.data(), previous.data(),
+		    scalar.size(), comparison.first, comparison.second);
+		for (std::size_t i = 0; i < scalar.size(); i++) {
+			bool expected = initial[i] != 0 &&
+			                matches(comparison.first, comparison.second,
+			                    current[i], previous[i]);
+			BOOST_REQUIRE_EQUAL(scalar[i], expected ? 0xff : 0x00);
+		}
+#if defined(VPNES_SEARCH_SSE2)
+		std::vector<std::uint8_t> vector(initial);
+		refineSSE2(vector.data(), current.data(), previous.data(),
+		    vector.size(), comparison.first, comparison.second);
+		BOOST_CHECK(vector == scalar);
+#endif
+	}
+}
+
+BOOST_AUTO_TEST_CASE(search_refine) {
+	STestConfig config(std::vector<std::uint8_t>(0x8000 + 0x2000, 0), 0x8000);
+	config.RAMSize = 0x2000;
+	CFrameFrontEnd frontEnd;
+	std::unique_ptr<CNES> nes(config.createInstance(&frontEnd));
+	CDebugger *debugger = nes->getDebugger();
+	typedef std::vector<std::uint16_t> addresses_t;
+	BOOST_CHECK(searchChanges(debugger, SearchEqual, 0x05) ==
+	            addresses_t({0x10}));
+	BOOST_CHECK(searchChanges(debugger, SearchChanged, 0) ==
+	            addresses_t({0x11, 0x12, 0x13, 0x14}));
+	BOOST_CHECK(searchChanges(debugger, SearchUnchanged, 0) ==
+	            addresses_t({0x10}));
+	BOOST_CHECK(searchChanges(debugger, SearchIncreased, 0) ==
+	            addresses_t({0x11, 0x13}));
+	BOOST_CHECK(searchChanges(debugger, SearchDecreased, 0) ==
+	            addresses_t({0x12, 0x14}));
+	BOOST_CHECK(searchChanges(debugger, SearchDelta, 0x02) ==
+	            addresses_t({0x11, 0x14}));
+	BOOST_CHECK(searchChanges(debugger, SearchDelta, 0xfe) ==
+	            addresses_t({0x12}));
+	CMemorySearch *search = debugger->getMemorySearch();
+	BOOST_CHECK_EQUAL(search->getValue(0x0011), 0x07);
+	BOOST_CHECK_THROW(search->getValue(0x2000), std::invalid_argument);
+	// Refines narrow previous candidates
+	searchChanges(debugger, SearchChanged, 0);
+	debugger->directCPUWrite(0x11, 0x08);
+	debugger->directCPUWrite(0x13, 0x05);
+	BOOST_CHECK_EQUAL(search->refine(SearchIncreased), 1);
+	BOOST_CHECK(search->getCandidates() == addresses_t({0x11}));
+}
+
+BOOST_AUTO_TEST_CASE(search_freeze) {
+	STestConfig config(std::vector<std::uint8_t>(0x8000 + 0x2000, 0), 0x8000);
+	config.RAMSize = 0x2000;
+	CFrameFrontEnd frontEnd;
+	std::unique_ptr<CNES> nes(config.createInstance(&frontEnd));
+	CDebugger *debugger = nes->getDebugger();
+	CMemorySearch *search = debugger->getMemorySearch();
+	search->freeze(0x0020, 0x42);
+	search->freeze(0x6000, 0x17);
+	search->freeze(0x0020, 0x43);
+	BOOST_CHECK_EQUAL(search->getFreezes().size(), 2);
+	search->applyFreezes();
+	BOOST_CHECK_EQUAL(debugger->directCPURead(0x0020), 0x43);
+	BOOST_CHECK_EQUAL(debugger->directCPURead(0x6000), 0x17);
+	debugger->directCPUWrite(0x0020, 0x00);
+	debugger->directCPUWrite(0x6000, 0x00);
+	search->unfreeze(0x6000);
+	search->applyFreezes();
+	BOOST_CHECK_EQUAL(debugger->directCPURead(0x0020), 0x43);
+	BOOST_CHECK_EQUAL(debugger->directCPURead(0x6000), 0x00);
+	BOOST_CHECK_EQUAL(search->getFreezes().size(), 1);
+}
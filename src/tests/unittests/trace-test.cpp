@@ -0,0 +1,152 @@
+/**
+ * @file
+ * Timeline trace unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <vpnes/core/trace.hpp>
+
+#if defined(VPNES_TRACE)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Trace file used by tests
+ */
+const char TraceFile[] = "trace-test.json";
+
+/**
+ * Makes a record
+ *
+ * @param ticks Clock ticks
+ * @return Slice record for even ticks, instant for odd ones
+ */
+STraceRecord makeRecord(std::intmax_t ticks) {
+	return {"a\"b", "test", 1234, 5, ticks, ticks % 2 ? 'i' : 'X'};
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(trace_buffer_overflow) {
+	CTraceBuffer buffer(1);
+	const std::size_t extra = 10;
+	for (std::size_t i = 0; i < CTraceBuffer::Capacity + extra; i++) {
+		buffer.push(makeRecord(i));
+	}
+	BOOST_CHECK_EQUAL(buffer.getDropped(), extra);
+	// Records past capacity are dropped, the rest are kept in order
+	std::vector<std::intmax_t> ticks;
+	buffer.drain([&](const STraceRecord &record) {
+		ticks.push_back(record.Ticks);
+	});
+	BOOST_REQUIRE_EQUAL(ticks.size(), CTraceBuffer::Capacity);
+	BOOST_CHECK_EQUAL(ticks.front(), 0);
+	BOOST_CHECK_EQUAL(ticks.back(), CTraceBuffer::Capacity - 1);
+	// Drained space is reused across the ring end
+	ticks.clear();
+	buffer.push(makeRecord(-1));
+	buffer.push(makeRecord(-2));
+	buffer.drain([&](const STraceRecord &record) {
+		ticks.push_back(record.Ticks);
+	});
+	BOOST_REQUIRE_EQUAL(ticks.size(), 2);
+	BOOST_CHECK_EQUAL(ticks[1], -2);
+	BOOST_CHECK_EQUAL(buffer.getDropped(), extra);
+}
+
+BOOST_AUTO_TEST_CASE(trace_buffer_threads) {
+	CTraceBuffer buffer(1);
+	const std::size_t count = CTraceBuffer::Capacity * 4;
+	std::thread producer([&]() {
+		for (std::size_t i = 0; i < count; i++) {
+			buffer.push(makeRecord(i));
+		}
+	});
+	std::vector<std::intmax_t> ticks;
+	auto consume = [&](const STraceRecord &record) {
+		ticks.push_back(record.Ticks);
+	};
+	for (int i = 0; i < 1000; i++) {
+		buffer.drain(consume);
+		std::this_thread::yield();
+	}
+	producer.join();
+	buffer.drain(consume);
+	// Every record is either consumed in order or counted as dropped
+	BOOST_CHECK_EQUAL(ticks.size() + buffer.getDropped(), count);
+	for (std::size_t i = 1; i < ticks.size(); i++) {
+		BOOST_REQUIRE_LT(ticks[i - 1], ticks[i]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(trace_writer_json) {
+	const std::size_t count = CTraceBuffer::Capacity + 3;
+	std::uint64_t dropped;
+	{
+		CTraceWriter writer(TraceFile);
+		CTraceBuffer *buffer = writer.addBuffer();
+		for (std::size_t i = 0; i < count; i++) {
+			buffer->push(makeRecord(i));
+		}
+		dropped = buffer->getDropped();
+	}
+	std::ifstream input(TraceFile);
+	std::string text((std::istreambuf_iterator<char>(input)),
+	    std::istreambuf_iterator<char>());
+	input.close();
+	std::remove(TraceFile);
+	std::string header = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	std::string footer =
+	    "\n],\"otherData\":{\"dropped\":" + std::to_string(dropped) + "}}\n";
+	BOOST_REQUIRE_GT(text.size(), header.size() + footer.size());
+	BOOST_CHECK_EQUAL(text.substr(0, header.size()), header);
+	BOOST_CHECK_EQUAL(text.substr(text.size() - footer.size()), footer);
+	// Writer drains while records are pushed, so some may be dropped
+	std::size_t events = 0, pos = 0;
+	while ((pos = text.find("{\"name\":", pos)) != std::string::npos) {
+		events++;
+		pos++;
+	}
+	BOOST_CHECK_EQUAL(events + dropped, count);
+	BOOST_CHECK(text.find("{\"name\":\"a\\\"b\",\"cat\":\"test\",\"ph\":\"X\","
+	                      "\"ts\":1.234,\"dur\":0.005,\"pid\":1,\"tid\":1,"
+	                      "\"args\":{\"ticks\":0}}") != std::string::npos);
+	BOOST_CHECK(text.find("{\"name\":\"a\\\"b\",\"cat\":\"test\",\"ph\":\"i\","
+	                      "\"ts\":1.234,\"s\":\"g\",\"pid\":1,\"tid\":1,"
+	                      "\"args\":{\"ticks\":1}}") != std::string::npos);
+}
+
+#endif  // defined(VPNES_TRACE)
@@ -0,0 +1,160 @@
+/**
+ * @file
+ * Bus watch unit tests
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <vpnes/core/watch.hpp>
+
+using namespace vpnes::core;
+
+namespace {
+
+/**
+ * Watchpoint hit
+ */
+struct SHit {
+	/**
+	 * Access type
+	 */
+	EWatchType Type;
+	/**
+	 * Address
+	 */
+	std::uint16_t Addr;
+	/**
+	 * Value
+	 */
+	std::uint8_t Val;
+};
+
+/**
+ * Sets handler recording hits of a layer
+ *
+ * @param watch Bus watch
+ * @param layer Layer
+ * @param hits Recorded hits
+ */
+void recordHits(CBusWatch *watch, EWatchLayer layer, std::vector<SHit> *hits) {
+	watch->setHandler(
+	    [hits](EWatchType type, std::uint16_t addr, std::uint8_t val) {
+		    hits->push_back({type, addr, val});
+	    },
+	    layer);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(watch_layers) {
+	CBusWatch watch;
+	std::vector<SHit> user, breakpoints;
+	recordHits(&watch, WatchLayerUser, &user);
+	recordHits(&watch, WatchLayerBreakpoints, &breakpoints);
+	BOOST_CHECK(!watch.isActive());
+	watch.setWatch(WatchWrite, 0x0010, 0x001f);
+	watch.setWatch(WatchWrite, 0x0018, 0x0027, true, WatchLayerBreakpoints);
+	watch.setWatch(WatchExec, 0x8000, 0x8000, true, WatchLayerBreakpoints);
+	BOOST_CHECK(watch.isActive());
+	BOOST_CHECK(watch.isWatched(WatchWrite, 0x0018));
+	BOOST_CHECK(!watch.isWatched(WatchWrite, 0x0020));
+	BOOST_CHECK(watch.isWatched(WatchWrite, 0x0020, WatchLayerBreakpoints));
+	watch.access(WatchWrite, 0x0010, 1);
+	watch.access(WatchWrite, 0x0018, 2);
+	watch.access(WatchWrite, 0x0020, 3);
+	watch.access(WatchRead, 0x0018, 4);
+	watch.access(WatchExec, 0x8000, 5);
+	BOOST_REQUIRE_EQUAL(user.size(), 2);
+	BOOST_CHECK_EQUAL(user[0].Addr, 0x0010);
+	BOOST_CHECK_EQUAL(user[1].Addr, 0x0018);
+	BOOST_CHECK_EQUAL(user[1].Val, 2);
+	BOOST_REQUIRE_EQUAL(breakpoints.size(), 3);
+	BOOST_CHECK_EQUAL(breakpoints[0].Addr, 0x0018);
+	BOOST_CHECK_EQUAL(breakpoints[1].Addr, 0x0020);
+	BOOST_CHECK_EQUAL(breakpoints[2].Type, WatchExec);
+	// Clearing a layer keeps watchpoints of the other one
+	watch.clearWatches(WatchLayerBreakpoints);
+	BOOST_CHECK(watch.isActive());
+	user.clear();
+	breakpoints.clear();
+	watch.access(WatchWrite, 0x0018, 6);
+	watch.access(WatchWrite, 0x0020, 7);
+	watch.access(WatchExec, 0x8000, 8);
+	BOOST_CHECK_EQUAL(user.size(), 1);
+	BOOST_CHECK(breakpoints.empty());
+	// Clearing a range keeps the rest of it
+	watch.setWatch(WatchWrite, 0x0010, 0x0017, false);
+	watch.access(WatchWrite, 0x0010, 9);
+	watch.access(WatchWrite, 0x001f, 10);
+	BOOST_REQUIRE_EQUAL(user.size(), 2);
+	BOOST_CHECK_EQUAL(user[1].Addr, 0x001f);
+	watch.clearWatches();
+	BOOST_CHECK(!watch.isActive());
+}
+
+BOOST_AUTO_TEST_CASE(watch_counters) {
+	CBusWatch watch;
+	watch.access(WatchRead, 0x0100, 0);
+	BOOST_CHECK_EQUAL(watch.getCount(WatchRead, 0x0100), 0);
+	watch.setCounters(true);
+	BOOST_CHECK(watch.isActive());
+	for (int i = 0; i < 3; i++) {
+		watch.access(WatchRead, 0x0100, 0);
+	}
+	watch.access(WatchWrite, 0x0100, 0);
+	watch.access(WatchExec, 0xc000, 0);
+	BOOST_CHECK_EQUAL(watch.getCount(WatchRead, 0x0100), 3);
+	BOOST_CHECK_EQUAL(watch.getCount(WatchWrite, 0x0100), 1);
+	BOOST_CHECK_EQUAL(watch.getCount(WatchExec, 0x0100), 0);
+	BOOST_CHECK_EQUAL(watch.getCount(WatchExec, 0xc000), 1);
+	std::ostringstream csv;
+	csv << std::hex;
+	watch.writeCSV(csv);
+	BOOST_CHECK_EQUAL(csv.str(),
+	    "address,reads,writes,executes\n"
+	    "0100,3,1,0\n"
+	    "c000,0,0,1\n");
+	// Stream format is restored
+	csv.str("");
+	csv << 10;
+	BOOST_CHECK_EQUAL(csv.str(), "a");
+	std::ostringstream pgm;
+	watch.writePGM(pgm, WatchRead);
+	std::string image = pgm.str();
+	std::string header = "P5\n256 256\n255\n";
+	BOOST_REQUIRE_EQUAL(image.size(), header.size() + 0x10000);
+	BOOST_CHECK_EQUAL(image.substr(0, header.size()), header);
+	BOOST_CHECK_EQUAL(
+	    static_cast<std::uint8_t>(image[header.size() + 0x0100]), 255);
+	BOOST_CHECK_EQUAL(image[header.size() + 0x0101], 0);
+	// Re-enabling resets counters, disabling deactivates the watch
+	watch.setCounters(true);
+	BOOST_CHECK_EQUAL(watch.getCount(WatchRead, 0x0100), 0);
+	watch.setCounters(false);
+	BOOST_CHECK(!watch.isActive());
+}
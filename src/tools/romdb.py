@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+#
+# NES Emulator
+# Copyright (C) 2012-2018  Ivanov Viktor
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+"""Generates ROM database from NesCartDB XML export.
+
+Usage: romdb.py nescarts.xml [src/core/romdb.cpp]
+
+Reads every cartridge of the export and prints ROMDatabase entries sorted
+by CRC32. If romdb.cpp is given, its ROMDatabase initializer is replaced in
+place instead.
+
+Cartridge CRC32 in NesCartDB covers PRG and CHR ROM without header, as
+expected by romdb::findROM. Mirroring comes from solder pads (H pad means
+vertical mirroring); boards without pads control mirroring themselves. WRAM
+with battery counts as battery-backed PRG RAM, VRAM as CHR RAM.
+"""
+
+import re
+import sys
+import xml.etree.ElementTree as ElementTree
+
+MIRRORING_MAPPER = 'MirroringHorizontal'
+
+
+def parse_size(size):
+    """Converts NesCartDB size ("8k", "512") to bytes."""
+    if not size:
+        return 0
+    size = size.strip().lower()
+    if size.endswith('k'):
+        return int(size[:-1]) * 1024
+    return int(size)
+
+
+def get_mirroring(board):
+    """Gets mirroring of the board."""
+    pad = board.find('pad')
+    if pad is None:
+        return MIRRORING_MAPPER
+    if pad.get('h') == '1':
+        return 'MirroringVertical'
+    if pad.get('v') == '1':
+        return 'MirroringHorizontal'
+    return MIRRORING_MAPPER
+
+
+def read_database(path):
+    """Reads cartridges from NesCartDB XML export."""
+    entries = {}
+    for game in ElementTree.parse(path).getroot().iter('game'):
+        name = game.get('name', '')
+        for cartridge in game.iter('cartridge'):
+            board = cartridge.find('board')
+            if board is None or not cartridge.get('crc'):
+                continue
+            ram_size = 0
+            battery_size = 0
+            for wram in board.iter('wram'):
+                if wram.get('battery') == '1':
+                    battery_size += parse_size(wram.get('size'))
+                else:
+                    ram_size += parse_size(wram.get('size'))
+            chr_ram_size = sum(
+                parse_size(vram.get('size')) for vram in board.iter('vram'))
+            entry = (int(board.get('mapper', '0')), 0, get_mirroring(board),
+                     ram_size, battery_size, chr_ram_size)
+            crc = int(cartridge.get('crc'), 16)
+            if crc in entries and entries[crc][0] != entry:
+                sys.stderr.write('Conflicting entries for %08x: %s, %s\n' %
+                                 (crc, entries[crc][1], name))
+                continue
+            entries.setdefault(crc, (entry, name))
+    return entries
+
+
+def format_size(size):
+    """Formats size in bytes."""
+    return '0x%x' % size if size else '0'
+
+
+def format_database(entries):
+    """Formats ROMDatabase initializer lines."""
+    lines = []
+    for crc in sorted(entries):
+        (mapper, submapper, mirroring, ram_size, battery_size,
+         chr_ram_size), name = entries[crc]
+        lines.append('    // %s\n' % name.replace('\n', ' '))
+        lines.append('    {0x%08x, %d, %d, %s, %s, %s, %s},\n' %
+                     (crc, mapper, submapper, mirroring,
+                      format_size(ram_size), format_size(battery_size),
+                      format_size(chr_ram_size)))
+    return ''.join(lines)
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 1
+    table = format_database(read_database(argv[1]))
+    if len(argv) == 2:
+        sys.stdout.write(table)
+        return 0
+    with open(argv[2]) as source:
+        text = source.read()
+    pattern = re.compile(
+        r'(static constexpr SROMInfo ROMDatabase\[\] = \{\n).*?(^\};)',
+        re.DOTALL | re.MULTILINE)
+    text, count = pattern.subn(
+        lambda match: match.group(1) + table + match.group(2), text)
+    if count != 1:
+        sys.stderr.write('ROMDatabase not found in %s\n' % argv[2])
+        return 1
+    with open(argv[2], 'w') as source:
+        source.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,66 @@
+/**
+ * @file
+ * Converts binary instruction trace to nestest-style log
+ */
+/*
+ NES Emulator
+ Copyright (C) 2012-2018  Ivanov Viktor
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <vpnes/vpnes.hpp>
+#include <vpnes/core/cputrace.hpp>
+
+/**
+ * Main entry
+ *
+ * @param argc Amount of parameters
+ * @param argv Array of parameters
+ * @return Exit code
+ */
+int main(int argc, char **argv) {
+	try {
+		if (argc > 2) {
+			std::cerr << "Usage:" << std::endl;
+			std::cerr << argv[0] << " [trace_file]" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (argc == 2) {
+			std::ifstream input(argv[1], std::ifstream::binary);
+			if (!input.is_open()) {
+				throw std::invalid_argument(
+				    std::string("Could not open ") + argv[1]);
+			}
+			vpnes::core::dumpInstructionTrace(input, std::cout);
+		} else {
+			vpnes::core::dumpInstructionTrace(std::cin, std::cout);
+		}
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}